@@ -0,0 +1,768 @@
+/*
+* Microbenchmarks for the math types, reports ns/op and throughput per batch size as a table and as JSON
+*
+* Build on Linux from the repository root:
+*   g++ -std=c++14 -O2 -pthread build/VrixicMathLibraryBenchmark/VrixicMathLibraryBenchmark.cpp -o VrixicMathLibraryBenchmark
+*   (add -mavx2 -mfma to benchmark the compile time AVX2 path instead of the runtime dispatched one)
+*
+* Usage: VrixicMathLibraryBenchmark [--json <file>] [--filter <text>] [--min-time <ms>] [--sizes 16,1024,65536] [--bvh-triangles 5000000] [--lbvh-triangles 1000000]
+* The BVH benchmarks build a level of --bvh-triangles triangles once per run, 0 skips them
+* The linear BVH benchmarks rebuild and refit a deforming mesh of --lbvh-triangles triangles, 0 skips them
+* Compare two JSON files by matching "name" + "batch_size" and looking at "ns_per_op"
+*/
+#include "../../includes/VrixicMath.h"
+#include "../../includes/AffineMatrix.h"
+#include "../../includes/AnimationClip.h"
+#include "../../includes/BVH.h"
+#include "../../includes/DualQuat.h"
+#include "../../includes/Frustum.h"
+#include "../../includes/MatrixChain.h"
+#include "../../includes/PackedFormats.h"
+#include "../../includes/QuatStream.h"
+#include "../../includes/RayPacket.h"
+#include "../../includes/Transform.h"
+#include "../../includes/TransformHierarchy.h"
+#include "../../includes/VrixicMathCPU.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace Vrixic::Math;
+
+/* Keeps the compiler from removing work whose result is never read */
+template<class T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char Sink;
+    Sink = *reinterpret_cast<const volatile char*>(&value);
+    _ReadWriteBarrier();
+#endif
+}
+
+struct BenchmarkResult
+{
+    std::string Name;
+    uint32 BatchSize;
+    uint64 Iterations;
+    double NsPerOp;
+    double MinNsPerOp;
+    double OpsPerSecond;
+};
+
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(double minTimeMs, const std::string& filter)
+        : MinTimeMs(minTimeMs), Filter(filter) { }
+
+    /**
+    * Times 'pass' which does 'batchSize' operations each call
+    * The pass is repeated until one sample takes MinTimeMs / Samples, the median sample is reported
+    */
+    template<class PassFunction>
+    void Run(const char* name, uint32 batchSize, PassFunction&& pass)
+    {
+        if (!Matches(name))
+        {
+            return;
+        }
+
+        typedef std::chrono::steady_clock Clock;
+        const double SampleTimeNs = MinTimeMs * 1.0e6 / Samples;
+
+        /* Warm up caches and find how many passes fill one sample */
+        uint64 PassesPerSample = 1;
+        for (;;)
+        {
+            Clock::time_point Start = Clock::now();
+            for (uint64 i = 0; i < PassesPerSample; ++i)
+            {
+                pass();
+            }
+            double ElapsedNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Start).count());
+
+            if (ElapsedNs >= SampleTimeNs || PassesPerSample >= (1ull << 40))
+            {
+                break;
+            }
+
+            PassesPerSample = ElapsedNs <= 0.0 ? PassesPerSample * 16 : std::max<uint64>(PassesPerSample * 2, static_cast<uint64>(PassesPerSample * SampleTimeNs * 1.2 / ElapsedNs));
+        }
+
+        double SampleNsPerOp[Samples];
+        for (uint32 s = 0; s < Samples; ++s)
+        {
+            Clock::time_point Start = Clock::now();
+            for (uint64 i = 0; i < PassesPerSample; ++i)
+            {
+                pass();
+            }
+            double ElapsedNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Start).count());
+            SampleNsPerOp[s] = ElapsedNs / (static_cast<double>(PassesPerSample) * batchSize);
+        }
+
+        std::sort(SampleNsPerOp, SampleNsPerOp + Samples);
+
+        BenchmarkResult Result;
+        Result.Name = name;
+        Result.BatchSize = batchSize;
+        Result.Iterations = PassesPerSample * Samples * batchSize;
+        Result.NsPerOp = SampleNsPerOp[Samples / 2];
+        Result.MinNsPerOp = SampleNsPerOp[0];
+        Result.OpsPerSecond = Result.NsPerOp > 0.0 ? 1.0e9 / Result.NsPerOp : 0.0;
+        Results.push_back(Result);
+
+        std::printf("%-36s %8u %12.3f %12.3f %16.0f\n", name, batchSize, Result.NsPerOp, Result.MinNsPerOp, Result.OpsPerSecond);
+    }
+
+    bool Matches(const char* name) const
+    {
+        return Filter.empty() || std::strstr(name, Filter.c_str()) != nullptr;
+    }
+
+    bool WriteJson(const char* path) const
+    {
+        FILE* File = std::fopen(path, "w");
+        if (File == nullptr)
+        {
+            return false;
+        }
+
+#if defined(__clang__)
+        const char* Compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+        const char* Compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        const char* Compiler = "msvc";
+#else
+        const char* Compiler = "unknown";
+#endif
+
+        std::fprintf(File, "{\n");
+        std::fprintf(File, "  \"library\": \"VrixicMathLibrary\",\n");
+        std::fprintf(File, "  \"compiler\": \"%s\",\n", Compiler);
+        std::fprintf(File, "  \"simd_compiled\": \"%s\",\n", GetSIMDLevelName(GetCompiledSIMDLevel()));
+        std::fprintf(File, "  \"simd_active\": \"%s\",\n", GetSIMDLevelName(GetActiveSIMDLevel()));
+        std::fprintf(File, "  \"min_time_ms\": %.1f,\n", MinTimeMs);
+        std::fprintf(File, "  \"results\": [\n");
+        for (size_t i = 0; i < Results.size(); ++i)
+        {
+            const BenchmarkResult& R = Results[i];
+            std::fprintf(File, "    { \"name\": \"%s\", \"batch_size\": %u, \"iterations\": %llu, \"ns_per_op\": %.4f, \"min_ns_per_op\": %.4f, \"ops_per_sec\": %.1f }%s\n",
+                R.Name.c_str(), R.BatchSize, static_cast<unsigned long long>(R.Iterations), R.NsPerOp, R.MinNsPerOp, R.OpsPerSecond,
+                i + 1 < Results.size() ? "," : "");
+        }
+        std::fprintf(File, "  ]\n}\n");
+
+        return std::fclose(File) == 0;
+    }
+
+private:
+    static constexpr uint32 Samples = 5;
+
+    double MinTimeMs;
+    std::string Filter;
+    std::vector<BenchmarkResult> Results;
+};
+
+/* Random inputs shared by every benchmark of one batch size, generated with a fixed seed so runs are comparable */
+struct BenchmarkData
+{
+    std::vector<Vector3D> A3, B3, Out3, Extents;
+    std::vector<Vector4D> A4, B4, Out4;
+    std::vector<Matrix4D> MatA, MatB, OutMat;
+    std::vector<AffineMatrix> AffineA, AffineB, OutAffine;
+    std::vector<Quat> QuatA, QuatB, OutQuat;
+    std::vector<PackedQuat32> Packed32;
+    std::vector<PackedQuat48> Packed48;
+    std::vector<HalfVector3D> Halves;
+    std::vector<QuantizedVector3D> Quantized;
+    std::vector<Transform> Transforms;
+    std::vector<Plane> Planes;
+    std::vector<float> Scalars, Angles, Units, Positives, OutA, OutB;
+    std::vector<uint32> Indices;
+    Vector3DStream Stream;
+    QuatStream QuatStreamA, QuatStreamB, OutQuatStream;
+
+    explicit BenchmarkData(uint32 count)
+    {
+        std::mt19937 Generator(1234u + count);
+        std::uniform_real_distribution<float> Value(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> Unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> Ratio(0.0f, 1.0f);
+
+        A3.resize(count); B3.resize(count); Out3.resize(count); Extents.resize(count);
+        A4.resize(count); B4.resize(count); Out4.resize(count);
+        MatA.resize(count); MatB.resize(count); OutMat.resize(count);
+        AffineA.resize(count); AffineB.resize(count); OutAffine.resize(count);
+        QuatA.resize(count); QuatB.resize(count); OutQuat.resize(count);
+        Packed32.resize(count); Packed48.resize(count); Halves.resize(count); Quantized.resize(count);
+        Transforms.resize(count);
+        Planes.resize(count); Scalars.resize(count); Indices.resize(count + 32);
+        Angles.resize(count); Units.resize(count); Positives.resize(count); OutA.resize(count); OutB.resize(count);
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            A3[i] = Vector3D(Value(Generator), Value(Generator), Value(Generator));
+            B3[i] = Vector3D(Value(Generator), Value(Generator), Value(Generator));
+            Extents[i] = Vector3D(Ratio(Generator) * 10.0f, Ratio(Generator) * 10.0f, Ratio(Generator) * 10.0f);
+            A4[i] = Vector4D(A3[i], 1.0f);
+            B4[i] = Vector4D(B3[i], 0.0f);
+
+            MatA[i] = Matrix4D::MakeRotX(Value(Generator)) * Matrix4D::MakeRotY(Value(Generator));
+            MatA[i].SetTranslation(A3[i]);
+            MatB[i] = Matrix4D::MakeRotZ(Value(Generator));
+            AffineA[i] = AffineMatrix(MatA[i]);
+            AffineB[i] = AffineMatrix(MatB[i]);
+
+            QuatA[i] = Quat(Unit(Generator), Unit(Generator), Unit(Generator), Unit(Generator));
+            QuatA[i].Normalize();
+            QuatB[i] = Quat(Unit(Generator), Unit(Generator), Unit(Generator), Unit(Generator));
+            QuatB[i].Normalize();
+
+            Vector3D Normal(Unit(Generator), Unit(Generator), Unit(Generator));
+            Normal.Normalize();
+            Planes[i] = Plane(Normal, Value(Generator));
+
+            Scalars[i] = Ratio(Generator);
+            Angles[i] = Value(Generator);
+            Units[i] = Unit(Generator);
+            Positives[i] = Ratio(Generator) * 100.0f + 0.001f;
+        }
+
+        Stream.FromAoS(A3.data(), count);
+        QuatStreamA.FromAoS(QuatA.data(), count);
+        QuatStreamB.FromAoS(QuatB.data(), count);
+        OutQuatStream.Resize(count);
+    }
+};
+
+void RunBenchmarks(BenchmarkRunner& runner, uint32 n)
+{
+    BenchmarkData D(n);
+
+    Frustum CameraFrustum(16.0f / 9.0f, 1.0f, 0.1f, 200.0f);
+    Matrix4D Camera = Matrix4D::Identity();
+    Camera.SetTranslation(Vector3D(0.0f, 0.0f, -100.0f));
+    CameraFrustum.CreateFrustum(Camera);
+
+    /* Vector3D */
+    runner.Run("Vector3D::operator+", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out3[i] = D.A3[i] + D.B3[i]; DoNotOptimize(D.Out3[0]); });
+    runner.Run("Vector3D::operator*(float)", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out3[i] = D.A3[i] * D.Scalars[i]; DoNotOptimize(D.Out3[0]); });
+    runner.Run("Vector3D::DotProduct", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Scalars[i] = Vector3D::DotProduct(D.A3[i], D.B3[i]); DoNotOptimize(D.Scalars[0]); });
+    runner.Run("Vector3D::CrossProduct", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out3[i] = Vector3D::CrossProduct(D.A3[i], D.B3[i]); DoNotOptimize(D.Out3[0]); });
+    runner.Run("Vector3D::Normalize", n, [&]() { for (uint32 i = 0; i < n; ++i) { D.Out3[i] = D.A3[i]; D.Out3[i].Normalize(); } DoNotOptimize(D.Out3[0]); });
+    runner.Run("Vector3D::Lerp", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out3[i] = Vector3D::Lerp(D.A3[i], D.B3[i], 0.25f); DoNotOptimize(D.Out3[0]); });
+
+    /* Vector4D */
+    runner.Run("Vector4D::operator+", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out4[i] = D.A4[i] + D.B4[i]; DoNotOptimize(D.Out4[0]); });
+    runner.Run("Vector4D::operator*", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out4[i] = D.A4[i] * D.B4[i]; DoNotOptimize(D.Out4[0]); });
+    runner.Run("Vector4D::DotProduct", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Scalars[i] = Vector4D::DotProduct(D.A4[i], D.B4[i]); DoNotOptimize(D.Scalars[0]); });
+    runner.Run("Vector4D::Normalize", n, [&]() { for (uint32 i = 0; i < n; ++i) { D.Out4[i] = D.A4[i]; D.Out4[i].Normalize(); } DoNotOptimize(D.Out4[0]); });
+
+    /* Vector3DStream */
+    runner.Run("Vector3DStream::Normalize", n, [&]() { D.Stream.Normalize(); DoNotOptimize(D.Stream.GetX()[0]); });
+
+    /* Matrix4D */
+    runner.Run("Matrix4D::operator*(Matrix4D)", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = D.MatA[i] * D.MatB[i]; DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::operator*(Vector4D)", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out4[i] = D.MatA[i] * D.A4[i]; DoNotOptimize(D.Out4[0]); });
+    runner.Run("Matrix4D::Inverse", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = D.MatA[i].Inverse(); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::InverseBatch", n, [&]() { Matrix4D::InverseBatch(D.MatA.data(), D.OutMat.data(), n); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MultiplyBatch", n, [&]() { Matrix4D::MultiplyBatch(D.MatA.data(), D.MatB.data(), D.OutMat.data(), n); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::Determinant", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Scalars[i] = D.MatA[i].Determinant(); DoNotOptimize(D.Scalars[0]); });
+    runner.Run("Matrix4D::GetLocalScale+Quat::MakeFromMatrix4D", n, [&]() { for (uint32 i = 0; i < n; ++i) { D.Out3[i] = D.MatA[i].GetLocalScale(); D.OutQuat[i] = Quat::MakeFromMatrix4D(D.MatA[i]); } DoNotOptimize(D.OutQuat[0]); });
+    runner.Run("Transform::Decompose", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Transforms[i] = Transform::Decompose(D.MatA[i]); DoNotOptimize(D.Transforms[0]); });
+    runner.Run("Transform::DecomposeBatch", n, [&]() { Transform::DecomposeBatch(D.MatA.data(), D.Transforms.data(), n); DoNotOptimize(D.Transforms[0]); });
+    std::vector<Transform> ParentTransforms(D.Transforms.rbegin(), D.Transforms.rend()), OutTransforms(n);
+    runner.Run("Transform::operator*", n, [&]() { for (uint32 i = 0; i < n; ++i) OutTransforms[i] = D.Transforms[i] * ParentTransforms[i]; DoNotOptimize(OutTransforms[0]); });
+    runner.Run("Transform::MultiplyBatch", n, [&]() { Transform::MultiplyBatch(D.Transforms.data(), ParentTransforms.data(), OutTransforms.data(), n); DoNotOptimize(OutTransforms[0]); });
+    runner.Run("Matrix4D::Transpose", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = Matrix4D::Transpose(D.MatA[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MakeRotX", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = Matrix4D::MakeRotX(D.Scalars[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MakeRotY", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = Matrix4D::MakeRotY(D.Scalars[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MakeRotZ", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = Matrix4D::MakeRotZ(D.Scalars[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MakeRotX*MakeRotY*MakeRotZ", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = Matrix4D::MakeRotX(D.Scalars[i]) * Matrix4D::MakeRotY(D.Scalars[i]) * Matrix4D::MakeRotZ(D.Scalars[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("MatrixChain RotX*RotY*RotZ", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = RotationXFactor(D.Scalars[i]) * RotationYFactor(D.Scalars[i]) * RotationZFactor(D.Scalars[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("MatrixChain RotY*RotX*Matrix4D", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = RotationYFactor(D.Scalars[i]) * RotationXFactor(D.Scalars[i]) * D.MatA[i]; DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MakeRotationXYZ", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = Matrix4D::MakeRotationXYZ(D.A3[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MakeRotationBatch", n, [&]() { Matrix4D::MakeRotationBatch(D.A3.data(), D.OutMat.data(), n); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::MakeRotationAxisAngle", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = Matrix4D::MakeRotationAxisAngle(Vector3D(0.0f, 1.0f, 0.0f), D.Scalars[i]); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Matrix4D::TransformPoints", n, [&]() { D.MatA[0].TransformPoints(D.A3.data(), D.Out3.data(), n); DoNotOptimize(D.Out3[0]); });
+    runner.Run("Matrix4D::TransformHomogeneous", n, [&]() { D.MatA[0].TransformHomogeneous(D.A4.data(), D.Out4.data(), n); DoNotOptimize(D.Out4[0]); });
+    runner.Run("AffineMatrix::operator*(AffineMatrix)", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutAffine[i] = D.AffineA[i] * D.AffineB[i]; DoNotOptimize(D.OutAffine[0]); });
+    runner.Run("AffineMatrix::Inverse", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutAffine[i] = D.AffineA[i].Inverse(); DoNotOptimize(D.OutAffine[0]); });
+    runner.Run("AffineMatrix::TransformPoint", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out3[i] = D.AffineA[0].TransformPoint(D.A3[i]); DoNotOptimize(D.Out3[0]); });
+
+    /* TransformHierarchy, a 4-ary tree of n nodes */
+    TransformHierarchy Hierarchy;
+    Hierarchy.Reserve(n);
+    for (uint32 i = 0; i < n; ++i)
+    {
+        Hierarchy.AddNode(D.MatA[i], i == 0 ? TransformHierarchy::InvalidNode : (i - 1) / 4);
+    }
+    Hierarchy.Update();
+    runner.Run("TransformHierarchy::Update (root dirty)", n, [&]() { Hierarchy.SetLocalMatrix(0, D.MatA[0]); Hierarchy.Update(); DoNotOptimize(Hierarchy.GetWorldMatrix(n - 1)); });
+    runner.Run("TransformHierarchy::Update (one leaf dirty)", n, [&]() { Hierarchy.SetLocalMatrix(n - 1, D.MatA[n - 1]); Hierarchy.Update(); DoNotOptimize(Hierarchy.GetWorldMatrix(n - 1)); });
+
+    /* Quat */
+    runner.Run("Quat::operator*", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutQuat[i] = D.QuatA[i] * D.QuatB[i]; DoNotOptimize(D.OutQuat[0]); });
+    runner.Run("Quat::Slerp", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutQuat[i] = Quat::Slerp(D.QuatA[i], D.QuatB[i], D.Scalars[i]); DoNotOptimize(D.OutQuat[0]); });
+    runner.Run("QuatStream::NLerp", n, [&]() { QuatStream::NLerp(D.QuatStreamA, D.QuatStreamB, 0.3f, D.OutQuatStream); DoNotOptimize(D.OutQuatStream.GetX()[0]); });
+    runner.Run("QuatStream::FastSlerp", n, [&]() { QuatStream::FastSlerp(D.QuatStreamA, D.QuatStreamB, 0.3f, D.OutQuatStream); DoNotOptimize(D.OutQuatStream.GetX()[0]); });
+    runner.Run("QuatStream::Slerp", n, [&]() { QuatStream::Slerp(D.QuatStreamA, D.QuatStreamB, 0.3f, D.OutQuatStream); DoNotOptimize(D.OutQuatStream.GetX()[0]); });
+    const QuatStream Poses[4] = { D.QuatStreamA, D.QuatStreamB, D.QuatStreamB, D.QuatStreamA };
+    const float PoseWeights[4] = { 0.4f, 0.3f, 0.2f, 0.1f };
+    runner.Run("QuatStream::Blend (4 poses)", n, [&]() { QuatStream::Blend(Poses, PoseWeights, 4, D.OutQuatStream); DoNotOptimize(D.OutQuatStream.GetX()[0]); });
+    /* Skinning with 4 influences per vertex, a 64 bone palette as matrices and as dual quaternions */
+    const uint32 BoneCount = 64;
+    std::vector<Matrix4D> MatrixPalette(D.MatA.begin(), D.MatA.begin() + (n < BoneCount ? n : BoneCount));
+    std::vector<DualQuat> DualQuatPalette(MatrixPalette.size());
+    for (size_t b = 0; b < MatrixPalette.size(); ++b)
+    {
+        DualQuatPalette[b] = DualQuat::MakeFromMatrix4D(MatrixPalette[b]);
+    }
+    std::vector<uint32> BoneIndices(n * 4);
+    std::vector<float> BoneWeights(n * 4);
+    for (uint32 i = 0; i < n * 4; ++i)
+    {
+        BoneIndices[i] = (i * 2654435761u >> 8) % static_cast<uint32>(MatrixPalette.size());
+        BoneWeights[i] = 0.25f;
+    }
+    runner.Run("Matrix4D linear blend skinning", n, [&]()
+    {
+        for (uint32 i = 0; i < n; ++i)
+        {
+            VectorRegister Rows[4] = { VectorRegisterZero(), VectorRegisterZero(), VectorRegisterZero(), VectorRegisterZero() };
+            for (uint32 k = 0; k < 4; ++k)
+            {
+                const Matrix4D& Bone = MatrixPalette[BoneIndices[i * 4 + k]];
+                const VectorRegister Weight = VectorRegisterReplicate(BoneWeights[i * 4 + k]);
+                for (uint32 r = 0; r < 4; ++r)
+                {
+                    Rows[r] = VectorRegisterMultiplyAdd(MakeVectorRegister(&Bone(r, 0)), Weight, Rows[r]);
+                }
+            }
+
+            alignas(16) float Point[4];
+            StoreVectorRegisterAligned(Point, VectorRegisterTransformByRows(MakeVectorRegister(D.A3[i].X, D.A3[i].Y, D.A3[i].Z, 1.0f), Rows[0], Rows[1], Rows[2], Rows[3]));
+            D.Out3[i] = Vector3D(Point[0], Point[1], Point[2]);
+        }
+        DoNotOptimize(D.Out3[0]);
+    });
+    runner.Run("DualQuat::SkinPoints", n, [&]() { DualQuat::SkinPoints(DualQuatPalette.data(), BoneIndices.data(), BoneWeights.data(), D.A3.data(), D.Out3.data(), n); DoNotOptimize(D.Out3[0]); });
+    runner.Run("Quat::RotateVector", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Out3[i] = D.QuatA[i].RotateVector(D.A3[i]); DoNotOptimize(D.Out3[0]); });
+    runner.Run("Quat::RotateVectors", n, [&]() { Quat::RotateVectors(D.QuatA.data(), D.A3.data(), D.Out3.data(), n); DoNotOptimize(D.Out3[0]); });
+    runner.Run("Quat::ToMatrix4D", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutMat[i] = D.QuatA[i].ToMatrix4D(); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Quat::ToMatrix4DBatch", n, [&]() { Quat::ToMatrix4DBatch(D.QuatA.data(), D.OutMat.data(), n); DoNotOptimize(D.OutMat[0]); });
+    runner.Run("Quat::MakeFromMatrix4D", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutQuat[i] = Quat::MakeFromMatrix4D(D.MatA[i]); DoNotOptimize(D.OutQuat[0]); });
+    runner.Run("Quat::MakeFromMatrix4DBatch", n, [&]() { Quat::MakeFromMatrix4DBatch(D.MatA.data(), D.OutQuat.data(), n); DoNotOptimize(D.OutQuat[0]); });
+
+    /* AnimationClip, n bones with 32 keys per channel played forward at 60 Hz, against a binary search per track */
+    const uint32 ClipKeyCount = 32;
+    const float ClipDuration = 1.0f;
+    std::vector<AnimationTrack> Tracks(n);
+    for (uint32 b = 0; b < n; ++b)
+    {
+        for (uint32 k = 0; k < ClipKeyCount; ++k)
+        {
+            const float Time = ClipDuration * k / (ClipKeyCount - 1);
+            const uint32 Source = (b + k) % n;
+            Tracks[b].RotationTimes.push_back(Time);
+            Tracks[b].Rotations.push_back(D.QuatA[Source]);
+            Tracks[b].TranslationTimes.push_back(Time);
+            Tracks[b].Translations.push_back(D.A3[Source]);
+            Tracks[b].ScaleTimes.push_back(Time);
+            Tracks[b].Scales.push_back(D.B3[Source]);
+        }
+    }
+    const AnimationClip Clip(Tracks.data(), n, ClipDuration);
+    AnimationSampler Sampler(Clip);
+    float ClipTime = 0.0f;
+    const auto AdvanceClipTime = [&]() { ClipTime += 1.0f / 60.0f; if (ClipTime > ClipDuration) ClipTime -= ClipDuration; };
+    const auto FindSegment = [](const std::vector<float>& times, float time, float& outRatio)
+    {
+        const uint32 Next = static_cast<uint32>(std::upper_bound(times.begin() + 1, times.end() - 1, time) - times.begin());
+        outRatio = std::min(std::max((time - times[Next - 1]) / (times[Next] - times[Next - 1]), 0.0f), 1.0f);
+        return Next - 1;
+    };
+    runner.Run("Binary search + Quat::Slerp pose", n, [&]()
+    {
+        AdvanceClipTime();
+        for (uint32 b = 0; b < n; ++b)
+        {
+            const AnimationTrack& Track = Tracks[b];
+            float Ratio;
+            uint32 Key = FindSegment(Track.RotationTimes, ClipTime, Ratio);
+            OutTransforms[b].Rotation = Quat::Slerp(Track.Rotations[Key], Track.Rotations[Key + 1], Ratio);
+            Key = FindSegment(Track.TranslationTimes, ClipTime, Ratio);
+            OutTransforms[b].Translation = Track.Translations[Key] + (Track.Translations[Key + 1] - Track.Translations[Key]) * Ratio;
+            Key = FindSegment(Track.ScaleTimes, ClipTime, Ratio);
+            OutTransforms[b].Scale = Track.Scales[Key] + (Track.Scales[Key + 1] - Track.Scales[Key]) * Ratio;
+        }
+        DoNotOptimize(OutTransforms[0]);
+    });
+    runner.Run("AnimationSampler::Sample", n, [&]() { AdvanceClipTime(); Sampler.Sample(ClipTime, OutTransforms.data()); DoNotOptimize(OutTransforms[0]); });
+
+    /* Ray, 8 rays against n boxes and n triangles, one ray at a time and as one 8 wide packet */
+    Ray Rays[8];
+    for (uint32 k = 0; k < 8; ++k)
+    {
+        Rays[k] = Ray(Vector3D(0.0f, 0.0f, -200.0f) + D.A3[k] * 0.1f, Vector3D(0.0f, 0.0f, 1.0f) + D.B3[k] * 0.002f);
+    }
+    const RayPacket8 Packet(Rays);
+    std::vector<Vector3D> BoxMax(n);
+    for (uint32 i = 0; i < n; ++i)
+    {
+        BoxMax[i] = D.A3[i] + Vector3D(20.0f, 20.0f, 20.0f);
+    }
+    runner.Run("Ray::IntersectAABB (x8 rays)", n, [&]()
+    {
+        uint32 Hits = 0;
+        float Distance;
+        for (uint32 i = 0; i < n; ++i) for (uint32 k = 0; k < 8; ++k) Hits += Rays[k].IntersectAABB(D.A3[i], BoxMax[i], 1000.0f, Distance);
+        DoNotOptimize(Hits);
+    });
+    runner.Run("RayPacket8::IntersectAABB", n, [&]()
+    {
+        uint32 Hits = 0;
+        VectorRegister8 Distance = VectorRegister8Zero();
+        for (uint32 i = 0; i < n; ++i) Hits += VectorRegister8MoveMask(Packet.IntersectAABB(D.A3[i], BoxMax[i], VectorRegister8Replicate(1000.0f), Distance));
+        DoNotOptimize(Hits);
+    });
+    runner.Run("Ray::IntersectTriangle (x8 rays)", n, [&]()
+    {
+        uint32 Hits = 0;
+        float Distance, U, V;
+        for (uint32 i = 0; i < n; ++i) for (uint32 k = 0; k < 8; ++k) Hits += Rays[k].IntersectTriangle(D.A3[i], D.B3[i], BoxMax[i], 1000.0f, Distance, U, V);
+        DoNotOptimize(Hits);
+    });
+    runner.Run("RayPacket8::IntersectTriangle", n, [&]()
+    {
+        uint32 Hits = 0;
+        VectorRegister8 Distance = VectorRegister8Zero(), U = VectorRegister8Zero(), V = VectorRegister8Zero();
+        for (uint32 i = 0; i < n; ++i) Hits += VectorRegister8MoveMask(Packet.IntersectTriangle(D.A3[i], D.B3[i], BoxMax[i], VectorRegister8Replicate(1000.0f), Distance, U, V));
+        DoNotOptimize(Hits);
+    });
+
+    /* PackedFormats */
+    const Vector3DQuantizer Quantizer(Vector3D(-100.0f, -100.0f, -100.0f), Vector3D(100.0f, 100.0f, 100.0f));
+    runner.Run("PackedQuat32::Encode", n, [&]() { for (uint32 i = 0; i < n; ++i) D.Packed32[i] = PackedQuat32::Encode(D.QuatA[i]); DoNotOptimize(D.Packed32[0]); });
+    runner.Run("PackedQuat32::EncodeBatch", n, [&]() { PackedQuat32::EncodeBatch(D.QuatA.data(), D.Packed32.data(), n); DoNotOptimize(D.Packed32[0]); });
+    runner.Run("PackedQuat32::Decode", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutQuat[i] = D.Packed32[i].Decode(); DoNotOptimize(D.OutQuat[0]); });
+    runner.Run("PackedQuat32::DecodeBatch", n, [&]() { PackedQuat32::DecodeBatch(D.Packed32.data(), D.OutQuat.data(), n); DoNotOptimize(D.OutQuat[0]); });
+    runner.Run("PackedQuat48::EncodeBatch", n, [&]() { PackedQuat48::EncodeBatch(D.QuatA.data(), D.Packed48.data(), n); DoNotOptimize(D.Packed48[0]); });
+    runner.Run("PackedQuat48::DecodeBatch", n, [&]() { PackedQuat48::DecodeBatch(D.Packed48.data(), D.OutQuat.data(), n); DoNotOptimize(D.OutQuat[0]); });
+    runner.Run("HalfVector3D::EncodeBatch", n, [&]() { HalfVector3D::EncodeBatch(D.A3.data(), D.Halves.data(), n); DoNotOptimize(D.Halves[0]); });
+    runner.Run("HalfVector3D::DecodeBatch", n, [&]() { HalfVector3D::DecodeBatch(D.Halves.data(), D.Out3.data(), n); DoNotOptimize(D.Out3[0]); });
+    runner.Run("Vector3DQuantizer::EncodeBatch", n, [&]() { Quantizer.EncodeBatch(D.A3.data(), D.Quantized.data(), n); DoNotOptimize(D.Quantized[0]); });
+    runner.Run("Vector3DQuantizer::DecodeBatch", n, [&]() { Quantizer.DecodeBatch(D.Quantized.data(), D.Out3.data(), n); DoNotOptimize(D.Out3[0]); });
+
+    /* Transcendentals, libm against the polynomial versions, the 8 wide loops skip the last n % 8 elements */
+    const uint32 n8 = n & ~7u;
+    runner.Run("std::sin+std::cos", n, [&]() { for (uint32 i = 0; i < n; ++i) { D.OutA[i] = std::sin(D.Angles[i]); D.OutB[i] = std::cos(D.Angles[i]); } DoNotOptimize(D.OutA[0]); });
+    runner.Run("MathUtils::SinCos", n, [&]() { for (uint32 i = 0; i < n; ++i) MathUtils::SinCos(D.Angles[i], D.OutA[i], D.OutB[i]); DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8SinCos<Fast>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) { VectorRegister8 S, C; VectorRegister8SinCos<MathAccuracy::Fast>(MakeVectorRegister8(&D.Angles[i]), S, C); StoreVectorRegister8(&D.OutA[i], S); StoreVectorRegister8(&D.OutB[i], C); } DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8SinCos<Medium>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) { VectorRegister8 S, C; VectorRegister8SinCos<MathAccuracy::Medium>(MakeVectorRegister8(&D.Angles[i]), S, C); StoreVectorRegister8(&D.OutA[i], S); StoreVectorRegister8(&D.OutB[i], C); } DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8SinCos<Precise>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) { VectorRegister8 S, C; VectorRegister8SinCos(MakeVectorRegister8(&D.Angles[i]), S, C); StoreVectorRegister8(&D.OutA[i], S); StoreVectorRegister8(&D.OutB[i], C); } DoNotOptimize(D.OutA[0]); });
+    runner.Run("std::atan2", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutA[i] = std::atan2(D.Angles[i], D.Units[i]); DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8Atan2<Precise>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) StoreVectorRegister8(&D.OutA[i], VectorRegister8Atan2(MakeVectorRegister8(&D.Angles[i]), MakeVectorRegister8(&D.Units[i]))); DoNotOptimize(D.OutA[0]); });
+    runner.Run("std::acos", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutA[i] = std::acos(D.Units[i]); DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8Acos<Precise>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) StoreVectorRegister8(&D.OutA[i], VectorRegister8Acos(MakeVectorRegister8(&D.Units[i]))); DoNotOptimize(D.OutA[0]); });
+    runner.Run("std::exp", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutA[i] = std::exp(D.Units[i]); DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8Exp<Precise>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) StoreVectorRegister8(&D.OutA[i], VectorRegister8Exp(MakeVectorRegister8(&D.Units[i]))); DoNotOptimize(D.OutA[0]); });
+    runner.Run("std::log", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutA[i] = std::log(D.Positives[i]); DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8Log<Precise>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) StoreVectorRegister8(&D.OutA[i], VectorRegister8Log(MakeVectorRegister8(&D.Positives[i]))); DoNotOptimize(D.OutA[0]); });
+    runner.Run("1/std::sqrt", n, [&]() { for (uint32 i = 0; i < n; ++i) D.OutA[i] = 1.0f / std::sqrt(D.Positives[i]); DoNotOptimize(D.OutA[0]); });
+    runner.Run("VectorRegister8ReciprocalSqrt<Medium>", n, [&]() { for (uint32 i = 0; i < n8; i += 8) StoreVectorRegister8(&D.OutA[i], VectorRegister8ReciprocalSqrt<MathAccuracy::Medium>(MakeVectorRegister8(&D.Positives[i]))); DoNotOptimize(D.OutA[0]); });
+
+    /* Plane */
+    runner.Run("Plane::IntersectSphereOnPlane", n, [&]() { uint32 NotBehind = 0; for (uint32 i = 0; i < n; ++i) NotBehind += Plane::IntersectSphereOnPlane(D.A3[i], D.Scalars[i], D.Planes[i]) != Back; DoNotOptimize(NotBehind); });
+    runner.Run("Plane::IntersectAABBOnPlane", n, [&]() { uint32 NotBehind = 0; for (uint32 i = 0; i < n; ++i) NotBehind += Plane::IntersectAABBOnPlane(D.A3[i], D.Extents[i], D.Planes[i]) != Back; DoNotOptimize(NotBehind); });
+
+    /* Frustum */
+    runner.Run("Frustum::CreateFrustum", n, [&]() { for (uint32 i = 0; i < n; ++i) CameraFrustum.CreateFrustum(D.MatA[i]); DoNotOptimize(CameraFrustum.Planes[0]); });
+    CameraFrustum.CreateFrustum(Camera);
+    runner.Run("Frustum::TestAABB", n, [&]() { uint32 Visible = 0; for (uint32 i = 0; i < n; ++i) Visible += CameraFrustum.TestAABB(D.A3[i], D.Extents[i]) != Back; DoNotOptimize(Visible); });
+    runner.Run("Frustum::CullAABBs", n, [&]() { CameraFrustum.CullAABBs(D.A3.data(), D.Extents.data(), n, D.Indices.data()); DoNotOptimize(D.Indices[0]); });
+    runner.Run("Frustum::CullAABBsToIndices", n, [&]() { uint32 Visible = CameraFrustum.CullAABBsToIndices(D.A3.data(), D.Extents.data(), n, D.Indices.data()); DoNotOptimize(Visible); });
+}
+
+/* Hands out chunks of [0, count) to every hardware thread, the calling thread works too */
+struct ThreadParallelFor
+{
+    uint32 ThreadCount;
+
+    template<class Job>
+    void operator()(uint32 count, Job&& job) const
+    {
+        const uint32 ChunkSize = std::max(1u, count / (ThreadCount * 8));
+        std::atomic<uint32> Next(0);
+        const auto Worker = [&]()
+        {
+            for (uint32 Begin = Next.fetch_add(ChunkSize); Begin < count; Begin = Next.fetch_add(ChunkSize))
+            {
+                job(Begin, std::min(count, Begin + ChunkSize));
+            }
+        };
+
+        std::vector<std::thread> Threads;
+        for (uint32 t = 1; t < ThreadCount && t * ChunkSize < count; ++t)
+        {
+            Threads.emplace_back(Worker);
+        }
+        Worker();
+        for (std::thread& Thread : Threads)
+        {
+            Thread.join();
+        }
+    }
+};
+
+/* Heightfield of about 'triangleCount' triangles on a grid of unit cells, returns the cells per side */
+uint32 MakeHeightfield(uint32 triangleCount, std::vector<Vector3D>& outVertices, std::vector<uint32>& outIndices)
+{
+    const uint32 GridSize = std::max(1u, static_cast<uint32>(std::sqrt(triangleCount / 2.0)));
+    outVertices.clear();
+    outVertices.reserve(size_t(GridSize + 1) * (GridSize + 1));
+    for (uint32 z = 0; z <= GridSize; ++z)
+    {
+        for (uint32 x = 0; x <= GridSize; ++x)
+        {
+            const float Height = 20.0f * std::sin(x * 0.01f) * std::cos(z * 0.013f) + 2.0f * std::sin(x * 0.3f + z * 0.17f);
+            outVertices.push_back(Vector3D(static_cast<float>(x), Height, static_cast<float>(z)));
+        }
+    }
+
+    outIndices.clear();
+    outIndices.reserve(size_t(GridSize) * GridSize * 6);
+    for (uint32 z = 0; z < GridSize; ++z)
+    {
+        for (uint32 x = 0; x < GridSize; ++x)
+        {
+            const uint32 Corner = z * (GridSize + 1) + x;
+            const uint32 Quad[6] = { Corner, Corner + GridSize + 1, Corner + 1, Corner + 1, Corner + GridSize + 1, Corner + GridSize + 2 };
+            outIndices.insert(outIndices.end(), Quad, Quad + 6);
+        }
+    }
+    return GridSize;
+}
+
+/* A heightfield level of about 'triangleCount' triangles, build time per triangle and rays per second */
+void RunBVHBenchmarks(BenchmarkRunner& runner, uint32 triangleCount)
+{
+    if (!runner.Matches("BVH::Build") && !runner.Matches("BVH::Intersect") && !runner.Matches("BVH::IsOccluded"))
+    {
+        return;
+    }
+
+    std::vector<Vector3D> Vertices;
+    std::vector<uint32> Indices;
+    const uint32 GridSize = MakeHeightfield(triangleCount, Vertices, Indices);
+    const float CellSize = 1.0f;
+    const uint32 LevelTriangles = static_cast<uint32>(Indices.size() / 3);
+
+    const ThreadParallelFor Threads = { std::max(1u, std::thread::hardware_concurrency()) };
+    BVH Hierarchy;
+    runner.Run("BVH::Build (1 thread)", LevelTriangles, [&]() { Hierarchy.Build(Vertices.data(), Indices.data(), LevelTriangles); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+    runner.Run("BVH::Build (all threads)", LevelTriangles, [&]() { Hierarchy.Build(Vertices.data(), Indices.data(), LevelTriangles, Threads); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+    if (Hierarchy.GetTriangleCount() == 0)
+    {
+        Hierarchy.Build(Vertices.data(), Indices.data(), LevelTriangles, Threads);
+    }
+    std::printf("BVH: %u triangles, %zu nodes, depth %u, %u threads\n", LevelTriangles, Hierarchy.GetNodes().size(), Hierarchy.GetDepth(), Threads.ThreadCount);
+
+    /* Picking style rays from above the level down onto it and line of sight rays between points above it */
+    const uint32 RayCount = 65536;
+    const float LevelSize = GridSize * CellSize;
+    std::mt19937 Generator(99u);
+    std::uniform_real_distribution<float> Position(0.0f, LevelSize);
+    std::uniform_real_distribution<float> Unit(-1.0f, 1.0f);
+    std::vector<Ray> DownRays(RayCount), SightRays(RayCount);
+    std::vector<float> SightDistances(RayCount);
+    for (uint32 i = 0; i < RayCount; ++i)
+    {
+        DownRays[i] = Ray(Vector3D(Position(Generator), 60.0f, Position(Generator)), Vector3D(Unit(Generator), -1.0f, Unit(Generator)));
+
+        const Vector3D From(Position(Generator), 25.0f, Position(Generator));
+        const Vector3D To = From + Vector3D(Unit(Generator), 0.0f, Unit(Generator)) * 100.0f;
+        SightRays[i] = Ray(From, To - From);
+        SightDistances[i] = (To - From).Length();
+    }
+
+    std::vector<RayHit> Hits(RayCount);
+    runner.Run("BVH::Intersect (1 thread)", RayCount, [&]()
+    {
+        uint32 HitCount = 0;
+        for (uint32 i = 0; i < RayCount; ++i) HitCount += Hierarchy.Intersect(DownRays[i], 1000.0f, Hits[i]);
+        DoNotOptimize(HitCount);
+    });
+    runner.Run("BVH::Intersect (all threads)", RayCount, [&]()
+    {
+        Threads(RayCount, [&](uint32 begin, uint32 end) { for (uint32 i = begin; i < end; ++i) Hierarchy.Intersect(DownRays[i], 1000.0f, Hits[i]); });
+        DoNotOptimize(Hits[0]);
+    });
+    runner.Run("BVH::IsOccluded (1 thread)", RayCount, [&]()
+    {
+        uint32 Occluded = 0;
+        for (uint32 i = 0; i < RayCount; ++i) Occluded += Hierarchy.IsOccluded(SightRays[i], SightDistances[i]);
+        DoNotOptimize(Occluded);
+    });
+}
+
+/* Per frame rebuild of a deforming mesh of about 'triangleCount' triangles, the heightfield waves every frame */
+void RunLinearBVHBenchmarks(BenchmarkRunner& runner, uint32 triangleCount)
+{
+    if (!runner.Matches("BVH::BuildLinear") && !runner.Matches("BVH::Refit") && !runner.Matches("BVH::Intersect (linear"))
+    {
+        return;
+    }
+
+    std::vector<Vector3D> Vertices;
+    std::vector<uint32> Indices;
+    const uint32 GridSize = MakeHeightfield(triangleCount, Vertices, Indices);
+    const uint32 MeshTriangles = static_cast<uint32>(Indices.size() / 3);
+
+    std::vector<Vector3D> Frame(Vertices);
+    uint32 FrameIndex = 0;
+    const auto NextFrame = [&]()
+    {
+        FrameIndex++;
+        for (size_t i = 0; i < Frame.size(); ++i)
+        {
+            Frame[i].Y = Vertices[i].Y + std::sin(Vertices[i].X * 0.05f + FrameIndex * 0.1f);
+        }
+    };
+    NextFrame();
+
+    const ThreadParallelFor Threads = { std::max(1u, std::thread::hardware_concurrency()) };
+    BVH Hierarchy;
+    runner.Run("BVH::BuildLinear 30 bit (1 thread)", MeshTriangles, [&]() { Hierarchy.BuildLinear(Frame.data(), Indices.data(), MeshTriangles, MortonPrecision::Bits30); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+    runner.Run("BVH::BuildLinear 30 bit (all threads)", MeshTriangles, [&]() { Hierarchy.BuildLinear(Frame.data(), Indices.data(), MeshTriangles, MortonPrecision::Bits30, Threads); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+    runner.Run("BVH::BuildLinear 63 bit (1 thread)", MeshTriangles, [&]() { Hierarchy.BuildLinear(Frame.data(), Indices.data(), MeshTriangles, MortonPrecision::Bits63); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+    runner.Run("BVH::BuildLinear 63 bit (all threads)", MeshTriangles, [&]() { Hierarchy.BuildLinear(Frame.data(), Indices.data(), MeshTriangles, MortonPrecision::Bits63, Threads); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+
+    /* Refit only measures the bounds update, the deformation itself runs outside the timed runs */
+    Hierarchy.BuildLinear(Frame.data(), Indices.data(), MeshTriangles, MortonPrecision::Bits30, Threads);
+    NextFrame();
+    runner.Run("BVH::Refit (1 thread)", MeshTriangles, [&]() { Hierarchy.Refit(Frame.data(), Indices.data()); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+    runner.Run("BVH::Refit (all threads)", MeshTriangles, [&]() { Hierarchy.Refit(Frame.data(), Indices.data(), Threads); DoNotOptimize(Hierarchy.GetNodes()[0]); });
+    std::printf("BVH (linear): %u triangles, %zu nodes, depth %u, %u threads\n", MeshTriangles, Hierarchy.GetNodes().size(), Hierarchy.GetDepth(), Threads.ThreadCount);
+
+    /* Same picking rays as RunBVHBenchmarks(), the cost of the Morton tree against the SAH one */
+    const uint32 RayCount = 65536;
+    std::mt19937 Generator(99u);
+    std::uniform_real_distribution<float> Position(0.0f, static_cast<float>(GridSize));
+    std::uniform_real_distribution<float> Unit(-1.0f, 1.0f);
+    std::vector<Ray> DownRays(RayCount);
+    for (uint32 i = 0; i < RayCount; ++i)
+    {
+        DownRays[i] = Ray(Vector3D(Position(Generator), 60.0f, Position(Generator)), Vector3D(Unit(Generator), -1.0f, Unit(Generator)));
+    }
+
+    std::vector<RayHit> Hits(RayCount);
+    runner.Run("BVH::Intersect (linear, 1 thread)", RayCount, [&]()
+    {
+        uint32 HitCount = 0;
+        for (uint32 i = 0; i < RayCount; ++i) HitCount += Hierarchy.Intersect(DownRays[i], 1000.0f, Hits[i]);
+        DoNotOptimize(HitCount);
+    });
+}
+
+int main(int argc, char** argv)
+{
+    const char* JsonPath = nullptr;
+    std::string Filter;
+    double MinTimeMs = 100.0;
+    std::vector<uint32> Sizes = { 16, 1024, 65536 };
+    uint32 BVHTriangles = 5000000;
+    uint32 LinearBVHTriangles = 1000000;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            JsonPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            Filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            MinTimeMs = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--bvh-triangles") == 0 && i + 1 < argc)
+        {
+            BVHTriangles = static_cast<uint32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--lbvh-triangles") == 0 && i + 1 < argc)
+        {
+            LinearBVHTriangles = static_cast<uint32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc)
+        {
+            Sizes.clear();
+            for (const char* Cursor = argv[++i]; *Cursor != '\0'; )
+            {
+                char* End = nullptr;
+                unsigned long Size = std::strtoul(Cursor, &End, 10);
+                if (End == Cursor)
+                {
+                    break;
+                }
+                if (Size > 0)
+                {
+                    Sizes.push_back(static_cast<uint32>(Size));
+                }
+                Cursor = (*End == ',') ? End + 1 : End;
+            }
+        }
+        else
+        {
+            std::printf("Usage: %s [--json <file>] [--filter <text>] [--min-time <ms>] [--sizes 16,1024,65536] [--bvh-triangles 5000000] [--lbvh-triangles 1000000]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("SIMD compiled: %s, active: %s\n", GetSIMDLevelName(GetCompiledSIMDLevel()), GetSIMDLevelName(GetActiveSIMDLevel()));
+    std::printf("%-36s %8s %12s %12s %16s\n", "benchmark", "batch", "ns/op", "min ns/op", "ops/s");
+
+    BenchmarkRunner Runner(MinTimeMs, Filter);
+    for (uint32 Size : Sizes)
+    {
+        RunBenchmarks(Runner, Size);
+    }
+
+    if (BVHTriangles > 0)
+    {
+        RunBVHBenchmarks(Runner, BVHTriangles);
+    }
+
+    if (LinearBVHTriangles > 0)
+    {
+        RunLinearBVHBenchmarks(Runner, LinearBVHTriangles);
+    }
+
+    if (JsonPath != nullptr && !Runner.WriteJson(JsonPath))
+    {
+        std::printf("Could not write %s\n", JsonPath);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,785 @@
+#pragma once
+#include "../../includes/VrixicMath.h"
+#include "../../includes/VrixicMathTranscendental.h"
+#include "../../includes/Frustum.h"
+#include "../../includes/PackedFormats.h"
+#include "../../includes/QuatStream.h"
+#include "../../includes/Transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+/**
+* Regression and accuracy checks for the batch kernels and the documented error bounds
+*
+* Every check prints one line with what it measured and the bound it was held to. The batch checks run once per SIMD
+* level this CPU and build can dispatch to, on exactly sized std::vectors so a sanitizer build sees any read or write
+* past the end. Build the sandbox with -fsanitize=address,undefined to get that
+*/
+namespace SandboxChecks
+{
+    using namespace Vrixic::Math;
+
+    inline int& FailureCount()
+    {
+        static int Count = 0;
+        return Count;
+    }
+
+    /* Passes when 'measured' is within 'bound', a NaN never passes */
+    inline void Check(const char* name, const char* level, double measured, double bound)
+    {
+        const bool Passed = measured <= bound;
+        std::printf("%-4s %-44s %-7s %12.4g  (bound %g)\n", Passed ? "ok" : "FAIL", name, level, measured, bound);
+        FailureCount() += Passed ? 0 : 1;
+    }
+
+    /* Runs 'check' once for every distinct level SetSIMDLevel() can select here */
+    template<typename CheckFunction>
+    inline void ForEachSIMDLevel(CheckFunction check)
+    {
+        uint32 Visited = 0;
+        for (uint32 i = 0; i <= static_cast<uint32>(SIMDLevel::AVX512); ++i)
+        {
+            SetSIMDLevel(static_cast<SIMDLevel>(i));
+            const uint32 Active = static_cast<uint32>(GetActiveSIMDLevel());
+            if ((Visited & (1u << Active)) == 0)
+            {
+                Visited |= 1u << Active;
+                check(GetSIMDLevelName(GetActiveSIMDLevel()));
+            }
+        }
+
+        ResetSIMDLevel();
+    }
+
+    /* Counts 0 to 67 cover every tail length of the 4 and 8 wide loops, the large ones the prefetch distances */
+    inline std::vector<uint32> BatchCounts()
+    {
+        std::vector<uint32> Counts;
+        for (uint32 i = 0; i < 68; ++i)
+        {
+            Counts.push_back(i);
+        }
+
+        Counts.push_back(1000);
+        Counts.push_back(4099);
+        return Counts;
+    }
+
+    inline Transform RandomTransform(std::mt19937& rng)
+    {
+        std::normal_distribution<float> Normal(0.0f, 1.0f);
+        std::uniform_real_distribution<float> Scale(0.5f, 2.0f);
+
+        Quat Rotation(Normal(rng), Normal(rng), Normal(rng), Normal(rng));
+        Rotation.Normalize();
+        return Transform(Vector3D(Normal(rng), Normal(rng), Normal(rng)) * 10.0f, Rotation, Vector3D(Scale(rng), Scale(rng), Scale(rng)));
+    }
+
+    inline Vector3D RandomVector(std::mt19937& rng, float range)
+    {
+        std::uniform_real_distribution<float> Uniform(-range, range);
+        return Vector3D(Uniform(rng), Uniform(rng), Uniform(rng));
+    }
+
+    inline double AbsoluteError(float value, double reference)
+    {
+        return std::fabs(value - reference);
+    }
+
+    /* Error of 'value' against 'reference', relative to 'scale' so large and small results are held to the same bound */
+    inline double RelativeError(float value, double reference, double scale)
+    {
+        return std::fabs(value - reference) / (1.0 + scale);
+    }
+
+    inline void CheckBatchTransforms()
+    {
+        ForEachSIMDLevel([](const char* level)
+        {
+            std::mt19937 Rng(3);
+            const Matrix4D M = RandomTransform(Rng).ToMatrix4D();
+
+            double PointError = 0.0, VectorError = 0.0, HomogeneousError = 0.0, InPlaceError = 0.0;
+            for (uint32 Count : BatchCounts())
+            {
+                std::vector<Vector3D> In(Count), Points(Count), Vectors(Count);
+                std::vector<Vector4D> In4(Count), Out4(Count);
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    In[i] = RandomVector(Rng, 100.0f);
+                    In4[i] = Vector4D(In[i].X, In[i].Y, In[i].Z, 1.0f + In[i].X * 0.01f);
+                }
+
+                M.TransformPoints(In.data(), Points.data(), Count);
+                M.TransformVectors(In.data(), Vectors.data(), Count);
+                M.TransformHomogeneous(In4.data(), Out4.data(), Count);
+
+                std::vector<Vector3D> InPlace = In;
+                M.TransformPoints(InPlace.data(), InPlace.data(), Count);
+
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    const float V[4] = { In4[i].X, In4[i].Y, In4[i].Z, In4[i].W };
+                    const float P[3] = { Points[i].X, Points[i].Y, Points[i].Z };
+                    const float D[3] = { Vectors[i].X, Vectors[i].Y, Vectors[i].Z };
+                    const float H[4] = { Out4[i].X, Out4[i].Y, Out4[i].Z, Out4[i].W };
+                    const float S[3] = { InPlace[i].X, InPlace[i].Y, InPlace[i].Z };
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        double Linear = 0.0, Scale = 0.0;
+                        for (int r = 0; r < 3; ++r)
+                        {
+                            Linear += static_cast<double>(V[r]) * M(r, c);
+                            Scale += std::fabs(static_cast<double>(V[r]) * M(r, c));
+                        }
+
+                        const double Translation = M(3, c);
+                        HomogeneousError = std::max(HomogeneousError, RelativeError(H[c], Linear + V[3] * Translation, Scale + std::fabs(V[3] * Translation)));
+                        if (c < 3)
+                        {
+                            PointError = std::max(PointError, RelativeError(P[c], Linear + Translation, Scale + std::fabs(Translation)));
+                            VectorError = std::max(VectorError, RelativeError(D[c], Linear, Scale));
+                            InPlaceError = std::max(InPlaceError, AbsoluteError(S[c], P[c]));
+                        }
+                    }
+                }
+            }
+
+            Check("Matrix4D::TransformPoints vs double", level, PointError, 1e-6);
+            Check("Matrix4D::TransformVectors vs double", level, VectorError, 1e-6);
+            Check("Matrix4D::TransformHomogeneous vs double", level, HomogeneousError, 1e-6);
+            Check("Matrix4D::TransformPoints in place", level, InPlaceError, 0.0);
+        });
+    }
+
+    inline void CheckMatrixBatches()
+    {
+        ForEachSIMDLevel([](const char* level)
+        {
+            std::mt19937 Rng(4);
+            double InverseError = 0.0, DeterminantError = 0.0, MultiplyError = 0.0;
+            for (uint32 Count : BatchCounts())
+            {
+                std::vector<Matrix4D> Left(Count), Right(Count), Inverses(Count), Products(Count);
+                std::vector<float> Determinants(Count);
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    Left[i] = RandomTransform(Rng).ToMatrix4D();
+                    Right[i] = RandomTransform(Rng).ToMatrix4D();
+                }
+
+                Matrix4D::InverseBatch(Left.data(), Inverses.data(), Count, Determinants.data());
+                Matrix4D::MultiplyBatch(Left.data(), Right.data(), Products.data(), Count);
+
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    float Determinant;
+                    const Matrix4D Inverse = Left[i].Inverse(Determinant);
+                    const Matrix4D Product = Left[i] * Right[i];
+                    DeterminantError = std::max(DeterminantError, AbsoluteError(Determinants[i], Determinant) / std::fabs(Determinant));
+                    /* The inverse is held to its largest entry, every product entry to the sum of its terms */
+                    double InverseScale = 0.0;
+                    for (int k = 0; k < 16; ++k)
+                    {
+                        InverseScale = std::max(InverseScale, static_cast<double>(std::fabs(Inverse(k / 4, k % 4))));
+                    }
+
+                    for (int r = 0; r < 4; ++r)
+                    {
+                        for (int c = 0; c < 4; ++c)
+                        {
+                            double ProductScale = 0.0;
+                            for (int k = 0; k < 4; ++k)
+                            {
+                                ProductScale += std::fabs(static_cast<double>(Left[i](r, k)) * Right[i](k, c));
+                            }
+
+                            InverseError = std::max(InverseError, RelativeError(Inverses[i](r, c), Inverse(r, c), InverseScale));
+                            MultiplyError = std::max(MultiplyError, RelativeError(Products[i](r, c), Product(r, c), ProductScale));
+                        }
+                    }
+                }
+            }
+
+            Check("Matrix4D::InverseBatch vs Inverse", level, InverseError, 1e-5);
+            Check("Matrix4D::InverseBatch determinants", level, DeterminantError, 1e-5);
+            Check("Matrix4D::MultiplyBatch vs operator*", level, MultiplyError, 1e-6);
+        });
+    }
+
+    inline void CheckRotateVectors()
+    {
+        ForEachSIMDLevel([](const char* level)
+        {
+            std::mt19937 Rng(5);
+            double SingleError = 0.0, PerQuatError = 0.0;
+            for (uint32 Count : BatchCounts())
+            {
+                std::vector<Quat> Quats(Count);
+                std::vector<Vector3D> In(Count), Single(Count), PerQuat(Count);
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    Quats[i] = RandomTransform(Rng).Rotation;
+                    In[i] = RandomVector(Rng, 10.0f);
+                }
+
+                const Quat Q = RandomTransform(Rng).Rotation;
+                Quat::RotateVectors(Q, In.data(), Single.data(), Count);
+                Quat::RotateVectors(Quats.data(), In.data(), PerQuat.data(), Count);
+
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    const Vector3D A = Q.RotateVector(In[i]);
+                    const Vector3D B = Quats[i].RotateVector(In[i]);
+                    const double Scale = In[i].Length();
+                    SingleError = std::max({ SingleError, RelativeError(Single[i].X, A.X, Scale), RelativeError(Single[i].Y, A.Y, Scale), RelativeError(Single[i].Z, A.Z, Scale) });
+                    PerQuatError = std::max({ PerQuatError, RelativeError(PerQuat[i].X, B.X, Scale), RelativeError(PerQuat[i].Y, B.Y, Scale), RelativeError(PerQuat[i].Z, B.Z, Scale) });
+                }
+            }
+
+            Check("Quat::RotateVectors vs RotateVector", level, SingleError, 1e-6);
+            Check("Quat::RotateVectors per quat vs RotateVector", level, PerQuatError, 1e-6);
+        });
+    }
+
+    inline void CheckCulling()
+    {
+        ForEachSIMDLevel([](const char* level)
+        {
+            std::mt19937 Rng(6);
+            std::uniform_real_distribution<float> Extent(0.0f, 5.0f);
+
+            Frustum Camera(16.0f / 9.0f, 1.0f, 0.1f, 100.0f);
+            Camera.CreateFrustum(RandomTransform(Rng).ToMatrix4D());
+
+            uint32 MaskMismatches = 0, IndexMismatches = 0, StreamMismatches = 0;
+            for (uint32 Count : BatchCounts())
+            {
+                std::vector<Vector3D> Centers(Count), Extents(Count);
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    Centers[i] = RandomVector(Rng, 100.0f);
+                    Extents[i] = Vector3D(Extent(Rng), Extent(Rng), Extent(Rng));
+                }
+
+                std::vector<uint32> Mask((Count + 31) / 32), StreamMask((Count + 31) / 32), Indices(Count);
+                Camera.CullAABBs(Centers.data(), Extents.data(), Count, Mask.data());
+                const uint32 VisibleCount = Camera.CullAABBsToIndices(Centers.data(), Extents.data(), Count, Indices.data());
+
+                Vector3DStream CenterStream, ExtentStream;
+                CenterStream.FromAoS(Centers.data(), Count);
+                ExtentStream.FromAoS(Extents.data(), Count);
+                Camera.CullAABBs(CenterStream, ExtentStream, StreamMask.data());
+
+                uint32 Next = 0;
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    const bool Visible = Camera.IsAABBVisible(Centers[i], Extents[i]);
+                    MaskMismatches += ((Mask[i >> 5] >> (i & 31)) & 1u) != static_cast<uint32>(Visible);
+                    StreamMismatches += ((StreamMask[i >> 5] >> (i & 31)) & 1u) != static_cast<uint32>(Visible);
+                    if (Visible)
+                    {
+                        IndexMismatches += (Next >= VisibleCount || Indices[Next] != i);
+                        ++Next;
+                    }
+                }
+
+                IndexMismatches += Next != VisibleCount;
+            }
+
+            Check("Frustum::CullAABBs vs IsAABBVisible", level, MaskMismatches, 0.0);
+            Check("Frustum::CullAABBsToIndices vs IsAABBVisible", level, IndexMismatches, 0.0);
+            Check("Frustum::CullAABBs stream vs IsAABBVisible", level, StreamMismatches, 0.0);
+        });
+    }
+
+    inline void CheckStreamNormalize()
+    {
+        ForEachSIMDLevel([](const char* level)
+        {
+            std::mt19937 Rng(7);
+            double Error = 0.0;
+            for (uint32 Count : BatchCounts())
+            {
+                std::vector<Vector3D> In(Count), Out(Count);
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    In[i] = RandomVector(Rng, 100.0f);
+                }
+
+                Vector3DStream Stream;
+                Stream.FromAoS(In.data(), Count);
+                Stream.Normalize();
+                Stream.ToAoS(Out.data());
+
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    Vector3D Expected = In[i];
+                    Expected.Normalize();
+                    Error = std::max({ Error, AbsoluteError(Out[i].X, Expected.X), AbsoluteError(Out[i].Y, Expected.Y), AbsoluteError(Out[i].Z, Expected.Z) });
+                }
+            }
+
+            Check("Vector3DStream::Normalize vs Vector3D", level, Error, 1e-6);
+        });
+    }
+
+    /* Error of 'value' in units in the last place of the float nearest 'reference' */
+    inline double UlpError(float value, double reference)
+    {
+        if (std::isnan(reference))
+        {
+            return std::isnan(value) ? 0.0 : 1e9;
+        }
+
+        const double Magnitude = std::max(std::fabs(reference), 1.17549435e-38);
+        int Exponent;
+        std::frexp(Magnitude, &Exponent);
+        return std::fabs(value - reference) / std::ldexp(1.0, Exponent - 24);
+    }
+
+    /* Worst ulp error of the 8 lane, 4 lane and scalar versions of one function over the input pairs (a[i], b[i]) */
+    template<typename Eval8, typename Eval4, typename Eval1, typename Reference>
+    inline double MeasureUlp(const std::vector<float>& a, const std::vector<float>& b, Eval8 eval8, Eval4 eval4, Eval1 eval1, Reference reference)
+    {
+        double Worst = 0.0;
+        for (size_t i = 0; i + 8 <= a.size(); i += 8)
+        {
+            alignas(32) float Wide[8];
+            alignas(32) float Narrow[8];
+            StoreVectorRegister8(Wide, eval8(MakeVectorRegister8(&a[i]), MakeVectorRegister8(&b[i])));
+            StoreVectorRegister(Narrow, eval4(MakeVectorRegister(&a[i]), MakeVectorRegister(&b[i])));
+            StoreVectorRegister(Narrow + 4, eval4(MakeVectorRegister(&a[i + 4]), MakeVectorRegister(&b[i + 4])));
+
+            for (size_t k = 0; k < 8; ++k)
+            {
+                const double Expected = reference(static_cast<double>(a[i + k]), static_cast<double>(b[i + k]));
+                Worst = std::max({ Worst, UlpError(Wide[k], Expected), UlpError(Narrow[k], Expected), UlpError(eval1(a[i + k], b[i + k]), Expected) });
+            }
+        }
+
+        return Worst;
+    }
+
+    inline float FloatFromBits(uint32 bits)
+    {
+        float Value;
+        std::memcpy(&Value, &bits, sizeof(Value));
+        return Value;
+    }
+
+    /* Random floats with bit patterns between 'lowBits' and 'highBits', so every exponent is sampled equally */
+    inline std::vector<float> RandomFloatBits(std::mt19937& rng, uint32 lowBits, uint32 highBits, uint32 count)
+    {
+        std::uniform_int_distribution<uint32> Bits(lowBits, highBits);
+        std::vector<float> Values(count);
+        for (float& Value : Values)
+        {
+            Value = FloatFromBits(Bits(rng));
+        }
+
+        return Values;
+    }
+
+    inline std::vector<float> RandomFloats(std::mt19937& rng, float low, float high, uint32 count)
+    {
+        std::uniform_real_distribution<float> Uniform(low, high);
+        std::vector<float> Values(count);
+        for (float& Value : Values)
+        {
+            Value = Uniform(rng);
+        }
+
+        return Values;
+    }
+
+    /* Holds every tier to the table at the top of VrixicMathTranscendental.h */
+    template<MathAccuracy Accuracy>
+    inline void CheckTranscendentals(const char* tier, const double bounds[6])
+    {
+        std::mt19937 Rng(8);
+        const uint32 Count = 1u << 20;
+
+        /* Random angles plus the 8 floats on each side of every multiple of pi/2, where sin or cos is tiny */
+        std::vector<float> Angles = RandomFloats(Rng, -8192.0f, 8192.0f, Count);
+        for (int k = -5215; k <= 5215; ++k)
+        {
+            float Near = static_cast<float>(k * 1.5707963267948966);
+            for (int d = 0; d < 8; ++d)
+            {
+                Near = std::nextafter(Near, -1e9f);
+            }
+
+            for (int d = 0; d <= 16; ++d, Near = std::nextafter(Near, 1e9f))
+            {
+                Angles.push_back(Near);
+            }
+        }
+
+        /* Angles past 8192 up to the largest float, which take the exact reduction, and infinity, which gives NaN */
+        std::vector<float> Large = RandomFloatBits(Rng, 0x46000000u, 0x7F7FFFFFu, Count / 4);
+        for (size_t i = 0; i < Large.size(); ++i)
+        {
+            Angles.push_back((i & 1) ? -Large[i] : Large[i]);
+        }
+
+        Angles.push_back(std::numeric_limits<float>::infinity());
+        Angles.push_back(-std::numeric_limits<float>::infinity());
+        while (Angles.size() % 8 != 0)
+        {
+            Angles.push_back(0.0f);
+        }
+
+        const std::vector<float> Zeros(Angles.size(), 0.0f);
+        const double Sin = MeasureUlp(Angles, Zeros,
+            [](const VectorRegister8& x, const VectorRegister8&) { VectorRegister8 S, C; VectorRegister8SinCos<Accuracy>(x, S, C); return S; },
+            [](const VectorRegister& x, const VectorRegister&) { VectorRegister S, C; VectorRegisterSinCos<Accuracy>(x, S, C); return S; },
+            [](float x, float) { return MathUtils::Sin<Accuracy>(x); },
+            [](double x, double) { return std::sin(x); });
+        const double Cos = MeasureUlp(Angles, Zeros,
+            [](const VectorRegister8& x, const VectorRegister8&) { VectorRegister8 S, C; VectorRegister8SinCos<Accuracy>(x, S, C); return C; },
+            [](const VectorRegister& x, const VectorRegister&) { VectorRegister S, C; VectorRegisterSinCos<Accuracy>(x, S, C); return C; },
+            [](float x, float) { return MathUtils::Cos<Accuracy>(x); },
+            [](double x, double) { return std::cos(x); });
+        Check("SinCos ulp", tier, std::max(Sin, Cos), bounds[0]);
+
+        const std::vector<float> Y = RandomFloatBits(Rng, 0x00000000u, 0x7F7FFFFFu, Count);
+        std::vector<float> X = RandomFloatBits(Rng, 0x00000000u, 0x7F7FFFFFu, Count);
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            /* Random signs, and every other x near y so the ratio is not always huge or tiny */
+            X[i] = (i & 1) ? Y[i] * (0.5f + (i & 1023) / 1024.0f) : X[i];
+            X[i] = (i & 2) ? -X[i] : X[i];
+        }
+
+        Check("Atan2 ulp", tier, MeasureUlp(Y, X,
+            [](const VectorRegister8& y, const VectorRegister8& x) { return VectorRegister8Atan2<Accuracy>(y, x); },
+            [](const VectorRegister& y, const VectorRegister& x) { return VectorRegisterAtan2<Accuracy>(y, x); },
+            [](float y, float x) { return MathUtils::Atan2<Accuracy>(y, x); },
+            [](double y, double x) { return std::atan2(y, x); }), bounds[1]);
+
+        const std::vector<float> Cosines = RandomFloats(Rng, -1.0f, 1.0f, Count);
+        Check("Acos ulp", tier, MeasureUlp(Cosines, Cosines,
+            [](const VectorRegister8& x, const VectorRegister8&) { return VectorRegister8Acos<Accuracy>(x); },
+            [](const VectorRegister& x, const VectorRegister&) { return VectorRegisterAcos<Accuracy>(x); },
+            [](float x, float) { return MathUtils::Acos<Accuracy>(x); },
+            [](double x, double) { return std::acos(x); }), bounds[2]);
+
+        const std::vector<float> Exponents = RandomFloats(Rng, -87.3f, 88.7f, Count);
+        Check("Exp ulp", tier, MeasureUlp(Exponents, Exponents,
+            [](const VectorRegister8& x, const VectorRegister8&) { return VectorRegister8Exp<Accuracy>(x); },
+            [](const VectorRegister& x, const VectorRegister&) { return VectorRegisterExp<Accuracy>(x); },
+            [](float x, float) { return MathUtils::Exp<Accuracy>(x); },
+            [](double x, double) { return std::exp(x); }), bounds[3]);
+
+        const std::vector<float> Positive = RandomFloatBits(Rng, 0x00000001u, 0x7F7FFFFFu, Count);
+        Check("Log ulp", tier, MeasureUlp(Positive, Positive,
+            [](const VectorRegister8& x, const VectorRegister8&) { return VectorRegister8Log<Accuracy>(x); },
+            [](const VectorRegister& x, const VectorRegister&) { return VectorRegisterLog<Accuracy>(x); },
+            [](float x, float) { return MathUtils::Log<Accuracy>(x); },
+            [](double x, double) { return std::log(x); }), bounds[4]);
+
+        const std::vector<float> Normal = RandomFloatBits(Rng, 0x00800000u, 0x7F7FFFFFu, Count);
+        Check("ReciprocalSqrt ulp", tier, MeasureUlp(Normal, Normal,
+            [](const VectorRegister8& x, const VectorRegister8&) { return VectorRegister8ReciprocalSqrt<Accuracy>(x); },
+            [](const VectorRegister& x, const VectorRegister&) { return VectorRegisterReciprocalSqrt<Accuracy>(x); },
+            [](float x, float) { return MathUtils::ReciprocalSqrt<Accuracy>(x); },
+            [](double x, double) { return 1.0 / std::sqrt(x); }), bounds[5]);
+    }
+
+    inline void CheckTranscendentals()
+    {
+        /* SinCos, Atan2, Acos, Exp, Log, ReciprocalSqrt */
+        const double Fast[6] = { 9500, 26400, 65500, 1650, 11500, 5000 };
+        const double Medium[6] = { 27, 502, 757, 71, 26, 5 };
+        const double Precise[6] = { 3, 4, 2, 2, 1, 2 };
+        CheckTranscendentals<MathAccuracy::Fast>("fast", Fast);
+        CheckTranscendentals<MathAccuracy::Medium>("medium", Medium);
+        CheckTranscendentals<MathAccuracy::Precise>("precise", Precise);
+    }
+
+    /* Largest component difference of 'a' and 'b' or 'a' and -b, both are the same rotation */
+    inline double QuatError(const Quat& a, const Quat& b)
+    {
+        const double Same = std::max({ std::fabs(a.X - b.X), std::fabs(a.Y - b.Y), std::fabs(a.Z - b.Z), std::fabs(a.W - b.W) });
+        const double Negated = std::max({ std::fabs(a.X + b.X), std::fabs(a.Y + b.Y), std::fabs(a.Z + b.Z), std::fabs(a.W + b.W) });
+        return std::min(Same, Negated);
+    }
+
+    /* Error bounds listed at the top of PackedFormats.h, and the batch versions against the single value ones */
+    inline void CheckPackedFormats()
+    {
+        std::mt19937 Rng(9);
+        const uint32 Count = 100003;
+
+        std::vector<Quat> Quats(Count), Decoded(Count);
+        /* Every fourth quat is close to four equal components, where rebuilding the dropped one loses the most */
+        std::uniform_real_distribution<float> Jitter(-0.02f, 0.02f);
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            Quats[i] = RandomTransform(Rng).Rotation;
+            if (i % 4 == 0)
+            {
+                const float SignY = (i & 8) ? -1.0f : 1.0f;
+                const float SignW = (i & 16) ? -1.0f : 1.0f;
+                Quats[i] = Quat(0.5f + Jitter(Rng), SignY * (0.5f + Jitter(Rng)), 0.5f + Jitter(Rng), SignW * (0.5f + Jitter(Rng)));
+                Quats[i].Normalize();
+            }
+        }
+
+        std::vector<PackedQuat32> Packed32(Count);
+        std::vector<PackedQuat48> Packed48(Count);
+        PackedQuat32::EncodeBatch(Quats.data(), Packed32.data(), Count);
+        PackedQuat48::EncodeBatch(Quats.data(), Packed48.data(), Count);
+
+        double Error32 = 0.0, Error48 = 0.0, BatchError = 0.0;
+        uint32 Mismatches = 0;
+        PackedQuat32::DecodeBatch(Packed32.data(), Decoded.data(), Count);
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            Mismatches += Packed32[i].Bits != PackedQuat32::Encode(Quats[i]).Bits;
+            Error32 = std::max(Error32, QuatError(Quats[i], Packed32[i].Decode()));
+            BatchError = std::max(BatchError, QuatError(Decoded[i], Packed32[i].Decode()));
+        }
+
+        PackedQuat48::DecodeBatch(Packed48.data(), Decoded.data(), Count);
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            const PackedQuat48 Single = PackedQuat48::Encode(Quats[i]);
+            Mismatches += std::memcmp(Single.Bits, Packed48[i].Bits, sizeof(Single.Bits)) != 0;
+            Error48 = std::max(Error48, QuatError(Quats[i], Packed48[i].Decode()));
+            BatchError = std::max(BatchError, QuatError(Decoded[i], Packed48[i].Decode()));
+        }
+
+        Check("PackedQuat32 component error", "", Error32, 2.1e-3);
+        Check("PackedQuat48 component error", "", Error48, 6.5e-5);
+        Check("PackedQuat EncodeBatch vs Encode", "", Mismatches, 0.0);
+        Check("PackedQuat DecodeBatch vs Decode", "", BatchError, 4.8e-7);
+
+        /* Every finite half survives the round trip, and a float is off by at most 2^-11 of itself */
+        uint32 RoundTripMismatches = 0;
+        for (uint32 h = 0; h < 0x10000; ++h)
+        {
+            const uint16 Half = static_cast<uint16>(h);
+            RoundTripMismatches += (h & 0x7C00) != 0x7C00 && HalfVector3D::FloatToHalf(HalfVector3D::HalfToFloat(Half)) != Half;
+        }
+
+        const std::vector<float> Floats = RandomFloats(Rng, -65504.0f, 65504.0f, Count * 3);
+        std::vector<HalfVector3D> Halves(Count);
+        std::vector<Vector3D> FromHalves(Count);
+        HalfVector3D::EncodeBatch(reinterpret_cast<const Vector3D*>(Floats.data()), Halves.data(), Count);
+        HalfVector3D::DecodeBatch(Halves.data(), FromHalves.data(), Count);
+
+        double HalfError = 0.0;
+        uint32 HalfMismatches = 0;
+        const uint16* HalfBits = reinterpret_cast<const uint16*>(Halves.data());
+        const float* HalfFloats = reinterpret_cast<const float*>(FromHalves.data());
+        for (uint32 i = 0; i < Count * 3; ++i)
+        {
+            const uint16 Half = HalfVector3D::FloatToHalf(Floats[i]);
+            HalfMismatches += HalfBits[i] != Half || HalfFloats[i] != HalfVector3D::HalfToFloat(Half);
+            if (std::fabs(Floats[i]) >= 6.103515625e-5f)
+            {
+                HalfError = std::max(HalfError, AbsoluteError(HalfVector3D::HalfToFloat(Half), Floats[i]) / std::fabs(Floats[i]));
+            }
+        }
+
+        Check("Half round trip of every finite half", "", RoundTripMismatches, 0.0);
+        Check("Half relative error", "", HalfError, 1.0 / 2048.0);
+        Check("HalfVector3D batches vs single values", "", HalfMismatches, 0.0);
+
+        const Vector3DQuantizer Quantizer(Vector3D(-100.0f, -5.0f, 0.0f), Vector3D(100.0f, 5.0f, 1.0f));
+        const Vector3D MaxError = Quantizer.GetMaxError();
+        std::vector<Vector3D> Points(Count), FromQuantized(Count);
+        for (Vector3D& P : Points)
+        {
+            P = RandomVector(Rng, 1.0f) * Vector3D(100.0f, 5.0f, 0.5f) + Vector3D(0.0f, 0.0f, 0.5f);
+        }
+
+        std::vector<QuantizedVector3D> Quantized(Count);
+        Quantizer.EncodeBatch(Points.data(), Quantized.data(), Count);
+        Quantizer.DecodeBatch(Quantized.data(), FromQuantized.data(), Count);
+
+        /* GetMaxError() leaves out float rounding, which is held to a couple of float steps at the box's largest magnitude */
+        const Vector3D FloatStep = Vector3D(100.0f, 5.0f, 1.0f) * 1.1920929e-7f;
+        double RoundingError = 0.0, QuantizedBatchError = 0.0;
+        uint32 QuantizedMismatches = 0;
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            const QuantizedVector3D Single = Quantizer.Encode(Points[i]);
+            QuantizedMismatches += std::memcmp(&Single, &Quantized[i], sizeof(Single)) != 0;
+
+            const Vector3D Back = Quantizer.Decode(Single);
+            RoundingError = std::max({ RoundingError, (AbsoluteError(Back.X, Points[i].X) - MaxError.X) / FloatStep.X,
+                (AbsoluteError(Back.Y, Points[i].Y) - MaxError.Y) / FloatStep.Y, (AbsoluteError(Back.Z, Points[i].Z) - MaxError.Z) / FloatStep.Z });
+            QuantizedBatchError = std::max({ QuantizedBatchError, AbsoluteError(FromQuantized[i].X, Back.X) / FloatStep.X,
+                AbsoluteError(FromQuantized[i].Y, Back.Y) / FloatStep.Y, AbsoluteError(FromQuantized[i].Z, Back.Z) / FloatStep.Z });
+        }
+
+        Check("Quantized error past GetMaxError(), float steps", "", RoundingError, 2.0);
+        Check("Vector3DQuantizer::EncodeBatch vs Encode", "", QuantizedMismatches, 0.0);
+        Check("Vector3DQuantizer::DecodeBatch vs Decode, float steps", "", QuantizedBatchError, 1.0);
+
+        /* Values outside the box clamp to its faces, even ones too large to round in a 32-bit integer */
+        const float Outside[8] = { 101.0f, -101.0f, 40000.0f, -40000.0f, 3e9f, -3e9f, 1e30f, -INFINITY };
+        std::vector<Vector3D> OutOfRange(64);
+        for (uint32 i = 0; i < 64; ++i)
+        {
+            OutOfRange[i] = Vector3D(Outside[i % 8], Outside[(i / 8) % 8], (i & 1) ? Outside[(i + 3) % 8] : 0.5f);
+        }
+
+        std::vector<QuantizedVector3D> OutOfRangeQuantized(64);
+        Quantizer.EncodeBatch(OutOfRange.data(), OutOfRangeQuantized.data(), 64);
+
+        uint32 OutOfRangeMismatches = 0;
+        for (uint32 i = 0; i < 64; ++i)
+        {
+            const QuantizedVector3D Single = Quantizer.Encode(OutOfRange[i]);
+            OutOfRangeMismatches += std::memcmp(&Single, &OutOfRangeQuantized[i], sizeof(Single)) != 0;
+            OutOfRangeMismatches += Single.X != (OutOfRange[i].X > 0.0f ? 65535 : 0);
+        }
+
+        Check("Vector3DQuantizer::EncodeBatch out of range", "", OutOfRangeMismatches, 0.0);
+    }
+
+    /* Round trip through ToMatrix4D(), and the batch version against the single one */
+    inline void CheckDecompose()
+    {
+        std::mt19937 Rng(10);
+        const uint32 Count = 40003;
+
+        std::vector<Matrix4D> Matrices(Count);
+        std::vector<Transform> Batch(Count);
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            Transform T = RandomTransform(Rng);
+            T.Scale.X = (i % 3 == 0) ? -T.Scale.X : T.Scale.X;
+            Matrices[i] = T.ToMatrix4D();
+        }
+
+        Transform::DecomposeBatch(Matrices.data(), Batch.data(), Count);
+
+        double RoundTripError = 0.0, BatchError = 0.0;
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            const Transform Single = Transform::Decompose(Matrices[i]);
+            const Matrix4D Back = Single.ToMatrix4D();
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    RoundTripError = std::max(RoundTripError, RelativeError(Back(r, c), Matrices[i](r, c), std::fabs(Matrices[i](r, c))));
+                }
+            }
+
+            BatchError = std::max({ BatchError, QuatError(Single.Rotation, Batch[i].Rotation),
+                AbsoluteError(Single.Scale.X, Batch[i].Scale.X), AbsoluteError(Single.Scale.Y, Batch[i].Scale.Y), AbsoluteError(Single.Scale.Z, Batch[i].Scale.Z),
+                AbsoluteError(Single.Translation.X, Batch[i].Translation.X), AbsoluteError(Single.Translation.Z, Batch[i].Translation.Z) });
+        }
+
+        Check("Transform::Decompose round trip", "", RoundTripError, 6e-6);
+        Check("Transform::DecomposeBatch vs Decompose", "", BatchError, 7e-7);
+    }
+
+    /* Angle between a double precision slerp and 'q' */
+    inline double SlerpAngleError(const Quat& a, const Quat& b, double t, const Quat& q)
+    {
+        double Dot = static_cast<double>(a.X) * b.X + static_cast<double>(a.Y) * b.Y + static_cast<double>(a.Z) * b.Z + static_cast<double>(a.W) * b.W;
+        const double Sign = Dot < 0.0 ? -1.0 : 1.0;
+        Dot = std::min(std::fabs(Dot), 1.0);
+
+        const double Theta = std::acos(Dot);
+        const double StartWeight = Theta < 1e-9 ? 1.0 - t : std::sin((1.0 - t) * Theta) / std::sin(Theta);
+        const double EndWeight = Sign * (Theta < 1e-9 ? t : std::sin(t * Theta) / std::sin(Theta));
+
+        const double R[4] = { StartWeight * a.X + EndWeight * b.X, StartWeight * a.Y + EndWeight * b.Y,
+            StartWeight * a.Z + EndWeight * b.Z, StartWeight * a.W + EndWeight * b.W };
+        const double Q[4] = { q.X, q.Y, q.Z, q.W };
+
+        double RQ = 0.0, RR = 0.0, QQ = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            RQ += R[k] * Q[k];
+            RR += R[k] * R[k];
+            QQ += Q[k] * Q[k];
+        }
+
+        return 2.0 * std::acos(std::min(std::fabs(RQ) / std::sqrt(RR * QQ), 1.0));
+    }
+
+    /* Angle error bounds listed in QuatStream.h */
+    inline void CheckQuatStream()
+    {
+        std::mt19937 Rng(11);
+        const uint32 Count = 20005;
+
+        std::vector<Quat> Start(Count), End(Count);
+        for (uint32 i = 0; i < Count; ++i)
+        {
+            Start[i] = RandomTransform(Rng).Rotation;
+            End[i] = RandomTransform(Rng).Rotation;
+            End[i] = (i % 7 == 0) ? Start[i] : End[i];
+            End[i] = (i % 11 == 0) ? Quat(-Start[i].X, -Start[i].Y, -Start[i].Z, -Start[i].W) : End[i];
+        }
+
+        QuatStream StartStream, EndStream, Out;
+        StartStream.FromAoS(Start.data(), Count);
+        EndStream.FromAoS(End.data(), Count);
+        Out.Resize(Count);
+
+        double Worst[3] = { 0.0, 0.0, 0.0 };
+        for (int Step = 0; Step <= 20; ++Step)
+        {
+            const float Ratio = Step / 20.0f;
+            for (int Method = 0; Method < 3; ++Method)
+            {
+                if (Method == 0)
+                {
+                    QuatStream::NLerp(StartStream, EndStream, Ratio, Out);
+                }
+                else if (Method == 1)
+                {
+                    QuatStream::FastSlerp(StartStream, EndStream, Ratio, Out);
+                }
+                else
+                {
+                    QuatStream::Slerp(StartStream, EndStream, Ratio, Out);
+                }
+
+                for (uint32 i = 0; i < Count; ++i)
+                {
+                    const double Error = SlerpAngleError(Start[i], End[i], Ratio, Out.Get(i));
+                    Worst[Method] = (Error <= Worst[Method]) ? Worst[Method] : Error;
+                }
+            }
+        }
+
+        Check("QuatStream::NLerp angle error", "", Worst[0], 0.1423);
+        Check("QuatStream::FastSlerp angle error", "", Worst[1], 7.6e-4);
+        Check("QuatStream::Slerp angle error", "", Worst[2], 3e-6);
+    }
+
+    /* returns the number of failed checks */
+    inline int RunAll()
+    {
+        CheckBatchTransforms();
+        CheckMatrixBatches();
+        CheckRotateVectors();
+        CheckCulling();
+        CheckStreamNormalize();
+        CheckTranscendentals();
+        CheckPackedFormats();
+        CheckDecompose();
+        CheckQuatStream();
+
+        std::printf("%d check(s) failed\n", FailureCount());
+        return FailureCount();
+    }
+}
@@ -2,6 +2,7 @@
 #include "../../includes/VrixicMath.h"
 #include "../../includes/ProjectionMatrix4D.h"
 #include "../../includes/Quat.h"
+#include "VrixicMathLibraryChecks.h"
 
 /** SandBox -> Testing math operations **/
 
@@ -42,5 +43,6 @@ int main()
     Vector3D RotateV1WithQ3_Slow = Q3.RotateVectorSlow(V1);
     Vector3D RotateV1WithQ3_Fast = Q3.RotateVector(V1);
 
-    return 0;
+    /* Regression and accuracy checks, the sandbox fails when one of them does */
+    return SandboxChecks::RunAll() == 0 ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "GenericDefines.h"
+#include "Matrix4D.h"
+#include "Vector3D.h"
+#include "VrixicMathSIMD.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace Vrixic
+{
+	namespace Math
+	{
+		/**
+		* 3x4 affine transform, the last column of a Matrix4D is always (0, 0, 0, 1) for rigid and scaled transforms
+		* so it is not stored. 48 bytes instead of 64 and composing/inverting skips the work on that column
+		*
+		* Stored transposed compared to Matrix4D: row i holds column i of the equivalent Matrix4D, so component i of a
+		* transformed point is Dot4(row i, (x, y, z, 1)) and the translation is (M[0][3], M[1][3], M[2][3])
+		*
+		* Composition order matches Matrix4D: (a * b) applies 'a' first then 'b'
+		*/
+		struct AffineMatrix
+		{
+		protected:
+			alignas(16) float M[3][4];
+
+		public:
+			inline constexpr AffineMatrix();
+
+			inline constexpr AffineMatrix(float n00, float n01, float n02, float n03,
+				float n10, float n11, float n12, float n13,
+				float n20, float n21, float n22, float n23);
+
+			/* Drops the last column of 'mat', it is expected to be (0, 0, 0, 1) */
+			inline explicit AffineMatrix(const Matrix4D& mat);
+
+		public:
+			/* Row/column of the stored 3x4, operator()(i, j) is Matrix4D::operator()(j, i) of the equivalent Matrix4D */
+			inline constexpr float& operator()(int i, int j)
+			{
+				return (M[i][j]);
+			}
+
+			inline constexpr const float& operator()(int i, int j) const
+			{
+				return (M[i][j]);
+			}
+
+			/* Applies this transform then 'otherM', 12 multiply adds per row instead of 16 for Matrix4D */
+			inline AffineMatrix operator*(const AffineMatrix& otherM) const;
+
+		public:
+			inline constexpr static AffineMatrix Identity();
+
+			inline constexpr Matrix4D ToMatrix4D() const;
+
+			/* Transforms a point (w = 1) */
+			inline Vector3D TransformPoint(const Vector3D& point) const;
+
+			/* Transforms a direction vector (w = 0), translation is ignored */
+			inline Vector3D TransformVector(const Vector3D& vector) const;
+
+			/* Batched versions, same rules as Matrix4D::TransformPoints() and Matrix4D::TransformVectors() */
+			inline void TransformPoints(const Vector3D* inPoints, Vector3D* outPoints, uint32 count) const;
+
+			inline void TransformVectors(const Vector3D* inVectors, Vector3D* outVectors, uint32 count) const;
+
+			inline Vector3D GetTranslation() const;
+
+			inline void SetTranslation(const Vector3D& translation);
+
+			/* Determinant of the 3x3 part, the same as the determinant of the equivalent Matrix4D */
+			inline float Determinant() const;
+
+			/**
+			* General affine inverse, works with scale and shear unlike Matrix4D::OrthogonalInverse()
+			* Inverts the 3x3 part with cross products and transforms the negated translation by it
+			*
+			* @param outDeterminant - determinant of the 3x3 part, when it is 0 the matrix is returned unchanged
+			*/
+			inline AffineMatrix Inverse(float& outDeterminant) const;
+
+			inline AffineMatrix Inverse() const;
+		};
+
+		static_assert(sizeof(AffineMatrix) == 12 * sizeof(float), "AffineMatrix should be a tightly packed 3x4 matrix");
+		static_assert(std::is_trivially_copyable<AffineMatrix>::value, "AffineMatrix should stay trivially copyable");
+
+		inline constexpr AffineMatrix::AffineMatrix()
+			: M{ } {}
+
+		inline constexpr AffineMatrix::AffineMatrix(float n00, float n01, float n02, float n03,
+			float n10, float n11, float n12, float n13,
+			float n20, float n21, float n22, float n23)
+			: M{ { n00, n01, n02, n03 },
+				{ n10, n11, n12, n13 },
+				{ n20, n21, n22, n23 } } {}
+
+		inline AffineMatrix::AffineMatrix(const Matrix4D& mat)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				M[i][0] = mat(0, i);
+				M[i][1] = mat(1, i);
+				M[i][2] = mat(2, i);
+				M[i][3] = mat(3, i);
+			}
+		}
+
+		inline AffineMatrix AffineMatrix::operator*(const AffineMatrix& otherM) const
+		{
+			/**
+			* Row i of the result is component i of 'otherM' applied to the rows of this matrix, the implied
+			* (0, 0, 0, 1) fourth row only adds the translation of 'otherM'
+			*/
+			const VectorRegister Row0 = VectorRegisterLoadAligned(M[0]);
+			const VectorRegister Row1 = VectorRegisterLoadAligned(M[1]);
+			const VectorRegister Row2 = VectorRegisterLoadAligned(M[2]);
+			const VectorRegister WAxis = MakeVectorRegister(0.0f, 0.0f, 0.0f, 1.0f);
+
+			AffineMatrix Result;
+			for (int i = 0; i < 3; ++i)
+			{
+				const VectorRegister Other = VectorRegisterLoadAligned(otherM.M[i]);
+
+				VectorRegister Row = VectorRegisterMultiply(VectorRegisterReplicateComponent<0>(Other), Row0);
+				Row = VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<1>(Other), Row1, Row);
+				Row = VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<2>(Other), Row2, Row);
+				Row = VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<3>(Other), WAxis, Row);
+
+				StoreVectorRegisterAligned(Result.M[i], Row);
+			}
+
+			return Result;
+		}
+
+		inline constexpr AffineMatrix AffineMatrix::Identity()
+		{
+			return AffineMatrix
+			(
+				1.0f, 0.0f, 0.0f, 0.0f,
+				0.0f, 1.0f, 0.0f, 0.0f,
+				0.0f, 0.0f, 1.0f, 0.0f
+			);
+		}
+
+		inline constexpr Matrix4D AffineMatrix::ToMatrix4D() const
+		{
+			return Matrix4D
+			(
+				M[0][0], M[1][0], M[2][0], 0.0f,
+				M[0][1], M[1][1], M[2][1], 0.0f,
+				M[0][2], M[1][2], M[2][2], 0.0f,
+				M[0][3], M[1][3], M[2][3], 1.0f
+			);
+		}
+
+		inline Vector3D AffineMatrix::TransformPoint(const Vector3D& point) const
+		{
+			return Vector3D
+			(
+				M[0][0] * point.X + M[0][1] * point.Y + M[0][2] * point.Z + M[0][3],
+				M[1][0] * point.X + M[1][1] * point.Y + M[1][2] * point.Z + M[1][3],
+				M[2][0] * point.X + M[2][1] * point.Y + M[2][2] * point.Z + M[2][3]
+			);
+		}
+
+		inline Vector3D AffineMatrix::TransformVector(const Vector3D& vector) const
+		{
+			return Vector3D
+			(
+				M[0][0] * vector.X + M[0][1] * vector.Y + M[0][2] * vector.Z,
+				M[1][0] * vector.X + M[1][1] * vector.Y + M[1][2] * vector.Z,
+				M[2][0] * vector.X + M[2][1] * vector.Y + M[2][2] * vector.Z
+			);
+		}
+
+		inline void AffineMatrix::TransformPoints(const Vector3D* inPoints, Vector3D* outPoints, uint32 count) const
+		{
+			/* Expanding once per batch lets the points go through the Matrix4D kernels and their runtime dispatch */
+			ToMatrix4D().TransformPoints(inPoints, outPoints, count);
+		}
+
+		inline void AffineMatrix::TransformVectors(const Vector3D* inVectors, Vector3D* outVectors, uint32 count) const
+		{
+			ToMatrix4D().TransformVectors(inVectors, outVectors, count);
+		}
+
+		inline Vector3D AffineMatrix::GetTranslation() const
+		{
+			return Vector3D(M[0][3], M[1][3], M[2][3]);
+		}
+
+		inline void AffineMatrix::SetTranslation(const Vector3D& translation)
+		{
+			M[0][3] = translation.X;
+			M[1][3] = translation.Y;
+			M[2][3] = translation.Z;
+		}
+
+		inline float AffineMatrix::Determinant() const
+		{
+			return M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1])
+				- M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0])
+				+ M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]);
+		}
+
+		inline AffineMatrix AffineMatrix::Inverse(float& outDeterminant) const
+		{
+			const VectorRegister Row0 = VectorRegisterLoadAligned(M[0]);
+			const VectorRegister Row1 = VectorRegisterLoadAligned(M[1]);
+			const VectorRegister Row2 = VectorRegisterLoadAligned(M[2]);
+
+			/* The inverse of a 3x3 with rows (a, b, c) has the columns (b x c, c x a, a x b) / det */
+			VectorRegister Column0 = VectorRegisterCross3(Row1, Row2);
+			VectorRegister Column1 = VectorRegisterCross3(Row2, Row0);
+			VectorRegister Column2 = VectorRegisterCross3(Row0, Row1);
+
+			const VectorRegister Det = VectorRegisterDot3(Row0, Column0);
+			outDeterminant = VectorRegisterGetX(Det);
+			if (outDeterminant == 0.0f)
+			{
+				return *this;
+			}
+
+			const VectorRegister InvDet = VectorRegisterDivide(VectorRegisterReplicate(1.0f), Det);
+			Column0 = VectorRegisterMultiply(Column0, InvDet);
+			Column1 = VectorRegisterMultiply(Column1, InvDet);
+			Column2 = VectorRegisterMultiply(Column2, InvDet);
+
+			/* New translation is -(inverse 3x3 * translation), the translation sits in the W components of the rows */
+			VectorRegister Translation = VectorRegisterMultiply(Column0, VectorRegisterReplicateComponent<3>(Row0));
+			Translation = VectorRegisterMultiplyAdd(Column1, VectorRegisterReplicateComponent<3>(Row1), Translation);
+			Translation = VectorRegisterMultiplyAdd(Column2, VectorRegisterReplicateComponent<3>(Row2), Translation);
+			Translation = VectorRegisterNegate(Translation);
+
+			/* Transposing the columns back into rows gives the stored layout, the 4th row written is not needed */
+			alignas(16) float Transposed[16];
+			VectorRegisterInterleaveXYZW(Transposed, Column0, Column1, Column2, Translation);
+
+			AffineMatrix Result;
+			std::memcpy(Result.M, Transposed, sizeof(Result.M));
+			return Result;
+		}
+
+		inline AffineMatrix AffineMatrix::Inverse() const
+		{
+			float Det;
+			return Inverse(Det);
+		}
+	}
+}
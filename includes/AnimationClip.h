@@ -0,0 +1,485 @@
+#pragma once
+#include "GenericDefines.h"
+#include "Quat.h"
+#include "QuatStream.h"
+#include "Transform.h"
+#include "Vector3D.h"
+#include "Vector3DStream.h"
+#include "VrixicMathSIMD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+* Keyframed rotation, translation and scale tracks sampled into local space poses
+*
+* AnimationClip stores every key with its time next to its value and starts each track on a 64-byte cache line, so
+* finding and reading a key pair is one or two cache lines. AnimationSampler keeps a cursor per track: playing forward
+* only steps the cursors (amortized O(1)), seeking backwards falls back to a binary search. A pose is decoded 8 bones
+* at a time, rotations with Quatx8::FastSlerp() and translation and scale with Vector3x8::Lerp()
+*
+*	std::vector<AnimationTrack> Tracks(BoneCount);
+*	... fill the keys, optionally Tracks[i].ReduceKeys(0.001f, 0.0001f, 0.0001f)
+*	AnimationClip Clip(Tracks.data(), BoneCount, Duration);
+*	AnimationSampler Sampler(Clip);
+*	Sampler.Sample(Time, Pose);
+*
+* The clip has to outlive its samplers, any number of samplers (one per character) can share one clip
+*/
+namespace Vrixic
+{
+	namespace Math
+	{
+		/* Source keys of one bone, times are in seconds and have to be increasing within each channel */
+		struct AnimationTrack
+		{
+		public:
+			std::vector<float> RotationTimes;
+			std::vector<Quat> Rotations;
+
+			std::vector<float> TranslationTimes;
+			std::vector<Vector3D> Translations;
+
+			std::vector<float> ScaleTimes;
+			std::vector<Vector3D> Scales;
+
+		public:
+			/**
+			* Removes every key that interpolating between the keys kept around it reproduces within the error budget,
+			* the first and last key of each channel are always kept. Greedy curve fit: the segment from the last kept key
+			* is stretched until one of the keys it skips would be off by more than the budget
+			*
+			* @param maxRotationError - largest rotation angle in radians between a removed key and the sampled rotation
+			* @param maxTranslationError - largest distance between a removed translation key and the sampled translation
+			* @param maxScaleError - largest distance between a removed scale key and the sampled scale
+			*/
+			inline void ReduceKeys(float maxRotationError, float maxTranslationError, float maxScaleError);
+
+			/* Rotation between two keys exactly as AnimationSampler computes it */
+			inline static Quat InterpolateRotation(const Quat& start, const Quat& end, float ratio);
+
+		private:
+			/* Reduces one channel, 'isWithinError(first, last, i)' checks key i against the segment [first, last] */
+			template<typename KeyType, typename ErrorCheck>
+			inline static void ReduceChannel(std::vector<float>& times, std::vector<KeyType>& keys, ErrorCheck&& isWithinError);
+		};
+
+		class AnimationClip
+		{
+		public:
+			struct RotationKey
+			{
+				Quat Value;
+				float Time;
+			};
+
+			struct VectorKey
+			{
+				Vector3D Value;
+				float Time;
+			};
+
+			/* Keys of one channel of one bone, 'Offset' is in floats from the start of the key block */
+			struct TrackRange
+			{
+				uint32 Offset;
+				uint32 Count;
+			};
+
+			/* Tracks start on this many floats (one 64-byte cache line) */
+			static constexpr uint32 PADDING = 16;
+
+		private:
+			/* Unaligned storage of every key, the aligned block starts somewhere in its first PADDING floats */
+			std::vector<float> Buffer;
+
+			/* Rotation, translation and scale range of every bone, bone b is at [b * 3, b * 3 + 3) */
+			std::vector<TrackRange> Tracks;
+
+			uint32 BoneCount;
+			float Duration;
+
+		public:
+			inline AnimationClip();
+
+			/**
+			* Copies and interleaves the keys of 'boneCount' tracks, a channel without keys samples to the identity
+			*
+			* @param duration - length of the clip in seconds, sampling times are clamped to [0, duration]
+			*/
+			inline AnimationClip(const AnimationTrack* tracks, uint32 boneCount, float duration);
+
+			/* The copied buffer can have a different alignment, the key block is moved to its aligned start */
+			inline AnimationClip(const AnimationClip& other);
+
+			inline AnimationClip(AnimationClip&& other) noexcept = default;
+
+			inline AnimationClip& operator=(const AnimationClip& other);
+
+			inline AnimationClip& operator=(AnimationClip&& other) noexcept = default;
+
+		public:
+			inline uint32 GetBoneCount() const;
+
+			inline float GetDuration() const;
+
+			/* Total number of keys over every channel of every bone */
+			inline uint32 GetKeyCount() const;
+
+			inline const RotationKey* GetRotationKeys(uint32 bone, uint32& outCount) const;
+
+			inline const VectorKey* GetTranslationKeys(uint32 bone, uint32& outCount) const;
+
+			inline const VectorKey* GetScaleKeys(uint32 bone, uint32& outCount) const;
+
+		private:
+			/* Start of the cache line aligned key block */
+			inline const float* GetKeyData() const;
+
+			inline float* GetKeyData();
+		};
+
+		/* Playback state of one clip instance, one cursor per track */
+		class AnimationSampler
+		{
+		private:
+			const AnimationClip* Clip;
+
+			/* Index of the first key of the current segment, 3 per bone like AnimationClip::Tracks */
+			std::vector<uint32> Cursors;
+
+		public:
+			inline explicit AnimationSampler(const AnimationClip& clip);
+
+		public:
+			/* Moves every cursor back to the first key */
+			inline void Reset();
+
+			/**
+			* Samples every bone of the clip at 'time' into 'outPose', which holds GetBoneCount() transforms
+			*
+			* Cursors only move forward while 'time' increases between calls, a looping clip should wrap 'time' before
+			* sampling and pays one binary search per track on the wrap
+			*/
+			inline void Sample(float time, Transform* outPose);
+
+		private:
+			/**
+			* Advances 'cursor' to the segment holding 'time' and returns the ratio between its two keys
+			*
+			* @param outNext - index of the second key, equal to 'cursor' for a single key track
+			*/
+			template<typename KeyType>
+			inline static float AdvanceCursor(const KeyType* keys, uint32 count, float time, uint32& cursor, uint32& outNext);
+		};
+
+		inline Quat AnimationTrack::InterpolateRotation(const Quat& start, const Quat& end, float ratio)
+		{
+			/* Every lane holds the same rotation, only the first is kept */
+			Quat Lanes[8];
+			Quatx8::FastSlerp(Quatx8(start), Quatx8(end), VectorRegister8Replicate(ratio)).StoreAoS(Lanes);
+			return Lanes[0];
+		}
+
+		template<typename KeyType, typename ErrorCheck>
+		inline void AnimationTrack::ReduceChannel(std::vector<float>& times, std::vector<KeyType>& keys, ErrorCheck&& isWithinError)
+		{
+			const uint32 Count = static_cast<uint32>(keys.size());
+			if (Count < 3)
+			{
+				return;
+			}
+
+			std::vector<float> KeptTimes;
+			std::vector<KeyType> KeptKeys;
+			KeptTimes.push_back(times[0]);
+			KeptKeys.push_back(keys[0]);
+
+			uint32 First = 0;
+			for (uint32 Last = 2; Last < Count; ++Last)
+			{
+				bool Fits = true;
+				for (uint32 i = First + 1; i < Last && Fits; ++i)
+				{
+					Fits = isWithinError(First, Last, i);
+				}
+
+				/* The segment can not reach 'Last', so the key before it ends the segment and starts the next one */
+				if (!Fits)
+				{
+					First = Last - 1;
+					KeptTimes.push_back(times[First]);
+					KeptKeys.push_back(keys[First]);
+				}
+			}
+
+			KeptTimes.push_back(times[Count - 1]);
+			KeptKeys.push_back(keys[Count - 1]);
+
+			times.swap(KeptTimes);
+			keys.swap(KeptKeys);
+		}
+
+		inline void AnimationTrack::ReduceKeys(float maxRotationError, float maxTranslationError, float maxScaleError)
+		{
+			/* The angle between two unit quats is 2 * acos(|dot|), compared without the acos */
+			const float MinRotationDot = std::cos(maxRotationError * 0.5f);
+
+			ReduceChannel(RotationTimes, Rotations, [this, MinRotationDot](uint32 first, uint32 last, uint32 i)
+			{
+				const float Ratio = (RotationTimes[i] - RotationTimes[first]) / (RotationTimes[last] - RotationTimes[first]);
+				const Quat Sampled = InterpolateRotation(Rotations[first], Rotations[last], Ratio);
+				return std::abs(Quat::DotProduct(Sampled, Rotations[i])) >= MinRotationDot;
+			});
+
+			const auto VectorCheck = [](const std::vector<float>& times, const std::vector<Vector3D>& keys, float maxError)
+			{
+				const float MaxErrorSquared = maxError * maxError;
+				return [&times, &keys, MaxErrorSquared](uint32 first, uint32 last, uint32 i)
+				{
+					const float Ratio = (times[i] - times[first]) / (times[last] - times[first]);
+					const Vector3D Sampled = keys[first] + (keys[last] - keys[first]) * Ratio;
+					return (Sampled - keys[i]).LengthSquared() <= MaxErrorSquared;
+				};
+			};
+
+			ReduceChannel(TranslationTimes, Translations, VectorCheck(TranslationTimes, Translations, maxTranslationError));
+			ReduceChannel(ScaleTimes, Scales, VectorCheck(ScaleTimes, Scales, maxScaleError));
+		}
+
+		inline AnimationClip::AnimationClip()
+			: BoneCount(0), Duration(0.0f) { }
+
+		inline AnimationClip::AnimationClip(const AnimationTrack* tracks, uint32 boneCount, float duration)
+			: BoneCount(boneCount), Duration(duration)
+		{
+			const uint32 RotationFloats = sizeof(RotationKey) / sizeof(float);
+			const uint32 VectorFloats = sizeof(VectorKey) / sizeof(float);
+
+			/* A channel without keys gets one identity key so sampling never has to check for empty tracks */
+			const auto KeyCount = [](size_t count) { return count == 0 ? 1u : static_cast<uint32>(count); };
+			const auto Align = [](uint32 floats) { return (floats + PADDING - 1) & ~(PADDING - 1); };
+
+			Tracks.resize(size_t(boneCount) * 3);
+			uint32 Size = 0;
+			for (uint32 Bone = 0; Bone < boneCount; ++Bone)
+			{
+				const AnimationTrack& Track = tracks[Bone];
+				TrackRange* Ranges = &Tracks[size_t(Bone) * 3];
+
+				Ranges[0] = { Size, KeyCount(Track.Rotations.size()) };
+				Size += Align(Ranges[0].Count * RotationFloats);
+				Ranges[1] = { Size, KeyCount(Track.Translations.size()) };
+				Size += Align(Ranges[1].Count * VectorFloats);
+				Ranges[2] = { Size, KeyCount(Track.Scales.size()) };
+				Size += Align(Ranges[2].Count * VectorFloats);
+			}
+
+			Buffer.assign(size_t(Size) + PADDING, 0.0f);
+			float* Data = GetKeyData();
+
+			for (uint32 Bone = 0; Bone < boneCount; ++Bone)
+			{
+				const AnimationTrack& Track = tracks[Bone];
+				const TrackRange* Ranges = &Tracks[size_t(Bone) * 3];
+
+				RotationKey* Rotations = reinterpret_cast<RotationKey*>(Data + Ranges[0].Offset);
+				if (Track.Rotations.empty())
+				{
+					Rotations[0] = { Quat::Identity(), 0.0f };
+				}
+				for (uint32 i = 0; i < Track.Rotations.size(); ++i)
+				{
+					Rotations[i] = { Track.Rotations[i], Track.RotationTimes[i] };
+				}
+
+				VectorKey* Translations = reinterpret_cast<VectorKey*>(Data + Ranges[1].Offset);
+				if (Track.Translations.empty())
+				{
+					Translations[0] = { Vector3D::ZeroVector(), 0.0f };
+				}
+				for (uint32 i = 0; i < Track.Translations.size(); ++i)
+				{
+					Translations[i] = { Track.Translations[i], Track.TranslationTimes[i] };
+				}
+
+				VectorKey* Scales = reinterpret_cast<VectorKey*>(Data + Ranges[2].Offset);
+				if (Track.Scales.empty())
+				{
+					Scales[0] = { Vector3D(1.0f, 1.0f, 1.0f), 0.0f };
+				}
+				for (uint32 i = 0; i < Track.Scales.size(); ++i)
+				{
+					Scales[i] = { Track.Scales[i], Track.ScaleTimes[i] };
+				}
+			}
+		}
+
+		inline AnimationClip::AnimationClip(const AnimationClip& other)
+			: AnimationClip()
+		{
+			*this = other;
+		}
+
+		inline AnimationClip& AnimationClip::operator=(const AnimationClip& other)
+		{
+			if (this != &other)
+			{
+				Buffer.assign(other.Buffer.size(), 0.0f);
+				if (!Buffer.empty())
+				{
+					std::memcpy(GetKeyData(), other.GetKeyData(), (Buffer.size() - PADDING) * sizeof(float));
+				}
+
+				Tracks = other.Tracks;
+				BoneCount = other.BoneCount;
+				Duration = other.Duration;
+			}
+			return *this;
+		}
+
+		inline uint32 AnimationClip::GetBoneCount() const
+		{
+			return BoneCount;
+		}
+
+		inline float AnimationClip::GetDuration() const
+		{
+			return Duration;
+		}
+
+		inline uint32 AnimationClip::GetKeyCount() const
+		{
+			uint32 Count = 0;
+			for (const TrackRange& Range : Tracks)
+			{
+				Count += Range.Count;
+			}
+			return Count;
+		}
+
+		inline const AnimationClip::RotationKey* AnimationClip::GetRotationKeys(uint32 bone, uint32& outCount) const
+		{
+			const TrackRange& Range = Tracks[size_t(bone) * 3];
+			outCount = Range.Count;
+			return reinterpret_cast<const RotationKey*>(GetKeyData() + Range.Offset);
+		}
+
+		inline const AnimationClip::VectorKey* AnimationClip::GetTranslationKeys(uint32 bone, uint32& outCount) const
+		{
+			const TrackRange& Range = Tracks[size_t(bone) * 3 + 1];
+			outCount = Range.Count;
+			return reinterpret_cast<const VectorKey*>(GetKeyData() + Range.Offset);
+		}
+
+		inline const AnimationClip::VectorKey* AnimationClip::GetScaleKeys(uint32 bone, uint32& outCount) const
+		{
+			const TrackRange& Range = Tracks[size_t(bone) * 3 + 2];
+			outCount = Range.Count;
+			return reinterpret_cast<const VectorKey*>(GetKeyData() + Range.Offset);
+		}
+
+		inline const float* AnimationClip::GetKeyData() const
+		{
+			const uintptr_t Address = reinterpret_cast<uintptr_t>(Buffer.data());
+			const uintptr_t Alignment = PADDING * sizeof(float);
+			return reinterpret_cast<const float*>((Address + Alignment - 1) & ~(Alignment - 1));
+		}
+
+		inline float* AnimationClip::GetKeyData()
+		{
+			return const_cast<float*>(static_cast<const AnimationClip*>(this)->GetKeyData());
+		}
+
+		inline AnimationSampler::AnimationSampler(const AnimationClip& clip)
+			: Clip(&clip), Cursors(size_t(clip.GetBoneCount()) * 3, 0) { }
+
+		inline void AnimationSampler::Reset()
+		{
+			std::fill(Cursors.begin(), Cursors.end(), 0u);
+		}
+
+		template<typename KeyType>
+		inline float AnimationSampler::AdvanceCursor(const KeyType* keys, uint32 count, float time, uint32& cursor, uint32& outNext)
+		{
+			if (count == 1)
+			{
+				outNext = 0;
+				return 0.0f;
+			}
+
+			/* Seeking backwards, the first key after 'time' ends the segment */
+			if (time < keys[cursor].Time)
+			{
+				const KeyType* Next = std::upper_bound(keys, keys + count, time,
+					[](float t, const KeyType& key) { return t < key.Time; });
+				cursor = Next == keys ? 0 : static_cast<uint32>(Next - keys) - 1;
+			}
+
+			/* Stops on the last segment so times past the end clamp to the last key */
+			while (cursor + 2 < count && keys[cursor + 1].Time <= time)
+			{
+				++cursor;
+			}
+			cursor = std::min(cursor, count - 2);
+
+			outNext = cursor + 1;
+			const float Ratio = (time - keys[cursor].Time) / (keys[outNext].Time - keys[cursor].Time);
+			return std::min(std::max(Ratio, 0.0f), 1.0f);
+		}
+
+		inline void AnimationSampler::Sample(float time, Transform* outPose)
+		{
+			const uint32 BoneCount = Clip->GetBoneCount();
+			time = std::min(std::max(time, 0.0f), Clip->GetDuration());
+
+			/* Key pairs and ratios of 8 bones gathered side by side, then interpolated in one go */
+			Quat RotationStart[8], RotationEnd[8], Rotations[8];
+			Vector3D TranslationStart[8], TranslationEnd[8], Translations[8];
+			Vector3D ScaleStart[8], ScaleEnd[8], Scales[8];
+			float RotationRatios[8], TranslationRatios[8], ScaleRatios[8];
+
+			for (uint32 Base = 0; Base < BoneCount; Base += 8)
+			{
+				const uint32 LaneCount = std::min(8u, BoneCount - Base);
+				for (uint32 Lane = 0; Lane < 8; ++Lane)
+				{
+					/* Unused lanes repeat the last bone and are not written out */
+					const uint32 Bone = Base + std::min(Lane, LaneCount - 1);
+					uint32* BoneCursors = &Cursors[size_t(Bone) * 3];
+					uint32 KeyCount, Next;
+
+					const AnimationClip::RotationKey* RotationKeys = Clip->GetRotationKeys(Bone, KeyCount);
+					RotationRatios[Lane] = AdvanceCursor(RotationKeys, KeyCount, time, BoneCursors[0], Next);
+					RotationStart[Lane] = RotationKeys[BoneCursors[0]].Value;
+					RotationEnd[Lane] = RotationKeys[Next].Value;
+
+					const AnimationClip::VectorKey* TranslationKeys = Clip->GetTranslationKeys(Bone, KeyCount);
+					TranslationRatios[Lane] = AdvanceCursor(TranslationKeys, KeyCount, time, BoneCursors[1], Next);
+					TranslationStart[Lane] = TranslationKeys[BoneCursors[1]].Value;
+					TranslationEnd[Lane] = TranslationKeys[Next].Value;
+
+					const AnimationClip::VectorKey* ScaleKeys = Clip->GetScaleKeys(Bone, KeyCount);
+					ScaleRatios[Lane] = AdvanceCursor(ScaleKeys, KeyCount, time, BoneCursors[2], Next);
+					ScaleStart[Lane] = ScaleKeys[BoneCursors[2]].Value;
+					ScaleEnd[Lane] = ScaleKeys[Next].Value;
+				}
+
+				Quatx8::FastSlerp(Quatx8::LoadAoS(RotationStart), Quatx8::LoadAoS(RotationEnd),
+					MakeVectorRegister8(RotationRatios)).StoreAoS(Rotations);
+				Vector3x8::Lerp(Vector3x8::LoadAoS(TranslationStart), Vector3x8::LoadAoS(TranslationEnd),
+					MakeVectorRegister8(TranslationRatios)).StoreAoS(Translations);
+				Vector3x8::Lerp(Vector3x8::LoadAoS(ScaleStart), Vector3x8::LoadAoS(ScaleEnd),
+					MakeVectorRegister8(ScaleRatios)).StoreAoS(Scales);
+
+				for (uint32 Lane = 0; Lane < LaneCount; ++Lane)
+				{
+					outPose[Base + Lane] = Transform(Translations[Lane], Rotations[Lane], Scales[Lane]);
+				}
+			}
+		}
+	}
+}
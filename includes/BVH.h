@@ -0,0 +1,1152 @@
+#pragma once
+#include "GenericDefines.h"
+#include "MortonCode.h"
+#include "Ray.h"
+#include "Vector3D.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/**
+* Bounding volume hierarchy over a triangle mesh for closest hit and any hit ray queries
+*
+* Build() splits nodes with a binned surface area heuristic (BinCount bins along each axis). The passes over the large
+* nodes at the top of the tree are spread over 'parallelFor', everything below SubtreeSize triangles is built as
+* independent subtrees, one parallelFor job each, which are then stitched into one node array
+*
+* BuildLinear() is the per frame path for skinned and moving meshes: triangles are sorted by the Morton code of their
+* centroid and every inner node is emitted independently from the sorted codes, so the whole build is a few parallel
+* passes. Its trees cost more per ray than the SAH ones. Refit() keeps the tree of either build and only recomputes the
+* bounds, for frames where the vertices moved but the triangles did not change
+*
+*	BVH Hierarchy;
+*	Hierarchy.Build(Vertices, Indices, TriangleCount, ParallelFor);
+*	RayHit Hit;
+*	if (Hierarchy.Intersect(Ray(Origin, Direction), 1000.0f, Hit)) { ... Hit.Triangle, Hit.Distance ... }
+*
+* Triangles are copied in leaf order, the mesh does not have to outlive the hierarchy
+*/
+namespace Vrixic
+{
+	namespace Math
+	{
+		/* 32 bytes, the children of an inner node are next to each other at LeftFirst and LeftFirst + 1 */
+		struct BVHNode
+		{
+		public:
+			Vector3D BoundsMin;
+
+			/* Inner node: index of the left child, leaf: first triangle in leaf order */
+			uint32 LeftFirst;
+
+			Vector3D BoundsMax;
+
+			/* Number of triangles of a leaf, 0 for an inner node */
+			uint32 Count;
+
+		public:
+			inline bool IsLeaf() const;
+		};
+
+		static_assert(sizeof(BVHNode) == 32, "BVHNode should stay 32 bytes");
+
+		struct RayHit
+		{
+			float Distance;
+
+			/* Barycentric weights of the second and third vertex */
+			float U;
+			float V;
+
+			/* Index of the triangle in the mesh given to Build() */
+			uint32 Triangle;
+		};
+
+		class BVH
+		{
+		public:
+			/* Bins per axis of the surface area heuristic */
+			static constexpr uint32 BinCount = 16;
+
+			/* Leaves never hold more triangles than this */
+			static constexpr uint32 MaxLeafSize = 8;
+
+			/* Triangles per leaf of BuildLinear(), the last leaf can hold fewer. Larger leaves build and refit faster, smaller ones trace faster */
+			static constexpr uint32 LinearLeafSize = 4;
+
+			/* Nodes with at most this many triangles are built as one subtree by one job */
+			static constexpr uint32 SubtreeSize = 32768;
+
+			/* Nodes deeper than this are split at the median, which bounds the depth and so the traversal stack */
+			static constexpr uint32 MaxSAHDepth = 48;
+
+			/* Deep enough for both builders, a linear build with 63 bit codes is at most 96 levels deep */
+			static constexpr uint32 StackSize = 96;
+
+			static constexpr uint32 InvalidNode = 0xFFFFFFFFu;
+
+		private:
+			struct BuildTask
+			{
+				uint32 Node;
+				uint32 Begin;
+				uint32 End;
+				uint32 Depth;
+			};
+
+			struct Bounds
+			{
+				Vector3D Min;
+				Vector3D Max;
+			};
+
+			/* Triangle bounds and centroid bounds of a range */
+			struct RangeBounds
+			{
+				Bounds Triangles;
+				Bounds Centroids;
+			};
+
+			struct Bin
+			{
+				Bounds Triangles;
+				uint32 Count;
+			};
+
+			struct SplitBins
+			{
+				Bin Bins[3][BinCount];
+			};
+
+		private:
+			std::vector<BVHNode> Nodes;
+
+			/* Mesh index of every triangle in leaf order */
+			std::vector<uint32> TriangleIndices;
+
+			/* 3 vertices per triangle in leaf order */
+			std::vector<Vector3D> TriangleVertices;
+
+			/* Parent of every node, InvalidNode for the root, Refit() walks it up from the leaves */
+			std::vector<uint32> Parents;
+
+			/* Only used while building, indexed by mesh triangle */
+			std::vector<Vector3D> Centroids;
+			std::vector<Bounds> TriangleBounds;
+
+		public:
+			inline BVH();
+
+		public:
+			/**
+			* Builds the hierarchy, single threaded
+			*
+			* @param vertices - vertex positions of the mesh
+			* @param indices - 3 vertex indices per triangle
+			*/
+			inline void Build(const Vector3D* vertices, const uint32* indices, uint32 triangleCount);
+
+			/**
+			* Same as Build() but spreads the work over 'parallelFor'
+			*
+			* @param parallelFor - called as parallelFor(count, job) and must call job(begin, end) over disjoint ranges
+			*	covering [0, count) before returning, 'job' is safe to run concurrently on different ranges
+			*/
+			template<typename ParallelFor>
+			inline void Build(const Vector3D* vertices, const uint32* indices, uint32 triangleCount, ParallelFor&& parallelFor);
+
+			/**
+			* Builds the hierarchy from the Morton order of the triangle centroids, single threaded
+			*
+			* @param precision - 30 bit codes sort faster, 63 bit codes keep dense meshes in a large level apart
+			*/
+			inline void BuildLinear(const Vector3D* vertices, const uint32* indices, uint32 triangleCount,
+				MortonPrecision precision = MortonPrecision::Bits30);
+
+			/* Same as BuildLinear() but spreads the work over 'parallelFor', see Build() */
+			template<typename ParallelFor>
+			inline void BuildLinear(const Vector3D* vertices, const uint32* indices, uint32 triangleCount, MortonPrecision precision,
+				ParallelFor&& parallelFor);
+
+			/**
+			* Recomputes every bound after the vertices moved, single threaded. The tree and the triangle order are kept, so
+			* rays get slower as triangles move away from where they were at the last build
+			*
+			* @param indices - same triangles as the last build, only the vertex positions may change
+			*/
+			inline void Refit(const Vector3D* vertices, const uint32* indices);
+
+			/* Same as Refit() but spreads the work over 'parallelFor', see Build() */
+			template<typename ParallelFor>
+			inline void Refit(const Vector3D* vertices, const uint32* indices, ParallelFor&& parallelFor);
+
+			inline void Clear();
+
+			/* Closest hit within [0, maxDistance], 'outHit' is only written on a hit */
+			inline bool Intersect(const Ray& ray, float maxDistance, RayHit& outHit) const;
+
+			/* True as soon as any triangle is hit within [0, maxDistance], for shadow and line of sight rays */
+			inline bool IsOccluded(const Ray& ray, float maxDistance) const;
+
+			inline const std::vector<BVHNode>& GetNodes() const;
+
+			inline uint32 GetTriangleCount() const;
+
+			/* Depth of the deepest leaf, the root has depth 1 */
+			inline uint32 GetDepth() const;
+
+		private:
+			/* Bounds of the triangles in [begin, end) of TriangleIndices */
+			inline RangeBounds ComputeRangeBounds(uint32 begin, uint32 end) const;
+
+			inline void BinRange(uint32 begin, uint32 end, const Bounds& centroids, SplitBins& outBins) const;
+
+			/**
+			* Picks the split of a node and partitions its triangles, returns the first triangle of the right child or
+			* task.End when the node should stay a leaf
+			*/
+			inline uint32 SplitTask(const BuildTask& task, const RangeBounds& range, const SplitBins* bins);
+
+			/* Builds every node under task.Node into 'nodes', the subtree root is nodes[0] */
+			inline void BuildSubtree(const BuildTask& task, const RangeBounds& range, std::vector<BVHNode>& nodes);
+
+			/* Codes, sort and node emission of BuildLinear(), Centroids holds the triangle centroids */
+			template<typename CodeType, typename ParallelFor>
+			inline void BuildLinearNodes(uint32 triangleCount, const Bounds& centroids, ParallelFor&& parallelFor);
+
+			/* Stable LSD radix sort of 'keys' with 8 bit digits, 'values' are moved along */
+			template<typename KeyType, typename ParallelFor>
+			inline static void RadixSort(std::vector<KeyType>& keys, std::vector<uint32>& values, uint32 keyBits, ParallelFor&& parallelFor);
+
+			/* Length of the common prefix of sorted codes i and j, equal codes compare their indices, -1 when j is out of range */
+			template<typename CodeType>
+			inline static int32 CommonPrefix(const CodeType* codes, int32 count, int32 i, int32 j);
+
+			/* Fills TriangleVertices from the mesh in the order of TriangleIndices */
+			template<typename ParallelFor>
+			inline void CopyLeafVertices(const Vector3D* vertices, const uint32* indices, ParallelFor&& parallelFor);
+
+			template<typename ParallelFor>
+			inline void ComputeParents(ParallelFor&& parallelFor);
+
+			/* Bounds of every node from TriangleVertices, bottom up */
+			template<typename ParallelFor>
+			inline void RefitNodes(ParallelFor&& parallelFor);
+
+			template<bool AnyHit>
+			inline bool Traverse(const Ray& ray, float maxDistance, RayHit& outHit) const;
+
+			inline static float GetAxis(const Vector3D& v, uint32 axis);
+
+			inline static void Grow(Bounds& bounds, const Bounds& other);
+
+			inline static void Grow(Bounds& bounds, const Vector3D& point);
+
+			inline static Bounds EmptyBounds();
+
+			/* Half the surface area, the SAH only compares ratios */
+			inline static float HalfArea(const Bounds& bounds);
+
+			inline static uint32 BinIndex(float centroid, float minimum, float scale);
+		};
+
+		inline bool BVHNode::IsLeaf() const
+		{
+			return Count > 0;
+		}
+
+		inline BVH::BVH() { }
+
+		inline void BVH::Build(const Vector3D* vertices, const uint32* indices, uint32 triangleCount)
+		{
+			Build(vertices, indices, triangleCount, [](uint32 count, auto&& job) { job(0u, count); });
+		}
+
+		template<typename ParallelFor>
+		inline void BVH::Build(const Vector3D* vertices, const uint32* indices, uint32 triangleCount, ParallelFor&& parallelFor)
+		{
+			Clear();
+			if (triangleCount == 0)
+			{
+				return;
+			}
+
+			TriangleIndices.resize(triangleCount);
+			Centroids.resize(triangleCount);
+			TriangleBounds.resize(triangleCount);
+
+			parallelFor(triangleCount, [&](uint32 begin, uint32 end)
+			{
+				for (uint32 i = begin; i < end; ++i)
+				{
+					Bounds Triangle = EmptyBounds();
+					Grow(Triangle, vertices[indices[i * 3]]);
+					Grow(Triangle, vertices[indices[i * 3 + 1]]);
+					Grow(Triangle, vertices[indices[i * 3 + 2]]);
+
+					TriangleBounds[i] = Triangle;
+					Centroids[i] = (Triangle.Min + Triangle.Max) * 0.5f;
+					TriangleIndices[i] = i;
+				}
+			});
+
+			/* Top of the tree, one node at a time with every pass over its triangles spread over the jobs */
+			const auto ParallelRangeBounds = [&](uint32 begin, uint32 end)
+			{
+				const uint32 ChunkSize = 8192;
+				const uint32 ChunkCount = (end - begin + ChunkSize - 1) / ChunkSize;
+				std::vector<RangeBounds> Chunks(ChunkCount);
+				parallelFor(ChunkCount, [&](uint32 first, uint32 last)
+				{
+					for (uint32 c = first; c < last; ++c)
+					{
+						Chunks[c] = ComputeRangeBounds(begin + c * ChunkSize, std::min(end, begin + (c + 1) * ChunkSize));
+					}
+				});
+
+				RangeBounds Result = Chunks[0];
+				for (uint32 c = 1; c < ChunkCount; ++c)
+				{
+					Grow(Result.Triangles, Chunks[c].Triangles);
+					Grow(Result.Centroids, Chunks[c].Centroids);
+				}
+				return Result;
+			};
+
+			const auto ParallelBins = [&](uint32 begin, uint32 end, const Bounds& centroids, SplitBins& outBins)
+			{
+				const uint32 ChunkSize = 8192;
+				const uint32 ChunkCount = (end - begin + ChunkSize - 1) / ChunkSize;
+				std::vector<SplitBins> Chunks(ChunkCount);
+				parallelFor(ChunkCount, [&](uint32 first, uint32 last)
+				{
+					for (uint32 c = first; c < last; ++c)
+					{
+						BinRange(begin + c * ChunkSize, std::min(end, begin + (c + 1) * ChunkSize), centroids, Chunks[c]);
+					}
+				});
+
+				outBins = Chunks[0];
+				for (uint32 c = 1; c < ChunkCount; ++c)
+				{
+					for (uint32 Axis = 0; Axis < 3; ++Axis)
+					{
+						for (uint32 b = 0; b < BinCount; ++b)
+						{
+							Grow(outBins.Bins[Axis][b].Triangles, Chunks[c].Bins[Axis][b].Triangles);
+							outBins.Bins[Axis][b].Count += Chunks[c].Bins[Axis][b].Count;
+						}
+					}
+				}
+			};
+
+			Nodes.reserve(triangleCount / 2 + 1);
+			Nodes.push_back(BVHNode());
+
+			std::vector<std::pair<BuildTask, RangeBounds>> Pending;
+			std::vector<std::pair<BuildTask, RangeBounds>> Subtrees;
+			Pending.push_back(std::make_pair(BuildTask{ 0, 0, triangleCount, 1 }, ParallelRangeBounds(0, triangleCount)));
+
+			while (!Pending.empty())
+			{
+				const BuildTask Task = Pending.back().first;
+				const RangeBounds Range = Pending.back().second;
+				Pending.pop_back();
+
+				if (Task.End - Task.Begin <= SubtreeSize)
+				{
+					Subtrees.push_back(std::make_pair(Task, Range));
+					continue;
+				}
+
+				SplitBins Bins;
+				ParallelBins(Task.Begin, Task.End, Range.Centroids, Bins);
+
+				BVHNode& Node = Nodes[Task.Node];
+				Node.BoundsMin = Range.Triangles.Min;
+				Node.BoundsMax = Range.Triangles.Max;
+
+				const uint32 Middle = SplitTask(Task, Range, &Bins);
+				if (Middle == Task.End)
+				{
+					Node.LeftFirst = Task.Begin;
+					Node.Count = Task.End - Task.Begin;
+					continue;
+				}
+
+				const uint32 Left = static_cast<uint32>(Nodes.size());
+				Nodes[Task.Node].LeftFirst = Left;
+				Nodes[Task.Node].Count = 0;
+				Nodes.resize(Nodes.size() + 2);
+
+				Pending.push_back(std::make_pair(BuildTask{ Left, Task.Begin, Middle, Task.Depth + 1 }, ParallelRangeBounds(Task.Begin, Middle)));
+				Pending.push_back(std::make_pair(BuildTask{ Left + 1, Middle, Task.End, Task.Depth + 1 }, ParallelRangeBounds(Middle, Task.End)));
+			}
+
+			/* Largest subtrees first so a parallelFor that hands out jobs in order balances better */
+			std::sort(Subtrees.begin(), Subtrees.end(), [](const std::pair<BuildTask, RangeBounds>& a, const std::pair<BuildTask, RangeBounds>& b)
+			{
+				return a.first.End - a.first.Begin > b.first.End - b.first.Begin;
+			});
+
+			std::vector<std::vector<BVHNode>> SubtreeNodes(Subtrees.size());
+			parallelFor(static_cast<uint32>(Subtrees.size()), [&](uint32 begin, uint32 end)
+			{
+				for (uint32 s = begin; s < end; ++s)
+				{
+					BuildSubtree(Subtrees[s].first, Subtrees[s].second, SubtreeNodes[s]);
+				}
+			});
+
+			/* Subtree node i > 0 moves to Base + i - 1, its root replaces the placeholder node */
+			for (uint32 s = 0; s < Subtrees.size(); ++s)
+			{
+				std::vector<BVHNode>& Local = SubtreeNodes[s];
+				const uint32 Base = static_cast<uint32>(Nodes.size());
+				for (BVHNode& Node : Local)
+				{
+					if (!Node.IsLeaf())
+					{
+						Node.LeftFirst += Base - 1;
+					}
+				}
+
+				Nodes[Subtrees[s].first.Node] = Local[0];
+				Nodes.insert(Nodes.end(), Local.begin() + 1, Local.end());
+				std::vector<BVHNode>().swap(Local);
+			}
+
+			CopyLeafVertices(vertices, indices, parallelFor);
+			ComputeParents(parallelFor);
+
+			std::vector<Vector3D>().swap(Centroids);
+			std::vector<Bounds>().swap(TriangleBounds);
+			Nodes.shrink_to_fit();
+		}
+
+		inline void BVH::BuildLinear(const Vector3D* vertices, const uint32* indices, uint32 triangleCount, MortonPrecision precision)
+		{
+			BuildLinear(vertices, indices, triangleCount, precision, [](uint32 count, auto&& job) { job(0u, count); });
+		}
+
+		template<typename ParallelFor>
+		inline void BVH::BuildLinear(const Vector3D* vertices, const uint32* indices, uint32 triangleCount, MortonPrecision precision,
+			ParallelFor&& parallelFor)
+		{
+			Clear();
+			if (triangleCount == 0)
+			{
+				return;
+			}
+
+			Centroids.resize(triangleCount);
+
+			/* Centroids and their bounds in one pass, one partial bound per chunk */
+			const uint32 ChunkSize = 8192;
+			const uint32 ChunkCount = (triangleCount + ChunkSize - 1) / ChunkSize;
+			std::vector<Bounds> Chunks(ChunkCount);
+			parallelFor(ChunkCount, [&](uint32 first, uint32 last)
+			{
+				for (uint32 c = first; c < last; ++c)
+				{
+					Bounds Chunk = EmptyBounds();
+					for (uint32 i = c * ChunkSize; i < std::min(triangleCount, (c + 1) * ChunkSize); ++i)
+					{
+						Bounds Triangle = EmptyBounds();
+						Grow(Triangle, vertices[indices[i * 3]]);
+						Grow(Triangle, vertices[indices[i * 3 + 1]]);
+						Grow(Triangle, vertices[indices[i * 3 + 2]]);
+
+						Centroids[i] = (Triangle.Min + Triangle.Max) * 0.5f;
+						Grow(Chunk, Centroids[i]);
+					}
+					Chunks[c] = Chunk;
+				}
+			});
+
+			Bounds CentroidBounds = Chunks[0];
+			for (uint32 c = 1; c < ChunkCount; ++c)
+			{
+				Grow(CentroidBounds, Chunks[c]);
+			}
+
+			/**
+			* Cubic cells, with one cell count per axis a flat level would be split along its thin axis as often as along
+			* the wide ones, giving children that overlap for every ray crossing them
+			*/
+			const Vector3D Extent = CentroidBounds.Max - CentroidBounds.Min;
+			const float CubeSize = std::max(Extent.X, std::max(Extent.Y, Extent.Z));
+			CentroidBounds.Max = CentroidBounds.Min + Vector3D(CubeSize, CubeSize, CubeSize);
+
+			if (precision == MortonPrecision::Bits63)
+			{
+				BuildLinearNodes<uint64>(triangleCount, CentroidBounds, parallelFor);
+			}
+			else
+			{
+				BuildLinearNodes<uint32>(triangleCount, CentroidBounds, parallelFor);
+			}
+			std::vector<Vector3D>().swap(Centroids);
+
+			CopyLeafVertices(vertices, indices, parallelFor);
+			RefitNodes(parallelFor);
+		}
+
+		inline void BVH::Refit(const Vector3D* vertices, const uint32* indices)
+		{
+			Refit(vertices, indices, [](uint32 count, auto&& job) { job(0u, count); });
+		}
+
+		template<typename ParallelFor>
+		inline void BVH::Refit(const Vector3D* vertices, const uint32* indices, ParallelFor&& parallelFor)
+		{
+			if (Nodes.empty())
+			{
+				return;
+			}
+
+			CopyLeafVertices(vertices, indices, parallelFor);
+			RefitNodes(parallelFor);
+		}
+
+		inline void BVH::Clear()
+		{
+			Nodes.clear();
+			TriangleIndices.clear();
+			TriangleVertices.clear();
+			Parents.clear();
+		}
+
+		inline bool BVH::Intersect(const Ray& ray, float maxDistance, RayHit& outHit) const
+		{
+			return Traverse<false>(ray, maxDistance, outHit);
+		}
+
+		inline bool BVH::IsOccluded(const Ray& ray, float maxDistance) const
+		{
+			RayHit Hit;
+			return Traverse<true>(ray, maxDistance, Hit);
+		}
+
+		inline const std::vector<BVHNode>& BVH::GetNodes() const
+		{
+			return Nodes;
+		}
+
+		inline uint32 BVH::GetTriangleCount() const
+		{
+			return static_cast<uint32>(TriangleIndices.size());
+		}
+
+		inline uint32 BVH::GetDepth() const
+		{
+			if (Nodes.empty())
+			{
+				return 0;
+			}
+
+			/* A linear build places children before their parent too, so walk the tree instead of the array */
+			std::vector<std::pair<uint32, uint32>> Stack(1, std::make_pair(0u, 1u));
+			uint32 Deepest = 1;
+			while (!Stack.empty())
+			{
+				const std::pair<uint32, uint32> Entry = Stack.back();
+				Stack.pop_back();
+
+				Deepest = std::max(Deepest, Entry.second);
+				if (!Nodes[Entry.first].IsLeaf())
+				{
+					Stack.push_back(std::make_pair(Nodes[Entry.first].LeftFirst, Entry.second + 1));
+					Stack.push_back(std::make_pair(Nodes[Entry.first].LeftFirst + 1, Entry.second + 1));
+				}
+			}
+			return Deepest;
+		}
+
+		inline BVH::RangeBounds BVH::ComputeRangeBounds(uint32 begin, uint32 end) const
+		{
+			RangeBounds Result = { EmptyBounds(), EmptyBounds() };
+			for (uint32 i = begin; i < end; ++i)
+			{
+				const uint32 Triangle = TriangleIndices[i];
+				Grow(Result.Triangles, TriangleBounds[Triangle]);
+				Grow(Result.Centroids, Centroids[Triangle]);
+			}
+			return Result;
+		}
+
+		inline void BVH::BinRange(uint32 begin, uint32 end, const Bounds& centroids, SplitBins& outBins) const
+		{
+			for (uint32 Axis = 0; Axis < 3; ++Axis)
+			{
+				for (uint32 b = 0; b < BinCount; ++b)
+				{
+					outBins.Bins[Axis][b].Triangles = EmptyBounds();
+					outBins.Bins[Axis][b].Count = 0;
+				}
+			}
+
+			const Vector3D Extent = centroids.Max - centroids.Min;
+			const Vector3D Scale(Extent.X > 0.0f ? BinCount / Extent.X : 0.0f, Extent.Y > 0.0f ? BinCount / Extent.Y : 0.0f,
+				Extent.Z > 0.0f ? BinCount / Extent.Z : 0.0f);
+
+			for (uint32 i = begin; i < end; ++i)
+			{
+				const uint32 Triangle = TriangleIndices[i];
+				const Vector3D& Centroid = Centroids[Triangle];
+				const Bounds& TriangleBox = TriangleBounds[Triangle];
+
+				/* All three indices first so the bin updates of the axes do not wait on each other */
+				const uint32 BinX = BinIndex(Centroid.X, centroids.Min.X, Scale.X);
+				const uint32 BinY = BinIndex(Centroid.Y, centroids.Min.Y, Scale.Y);
+				const uint32 BinZ = BinIndex(Centroid.Z, centroids.Min.Z, Scale.Z);
+
+				Grow(outBins.Bins[0][BinX].Triangles, TriangleBox);
+				Grow(outBins.Bins[1][BinY].Triangles, TriangleBox);
+				Grow(outBins.Bins[2][BinZ].Triangles, TriangleBox);
+				outBins.Bins[0][BinX].Count++;
+				outBins.Bins[1][BinY].Count++;
+				outBins.Bins[2][BinZ].Count++;
+			}
+		}
+
+		inline uint32 BVH::SplitTask(const BuildTask& task, const RangeBounds& range, const SplitBins* bins)
+		{
+			const uint32 Count = task.End - task.Begin;
+			const Vector3D CentroidExtent = range.Centroids.Max - range.Centroids.Min;
+
+			uint32 LongestAxis = 0;
+			for (uint32 Axis = 1; Axis < 3; ++Axis)
+			{
+				if (GetAxis(CentroidExtent, Axis) > GetAxis(CentroidExtent, LongestAxis))
+				{
+					LongestAxis = Axis;
+				}
+			}
+
+			/* Two triangles or fewer always go in one leaf, binning them is not worth it */
+			if (Count <= 2)
+			{
+				return task.End;
+			}
+
+			/* Every centroid in one spot, no plane separates them */
+			if (GetAxis(CentroidExtent, LongestAxis) <= 0.0f)
+			{
+				return Count <= MaxLeafSize ? task.End : task.Begin + Count / 2;
+			}
+
+			if (bins != nullptr && task.Depth <= MaxSAHDepth)
+			{
+				/* Cost in triangle tests: 1 per traversal step plus the area weighted triangle counts of both children */
+				const float NodeArea = HalfArea(range.Triangles);
+				float BestCost = static_cast<float>(Count);
+				uint32 BestAxis = 3;
+				uint32 BestBin = 0;
+
+				for (uint32 Axis = 0; Axis < 3; ++Axis)
+				{
+					const Bin* AxisBins = bins->Bins[Axis];
+
+					float RightCosts[BinCount];
+					Bounds Right = EmptyBounds();
+					uint32 RightCount = 0;
+					for (uint32 b = BinCount - 1; b > 0; --b)
+					{
+						Grow(Right, AxisBins[b].Triangles);
+						RightCount += AxisBins[b].Count;
+						RightCosts[b] = RightCount > 0 ? RightCount * HalfArea(Right) : 0.0f;
+					}
+
+					Bounds Left = EmptyBounds();
+					uint32 LeftCount = 0;
+					for (uint32 b = 0; b + 1 < BinCount; ++b)
+					{
+						Grow(Left, AxisBins[b].Triangles);
+						LeftCount += AxisBins[b].Count;
+						if (LeftCount == 0 || LeftCount == Count)
+						{
+							continue;
+						}
+
+						const float Cost = 1.0f + (LeftCount * HalfArea(Left) + RightCosts[b + 1]) / NodeArea;
+						if (Cost < BestCost)
+						{
+							BestCost = Cost;
+							BestAxis = Axis;
+							BestBin = b;
+						}
+					}
+				}
+
+				if (BestAxis == 3)
+				{
+					if (Count <= MaxLeafSize)
+					{
+						return task.End;
+					}
+				}
+				else
+				{
+					const float Minimum = GetAxis(range.Centroids.Min, BestAxis);
+					const float Scale = BinCount / GetAxis(CentroidExtent, BestAxis);
+					const uint32* Middle = std::partition(TriangleIndices.data() + task.Begin, TriangleIndices.data() + task.End,
+						[&](uint32 triangle) { return BinIndex(GetAxis(Centroids[triangle], BestAxis), Minimum, Scale) <= BestBin; });
+					return static_cast<uint32>(Middle - TriangleIndices.data());
+				}
+			}
+			else if (Count <= MaxLeafSize)
+			{
+				return task.End;
+			}
+
+			/* Too deep for the SAH or no split beats a leaf that is too large, median of the longest axis */
+			const uint32 Middle = task.Begin + Count / 2;
+			std::nth_element(TriangleIndices.data() + task.Begin, TriangleIndices.data() + Middle, TriangleIndices.data() + task.End,
+				[&](uint32 a, uint32 b) { return GetAxis(Centroids[a], LongestAxis) < GetAxis(Centroids[b], LongestAxis); });
+			return Middle;
+		}
+
+		inline void BVH::BuildSubtree(const BuildTask& task, const RangeBounds& range, std::vector<BVHNode>& nodes)
+		{
+			/* Node indices inside 'nodes', task.Node is only used by the caller */
+			std::vector<std::pair<BuildTask, RangeBounds>> Stack;
+			Stack.push_back(std::make_pair(BuildTask{ 0, task.Begin, task.End, task.Depth }, range));
+			nodes.push_back(BVHNode());
+
+			SplitBins Bins;
+			while (!Stack.empty())
+			{
+				const BuildTask Task = Stack.back().first;
+				const RangeBounds Range = Stack.back().second;
+				Stack.pop_back();
+
+				const bool UseBins = Task.End - Task.Begin > 2 && Task.Depth <= MaxSAHDepth;
+				if (UseBins)
+				{
+					BinRange(Task.Begin, Task.End, Range.Centroids, Bins);
+				}
+
+				BVHNode& Node = nodes[Task.Node];
+				Node.BoundsMin = Range.Triangles.Min;
+				Node.BoundsMax = Range.Triangles.Max;
+
+				const uint32 Middle = SplitTask(Task, Range, UseBins ? &Bins : nullptr);
+				if (Middle == Task.End)
+				{
+					Node.LeftFirst = Task.Begin;
+					Node.Count = Task.End - Task.Begin;
+					continue;
+				}
+
+				const uint32 Left = static_cast<uint32>(nodes.size());
+				nodes[Task.Node].LeftFirst = Left;
+				nodes[Task.Node].Count = 0;
+				nodes.resize(nodes.size() + 2);
+
+				Stack.push_back(std::make_pair(BuildTask{ Left, Task.Begin, Middle, Task.Depth + 1 }, ComputeRangeBounds(Task.Begin, Middle)));
+				Stack.push_back(std::make_pair(BuildTask{ Left + 1, Middle, Task.End, Task.Depth + 1 }, ComputeRangeBounds(Middle, Task.End)));
+			}
+		}
+
+		template<typename CodeType, typename ParallelFor>
+		inline void BVH::BuildLinearNodes(uint32 triangleCount, const Bounds& centroids, ParallelFor&& parallelFor)
+		{
+			std::vector<CodeType> Codes(triangleCount);
+			TriangleIndices.resize(triangleCount);
+
+			const uint32 ChunkSize = 8192;
+			const uint32 ChunkCount = (triangleCount + ChunkSize - 1) / ChunkSize;
+			parallelFor(ChunkCount, [&](uint32 first, uint32 last)
+			{
+				for (uint32 c = first; c < last; ++c)
+				{
+					const uint32 Begin = c * ChunkSize;
+					const uint32 End = std::min(triangleCount, Begin + ChunkSize);
+					MortonCode::Encode(&Centroids[Begin], End - Begin, centroids.Min, centroids.Max, &Codes[Begin]);
+					for (uint32 i = Begin; i < End; ++i)
+					{
+						TriangleIndices[i] = i;
+					}
+				}
+			});
+
+			RadixSort(Codes, TriangleIndices, sizeof(CodeType) == 4 ? 30 : 63, parallelFor);
+
+			/* Leaves are runs of LinearLeafSize consecutive triangles in Morton order, keyed by the code of their first triangle */
+			const uint32 LeafCount = (triangleCount + LinearLeafSize - 1) / LinearLeafSize;
+			std::vector<CodeType> LeafCodes(LeafCount);
+			for (uint32 Leaf = 0; Leaf < LeafCount; ++Leaf)
+			{
+				LeafCodes[Leaf] = Codes[size_t(Leaf) * LinearLeafSize];
+			}
+
+			/* Leaf k sits in slot 2k + 1 when it is a left child and in slot 2k when it is a right child, see below */
+			Nodes.resize(size_t(LeafCount) * 2 - 1);
+			Parents.resize(Nodes.size());
+			Parents[0] = InvalidNode;
+			const auto MakeLeaf = [&](uint32 slot, uint32 leaf)
+			{
+				const uint32 First = leaf * LinearLeafSize;
+				Nodes[slot].LeftFirst = First;
+				Nodes[slot].Count = triangleCount - First < LinearLeafSize ? triangleCount - First : LinearLeafSize;
+			};
+
+			if (LeafCount == 1)
+			{
+				MakeLeaf(0, 0);
+				return;
+			}
+
+			/**
+			* Karras 2012: inner node i covers a range of sorted leaves with i at one end, found from the common prefixes
+			* around i alone, so every inner node is independent. The two children of the node that splits after leaf s
+			* go to slots 2s + 1 and 2s + 2, every s in [0, n - 1) splits exactly one node so no two nodes share a slot.
+			* Inner node i is the left child of the node splitting after i when its range ends at i and the right child of
+			* the node splitting after i - 1 when it starts at i, which gives its own slot without knowing its parent
+			*/
+			const int32 Count = static_cast<int32>(LeafCount);
+			const CodeType* SortedCodes = LeafCodes.data();
+			parallelFor(LeafCount - 1, [&](uint32 begin, uint32 end)
+			{
+				for (int32 i = static_cast<int32>(begin); i < static_cast<int32>(end); ++i)
+				{
+					/* The range grows towards the neighbour sharing the longer prefix */
+					const int32 Direction = CommonPrefix(SortedCodes, Count, i, i + 1) > CommonPrefix(SortedCodes, Count, i, i - 1) ? 1 : -1;
+					const int32 MinPrefix = CommonPrefix(SortedCodes, Count, i, i - Direction);
+
+					int32 MaxLength = 2;
+					while (CommonPrefix(SortedCodes, Count, i, i + MaxLength * Direction) > MinPrefix)
+					{
+						MaxLength *= 2;
+					}
+
+					int32 Length = 0;
+					for (int32 Step = MaxLength / 2; Step >= 1; Step /= 2)
+					{
+						if (CommonPrefix(SortedCodes, Count, i, i + (Length + Step) * Direction) > MinPrefix)
+						{
+							Length += Step;
+						}
+					}
+					const int32 Other = i + Length * Direction;
+
+					/* Last leaf that still shares more than the node prefix with i, binary searched from i */
+					const int32 NodePrefix = CommonPrefix(SortedCodes, Count, i, Other);
+					int32 Offset = 0;
+					int32 Step = Length;
+					do
+					{
+						Step = (Step + 1) / 2;
+						if (CommonPrefix(SortedCodes, Count, i, i + (Offset + Step) * Direction) > NodePrefix)
+						{
+							Offset += Step;
+						}
+					} while (Step > 1);
+
+					const uint32 Split = static_cast<uint32>(i + Offset * Direction + std::min(Direction, 0));
+					const uint32 Slot = static_cast<uint32>(i == 0 ? 0 : (Direction > 0 ? 2 * i : 2 * i + 1));
+					const uint32 Left = 2 * Split + 1;
+
+					Nodes[Slot].LeftFirst = Left;
+					Nodes[Slot].Count = 0;
+					Parents[Left] = Slot;
+					Parents[Left + 1] = Slot;
+
+					if (static_cast<uint32>(std::min(i, Other)) == Split)
+					{
+						MakeLeaf(Left, Split);
+					}
+					if (static_cast<uint32>(std::max(i, Other)) == Split + 1)
+					{
+						MakeLeaf(Left + 1, Split + 1);
+					}
+				}
+			});
+		}
+
+		template<typename KeyType, typename ParallelFor>
+		inline void BVH::RadixSort(std::vector<KeyType>& keys, std::vector<uint32>& values, uint32 keyBits, ParallelFor&& parallelFor)
+		{
+			const uint32 DigitBits = 8;
+			const uint32 DigitCount = 1u << DigitBits;
+			const uint32 Count = static_cast<uint32>(keys.size());
+			const uint32 ChunkSize = 16384;
+			const uint32 ChunkCount = (Count + ChunkSize - 1) / ChunkSize;
+
+			std::vector<KeyType> SortedKeys(Count);
+			std::vector<uint32> SortedValues(Count);
+
+			/* Histogram of every chunk, turned in place into the first output position of each digit of each chunk */
+			std::vector<uint32> Offsets(size_t(ChunkCount) * DigitCount);
+
+			for (uint32 Shift = 0; Shift < keyBits; Shift += DigitBits)
+			{
+				parallelFor(ChunkCount, [&](uint32 first, uint32 last)
+				{
+					for (uint32 c = first; c < last; ++c)
+					{
+						uint32* Histogram = &Offsets[size_t(c) * DigitCount];
+						std::fill(Histogram, Histogram + DigitCount, 0u);
+						for (uint32 i = c * ChunkSize; i < std::min(Count, (c + 1) * ChunkSize); ++i)
+						{
+							Histogram[static_cast<uint32>(keys[i] >> Shift) & (DigitCount - 1)]++;
+						}
+					}
+				});
+
+				/* Digit major so each chunk writes its keys of a digit after the same digit of the earlier chunks */
+				uint32 Total = 0;
+				bool SingleDigit = false;
+				for (uint32 Digit = 0; Digit < DigitCount; ++Digit)
+				{
+					const uint32 DigitBegin = Total;
+					for (uint32 c = 0; c < ChunkCount; ++c)
+					{
+						const uint32 Keys = Offsets[size_t(c) * DigitCount + Digit];
+						Offsets[size_t(c) * DigitCount + Digit] = Total;
+						Total += Keys;
+					}
+					SingleDigit = SingleDigit || Total - DigitBegin == Count;
+				}
+
+				/* Every key has the same digit, common for the high digits of a compact scene, the order is unchanged */
+				if (SingleDigit)
+				{
+					continue;
+				}
+
+				parallelFor(ChunkCount, [&](uint32 first, uint32 last)
+				{
+					for (uint32 c = first; c < last; ++c)
+					{
+						uint32* Offset = &Offsets[size_t(c) * DigitCount];
+						for (uint32 i = c * ChunkSize; i < std::min(Count, (c + 1) * ChunkSize); ++i)
+						{
+							const uint32 Target = Offset[static_cast<uint32>(keys[i] >> Shift) & (DigitCount - 1)]++;
+							SortedKeys[Target] = keys[i];
+							SortedValues[Target] = values[i];
+						}
+					}
+				});
+
+				keys.swap(SortedKeys);
+				values.swap(SortedValues);
+			}
+		}
+
+		template<typename CodeType>
+		inline int32 BVH::CommonPrefix(const CodeType* codes, int32 count, int32 i, int32 j)
+		{
+			if (j < 0 || j >= count)
+			{
+				return -1;
+			}
+
+			if (codes[i] == codes[j])
+			{
+				return static_cast<int32>(sizeof(CodeType) * 8 + MortonCode::CountLeadingZeros(static_cast<uint32>(i ^ j)));
+			}
+			return static_cast<int32>(MortonCode::CountLeadingZeros(codes[i] ^ codes[j]));
+		}
+
+		template<typename ParallelFor>
+		inline void BVH::CopyLeafVertices(const Vector3D* vertices, const uint32* indices, ParallelFor&& parallelFor)
+		{
+			const uint32 TriangleCount = static_cast<uint32>(TriangleIndices.size());
+			TriangleVertices.resize(size_t(TriangleCount) * 3);
+			parallelFor(TriangleCount, [&](uint32 begin, uint32 end)
+			{
+				for (uint32 i = begin; i < end; ++i)
+				{
+					const uint32* Triangle = indices + size_t(TriangleIndices[i]) * 3;
+					TriangleVertices[size_t(i) * 3] = vertices[Triangle[0]];
+					TriangleVertices[size_t(i) * 3 + 1] = vertices[Triangle[1]];
+					TriangleVertices[size_t(i) * 3 + 2] = vertices[Triangle[2]];
+				}
+			});
+		}
+
+		template<typename ParallelFor>
+		inline void BVH::ComputeParents(ParallelFor&& parallelFor)
+		{
+			Parents.resize(Nodes.size());
+			Parents[0] = InvalidNode;
+			parallelFor(static_cast<uint32>(Nodes.size()), [&](uint32 begin, uint32 end)
+			{
+				for (uint32 i = begin; i < end; ++i)
+				{
+					if (!Nodes[i].IsLeaf())
+					{
+						Parents[Nodes[i].LeftFirst] = i;
+						Parents[Nodes[i].LeftFirst + 1] = i;
+					}
+				}
+			});
+		}
+
+		template<typename ParallelFor>
+		inline void BVH::RefitNodes(ParallelFor&& parallelFor)
+		{
+			/* Every leaf walks up, the first child to reach a parent stops and the second one, which sees both children done, goes on */
+			std::vector<std::atomic<uint32>> Arrivals(Nodes.size());
+			parallelFor(static_cast<uint32>(Nodes.size()), [&](uint32 begin, uint32 end)
+			{
+				for (uint32 i = begin; i < end; ++i)
+				{
+					BVHNode& Leaf = Nodes[i];
+					if (!Leaf.IsLeaf())
+					{
+						continue;
+					}
+
+					Bounds Box = EmptyBounds();
+					for (size_t v = size_t(Leaf.LeftFirst) * 3; v < size_t(Leaf.LeftFirst + Leaf.Count) * 3; ++v)
+					{
+						Grow(Box, TriangleVertices[v]);
+					}
+					Leaf.BoundsMin = Box.Min;
+					Leaf.BoundsMax = Box.Max;
+
+					/* acq_rel publishes this child's bounds to the thread that finishes the parent */
+					for (uint32 Node = Parents[i]; Node != InvalidNode; Node = Parents[Node])
+					{
+						if (Arrivals[Node].fetch_add(1, std::memory_order_acq_rel) == 0)
+						{
+							break;
+						}
+
+						BVHNode& Parent = Nodes[Node];
+						const BVHNode& Left = Nodes[Parent.LeftFirst];
+						const BVHNode& Right = Nodes[Parent.LeftFirst + 1];
+						Box = Bounds{ Left.BoundsMin, Left.BoundsMax };
+						Grow(Box, Bounds{ Right.BoundsMin, Right.BoundsMax });
+						Parent.BoundsMin = Box.Min;
+						Parent.BoundsMax = Box.Max;
+					}
+				}
+			});
+		}
+
+		template<bool AnyHit>
+		inline bool BVH::Traverse(const Ray& ray, float maxDistance, RayHit& outHit) const
+		{
+			if (Nodes.empty())
+			{
+				return false;
+			}
+
+			float Closest = maxDistance;
+			float Entry;
+			if (!ray.IntersectAABB(Nodes[0].BoundsMin, Nodes[0].BoundsMax, Closest, Entry))
+			{
+				return false;
+			}
+
+			/* Far children waiting to be visited with the distance where the ray enters them */
+			uint32 StackNodes[StackSize];
+			float StackEntries[StackSize];
+			uint32 StackCount = 0;
+
+			bool Hit = false;
+			uint32 NodeIndex = 0;
+			for (;;)
+			{
+				const BVHNode& Node = Nodes[NodeIndex];
+				if (Node.IsLeaf())
+				{
+					for (uint32 i = Node.LeftFirst; i < Node.LeftFirst + Node.Count; ++i)
+					{
+						const Vector3D* Triangle = &TriangleVertices[size_t(i) * 3];
+						float Distance, U, V;
+						if (ray.IntersectTriangle(Triangle[0], Triangle[1], Triangle[2], Closest, Distance, U, V))
+						{
+							if (AnyHit)
+							{
+								return true;
+							}
+
+							Closest = Distance;
+							outHit.Distance = Distance;
+							outHit.U = U;
+							outHit.V = V;
+							outHit.Triangle = TriangleIndices[i];
+							Hit = true;
+						}
+					}
+				}
+				else
+				{
+					const BVHNode& Left = Nodes[Node.LeftFirst];
+					const BVHNode& Right = Nodes[Node.LeftFirst + 1];
+					float LeftEntry, RightEntry;
+					const bool HitLeft = ray.IntersectAABB(Left.BoundsMin, Left.BoundsMax, Closest, LeftEntry);
+					const bool HitRight = ray.IntersectAABB(Right.BoundsMin, Right.BoundsMax, Closest, RightEntry);
+
+					if (HitLeft && HitRight)
+					{
+						/* Nearer child first so the closest distance shrinks early and culls the other one */
+						const bool RightFirst = RightEntry < LeftEntry;
+						NodeIndex = Node.LeftFirst + (RightFirst ? 1 : 0);
+						StackNodes[StackCount] = Node.LeftFirst + (RightFirst ? 0 : 1);
+						StackEntries[StackCount] = RightFirst ? LeftEntry : RightEntry;
+						StackCount++;
+						continue;
+					}
+					if (HitLeft || HitRight)
+					{
+						NodeIndex = Node.LeftFirst + (HitLeft ? 0 : 1);
+						continue;
+					}
+				}
+
+				/* Pop the next node the ray still reaches before the closest hit */
+				do
+				{
+					if (StackCount == 0)
+					{
+						return Hit;
+					}
+					StackCount--;
+				} while (StackEntries[StackCount] > Closest);
+
+				NodeIndex = StackNodes[StackCount];
+			}
+		}
+
+		inline float BVH::GetAxis(const Vector3D& v, uint32 axis)
+		{
+			return (&v.X)[axis];
+		}
+
+		inline void BVH::Grow(Bounds& bounds, const Bounds& other)
+		{
+			bounds.Min = Vector3D(std::min(bounds.Min.X, other.Min.X), std::min(bounds.Min.Y, other.Min.Y), std::min(bounds.Min.Z, other.Min.Z));
+			bounds.Max = Vector3D(std::max(bounds.Max.X, other.Max.X), std::max(bounds.Max.Y, other.Max.Y), std::max(bounds.Max.Z, other.Max.Z));
+		}
+
+		inline void BVH::Grow(Bounds& bounds, const Vector3D& point)
+		{
+			Grow(bounds, Bounds{ point, point });
+		}
+
+		inline BVH::Bounds BVH::EmptyBounds()
+		{
+			return Bounds{ Vector3D(1e30f, 1e30f, 1e30f), Vector3D(-1e30f, -1e30f, -1e30f) };
+		}
+
+		inline float BVH::HalfArea(const Bounds& bounds)
+		{
+			const Vector3D Extent = bounds.Max - bounds.Min;
+			return Extent.X * Extent.Y + Extent.Y * Extent.Z + Extent.Z * Extent.X;
+		}
+
+		inline uint32 BVH::BinIndex(float centroid, float minimum, float scale)
+		{
+			const int32 Index = static_cast<int32>((centroid - minimum) * scale);
+			return static_cast<uint32>(std::min(std::max(Index, 0), static_cast<int32>(BinCount) - 1));
+		}
+	}
+}
@@ -0,0 +1,245 @@
+#pragma once
+#include "GenericDefines.h"
+#include "Matrix4D.h"
+#include "Quat.h"
+#include "Transform.h"
+#include "Vector3D.h"
+#include "VrixicMathSIMD.h"
+
+#include <cmath>
+
+namespace Vrixic
+{
+	namespace Math
+	{
+		/**
+		* Rigid transform (rotation + translation) as a unit dual quaternion, Real + e * Dual, 32 bytes
+		*
+		* Follows the same conventions as Matrix4D: Real is the quat whose ToMatrix4D() is the rotation part of the matrix,
+		* TransformPoint() gives the same result as Matrix4D::TransformPoints() and (a * b) applies 'a' first.
+		* With the translation t as the pure quat (t, 0), Dual = -0.5 * Real * t
+		*
+		* Blending dual quaternions and renormalizing (BlendSkinning()) keeps the volume of twisted joints, unlike blending
+		* skinning matrices
+		*/
+		struct DualQuat
+		{
+		public:
+			Quat Real;
+			Quat Dual;
+
+		public:
+			/* Identity transform */
+			inline constexpr DualQuat();
+
+			inline constexpr DualQuat(const Quat& real, const Quat& dual);
+
+			/* 'rotation' has to be normalized */
+			inline DualQuat(const Quat& rotation, const Vector3D& translation);
+
+		public:
+			/* Same order as Matrix4D, (a * b) is 'a' followed by 'b' */
+			inline DualQuat operator*(const DualQuat& dq) const;
+
+			inline DualQuat operator*(float scalar) const;
+
+			inline DualQuat operator+(const DualQuat& dq) const;
+
+		public:
+			inline constexpr static DualQuat Identity();
+
+			/* Drops the scale of the transform */
+			inline static DualQuat MakeFromTransform(const Transform& transform);
+
+			/* Drops any scale of the matrix, the rotation comes from its normalized rows */
+			inline static DualQuat MakeFromMatrix4D(const Matrix4D& matrix);
+
+			inline Quat GetRotation() const;
+
+			inline Vector3D GetTranslation() const;
+
+			/* Scales both parts so Real is a unit quat and makes Dual orthogonal to it */
+			inline const DualQuat& Normalize();
+
+			/* Inverse of a normalized dual quaternion */
+			inline DualQuat Inverse() const;
+
+			/* Only valid for normalized dual quaternions, same as Matrix4D::TransformPoints() of ToMatrix4D() */
+			inline Vector3D TransformPoint(const Vector3D& point) const;
+
+			/* Rotation only, same as Matrix4D::TransformVectors() of ToMatrix4D() */
+			inline Vector3D TransformVector(const Vector3D& vector) const;
+
+			inline Matrix4D ToMatrix4D() const;
+
+			/**
+			* Dual quaternion linear blending of 4 influences per vertex, each blend is normalized
+			*
+			* @param palette - one dual quaternion per bone
+			* @param boneIndices - 4 indices into the palette per vertex, boneIndices[i * 4 + k]
+			* @param boneWeights - 4 weights per vertex, boneWeights[i * 4 + k], unused influences have a weight of 0
+			* @param outBlended - 'count' blended dual quaternions
+			*/
+			inline static void BlendSkinning(const DualQuat* palette, const uint32* boneIndices, const float* boneWeights, DualQuat* outBlended, uint32 count);
+
+			/**
+			* BlendSkinning() followed by TransformPoint() for each vertex, without writing out the blended dual quaternions
+			* 'outPoints' may be the same array as 'inPoints'
+			*/
+			inline static void SkinPoints(const DualQuat* palette, const uint32* boneIndices, const float* boneWeights, const Vector3D* inPoints, Vector3D* outPoints, uint32 count);
+
+		private:
+			/* Weighted sum of the 4 influences of one vertex, every influence is flipped into the hemisphere of the first */
+			inline static DualQuat BlendInfluences(const DualQuat* palette, const uint32* boneIndices, const float* boneWeights);
+		};
+
+		static_assert(sizeof(DualQuat) == 32, "DualQuat should stay 32 bytes");
+
+		inline constexpr DualQuat::DualQuat()
+			: Real(0.0f, 0.0f, 0.0f, 1.0f), Dual(0.0f, 0.0f, 0.0f, 0.0f) { }
+
+		inline constexpr DualQuat::DualQuat(const Quat& real, const Quat& dual)
+			: Real(real), Dual(dual) { }
+
+		inline DualQuat::DualQuat(const Quat& rotation, const Vector3D& translation)
+			: Real(rotation), Dual(rotation * Quat(translation * -0.5f, 0.0f)) { }
+
+		inline DualQuat DualQuat::operator*(const DualQuat& dq) const
+		{
+			return DualQuat(Real * dq.Real, Real * dq.Dual + Dual * dq.Real);
+		}
+
+		inline DualQuat DualQuat::operator*(float scalar) const
+		{
+			return DualQuat(Quat(Real.X * scalar, Real.Y * scalar, Real.Z * scalar, Real.W * scalar),
+				Quat(Dual.X * scalar, Dual.Y * scalar, Dual.Z * scalar, Dual.W * scalar));
+		}
+
+		inline DualQuat DualQuat::operator+(const DualQuat& dq) const
+		{
+			return DualQuat(Real + dq.Real, Dual + dq.Dual);
+		}
+
+		inline constexpr DualQuat DualQuat::Identity()
+		{
+			return DualQuat();
+		}
+
+		inline DualQuat DualQuat::MakeFromTransform(const Transform& transform)
+		{
+			return DualQuat(transform.Rotation, transform.Translation);
+		}
+
+		inline DualQuat DualQuat::MakeFromMatrix4D(const Matrix4D& matrix)
+		{
+			return MakeFromTransform(Transform::Decompose(matrix));
+		}
+
+		inline Quat DualQuat::GetRotation() const
+		{
+			return Real;
+		}
+
+		inline Vector3D DualQuat::GetTranslation() const
+		{
+			/* t = -2 * Real^-1 * Dual, the vector part of the product */
+			const Vector3D RealV(Real.X, Real.Y, Real.Z);
+			const Vector3D DualV(Dual.X, Dual.Y, Dual.Z);
+			return (DualV * -Real.W + RealV * Dual.W + Vector3D::CrossProduct(RealV, DualV)) * 2.0f;
+		}
+
+		inline const DualQuat& DualQuat::Normalize()
+		{
+			const float InverseLength = 1.0f / Real.Length();
+			*this = *this * InverseLength;
+
+			const float Dot = Quat::DotProduct(Real, Dual);
+			Dual = Quat(Dual.X - Real.X * Dot, Dual.Y - Real.Y * Dot, Dual.Z - Real.Z * Dot, Dual.W - Real.W * Dot);
+
+			return *this;
+		}
+
+		inline DualQuat DualQuat::Inverse() const
+		{
+			return DualQuat(Real.Conjugate(), Dual.Conjugate());
+		}
+
+		inline Vector3D DualQuat::TransformPoint(const Vector3D& point) const
+		{
+			return TransformVector(point) + GetTranslation();
+		}
+
+		inline Vector3D DualQuat::TransformVector(const Vector3D& vector) const
+		{
+			/* Matrices built by Quat::ToMatrix4D() rotate row vectors by the conjugate */
+			return Real.Conjugate().RotateVector(vector);
+		}
+
+		inline Matrix4D DualQuat::ToMatrix4D() const
+		{
+			Matrix4D Result = Real.ToMatrix4D();
+			Result.SetTranslation(GetTranslation());
+			return Result;
+		}
+
+		inline DualQuat DualQuat::BlendInfluences(const DualQuat* palette, const uint32* boneIndices, const float* boneWeights)
+		{
+			const VectorRegister SignMask = VectorRegisterReplicate(-0.0f);
+
+			const DualQuat& First = palette[boneIndices[0]];
+			const VectorRegister FirstReal = MakeVectorRegister(&First.Real.X);
+			const VectorRegister FirstWeight = VectorRegisterReplicate(boneWeights[0]);
+
+			VectorRegister BlendReal = VectorRegisterMultiply(FirstReal, FirstWeight);
+			VectorRegister BlendDual = VectorRegisterMultiply(MakeVectorRegister(&First.Dual.X), FirstWeight);
+
+			for (uint32 k = 1; k < 4; ++k)
+			{
+				const DualQuat& Influence = palette[boneIndices[k]];
+				const VectorRegister InfluenceReal = MakeVectorRegister(&Influence.Real.X);
+
+				/* q and -q are the same rotation, the sign of the dot product moves onto the weight */
+				const VectorRegister Sign = VectorRegisterBitwiseAnd(VectorRegisterDot4(FirstReal, InfluenceReal), SignMask);
+				const VectorRegister Weight = VectorRegisterBitwiseXor(VectorRegisterReplicate(boneWeights[k]), Sign);
+
+				BlendReal = VectorRegisterMultiplyAdd(InfluenceReal, Weight, BlendReal);
+				BlendDual = VectorRegisterMultiplyAdd(MakeVectorRegister(&Influence.Dual.X), Weight, BlendDual);
+			}
+
+			DualQuat Result;
+			StoreVectorRegister(&Result.Real.X, BlendReal);
+			StoreVectorRegister(&Result.Dual.X, BlendDual);
+			return Result;
+		}
+
+		inline void DualQuat::BlendSkinning(const DualQuat* palette, const uint32* boneIndices, const float* boneWeights, DualQuat* outBlended, uint32 count)
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				outBlended[i] = BlendInfluences(palette, boneIndices + i * 4, boneWeights + i * 4);
+				outBlended[i].Normalize();
+			}
+		}
+
+		inline void DualQuat::SkinPoints(const DualQuat* palette, const uint32* boneIndices, const float* boneWeights, const Vector3D* inPoints, Vector3D* outPoints, uint32 count)
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				const DualQuat Blended = BlendInfluences(palette, boneIndices + i * 4, boneWeights + i * 4);
+
+				/* Dividing by |Real|^2 once replaces the normalization, the point is rotated and translated by the unnormalized quats */
+				const float InverseLengthSquared = 1.0f / Blended.Real.LengthSquared();
+				const Vector3D RealV(Blended.Real.X, Blended.Real.Y, Blended.Real.Z);
+				const Vector3D DualV(Blended.Dual.X, Blended.Dual.Y, Blended.Dual.Z);
+				const Vector3D Point = inPoints[i];
+
+				/* Conjugate rotation, p + 2 * w * t + 2 * Cross(v, t) with t = Cross(v, p) and v the negated vector part */
+				const Vector3D T = Vector3D::CrossProduct(RealV, Point);
+				const Vector3D Rotated = Point * Blended.Real.LengthSquared() - T * (2.0f * Blended.Real.W) + Vector3D::CrossProduct(RealV, T) * 2.0f;
+				const Vector3D Translation = (DualV * -Blended.Real.W + RealV * Blended.Dual.W + Vector3D::CrossProduct(RealV, DualV)) * 2.0f;
+
+				outPoints[i] = (Rotated + Translation) * InverseLengthSquared;
+			}
+		}
+	}
+}
@@ -1,6 +1,10 @@
 #pragma once
 #include "GenericDefines.h"
 #include "VrixicMath.h"
+#include "Vector3DStream.h"
+#include "VrixicMathKernels.h"
+
+#include <algorithm>
 
 struct Frustum
 {
@@ -11,6 +15,18 @@ struct Frustum
 
 	VM::Plane Planes[6];
 
+	/*
+	* Planes in structure of arrays form with the absolute normals precomputed, used by the batch culling kernels
+	* Rebuilt by CreateFrustum(), call UpdateCullingPlanes() after editing Planes by hand
+	*/
+	struct CullingPlaneData
+	{
+		float NormalX[6], NormalY[6], NormalZ[6];
+		float AbsNormalX[6], AbsNormalY[6], AbsNormalZ[6];
+		float Distance[6];
+	} CullingPlanes;
+	static_assert(sizeof(CullingPlaneData) == sizeof(float) * 42, "The AVX2 culling kernels read CullingPlanes as one float array");
+
 	/*
 	*  WidthMultiplier -> scales the width of the frustum
 	*/
@@ -34,11 +50,15 @@ private:
 public:
 	Frustum() : AspectRatio(0.0f), WidthMultiplier(0.0f), NearPlaneDist(0.0f), FarPlaneDist(0.0f),
 				FarPlaneHeight(0.0f), FarPlaneWidth(0.0f), NearPlaneHeight(0.0f), NearPlaneWidth(0.0f),
-				WidthMultiplierRecip(0.0f) { }
+				WidthMultiplierRecip(0.0f)
+	{
+		UpdateCullingPlanes();
+	}
 
 	Frustum(float aspectRatio, float widthMultiplier, float nearPlaneDist, float farPlaneDist)
 	{
 		SetFrustumInternals(aspectRatio, widthMultiplier, nearPlaneDist, farPlaneDist);
+		UpdateCullingPlanes();
 	}
 
 public:
@@ -119,6 +139,26 @@ public:
 		PlaneCenters[LEFT] = (NBL + NTL + FTL + FBL) * 0.25f;
 		PlaneCenters[RIGHT] = (NBR + NTR + FTR + FBR) * 0.25f;
 #endif
+
+		UpdateCullingPlanes();
+	}
+
+	/* Copies Planes into CullingPlanes */
+	void UpdateCullingPlanes()
+	{
+		for (uint32 i = 0; i < 6; ++i)
+		{
+			CullingPlanes.NormalX[i] = Planes[i].X;
+			CullingPlanes.NormalY[i] = Planes[i].Y;
+			CullingPlanes.NormalZ[i] = Planes[i].Z;
+
+			VM::Vector3D AbsNormal = Planes[i].AbsNormal();
+			CullingPlanes.AbsNormalX[i] = AbsNormal.X;
+			CullingPlanes.AbsNormalY[i] = AbsNormal.Y;
+			CullingPlanes.AbsNormalZ[i] = AbsNormal.Z;
+
+			CullingPlanes.Distance[i] = Planes[i].Distance;
+		}
 	}
 
 	PlaneIntersectionResult TestAABB(const VM::Vector3D& aabbMin, const VM::Vector3D& aabbMax)
@@ -135,6 +175,109 @@ public:
 		return PlaneIntersectionResult::Front;
 	}
 
+	/* 
+	* Batch culling, a box is given as center/extents, same as TestAABB()
+	* A box is visible unless it is fully behind at least one plane, every box is tested against all 6 planes without branching
+	*/
+
+	/* Tests 8 boxes, returns the visibility of box i in bit i */
+	uint32 TestAABBPacket(const VM::Vector3x8& centers, const VM::Vector3x8& extents) const
+	{
+		return SIMDKernels::TestAABBPacket(CullingPlanes.NormalX, centers.X, centers.Y, centers.Z, extents.X, extents.Y, extents.Z);
+	}
+
+	/* Single box version of TestAABBPacket(), uses the same precomputed planes */
+	bool IsAABBVisible(const VM::Vector3D& center, const VM::Vector3D& extents) const
+	{
+		bool Outside = false;
+		for (uint32 i = 0; i < 6; ++i)
+		{
+			float Distance = center.X * CullingPlanes.NormalX[i] + center.Y * CullingPlanes.NormalY[i] + center.Z * CullingPlanes.NormalZ[i] - CullingPlanes.Distance[i];
+			float Radius = extents.X * CullingPlanes.AbsNormalX[i] + extents.Y * CullingPlanes.AbsNormalY[i] + extents.Z * CullingPlanes.AbsNormalZ[i];
+			Outside |= (Distance + Radius) < 0.0f;
+		}
+
+		return !Outside;
+	}
+
+	/**
+	* Culls 'count' boxes into a bitmask
+	*
+	* @param outVisibilityMask - bit (i % 32) of word (i / 32) is set when box i is visible, has to hold (count + 31) / 32 words
+	*/
+	void CullAABBs(const VM::Vector3D* centers, const VM::Vector3D* extents, uint32 count, uint32* outVisibilityMask) const
+	{
+		std::fill_n(outVisibilityMask, (count + 31) / 32, 0u);
+
+		uint32 i = 0;
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+		if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+		{
+			i = SIMDKernelsAVX2::CullAABBs(CullingPlanes.NormalX, reinterpret_cast<const float*>(centers), reinterpret_cast<const float*>(extents), count, outVisibilityMask);
+		}
+		else
+#endif
+		{
+			i = SIMDKernels::CullAABBs(CullingPlanes.NormalX, reinterpret_cast<const float*>(centers), reinterpret_cast<const float*>(extents), count, outVisibilityMask);
+		}
+
+
+		for (; i < count; ++i)
+		{
+			outVisibilityMask[i >> 5] |= static_cast<uint32>(IsAABBVisible(centers[i], extents[i])) << (i & 31);
+		}
+	}
+
+	/* Same as above for boxes already in structure of arrays form, padding lanes never show up in the mask */
+	void CullAABBs(const VM::Vector3DStream& centers, const VM::Vector3DStream& extents, uint32* outVisibilityMask) const
+	{
+		const uint32 Count = centers.Size();
+		std::fill_n(outVisibilityMask, (Count + 31) / 32, 0u);
+
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+		if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+		{
+			SIMDKernelsAVX2::CullAABBsSoA(CullingPlanes.NormalX, centers.GetX(), centers.GetY(), centers.GetZ(),
+				extents.GetX(), extents.GetY(), extents.GetZ(), Count, outVisibilityMask);
+			return;
+		}
+#endif
+		SIMDKernels::CullAABBsSoA(CullingPlanes.NormalX, centers.GetX(), centers.GetY(), centers.GetZ(),
+			extents.GetX(), extents.GetY(), extents.GetZ(), Count, outVisibilityMask);
+	}
+
+	/**
+	* Culls 'count' boxes into a compacted list of visible box indices
+	*
+	* @param outVisibleIndices - has to hold 'count' indices
+	* @return uint32 number of visible boxes written to 'outVisibleIndices'
+	*/
+	uint32 CullAABBsToIndices(const VM::Vector3D* centers, const VM::Vector3D* extents, uint32 count, uint32* outVisibleIndices) const
+	{
+		uint32 VisibleCount = 0;
+
+		uint32 i = 0;
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+		if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+		{
+			i = SIMDKernelsAVX2::CullAABBsToIndices(CullingPlanes.NormalX, reinterpret_cast<const float*>(centers), reinterpret_cast<const float*>(extents), count, outVisibleIndices, VisibleCount);
+		}
+		else
+#endif
+		{
+			i = SIMDKernels::CullAABBsToIndices(CullingPlanes.NormalX, reinterpret_cast<const float*>(centers), reinterpret_cast<const float*>(extents), count, outVisibleIndices, VisibleCount);
+		}
+
+
+		for (; i < count; ++i)
+		{
+			outVisibleIndices[VisibleCount] = i;
+			VisibleCount += static_cast<uint32>(IsAABBVisible(centers[i], extents[i]));
+		}
+
+		return VisibleCount;
+	}
+
 private:
 	void RecalculateFustrumInternals()
 	{
@@ -10,7 +10,7 @@ typedef unsigned short		uint16;
 typedef unsigned int		uint32;
 
 /* unsigned int 64-bit */
-typedef unsigned long		uint64;
+typedef unsigned long long	uint64;
 
 /* signed int 8-bit */
 typedef signed char			int8;
@@ -22,5 +22,12 @@ typedef signed short		int16;
 typedef signed int			int32;
 
 /* signed int 64-bit */
-typedef signed long			int64;
+typedef signed long long	int64;
+
+/* keeps a rarely taken path out of its caller, so the caller's hot loop does not pay for the spills */
+#if defined(_MSC_VER)
+#define VRIXIC_NOINLINE __declspec(noinline)
+#else
+#define VRIXIC_NOINLINE __attribute__((noinline))
+#endif
 #pragma once
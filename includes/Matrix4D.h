@@ -1,16 +1,33 @@
 #pragma once
 
+#include "GenericDefines.h"
 #include "Vector3D.h"
 #include "Vector4D.h"
 #include "VrixicMathHelper.h"
-#include "VrixicMathDirectX.h"
+#include "VrixicMathSIMD.h"
+#include "VrixicMathKernels.h"
 
+#include <cstring>
 #include <iostream>
+#include <type_traits>
 
 namespace Vrixic
 {
 	namespace Math
 	{
+		/* Order Euler rotations are applied in, XYZ rotates around X first then Y then Z */
+		enum class EulerOrder : uint32
+		{
+			XYZ = 0,
+			XZY,
+			YXZ,
+			YZX,
+			ZXY,
+			ZYX
+		};
+
+		struct Quat;
+
 		struct Matrix4D
 		{
 		protected:
@@ -18,22 +35,22 @@ namespace Vrixic
 			alignas(16) float M[4][4];
 
 		public:
-			inline Matrix4D();
+			inline constexpr Matrix4D();
 
-			inline Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d);
+			inline constexpr Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d);
 
-			inline Matrix4D(float n00, float n01, float n02, float n03,
+			inline constexpr Matrix4D(float n00, float n01, float n02, float n03,
 				float n10, float n11, float n12, float n13,
 				float n20, float n21, float n22, float n23,
 				float n30, float n31, float n32, float n33);
 
 		public:
-			inline float& operator()(int i, int j)
+			inline constexpr float& operator()(int i, int j)
 			{
 				return (M[i][j]);
 			}
 
-			inline const float& operator()(int i, int j) const
+			inline constexpr const float& operator()(int i, int j) const
 			{
 				return (M[i][j]);
 			}
@@ -54,11 +71,29 @@ namespace Vrixic
 
 			inline Matrix4D operator*(const Matrix4D& otherM) const;
 
+		public:
+			/**
+			* Batched row vector transforms, the matrix is loaded once for the whole array
+			* The output may be the same array as the input but the two must not partially overlap
+			*/
+
+			/* Transforms points (w = 1), the resulting w is dropped so no perspective divide is done */
+			inline void TransformPoints(const Vector3D* inPoints, Vector3D* outPoints, uint32 count) const;
+
+			/* Transforms direction vectors (w = 0), translation is ignored */
+			inline void TransformVectors(const Vector3D* inVectors, Vector3D* outVectors, uint32 count) const;
+
+			/* Full 4x4 transform, arrays bigger than BatchStreamingThreshold are written with non-temporal stores */
+			inline void TransformHomogeneous(const Vector4D* inVectors, Vector4D* outVectors, uint32 count) const;
+
+			/* Element count above which TransformHomogeneous() bypasses the cache when writing, ~1MB of output */
+			static constexpr uint32 BatchStreamingThreshold = 1u << 16;
+
 		public:
 
-			inline static Matrix4D Identity();
+			inline constexpr static Matrix4D Identity();
 
-			inline static Matrix4D Transpose(const Matrix4D& mat);
+			inline constexpr static Matrix4D Transpose(const Matrix4D& mat);
 
 			/* Euler Angles Rotation Calculation */
 
@@ -73,6 +108,35 @@ namespace Vrixic
 			// Rotation over Z - axis, return matrix
 			inline static Matrix4D MakeRotZ(float angle);
 
+			/**
+			* Rotation from Euler angles in degrees, MakeRotation(angles, EulerOrder::XYZ) is the same matrix as
+			* MakeRotX(angles.X) * MakeRotY(angles.Y) * MakeRotZ(angles.Z)
+			* All sines and cosines come from one VectorRegisterSinCos() and the matrix is written directly, no dense products
+			*/
+			inline static Matrix4D MakeRotation(const Vector3D& eulerDegrees, EulerOrder order = EulerOrder::XYZ);
+
+			inline static Matrix4D MakeRotationXYZ(const Vector3D& eulerDegrees);
+
+			inline static Matrix4D MakeRotationXZY(const Vector3D& eulerDegrees);
+
+			inline static Matrix4D MakeRotationYXZ(const Vector3D& eulerDegrees);
+
+			inline static Matrix4D MakeRotationYZX(const Vector3D& eulerDegrees);
+
+			inline static Matrix4D MakeRotationZXY(const Vector3D& eulerDegrees);
+
+			inline static Matrix4D MakeRotationZYX(const Vector3D& eulerDegrees);
+
+			/* Rotation of 'degrees' around the unit length 'axis', MakeRotationAxisAngle(Vector3D(1, 0, 0), a) == MakeRotX(a) */
+			inline static Matrix4D MakeRotationAxisAngle(const Vector3D& axis, float degrees);
+
+			/**
+			* MakeRotation() for an array of Euler angles, the sines and cosines of 8 rotations are computed at once
+			*
+			* @param order - used for every rotation in the batch
+			*/
+			inline static void MakeRotationBatch(const Vector3D* eulerDegrees, Matrix4D* outMatrices, uint32 count, EulerOrder order = EulerOrder::XYZ);
+
 			/* Makes a LookAt Matrix that is not inversed, returns world space matrix  */
 			inline static Matrix4D LookAt(const Vector3D& eye, const Vector3D& target, const Vector3D& up);
 
@@ -91,9 +155,6 @@ namespace Vrixic
 			inline void ScaleMatrix(const Vector3D& scale);
 
 
-			/* DO NOT call this, need to be reworked....*/ // Makes a rotation from vector3
-			//inline static Matrix4D MakeRotation(const Vector3D& rotation);
-
 			inline float Determinant() const;
 
 			/* Inverse that only works for orthogonal matrices */
@@ -102,76 +163,78 @@ namespace Vrixic
 			/* An actual Matrix4D transformation inverse */
 			inline Matrix4D Inverse() const;
 
+			/* Same as Inverse(), also hands back the determinant so it does not have to be computed again */
+			inline Matrix4D Inverse(float& outDeterminant) const;
+
+			/**
+			* Inverts 'count' matrices, 8 at a time in SIMD registers
+			*
+			* @param outMatrices - can be the same array as 'inMatrices'
+			* @param outDeterminants - determinant of every input matrix, can be null
+			*/
+			inline static void InverseBatch(const Matrix4D* inMatrices, Matrix4D* outMatrices, uint32 count, float* outDeterminants = nullptr);
+
+			/**
+			* outMatrices[i] = left[i] * right[i] for 'count' pairs
+			*
+			* @param outMatrices - can be the same array as either input
+			*/
+			inline static void MultiplyBatch(const Matrix4D* left, const Matrix4D* right, Matrix4D* outMatrices, uint32 count);
+
 
 			inline Vector3D GetEulerAngles() const;
 
+			/**
+			* Length of each of the first three rows, which is the scale of a rotation * scale matrix
+			* The sign of a mirrored axis is lost, Transform::Decompose() keeps it
+			*/
 			inline Vector3D GetLocalScale() const;
 
 			/**
 			* Creates a quaternion from a rotational Matrix4D, same as Quat::MakeFromMatrix4D(const Matrix4D& inMat)
-			* Algorithm from: "https://www.gamedeveloper.com/programming/rotating-objects-using-quaternions"
 			* 
-			* This avoids redefinition of Matrix4D in Quat
-			* 
-			* return float* a pointer to float[4] which should be converted over to a Quat
+			* Defined in Quat.h, which includes this header
 			*/
-			inline float* ToQuat() const;
+			inline Quat ToQuat() const;
+
+		private:
+			/* Builds the Euler rotation from the sine and cosine of each axis angle, indexed X = 0, Y = 1, Z = 2 */
+			inline static Matrix4D MakeRotationFromSinCos(const float* sines, const float* cosines, EulerOrder order);
+
+			/* First * Second * Third, the last rotation is written out and the other two are applied to its rows in place */
+			template<int First, int Second, int Third>
+			inline static Matrix4D MakeRotationFromSinCos(const float* sines, const float* cosines);
+
+			/* Shared kernel for TransformPoints() and TransformVectors(), 'HasTranslation' is whether the implied w is 1 or 0 */
+			template<bool HasTranslation>
+			inline void TransformVector3DArray(const Vector3D* inVectors, Vector3D* outVectors, uint32 count) const;
 		};
 
-		inline Matrix4D::Matrix4D()
+		static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Batched transforms expect tightly packed Vector3D arrays");
+		static_assert(sizeof(Matrix4D) == 16 * sizeof(float), "InverseBatch() expects tightly packed Matrix4D arrays");
+		static_assert(std::is_trivially_copyable<Matrix4D>::value, "Matrix4D should stay trivially copyable");
+
+		inline constexpr Matrix4D::Matrix4D()
 			: Matrix4D(0.0f, 0.0f, 0.0f, 0.0f,
 				0.0f, 0.0f, 0.0f, 0.0f,
 				0.0f, 0.0f, 0.0f, 0.0f,
 				0.0f, 0.0f, 0.0f, 1.0f) {}
 
-		inline Matrix4D::Matrix4D(float n00, float n01, float n02, float n03,
+		/* Every element is set in the initializer list so the constructors can be used in constant expressions */
+		inline constexpr Matrix4D::Matrix4D(float n00, float n01, float n02, float n03,
 			float n10, float n11, float n12, float n13,
 			float n20, float n21, float n22, float n23,
 			float n30, float n31, float n32, float n33)
-		{
-			M[0][0] = n00;
-			M[0][1] = n01;
-			M[0][2] = n02;
-			M[0][3] = n03;
-
-			M[1][0] = n10;
-			M[1][1] = n11;
-			M[1][2] = n12;
-			M[1][3] = n13;
+			: M{ { n00, n01, n02, n03 },
+				{ n10, n11, n12, n13 },
+				{ n20, n21, n22, n23 },
+				{ n30, n31, n32, n33 } } {}
 
-			M[2][0] = n20;
-			M[2][1] = n21;
-			M[2][2] = n22;
-			M[2][3] = n23;
-
-			M[3][0] = n30;
-			M[3][1] = n31;
-			M[3][2] = n32;
-			M[3][3] = n33;
-		}
-
-		inline Matrix4D::Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d)
-		{
-			M[0][0] = a.X;
-			M[0][1] = a.Y;
-			M[0][2] = a.Z;
-			M[0][3] = a.W;
-
-			M[1][0] = b.X;
-			M[1][1] = b.Y;
-			M[1][2] = b.Z;
-			M[1][3] = b.W;
-
-			M[2][0] = c.X;
-			M[2][1] = c.Y;
-			M[2][2] = c.Z;
-			M[2][3] = c.W;
-
-			M[3][0] = d.X;
-			M[3][1] = d.Y;
-			M[3][2] = d.Z;
-			M[3][3] = d.W;
-		}
+		inline constexpr Matrix4D::Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d)
+			: M{ { a.X, a.Y, a.Z, a.W },
+				{ b.X, b.Y, b.Z, b.W },
+				{ c.X, c.Y, c.Z, c.W },
+				{ d.X, d.Y, d.Z, d.W } } {}
 
 		inline Vector4D Matrix4D::operator*(const Vector4D& v) const
 		{
@@ -183,12 +246,8 @@ namespace Vrixic
 				(v.X * M[0][3] + v.Y * M[1][3] + v.Z * M[2][3] + v.W * M[3][3])
 			);*/
 
-			VectorRegister VR = MakeVectorRegister(&v.X);
-			VR = TransformVectorByMatrix(VR, &this->M[0][0]);
-
-			Vector4D Result;
-			StoreVectorRegister(&Result.X, VR);
-			return Result;
+			/* Both operands are 16-byte aligned, so the vector and the rows are loaded straight into registers */
+			return Vector4D(TransformVectorByMatrix(v.ToVectorRegister(), &this->M[0][0]));
 		}
 
 		inline Matrix4D Matrix4D::operator*(const Matrix4D& otherM) const
@@ -221,7 +280,114 @@ namespace Vrixic
 			return Result;
 		}
 
-		inline Matrix4D Matrix4D::Identity()
+		inline void Matrix4D::TransformPoints(const Vector3D* inPoints, Vector3D* outPoints, uint32 count) const
+		{
+			TransformVector3DArray<true>(inPoints, outPoints, count);
+		}
+
+		inline void Matrix4D::TransformVectors(const Vector3D* inVectors, Vector3D* outVectors, uint32 count) const
+		{
+			TransformVector3DArray<false>(inVectors, outVectors, count);
+		}
+
+		template<bool HasTranslation>
+		inline void Matrix4D::TransformVector3DArray(const Vector3D* inVectors, Vector3D* outVectors, uint32 count) const
+		{
+			const float* In = reinterpret_cast<const float*>(inVectors);
+			float* Out = reinterpret_cast<float*>(outVectors);
+			uint32 i = 0;
+
+			/* Vectors are split into X/Y/Z registers so every lane is one vector, matrix entries are broadcast once */
+#if defined(VRIXIC_SIMD_AVX2)
+			i = SIMDKernels::TransformVector3DArray(&M[0][0], In, Out, count, HasTranslation);
+#elif defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				i = SIMDKernelsAVX2::TransformVector3DArray(&M[0][0], In, Out, count, HasTranslation);
+			}
+#endif
+			{
+				const VectorRegister M00 = VectorRegisterReplicate(M[0][0]), M01 = VectorRegisterReplicate(M[0][1]), M02 = VectorRegisterReplicate(M[0][2]);
+				const VectorRegister M10 = VectorRegisterReplicate(M[1][0]), M11 = VectorRegisterReplicate(M[1][1]), M12 = VectorRegisterReplicate(M[1][2]);
+				const VectorRegister M20 = VectorRegisterReplicate(M[2][0]), M21 = VectorRegisterReplicate(M[2][1]), M22 = VectorRegisterReplicate(M[2][2]);
+				const VectorRegister T0 = VectorRegisterReplicate(HasTranslation ? M[3][0] : 0.0f);
+				const VectorRegister T1 = VectorRegisterReplicate(HasTranslation ? M[3][1] : 0.0f);
+				const VectorRegister T2 = VectorRegisterReplicate(HasTranslation ? M[3][2] : 0.0f);
+
+				for (; i + 4 <= count; i += 4)
+				{
+					if (i + 16 < count)
+					{
+						VectorRegisterPrefetch(In + (i + 16) * 3);
+					}
+
+					VectorRegister X, Y, Z;
+					VectorRegisterDeinterleaveXYZ(In + i * 3, X, Y, Z);
+
+					VectorRegister RX = VectorRegisterMultiplyAdd(Z, M20, VectorRegisterMultiplyAdd(Y, M10, VectorRegisterMultiplyAdd(X, M00, T0)));
+					VectorRegister RY = VectorRegisterMultiplyAdd(Z, M21, VectorRegisterMultiplyAdd(Y, M11, VectorRegisterMultiplyAdd(X, M01, T1)));
+					VectorRegister RZ = VectorRegisterMultiplyAdd(Z, M22, VectorRegisterMultiplyAdd(Y, M12, VectorRegisterMultiplyAdd(X, M02, T2)));
+
+					VectorRegisterInterleaveXYZ(Out + i * 3, RX, RY, RZ);
+				}
+			}
+
+			/* Tail that does not fill a whole register */
+			for (; i < count; ++i)
+			{
+				const Vector3D V = inVectors[i];
+				const float W = HasTranslation ? 1.0f : 0.0f;
+
+				outVectors[i] = Vector3D(
+					V.X * M[0][0] + V.Y * M[1][0] + V.Z * M[2][0] + W * M[3][0],
+					V.X * M[0][1] + V.Y * M[1][1] + V.Z * M[2][1] + W * M[3][1],
+					V.X * M[0][2] + V.Y * M[1][2] + V.Z * M[2][2] + W * M[3][2]);
+			}
+		}
+
+		inline void Matrix4D::TransformHomogeneous(const Vector4D* inVectors, Vector4D* outVectors, uint32 count) const
+		{
+			const bool Stream = count > BatchStreamingThreshold;
+			uint32 i = 0;
+
+#if defined(VRIXIC_SIMD_AVX2)
+			i = SIMDKernels::TransformVector4DArray(&M[0][0], reinterpret_cast<const float*>(inVectors), reinterpret_cast<float*>(outVectors), count, Stream);
+#elif defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				i = SIMDKernelsAVX2::TransformVector4DArray(&M[0][0], reinterpret_cast<const float*>(inVectors), reinterpret_cast<float*>(outVectors), count, Stream);
+			}
+#endif
+			const VectorRegister Row0 = VectorRegisterLoadAligned(M[0]);
+			const VectorRegister Row1 = VectorRegisterLoadAligned(M[1]);
+			const VectorRegister Row2 = VectorRegisterLoadAligned(M[2]);
+			const VectorRegister Row3 = VectorRegisterLoadAligned(M[3]);
+
+			for (; i < count; ++i)
+			{
+				if (i + 8 < count)
+				{
+					VectorRegisterPrefetch(inVectors + i + 8);
+				}
+
+				VectorRegister R = VectorRegisterTransformByRows(inVectors[i].ToVectorRegister(), Row0, Row1, Row2, Row3);
+				if (Stream)
+				{
+					StreamVectorRegister(&outVectors[i].X, R);
+				}
+				else
+				{
+					StoreVectorRegisterAligned(&outVectors[i].X, R);
+				}
+			}
+
+			if (Stream)
+			{
+				VectorRegisterStreamFence();
+			}
+		}
+
+		inline constexpr Matrix4D Matrix4D::Identity()
 		{
 			return Matrix4D
 			(
@@ -232,7 +398,7 @@ namespace Vrixic
 			);
 		}
 
-		inline Matrix4D Matrix4D::Transpose(const Matrix4D& mat)
+		inline constexpr Matrix4D Matrix4D::Transpose(const Matrix4D& mat)
 		{
 			return Matrix4D(
 				mat(0, 0), mat(1, 0), mat(2, 0), mat(3, 0),
@@ -245,8 +411,8 @@ namespace Vrixic
 		inline Matrix4D Matrix4D::MakeRotX(float degrees)
 		{
 			float Rads = MathUtils::DegreesToRadians(degrees);
-			float C = cos(Rads);
-			float S = sin(Rads);
+			float S, C;
+			MathUtils::SinCos(Rads, S, C);
 
 			return Matrix4D
 			(
@@ -260,8 +426,8 @@ namespace Vrixic
 		inline Matrix4D Matrix4D::MakeRotY(float degrees)
 		{
 			float Rads = MathUtils::DegreesToRadians(degrees);
-			float C = cos(Rads);
-			float S = sin(Rads);
+			float S, C;
+			MathUtils::SinCos(Rads, S, C);
 
 			return Matrix4D
 			(
@@ -275,8 +441,8 @@ namespace Vrixic
 		inline Matrix4D Matrix4D::MakeRotZ(float degrees)
 		{
 			float Rads = MathUtils::DegreesToRadians(degrees);
-			float C = cos(Rads);
-			float S = sin(Rads);
+			float S, C;
+			MathUtils::SinCos(Rads, S, C);
 
 			return Matrix4D
 			(
@@ -288,18 +454,173 @@ namespace Vrixic
 		}
 
 		/* X -> pitch, Y -> yaw, Z -> roll*/
-		//inline Matrix4D Matrix4D::MakeRotation(const Vector3D& rotation)
-		//{
-		//	Matrix4D RotX = MakeRotX(rotation.X);
-		//	Matrix4D RotY = MakeRotY(rotation.Y);
-		//	Matrix4D RotZ = MakeRotZ(rotation.Z);
-		//	Matrix4D Result;
-		//
-		//	VectorRegisterMatrixMultiply(&Result, &RotX, &RotY);
-		//	VectorRegisterMatrixMultiply(&Result, &Result, &RotZ);
-		//
-		//	return Result;
-		//}
+		inline Matrix4D Matrix4D::MakeRotation(const Vector3D& eulerDegrees, EulerOrder order)
+		{
+			VectorRegister Sin, Cos;
+			VectorRegisterSinCos(VectorRegisterMultiply(MakeVectorRegister(eulerDegrees.X, eulerDegrees.Y, eulerDegrees.Z, 0.0f),
+				VectorRegisterReplicate(DEGTORADS)), Sin, Cos);
+
+			alignas(16) float Sines[4];
+			alignas(16) float Cosines[4];
+			StoreVectorRegisterAligned(Sines, Sin);
+			StoreVectorRegisterAligned(Cosines, Cos);
+
+			return MakeRotationFromSinCos(Sines, Cosines, order);
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationXYZ(const Vector3D& eulerDegrees)
+		{
+			return MakeRotation(eulerDegrees, EulerOrder::XYZ);
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationXZY(const Vector3D& eulerDegrees)
+		{
+			return MakeRotation(eulerDegrees, EulerOrder::XZY);
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationYXZ(const Vector3D& eulerDegrees)
+		{
+			return MakeRotation(eulerDegrees, EulerOrder::YXZ);
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationYZX(const Vector3D& eulerDegrees)
+		{
+			return MakeRotation(eulerDegrees, EulerOrder::YZX);
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationZXY(const Vector3D& eulerDegrees)
+		{
+			return MakeRotation(eulerDegrees, EulerOrder::ZXY);
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationZYX(const Vector3D& eulerDegrees)
+		{
+			return MakeRotation(eulerDegrees, EulerOrder::ZYX);
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationAxisAngle(const Vector3D& axis, float degrees)
+		{
+			VectorRegister Sin, Cos;
+			VectorRegisterSinCos(VectorRegisterReplicate(MathUtils::DegreesToRadians(degrees)), Sin, Cos);
+
+			float S = VectorRegisterGetX(Sin);
+			float C = VectorRegisterGetX(Cos);
+			float T = 1.0f - C;
+
+			/* Transposed Rodrigues formula since the matrix is applied to row vectors */
+			float TXY = T * axis.X * axis.Y;
+			float TXZ = T * axis.X * axis.Z;
+			float TYZ = T * axis.Y * axis.Z;
+
+			return Matrix4D
+			(
+				T * axis.X * axis.X + C, TXY + S * axis.Z, TXZ - S * axis.Y, 0.0f,
+				TXY - S * axis.Z, T * axis.Y * axis.Y + C, TYZ + S * axis.X, 0.0f,
+				TXZ + S * axis.Y, TYZ - S * axis.X, T * axis.Z * axis.Z + C, 0.0f,
+				0.0f, 0.0f, 0.0f, 1.0f
+			);
+		}
+
+		inline void Matrix4D::MakeRotationBatch(const Vector3D* eulerDegrees, Matrix4D* outMatrices, uint32 count, EulerOrder order)
+		{
+			const VectorRegister8 DegreesToRadians = VectorRegister8Replicate(DEGTORADS);
+
+			for (uint32 i = 0; i < count; i += 8)
+			{
+				const uint32 Count = (count - i) < 8 ? (count - i) : 8;
+
+				/* The last partial group is padded with zero angles so it goes through the same 8 wide path */
+				float Padded[24] = { };
+				const float* In = reinterpret_cast<const float*>(eulerDegrees + i);
+				if (Count < 8)
+				{
+					std::memcpy(Padded, In, Count * sizeof(Vector3D));
+					In = Padded;
+				}
+
+				VectorRegister8 X, Y, Z;
+				VectorRegister8DeinterleaveXYZ(In, X, Y, Z);
+
+				VectorRegister8 SinX, CosX, SinY, CosY, SinZ, CosZ;
+				VectorRegister8SinCos(VectorRegister8Multiply(X, DegreesToRadians), SinX, CosX);
+				VectorRegister8SinCos(VectorRegister8Multiply(Y, DegreesToRadians), SinY, CosY);
+				VectorRegister8SinCos(VectorRegister8Multiply(Z, DegreesToRadians), SinZ, CosZ);
+
+				alignas(32) float Sines[3][8];
+				alignas(32) float Cosines[3][8];
+				StoreVectorRegister8Aligned(Sines[0], SinX);
+				StoreVectorRegister8Aligned(Sines[1], SinY);
+				StoreVectorRegister8Aligned(Sines[2], SinZ);
+				StoreVectorRegister8Aligned(Cosines[0], CosX);
+				StoreVectorRegister8Aligned(Cosines[1], CosY);
+				StoreVectorRegister8Aligned(Cosines[2], CosZ);
+
+				for (uint32 j = 0; j < Count; ++j)
+				{
+					const float S[3] = { Sines[0][j], Sines[1][j], Sines[2][j] };
+					const float C[3] = { Cosines[0][j], Cosines[1][j], Cosines[2][j] };
+					outMatrices[i + j] = MakeRotationFromSinCos(S, C, order);
+				}
+			}
+		}
+
+		inline Matrix4D Matrix4D::MakeRotationFromSinCos(const float* sines, const float* cosines, EulerOrder order)
+		{
+			switch (order)
+			{
+			case EulerOrder::XZY:
+				return MakeRotationFromSinCos<0, 2, 1>(sines, cosines);
+			case EulerOrder::YXZ:
+				return MakeRotationFromSinCos<1, 0, 2>(sines, cosines);
+			case EulerOrder::YZX:
+				return MakeRotationFromSinCos<1, 2, 0>(sines, cosines);
+			case EulerOrder::ZXY:
+				return MakeRotationFromSinCos<2, 0, 1>(sines, cosines);
+			case EulerOrder::ZYX:
+				return MakeRotationFromSinCos<2, 1, 0>(sines, cosines);
+			default:
+				return MakeRotationFromSinCos<0, 1, 2>(sines, cosines);
+			}
+		}
+
+		template<int First, int Second, int Third>
+		inline Matrix4D Matrix4D::MakeRotationFromSinCos(const float* sines, const float* cosines)
+		{
+			/**
+			* Rotation around axis A lives in the (A + 1, A + 2) plane, see VectorRegisterMatrixRotateRows()
+			* The rows stay in registers the whole time, writing them out between steps would stall on store forwarding
+			*/
+			constexpr int I3 = (Third + 1) % 3, J3 = (Third + 2) % 3;
+			constexpr int I2 = (Second + 1) % 3, J2 = (Second + 2) % 3;
+			constexpr int I1 = (First + 1) % 3, J1 = (First + 2) % 3;
+
+			const float S = sines[Third];
+			const float C = cosines[Third];
+
+			VectorRegister Rows[3];
+			Rows[Third] = MakeVectorRegister(Third == 0 ? 1.0f : 0.0f, Third == 1 ? 1.0f : 0.0f, Third == 2 ? 1.0f : 0.0f, 0.0f);
+			Rows[I3] = MakeVectorRegister(I3 == 0 ? C : (J3 == 0 ? S : 0.0f), I3 == 1 ? C : (J3 == 1 ? S : 0.0f), I3 == 2 ? C : (J3 == 2 ? S : 0.0f), 0.0f);
+			Rows[J3] = MakeVectorRegister(I3 == 0 ? -S : (J3 == 0 ? C : 0.0f), I3 == 1 ? -S : (J3 == 1 ? C : 0.0f), I3 == 2 ? -S : (J3 == 2 ? C : 0.0f), 0.0f);
+
+			VectorRegister Sin = VectorRegisterReplicate(sines[Second]);
+			VectorRegister Cos = VectorRegisterReplicate(cosines[Second]);
+			VectorRegister RowI = VectorRegisterMultiplyAdd(Rows[J2], Sin, VectorRegisterMultiply(Rows[I2], Cos));
+			Rows[J2] = VectorRegisterSubtract(VectorRegisterMultiply(Rows[J2], Cos), VectorRegisterMultiply(Rows[I2], Sin));
+			Rows[I2] = RowI;
+
+			Sin = VectorRegisterReplicate(sines[First]);
+			Cos = VectorRegisterReplicate(cosines[First]);
+			RowI = VectorRegisterMultiplyAdd(Rows[J1], Sin, VectorRegisterMultiply(Rows[I1], Cos));
+			Rows[J1] = VectorRegisterSubtract(VectorRegisterMultiply(Rows[J1], Cos), VectorRegisterMultiply(Rows[I1], Sin));
+			Rows[I1] = RowI;
+
+			Matrix4D Result;
+			StoreVectorRegisterAligned(Result.M[0], Rows[0]);
+			StoreVectorRegisterAligned(Result.M[1], Rows[1]);
+			StoreVectorRegisterAligned(Result.M[2], Rows[2]);
+			StoreVectorRegisterAligned(Result.M[3], MakeVectorRegister(0.0f, 0.0f, 0.0f, 1.0f));
+			return Result;
+		}
 
 		inline Matrix4D Matrix4D::LookAt(const Vector3D& eye, const Vector3D& target, const Vector3D& up)
 		{
@@ -342,9 +663,17 @@ namespace Vrixic
 			/* DotX -> the dot of ToTarget to the up vector */
 			float DotX = Vector3D::DotProduct(ToTarget, mat[1].ToVector3D());
 
-			Matrix4D RotX = Matrix4D::MakeRotX(MathUtils::RadiansToDegrees(-DotX) * deltaTime * speed);
-			Matrix4D RotY = Matrix4D::MakeRotY(MathUtils::RadiansToDegrees(DotY) * deltaTime * speed);
-			Matrix4D Result = RotY * RotX * mat;
+			float RadsX = -DotX * deltaTime * speed;
+			float RadsY = DotY * deltaTime * speed;
+
+			/* RotY * RotX * mat, each rotation only mixes two rows so they are applied in place instead of two dense products */
+			float SinX, CosX, SinY, CosY;
+			MathUtils::SinCos(RadsX, SinX, CosX);
+			MathUtils::SinCos(RadsY, SinY, CosY);
+
+			Matrix4D Result = mat;
+			VectorRegisterMatrixRotateRows<1, 2>(&Result.M[0][0], SinX, CosX);
+			VectorRegisterMatrixRotateRows<2, 0>(&Result.M[0][0], SinY, CosY);
 
 			return OrthoNormalizeMatrix(Result);
 
@@ -445,127 +774,84 @@ namespace Vrixic
 
 		inline Matrix4D Matrix4D::Inverse() const
 		{
-			/* Non-Minor matrix calculations */
-			float X0 = M[0][0] * M[1][1] - M[0][1] * M[1][0];
-			float X1 = M[0][0] * M[1][2] - M[0][2] * M[1][0];
-			float X2 = M[0][0] * M[1][3] - M[0][3] * M[1][0];
-
-			float X3 = M[0][1] * M[1][2] - M[0][2] * M[1][1];
-			float X4 = M[0][1] * M[1][3] - M[0][3] * M[1][1];
-
-			float X5 = M[0][2] * M[1][3] - M[0][3] * M[1][2];
+			float Det;
+			return Inverse(Det);
+		}
 
-			/* Minor matrix calculations */
-			float M0 = M[2][2] * M[3][3] - M[2][3] * M[3][2];
+		inline Matrix4D Matrix4D::Inverse(float& outDeterminant) const
+		{
+			Matrix4D Result;
+			outDeterminant = VectorRegisterMatrixInverse(&Result.M[0][0], &M[0][0]);
 
-			float M1 = M[2][1] * M[3][3] - M[2][3] * M[3][1];
-			float M2 = M[2][1] * M[3][2] - M[2][2] * M[3][1];
+			if (outDeterminant == 0.0f)
+			{
+				return *this; // Matrix4D::Identity();
+			}
 
-			float M3 = M[2][0] * M[3][3] - M[2][3] * M[3][0];
-			float M4 = M[2][0] * M[3][2] - M[2][2] * M[3][0];
-			float M5 = M[2][0] * M[3][1] - M[2][1] * M[3][0];
+			return Result;
+		}
 
-			float Det = ((X0 * M0) - (X1 * M1) + (X2 * M2) + (X3 * M3) - (X4 * M4) + (X5 * M5));
+		inline void Matrix4D::InverseBatch(const Matrix4D* inMatrices, Matrix4D* outMatrices, uint32 count, float* outDeterminants)
+		{
+			const float* In = reinterpret_cast<const float*>(inMatrices);
+			float* Out = reinterpret_cast<float*>(outMatrices);
+			uint32 i = 0;
 
-			if (Det == 0.0f)
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
 			{
-				return *this; // Matrix4D::Identity();
+				i = SIMDKernelsAVX2::InverseMatrices(In, Out, outDeterminants, count);
+			}
+			else
+#endif
+			{
+				i = SIMDKernels::InverseMatrices(In, Out, outDeterminants, count);
 			}
 
-			float RDet = (1.0f / Det);
-
-			Matrix4D Result;
-			Result(0, 0) = RDet * (M[1][1] * M0 - M[1][2] * M1 + M[1][3] * M2);
-			Result(0, 1) = RDet * (-M[0][1] * M0 + M[0][2] * M1 - M[0][3] * M2);
-			Result(0, 2) = RDet * (M[3][3] * X3 + M[3][1] * X5 - M[3][2] * X4);
-			Result(0, 3) = RDet * (M[2][3] * X3 - M[2][1] * X5 + M[2][2] * X4);
-
-			Result(1, 0) = RDet * (-M[1][0] * M0 + M[1][2] * M3 - M[1][3] * M4);
-			Result(1, 1) = RDet * (M[0][0] * M0 - M[0][2] * M3 + M[0][3] * M4);
-			Result(1, 2) = RDet * (-M[3][3] * X1 - M[3][0] * X5 + M[3][2] * X2);
-			Result(1, 3) = RDet * (M[2][3] * X1 + M[2][0] * X5 - M[2][2] * X2);
-
-			Result(2, 0) = RDet * (M[1][0] * M1 - M[1][1] * M3 + M[1][3] * M5);
-			Result(2, 1) = RDet * (-M[0][0] * M1 + M[0][1] * M3 - M[0][3] * M5);
-			Result(2, 2) = RDet * (M[3][3] * X0 + M[3][0] * X4 - M[3][1] * X2);
-			Result(2, 3) = RDet * (-M[2][3] * X0 - M[2][0] * X4 + M[2][1] * X2);
-
-			Result(3, 0) = RDet * (-M[1][0] * M2 + M[1][1] * M4 - M[1][2] * M5);
-			Result(3, 1) = RDet * (M[0][0] * M2 - M[0][1] * M4 + M[0][2] * M5);
-			Result(3, 2) = RDet * (-M[3][2] * X0 - M[3][0] * X3 + M[3][1] * X1);
-			Result(3, 3) = RDet * (M[2][2] * X0 + M[2][0] * X3 - M[2][1] * X1);
+			for (; i < count; ++i)
+			{
+				float Det;
+				outMatrices[i] = inMatrices[i].Inverse(Det);
+				if (outDeterminants != nullptr)
+				{
+					outDeterminants[i] = Det;
+				}
+			}
+		}
 
-			return Result;
+		inline void Matrix4D::MultiplyBatch(const Matrix4D* left, const Matrix4D* right, Matrix4D* outMatrices, uint32 count)
+		{
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				SIMDKernelsAVX2::MultiplyMatrices(reinterpret_cast<const float*>(left), reinterpret_cast<const float*>(right), reinterpret_cast<float*>(outMatrices), count);
+				return;
+			}
+#endif
+			SIMDKernels::MultiplyMatrices(reinterpret_cast<const float*>(left), reinterpret_cast<const float*>(right), reinterpret_cast<float*>(outMatrices), count);
 		}
 
 		/* Converts matrix rotations into euler angles */
 		inline Vector3D Matrix4D::GetEulerAngles() const
 		{
-			Vector3D Result;
-
-			Result.X = atan2(M[2][1], M[2][2]);
-
 			float r32 = M[2][1] * M[2][1];
 			float r33 = M[2][2] * M[2][2];
 
-			Result.Y = atan2(-M[2][0], sqrt(r32 + r33));
-			Result.Z = atan2(M[1][0], M[0][0]);
+			/* The three atan2 run in one register */
+			alignas(16) float Angles[4];
+			StoreVectorRegisterAligned(Angles, VectorRegisterAtan2(MakeVectorRegister(M[2][1], -M[2][0], M[1][0], 0.0f),
+				MakeVectorRegister(M[2][2], sqrtf(r32 + r33), M[0][0], 1.0f)));
 
-			return Result;
+			return Vector3D(Angles[0], Angles[1], Angles[2]);
 		}
 
 		inline Vector3D Matrix4D::GetLocalScale() const
 		{
-			return Vector3D(M[0][0], M[1][1], M[2][2]);
+			return Vector3D(sqrtf(M[0][0] * M[0][0] + M[0][1] * M[0][1] + M[0][2] * M[0][2]),
+				sqrtf(M[1][0] * M[1][0] + M[1][1] * M[1][1] + M[1][2] * M[1][2]),
+				sqrtf(M[2][0] * M[2][0] + M[2][1] * M[2][1] + M[2][2] * M[2][2]));
 		}
 
-		inline float* Matrix4D::ToQuat() const
-		{
-			float Result[4];
-
-			float Trace = M[0][0] + M[1][1] + M[2][2];
-
-			// Check the diagonal
-			if (Trace > 0.0f)
-			{
-				float S = sqrtf(Trace + 1.0f);
-				float T = 0.5f / S;
-
-				Result[0] = (M[2][1] - M[1][2]) * T;
-				Result[1] = (M[0][2] - M[2][0]) * T;
-				Result[2] = (M[1][0] - M[0][1]) * T;
-				Result[3] = S * 0.5f;
-			}
-			else
-			{
-				// Diagonal is negative
-				int I = 0;
-				if (M[1][1] > M[0][0]) I = 1;
-				if (M[2][2] > M[I][I]) I = 2;
-
-				static const int NEXT[3] = { 1, 2, 0 };
-				int J = NEXT[I];
-				int K = NEXT[J];
-
-				float S = sqrt((M[I][J] - (M[J][J] + M[K][K]))
-					+ 1.0f);
-				Result[I] = S * 0.5f;
-				float T;
-				if (S != 0.0)
-				{
-					T = 0.5f / S;
-				}
-				else
-				{
-					T = S;
-				}
-
-				Result[3] = (M[K][J] - M[J][K]) * T;
-				Result[J] = (M[J][I] + M[I][J]) * T;
-				Result[K] = (M[K][I] + M[I][K]) * T;
-			}
-
-			return Result;
-		}
+		static_assert(Matrix4D::Identity()(0, 0) == 1.0f && Matrix4D::Identity()(3, 0) == 0.0f, "Matrix4D::Identity() should be usable in constant expressions");
 	}
 }
\ No newline at end of file
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "GenericDefines.h"
+#include "Matrix4D.h"
+#include "Vector3D.h"
+#include "VrixicMathHelper.h"
+#include "VrixicMathSIMD.h"
+
+#include <cmath>
+#include <type_traits>
+
+/**
+* Lazy products of structured matrices
+*
+* The factors below are the same matrices as Matrix4D::MakeRotX/Y/Z, a translation and a scale, but only keep the few
+* numbers that define them. Multiplying factors together does not compute anything, it builds a MatrixProduct that is
+* evaluated when it is converted to a Matrix4D or multiplied with one. Every factor is then applied in place with a
+* structured product (see VectorRegisterMatrixRotateRows() and friends) instead of a dense 4x4 product
+*
+*	Matrix4D World = RotationYFactor(Yaw) * RotationXFactor(Pitch) * Local;	// two row rotations, no dense product
+*	Matrix4D Rotation = RotationXFactor(X) * RotationYFactor(Y) * RotationZFactor(Z);
+*
+* Products keep their factors by value, so holding one in an 'auto' variable is safe
+*/
+namespace Vrixic
+{
+	namespace Math
+	{
+		/**
+		* Rotation about one axis, Axis 0 = X, 1 = Y, 2 = Z
+		* The rotation lives in the (I, J) plane where I = Axis + 1 and J = Axis + 2 (mod 3)
+		*/
+		template<int Axis>
+		struct AxisRotationFactor
+		{
+		public:
+			static constexpr int I = (Axis + 1) % 3;
+			static constexpr int J = (Axis + 2) % 3;
+
+			float Sin;
+			float Cos;
+
+		public:
+			inline explicit AxisRotationFactor(float degrees);
+
+			/* matrix = this * matrix */
+			inline void ApplyLeft(Matrix4D& matrix) const;
+
+			/* matrix = matrix * this */
+			inline void ApplyRight(Matrix4D& matrix) const;
+
+			inline Matrix4D ToMatrix4D() const;
+		};
+
+		typedef AxisRotationFactor<0> RotationXFactor;
+		typedef AxisRotationFactor<1> RotationYFactor;
+		typedef AxisRotationFactor<2> RotationZFactor;
+
+		/* Same matrix as TranslationMatrix4D */
+		struct TranslationFactor
+		{
+		public:
+			Vector3D Translation;
+
+		public:
+			inline explicit TranslationFactor(const Vector3D& translation)
+				: Translation(translation) { }
+
+			inline void ApplyLeft(Matrix4D& matrix) const;
+
+			inline void ApplyRight(Matrix4D& matrix) const;
+
+			inline Matrix4D ToMatrix4D() const;
+		};
+
+		/* Diagonal (X, Y, Z, 1) matrix */
+		struct ScaleFactor
+		{
+		public:
+			Vector3D Scale;
+
+		public:
+			inline explicit ScaleFactor(const Vector3D& scale)
+				: Scale(scale) { }
+
+			inline void ApplyLeft(Matrix4D& matrix) const;
+
+			inline void ApplyRight(Matrix4D& matrix) const;
+
+			inline Matrix4D ToMatrix4D() const;
+		};
+
+		/* Unevaluated Left * Right, either side can be another MatrixProduct */
+		template<typename Left, typename Right>
+		struct MatrixProduct
+		{
+		public:
+			Left LeftFactor;
+			Right RightFactor;
+
+		public:
+			inline MatrixProduct(const Left& left, const Right& right)
+				: LeftFactor(left), RightFactor(right) { }
+
+			/* matrix = Left * Right * matrix, the right most factor is applied first */
+			inline void ApplyLeft(Matrix4D& matrix) const
+			{
+				RightFactor.ApplyLeft(matrix);
+				LeftFactor.ApplyLeft(matrix);
+			}
+
+			/* matrix = matrix * Left * Right */
+			inline void ApplyRight(Matrix4D& matrix) const
+			{
+				LeftFactor.ApplyRight(matrix);
+				RightFactor.ApplyRight(matrix);
+			}
+
+			/* The right most factor is built directly, the rest are applied onto it */
+			inline Matrix4D ToMatrix4D() const
+			{
+				Matrix4D Result = RightFactor.ToMatrix4D();
+				LeftFactor.ApplyLeft(Result);
+				return Result;
+			}
+
+			inline operator Matrix4D() const
+			{
+				return ToMatrix4D();
+			}
+		};
+
+		/* Marks the types the chain operators below accept */
+		template<typename T>
+		struct IsMatrixFactor : std::false_type { };
+
+		template<int Axis>
+		struct IsMatrixFactor<AxisRotationFactor<Axis>> : std::true_type { };
+
+		template<>
+		struct IsMatrixFactor<TranslationFactor> : std::true_type { };
+
+		template<>
+		struct IsMatrixFactor<ScaleFactor> : std::true_type { };
+
+		template<typename Left, typename Right>
+		struct IsMatrixFactor<MatrixProduct<Left, Right>> : std::true_type { };
+
+		/* factor * factor, nothing is computed until the product meets a Matrix4D */
+		template<typename Left, typename Right,
+			typename = typename std::enable_if<IsMatrixFactor<Left>::value && IsMatrixFactor<Right>::value>::type>
+		inline MatrixProduct<Left, Right> operator*(const Left& left, const Right& right)
+		{
+			return MatrixProduct<Left, Right>(left, right);
+		}
+
+		/* factor * matrix */
+		template<typename Left, typename = typename std::enable_if<IsMatrixFactor<Left>::value>::type>
+		inline Matrix4D operator*(const Left& left, const Matrix4D& right)
+		{
+			Matrix4D Result = right;
+			left.ApplyLeft(Result);
+			return Result;
+		}
+
+		/* matrix * factor */
+		template<typename Right, typename = typename std::enable_if<IsMatrixFactor<Right>::value>::type>
+		inline Matrix4D operator*(const Matrix4D& left, const Right& right)
+		{
+			Matrix4D Result = left;
+			right.ApplyRight(Result);
+			return Result;
+		}
+
+		template<int Axis>
+		inline AxisRotationFactor<Axis>::AxisRotationFactor(float degrees)
+		{
+			float Rads = MathUtils::DegreesToRadians(degrees);
+			MathUtils::SinCos(Rads, Sin, Cos);
+		}
+
+		template<int Axis>
+		inline void AxisRotationFactor<Axis>::ApplyLeft(Matrix4D& matrix) const
+		{
+			VectorRegisterMatrixRotateRows<I, J>(&matrix(0, 0), Sin, Cos);
+		}
+
+		template<int Axis>
+		inline void AxisRotationFactor<Axis>::ApplyRight(Matrix4D& matrix) const
+		{
+			VectorRegisterMatrixRotateColumns<I, J>(&matrix(0, 0), Sin, Cos);
+		}
+
+		template<int Axis>
+		inline Matrix4D AxisRotationFactor<Axis>::ToMatrix4D() const
+		{
+			Matrix4D Result = Matrix4D::Identity();
+			Result(I, I) = Cos;
+			Result(I, J) = Sin;
+			Result(J, I) = -Sin;
+			Result(J, J) = Cos;
+			return Result;
+		}
+
+		inline void TranslationFactor::ApplyLeft(Matrix4D& matrix) const
+		{
+			VectorRegisterMatrixTranslateRows(&matrix(0, 0), Translation.X, Translation.Y, Translation.Z);
+		}
+
+		inline void TranslationFactor::ApplyRight(Matrix4D& matrix) const
+		{
+			VectorRegisterMatrixTranslateColumns(&matrix(0, 0), Translation.X, Translation.Y, Translation.Z);
+		}
+
+		inline Matrix4D TranslationFactor::ToMatrix4D() const
+		{
+			Matrix4D Result = Matrix4D::Identity();
+			Result.SetTranslation(Translation);
+			return Result;
+		}
+
+		inline void ScaleFactor::ApplyLeft(Matrix4D& matrix) const
+		{
+			VectorRegisterMatrixScaleRows(&matrix(0, 0), Scale.X, Scale.Y, Scale.Z);
+		}
+
+		inline void ScaleFactor::ApplyRight(Matrix4D& matrix) const
+		{
+			VectorRegisterMatrixScaleColumns(&matrix(0, 0), Scale.X, Scale.Y, Scale.Z);
+		}
+
+		inline Matrix4D ScaleFactor::ToMatrix4D() const
+		{
+			return Matrix4D
+			(
+				Scale.X, 0.0f, 0.0f, 0.0f,
+				0.0f, Scale.Y, 0.0f, 0.0f,
+				0.0f, 0.0f, Scale.Z, 0.0f,
+				0.0f, 0.0f, 0.0f, 1.0f
+			);
+		}
+	}
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include "GenericDefines.h"
+#include "Vector3D.h"
+#include "VrixicMathSIMD.h"
+
+#include <cstring>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace Vrixic
+{
+	namespace Math
+	{
+		/* 30 bit codes use 10 bits per axis (1024 cells), 63 bit codes 21 bits per axis */
+		enum class MortonPrecision : uint32
+		{
+			Bits30,
+			Bits63
+		};
+
+		/**
+		* Z-order curve codes, points close in space get codes close in value. X takes the highest bit of every
+		* interleaved triple, then Y, then Z
+		*/
+		struct MortonCode
+		{
+		public:
+			/* Each coordinate must be below 1024 */
+			inline static uint32 Encode30(uint32 x, uint32 y, uint32 z);
+
+			/* Each coordinate must be below 2^21 */
+			inline static uint64 Encode63(uint32 x, uint32 y, uint32 z);
+
+			/**
+			* Quantizes 'count' points onto a 1024^3 grid spanning [boundsMin, boundsMax] and encodes them, 4 points
+			* at a time. Points outside the bounds are clamped to the border cells
+			*/
+			inline static void Encode(const Vector3D* points, uint32 count, const Vector3D& boundsMin, const Vector3D& boundsMax, uint32* outCodes);
+
+			/* Same as above on a 2^21 grid per axis */
+			inline static void Encode(const Vector3D* points, uint32 count, const Vector3D& boundsMin, const Vector3D& boundsMax, uint64* outCodes);
+
+			/* 32 when 'v' is 0 */
+			inline static uint32 CountLeadingZeros(uint32 v);
+
+			/* 64 when 'v' is 0 */
+			inline static uint32 CountLeadingZeros(uint64 v);
+
+		private:
+			/* Inserts two zero bits above each of the low 10 bits */
+			inline static uint32 Expand10(uint32 v);
+
+			/* Inserts two zero bits above each of the low 21 bits */
+			inline static uint64 Expand21(uint64 v);
+
+			template<typename CodeType>
+			inline static CodeType EncodeCell(uint32 x, uint32 y, uint32 z);
+
+			template<typename CodeType>
+			inline static void EncodeBatch(const Vector3D* points, uint32 count, const Vector3D& boundsMin, const Vector3D& boundsMax,
+				float cellCount, CodeType* outCodes);
+		};
+
+		inline uint32 MortonCode::Encode30(uint32 x, uint32 y, uint32 z)
+		{
+			return (Expand10(x) << 2) | (Expand10(y) << 1) | Expand10(z);
+		}
+
+		inline uint64 MortonCode::Encode63(uint32 x, uint32 y, uint32 z)
+		{
+			return (Expand21(x) << 2) | (Expand21(y) << 1) | Expand21(z);
+		}
+
+		inline uint32 MortonCode::CountLeadingZeros(uint32 v)
+		{
+#if defined(_MSC_VER)
+			unsigned long Index;
+			return _BitScanReverse(&Index, v) ? 31u - static_cast<uint32>(Index) : 32u;
+#else
+			return v == 0 ? 32u : static_cast<uint32>(__builtin_clz(v));
+#endif
+		}
+
+		inline uint32 MortonCode::CountLeadingZeros(uint64 v)
+		{
+			/* Two 32 bit scans so 32 bit targets do not need a 64 bit intrinsic */
+			const uint32 High = static_cast<uint32>(v >> 32);
+			return High != 0 ? CountLeadingZeros(High) : 32u + CountLeadingZeros(static_cast<uint32>(v));
+		}
+
+		inline uint32 MortonCode::Expand10(uint32 v)
+		{
+			v &= 0x000003FFu;
+			v = (v | (v << 16)) & 0x030000FFu;
+			v = (v | (v << 8)) & 0x0300F00Fu;
+			v = (v | (v << 4)) & 0x030C30C3u;
+			v = (v | (v << 2)) & 0x09249249u;
+			return v;
+		}
+
+		inline uint64 MortonCode::Expand21(uint64 v)
+		{
+			v &= 0x00000000001FFFFFull;
+			v = (v | (v << 32)) & 0x001F00000000FFFFull;
+			v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+			v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+			v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+			v = (v | (v << 2)) & 0x1249249249249249ull;
+			return v;
+		}
+
+		template<>
+		inline uint32 MortonCode::EncodeCell<uint32>(uint32 x, uint32 y, uint32 z)
+		{
+			return Encode30(x, y, z);
+		}
+
+		template<>
+		inline uint64 MortonCode::EncodeCell<uint64>(uint32 x, uint32 y, uint32 z)
+		{
+			return Encode63(x, y, z);
+		}
+
+		template<typename CodeType>
+		inline void MortonCode::EncodeBatch(const Vector3D* points, uint32 count, const Vector3D& boundsMin, const Vector3D& boundsMax,
+			float cellCount, CodeType* outCodes)
+		{
+			static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Batched encoding expects tightly packed Vector3D arrays");
+
+			/* A flat axis maps every point to cell 0 instead of dividing by zero */
+			const Vector3D Extent = boundsMax - boundsMin;
+			const VectorRegister ScaleX = VectorRegisterReplicate(Extent.X > 0.0f ? cellCount / Extent.X : 0.0f);
+			const VectorRegister ScaleY = VectorRegisterReplicate(Extent.Y > 0.0f ? cellCount / Extent.Y : 0.0f);
+			const VectorRegister ScaleZ = VectorRegisterReplicate(Extent.Z > 0.0f ? cellCount / Extent.Z : 0.0f);
+			const VectorRegister MinX = VectorRegisterReplicate(boundsMin.X);
+			const VectorRegister MinY = VectorRegisterReplicate(boundsMin.Y);
+			const VectorRegister MinZ = VectorRegisterReplicate(boundsMin.Z);
+			const VectorRegister Zero = VectorRegisterZero();
+			const VectorRegister LastCell = VectorRegisterReplicate(cellCount - 1.0f);
+
+			for (uint32 i = 0; i < count; i += 4)
+			{
+				const uint32 Count = (count - i) < 4 ? (count - i) : 4;
+
+				/* The last partial group is padded so it goes through the same 4 wide path */
+				float Padded[12] = { };
+				const float* In = reinterpret_cast<const float*>(points + i);
+				if (Count < 4)
+				{
+					std::memcpy(Padded, In, Count * sizeof(Vector3D));
+					In = Padded;
+				}
+
+				VectorRegister X, Y, Z;
+				VectorRegisterDeinterleaveXYZ(In, X, Y, Z);
+
+				/* Cell coordinates stay whole floats below 2^24, the integer conversion below truncates them exactly */
+				X = VectorRegisterMin(VectorRegisterMax(VectorRegisterMultiply(VectorRegisterSubtract(X, MinX), ScaleX), Zero), LastCell);
+				Y = VectorRegisterMin(VectorRegisterMax(VectorRegisterMultiply(VectorRegisterSubtract(Y, MinY), ScaleY), Zero), LastCell);
+				Z = VectorRegisterMin(VectorRegisterMax(VectorRegisterMultiply(VectorRegisterSubtract(Z, MinZ), ScaleZ), Zero), LastCell);
+
+				alignas(16) float Cells[3][4];
+				StoreVectorRegisterAligned(Cells[0], X);
+				StoreVectorRegisterAligned(Cells[1], Y);
+				StoreVectorRegisterAligned(Cells[2], Z);
+
+				for (uint32 Lane = 0; Lane < Count; ++Lane)
+				{
+					outCodes[i + Lane] = EncodeCell<CodeType>(static_cast<uint32>(Cells[0][Lane]), static_cast<uint32>(Cells[1][Lane]),
+						static_cast<uint32>(Cells[2][Lane]));
+				}
+			}
+		}
+
+		inline void MortonCode::Encode(const Vector3D* points, uint32 count, const Vector3D& boundsMin, const Vector3D& boundsMax, uint32* outCodes)
+		{
+			EncodeBatch(points, count, boundsMin, boundsMax, 1024.0f, outCodes);
+		}
+
+		inline void MortonCode::Encode(const Vector3D* points, uint32 count, const Vector3D& boundsMin, const Vector3D& boundsMax, uint64* outCodes)
+		{
+			EncodeBatch(points, count, boundsMin, boundsMax, 2097152.0f, outCodes);
+		}
+	}
+}
@@ -0,0 +1,695 @@
+#pragma once
+#include "GenericDefines.h"
+#include "Quat.h"
+#include "Vector3D.h"
+#include "Vector3DStream.h"
+#include "VrixicMathSIMD.h"
+#include "VrixicMathKernels.h"
+
+#include <cmath>
+#include <cstring>
+
+/**
+* Compact storage for rotations, translations and scales, meant for animation clips and network snapshots
+*
+*	Format				Size		Max error (measured over random unit quats / in range values)
+*	PackedQuat32		4 bytes		2.1e-3 per component, the worst case is four components close to 0.5
+*	PackedQuat48		6 bytes		6.5e-5 per component, same worst case
+*	HalfVector3D		6 bytes		2^-11 relative for |v| in [6.1e-5, 65504], larger values become infinity
+*	QuantizedVector3D	6 bytes		half a step per axis, see Vector3DQuantizer::GetMaxError()
+*
+* The quaternion formats store the smallest three components of a unit quaternion, the largest one is rebuilt from
+* the unit length, so decoding can return -q for q which is the same rotation. Inputs should be normalized
+*
+* The batch functions work on 8 values at a time and encode to the same bits as the single value versions, decoded
+* values can differ by a few float steps where the batch path uses fused multiply-adds
+*/
+namespace Vrixic
+{
+	namespace Math
+	{
+		namespace PackingKernels
+		{
+			/**
+			* Smallest three quaternion compression with 'Bits' bits per stored component
+			* The 3 stored components of a unit quaternion are in [-1/sqrt(2), 1/sqrt(2)] when the largest is dropped
+			*/
+			template<uint32 Bits>
+			struct SmallestThree
+			{
+				static constexpr float MaxValue = static_cast<float>((1u << Bits) - 1);
+				static constexpr float Range = 0.70710678f;
+				static constexpr float EncodeScale = MaxValue / (2.0f * Range);
+				static constexpr float EncodeBias = MaxValue * 0.5f;
+				static constexpr float DecodeScale = (2.0f * Range) / MaxValue;
+
+				/* 'outValues' receives the quantized components in X, Y, Z, W order with the largest one skipped */
+				inline static void Encode(const Quat& q, uint32& outIndex, uint32 outValues[3]);
+
+				inline static Quat Decode(uint32 index, const uint32 values[3]);
+
+				/**
+				* Same as Encode() for 8 quats, the results stay in floats so the caller can pack them
+				*
+				* @param outIndices - 8 floats holding the dropped component index of each quat
+				* @param outValues - 3 groups of 8 floats, the first, second and third stored component
+				*/
+				inline static void Encode8(const Quat* quats, float* outIndices, float* outValues);
+
+				/* Inverse of Encode8() */
+				inline static void Decode8(const float* indices, const float* values, Quat* outQuats);
+			};
+		}
+
+		/* Unit quaternion in 32 bits, 2 bits for the dropped component and 10 bits for each of the other three */
+		struct PackedQuat32
+		{
+		public:
+			uint32 Bits;
+
+		public:
+			inline static PackedQuat32 Encode(const Quat& q);
+
+			inline Quat Decode() const;
+
+			inline static void EncodeBatch(const Quat* inQuats, PackedQuat32* outPacked, uint32 count);
+
+			inline static void DecodeBatch(const PackedQuat32* inPacked, Quat* outQuats, uint32 count);
+
+		private:
+			typedef PackingKernels::SmallestThree<10> Codec;
+
+			inline static PackedQuat32 Pack(uint32 index, uint32 a, uint32 b, uint32 c);
+
+			inline void Unpack(uint32& outIndex, uint32 outValues[3]) const;
+		};
+
+		/* Unit quaternion in 48 bits, 15 bits for each stored component and the dropped index in the top bits */
+		struct PackedQuat48
+		{
+		public:
+			uint16 Bits[3];
+
+		public:
+			inline static PackedQuat48 Encode(const Quat& q);
+
+			inline Quat Decode() const;
+
+			inline static void EncodeBatch(const Quat* inQuats, PackedQuat48* outPacked, uint32 count);
+
+			inline static void DecodeBatch(const PackedQuat48* inPacked, Quat* outQuats, uint32 count);
+
+		private:
+			typedef PackingKernels::SmallestThree<15> Codec;
+
+			inline static PackedQuat48 Pack(uint32 index, uint32 a, uint32 b, uint32 c);
+
+			inline void Unpack(uint32& outIndex, uint32 outValues[3]) const;
+		};
+
+		/* IEEE half precision Vector3D, rounds to nearest even */
+		struct HalfVector3D
+		{
+		public:
+			uint16 X;
+			uint16 Y;
+			uint16 Z;
+
+		public:
+			inline static uint16 FloatToHalf(float f);
+
+			inline static float HalfToFloat(uint16 h);
+
+			inline static HalfVector3D Encode(const Vector3D& v);
+
+			inline Vector3D Decode() const;
+
+			inline static void EncodeBatch(const Vector3D* inVectors, HalfVector3D* outHalves, uint32 count);
+
+			inline static void DecodeBatch(const HalfVector3D* inHalves, Vector3D* outVectors, uint32 count);
+		};
+
+		/* 16 bits per axis, only meaningful together with the Vector3DQuantizer that made it */
+		struct QuantizedVector3D
+		{
+		public:
+			uint16 X;
+			uint16 Y;
+			uint16 Z;
+		};
+
+		/* Maps the box [min, max] onto 65536 steps per axis, values outside the box are clamped to it */
+		struct Vector3DQuantizer
+		{
+		public:
+			Vector3D Min;
+			Vector3D Step;
+			Vector3D InverseStep;
+
+		public:
+			inline Vector3DQuantizer(const Vector3D& min, const Vector3D& max);
+
+		public:
+			inline QuantizedVector3D Encode(const Vector3D& v) const;
+
+			inline Vector3D Decode(const QuantizedVector3D& q) const;
+
+			inline void EncodeBatch(const Vector3D* inVectors, QuantizedVector3D* outQuantized, uint32 count) const;
+
+			inline void DecodeBatch(const QuantizedVector3D* inQuantized, Vector3D* outVectors, uint32 count) const;
+
+			/* Largest difference per axis between an in range value and its decoded copy, not counting float rounding */
+			inline Vector3D GetMaxError() const;
+		};
+
+		static_assert(sizeof(PackedQuat32) == 4, "PackedQuat32 is expected to be 4 bytes");
+		static_assert(sizeof(PackedQuat48) == 6, "PackedQuat48 is expected to be 6 bytes");
+		static_assert(sizeof(HalfVector3D) == 6, "HalfVector3D is expected to be 6 bytes");
+		static_assert(sizeof(QuantizedVector3D) == 6, "QuantizedVector3D is expected to be 6 bytes");
+
+		namespace PackingKernels
+		{
+			template<uint32 Bits>
+			inline void SmallestThree<Bits>::Encode(const Quat& q, uint32& outIndex, uint32 outValues[3])
+			{
+				const float Components[4] = { q.X, q.Y, q.Z, q.W };
+
+				/* Ties go to the lowest index, same as Encode8() */
+				uint32 Largest = 0;
+				float LargestAbs = std::fabs(Components[0]);
+				for (uint32 k = 1; k < 4; ++k)
+				{
+					if (std::fabs(Components[k]) > LargestAbs)
+					{
+						LargestAbs = std::fabs(Components[k]);
+						Largest = k;
+					}
+				}
+
+				/* Keeps the dropped component positive so decoding can take the positive root */
+				const float Sign = Components[Largest] < 0.0f ? -1.0f : 1.0f;
+
+				uint32 j = 0;
+				for (uint32 k = 0; k < 4; ++k)
+				{
+					if (k != Largest)
+					{
+						/* The same multiply-add as Encode8(), so both round the same value with or without FMA */
+						const VectorRegister Scaled = VectorRegisterMultiplyAdd(VectorRegisterReplicate(Components[k] * Sign),
+							VectorRegisterReplicate(EncodeScale), VectorRegisterReplicate(EncodeBias));
+						float Value = std::nearbyint(VectorRegisterGetX(Scaled));
+						Value = Value < 0.0f ? 0.0f : (Value > MaxValue ? MaxValue : Value);
+						outValues[j++] = static_cast<uint32>(Value);
+					}
+				}
+				outIndex = Largest;
+			}
+
+			template<uint32 Bits>
+			inline Quat SmallestThree<Bits>::Decode(uint32 index, const uint32 values[3])
+			{
+				const float A = static_cast<float>(values[0]) * DecodeScale - Range;
+				const float B = static_cast<float>(values[1]) * DecodeScale - Range;
+				const float C = static_cast<float>(values[2]) * DecodeScale - Range;
+
+				const float Remaining = 1.0f - (A * A + B * B + C * C);
+				const float D = std::sqrt(Remaining > 0.0f ? Remaining : 0.0f);
+
+				switch (index)
+				{
+				case 0:
+					return Quat(D, A, B, C);
+				case 1:
+					return Quat(A, D, B, C);
+				case 2:
+					return Quat(A, B, D, C);
+				default:
+					return Quat(A, B, C, D);
+				}
+			}
+
+			template<uint32 Bits>
+			inline void SmallestThree<Bits>::Encode8(const Quat* quats, float* outIndices, float* outValues)
+			{
+				VectorRegister8 X, Y, Z, W;
+				VectorRegister8DeinterleaveXYZW(&quats[0].X, X, Y, Z, W);
+
+				const VectorRegister8 AbsX = VectorRegister8Abs(X);
+				const VectorRegister8 AbsY = VectorRegister8Abs(Y);
+				const VectorRegister8 AbsZ = VectorRegister8Abs(Z);
+				const VectorRegister8 AbsW = VectorRegister8Abs(W);
+				const VectorRegister8 LargestAbs = VectorRegister8Max(VectorRegister8Max(AbsX, AbsY), VectorRegister8Max(AbsZ, AbsW));
+
+				const VectorRegister8 IsX = VectorRegister8CompareEqual(AbsX, LargestAbs);
+				const VectorRegister8 IsY = VectorRegister8CompareEqual(AbsY, LargestAbs);
+				const VectorRegister8 IsZ = VectorRegister8CompareEqual(AbsZ, LargestAbs);
+
+				/* The first lane mask that is set wins, so 'Index <= n' is a plain comparison below */
+				const VectorRegister8 Index = VectorRegister8Select(IsX, VectorRegister8Zero(),
+					VectorRegister8Select(IsY, VectorRegister8Replicate(1.0f),
+					VectorRegister8Select(IsZ, VectorRegister8Replicate(2.0f), VectorRegister8Replicate(3.0f))));
+
+				const VectorRegister8 DroppedFirst = VectorRegister8CompareLess(Index, VectorRegister8Replicate(0.5f));
+				const VectorRegister8 DroppedSecond = VectorRegister8CompareLess(Index, VectorRegister8Replicate(1.5f));
+				const VectorRegister8 DroppedThird = VectorRegister8CompareLess(Index, VectorRegister8Replicate(2.5f));
+
+				VectorRegister8 A = VectorRegister8Select(DroppedFirst, Y, X);
+				VectorRegister8 B = VectorRegister8Select(DroppedSecond, Z, Y);
+				VectorRegister8 C = VectorRegister8Select(DroppedThird, W, Z);
+
+				/* Flips the stored components of the lanes whose dropped component is negative */
+				const VectorRegister8 Dropped = VectorRegister8Select(DroppedFirst, X,
+					VectorRegister8Select(DroppedSecond, Y, VectorRegister8Select(DroppedThird, Z, W)));
+				const VectorRegister8 SignFlip = VectorRegister8BitwiseAnd(Dropped, VectorRegister8Replicate(-0.0f));
+				A = VectorRegister8BitwiseXor(A, SignFlip);
+				B = VectorRegister8BitwiseXor(B, SignFlip);
+				C = VectorRegister8BitwiseXor(C, SignFlip);
+
+				const VectorRegister8 Scale = VectorRegister8Replicate(EncodeScale);
+				const VectorRegister8 Bias = VectorRegister8Replicate(EncodeBias);
+				const VectorRegister8 Zero = VectorRegister8Zero();
+				const VectorRegister8 Max = VectorRegister8Replicate(MaxValue);
+
+				/* Clamped before rounding, VectorRegister8Round() is only valid within the int32 range on SSE2 */
+				StoreVectorRegister8(outIndices, Index);
+				StoreVectorRegister8(outValues, VectorRegister8Round(VectorRegister8Min(VectorRegister8Max(VectorRegister8MultiplyAdd(A, Scale, Bias), Zero), Max)));
+				StoreVectorRegister8(outValues + 8, VectorRegister8Round(VectorRegister8Min(VectorRegister8Max(VectorRegister8MultiplyAdd(B, Scale, Bias), Zero), Max)));
+				StoreVectorRegister8(outValues + 16, VectorRegister8Round(VectorRegister8Min(VectorRegister8Max(VectorRegister8MultiplyAdd(C, Scale, Bias), Zero), Max)));
+			}
+
+			template<uint32 Bits>
+			inline void SmallestThree<Bits>::Decode8(const float* indices, const float* values, Quat* outQuats)
+			{
+				const VectorRegister8 Scale = VectorRegister8Replicate(DecodeScale);
+				const VectorRegister8 Bias = VectorRegister8Replicate(-Range);
+
+				const VectorRegister8 A = VectorRegister8MultiplyAdd(MakeVectorRegister8(values), Scale, Bias);
+				const VectorRegister8 B = VectorRegister8MultiplyAdd(MakeVectorRegister8(values + 8), Scale, Bias);
+				const VectorRegister8 C = VectorRegister8MultiplyAdd(MakeVectorRegister8(values + 16), Scale, Bias);
+
+				const VectorRegister8 Remaining = VectorRegister8Subtract(VectorRegister8Replicate(1.0f),
+					VectorRegister8MultiplyAdd(A, A, VectorRegister8MultiplyAdd(B, B, VectorRegister8Multiply(C, C))));
+				const VectorRegister8 D = VectorRegister8Sqrt(VectorRegister8Max(Remaining, VectorRegister8Zero()));
+
+				const VectorRegister8 Index = MakeVectorRegister8(indices);
+				const VectorRegister8 DroppedFirst = VectorRegister8CompareLess(Index, VectorRegister8Replicate(0.5f));
+				const VectorRegister8 DroppedSecond = VectorRegister8CompareLess(Index, VectorRegister8Replicate(1.5f));
+				const VectorRegister8 DroppedThird = VectorRegister8CompareLess(Index, VectorRegister8Replicate(2.5f));
+				const VectorRegister8 IsY = VectorRegister8BitwiseXor(DroppedSecond, DroppedFirst);
+				const VectorRegister8 IsZ = VectorRegister8BitwiseXor(DroppedThird, DroppedSecond);
+
+				const VectorRegister8 X = VectorRegister8Select(DroppedFirst, D, A);
+				const VectorRegister8 Y = VectorRegister8Select(DroppedFirst, A, VectorRegister8Select(IsY, D, B));
+				const VectorRegister8 Z = VectorRegister8Select(DroppedSecond, B, VectorRegister8Select(IsZ, D, C));
+				const VectorRegister8 W = VectorRegister8Select(DroppedThird, C, D);
+
+				VectorRegister8InterleaveXYZW(&outQuats[0].X, X, Y, Z, W);
+			}
+		}
+
+		inline PackedQuat32 PackedQuat32::Pack(uint32 index, uint32 a, uint32 b, uint32 c)
+		{
+			PackedQuat32 Result;
+			Result.Bits = (index << 30) | (a << 20) | (b << 10) | c;
+			return Result;
+		}
+
+		inline void PackedQuat32::Unpack(uint32& outIndex, uint32 outValues[3]) const
+		{
+			outIndex = Bits >> 30;
+			outValues[0] = (Bits >> 20) & 0x3FF;
+			outValues[1] = (Bits >> 10) & 0x3FF;
+			outValues[2] = Bits & 0x3FF;
+		}
+
+		inline PackedQuat32 PackedQuat32::Encode(const Quat& q)
+		{
+			uint32 Index;
+			uint32 Values[3];
+			Codec::Encode(q, Index, Values);
+			return Pack(Index, Values[0], Values[1], Values[2]);
+		}
+
+		inline Quat PackedQuat32::Decode() const
+		{
+			uint32 Index;
+			uint32 Values[3];
+			Unpack(Index, Values);
+			return Codec::Decode(Index, Values);
+		}
+
+		inline void PackedQuat32::EncodeBatch(const Quat* inQuats, PackedQuat32* outPacked, uint32 count)
+		{
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				alignas(32) float Indices[8];
+				alignas(32) float Values[24];
+				Codec::Encode8(inQuats + i, Indices, Values);
+
+				for (uint32 k = 0; k < 8; ++k)
+				{
+					outPacked[i + k] = Pack(static_cast<uint32>(Indices[k]), static_cast<uint32>(Values[k]),
+						static_cast<uint32>(Values[k + 8]), static_cast<uint32>(Values[k + 16]));
+				}
+			}
+
+			for (; i < count; ++i)
+			{
+				outPacked[i] = Encode(inQuats[i]);
+			}
+		}
+
+		inline void PackedQuat32::DecodeBatch(const PackedQuat32* inPacked, Quat* outQuats, uint32 count)
+		{
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				alignas(32) float Indices[8];
+				alignas(32) float Values[24];
+				for (uint32 k = 0; k < 8; ++k)
+				{
+					const uint32 Packed = inPacked[i + k].Bits;
+					Indices[k] = static_cast<float>(Packed >> 30);
+					Values[k] = static_cast<float>((Packed >> 20) & 0x3FF);
+					Values[k + 8] = static_cast<float>((Packed >> 10) & 0x3FF);
+					Values[k + 16] = static_cast<float>(Packed & 0x3FF);
+				}
+
+				Codec::Decode8(Indices, Values, outQuats + i);
+			}
+
+			for (; i < count; ++i)
+			{
+				outQuats[i] = inPacked[i].Decode();
+			}
+		}
+
+		inline PackedQuat48 PackedQuat48::Pack(uint32 index, uint32 a, uint32 b, uint32 c)
+		{
+			PackedQuat48 Result;
+			Result.Bits[0] = static_cast<uint16>(a | ((index >> 1) << 15));
+			Result.Bits[1] = static_cast<uint16>(b | ((index & 1) << 15));
+			Result.Bits[2] = static_cast<uint16>(c);
+			return Result;
+		}
+
+		inline void PackedQuat48::Unpack(uint32& outIndex, uint32 outValues[3]) const
+		{
+			outIndex = ((Bits[0] >> 15) << 1) | (Bits[1] >> 15);
+			outValues[0] = Bits[0] & 0x7FFF;
+			outValues[1] = Bits[1] & 0x7FFF;
+			outValues[2] = Bits[2] & 0x7FFF;
+		}
+
+		inline PackedQuat48 PackedQuat48::Encode(const Quat& q)
+		{
+			uint32 Index;
+			uint32 Values[3];
+			Codec::Encode(q, Index, Values);
+			return Pack(Index, Values[0], Values[1], Values[2]);
+		}
+
+		inline Quat PackedQuat48::Decode() const
+		{
+			uint32 Index;
+			uint32 Values[3];
+			Unpack(Index, Values);
+			return Codec::Decode(Index, Values);
+		}
+
+		inline void PackedQuat48::EncodeBatch(const Quat* inQuats, PackedQuat48* outPacked, uint32 count)
+		{
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				alignas(32) float Indices[8];
+				alignas(32) float Values[24];
+				Codec::Encode8(inQuats + i, Indices, Values);
+
+				for (uint32 k = 0; k < 8; ++k)
+				{
+					outPacked[i + k] = Pack(static_cast<uint32>(Indices[k]), static_cast<uint32>(Values[k]),
+						static_cast<uint32>(Values[k + 8]), static_cast<uint32>(Values[k + 16]));
+				}
+			}
+
+			for (; i < count; ++i)
+			{
+				outPacked[i] = Encode(inQuats[i]);
+			}
+		}
+
+		inline void PackedQuat48::DecodeBatch(const PackedQuat48* inPacked, Quat* outQuats, uint32 count)
+		{
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				alignas(32) float Indices[8];
+				alignas(32) float Values[24];
+				for (uint32 k = 0; k < 8; ++k)
+				{
+					const uint16* Packed = inPacked[i + k].Bits;
+					Indices[k] = static_cast<float>(((Packed[0] >> 15) << 1) | (Packed[1] >> 15));
+					Values[k] = static_cast<float>(Packed[0] & 0x7FFF);
+					Values[k + 8] = static_cast<float>(Packed[1] & 0x7FFF);
+					Values[k + 16] = static_cast<float>(Packed[2] & 0x7FFF);
+				}
+
+				Codec::Decode8(Indices, Values, outQuats + i);
+			}
+
+			for (; i < count; ++i)
+			{
+				outQuats[i] = inPacked[i].Decode();
+			}
+		}
+
+		inline uint16 HalfVector3D::FloatToHalf(float f)
+		{
+			/* Integer rounding trick from Fabian Giesen's float_to_half_fast3_rtne */
+			uint32 Bits;
+			std::memcpy(&Bits, &f, sizeof(Bits));
+
+			const uint32 Sign = Bits & 0x80000000u;
+			Bits ^= Sign;
+
+			uint32 Result;
+			if (Bits >= 0x47800000u)
+			{
+				/* Too large for a half, or already infinity / NaN */
+				Result = Bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+			}
+			else if (Bits < 0x38800000u)
+			{
+				/* Subnormal half or zero, adding 0.5 lines the mantissa up and lets the FPU round it */
+				float Shifted;
+				std::memcpy(&Shifted, &Bits, sizeof(Shifted));
+				Shifted += 0.5f;
+
+				std::memcpy(&Result, &Shifted, sizeof(Result));
+				Result -= 0x3F000000u;
+			}
+			else
+			{
+				/* Rebias the exponent and round the mantissa to nearest even */
+				const uint32 MantissaOdd = (Bits >> 13) & 1;
+				Bits += 0xC8000FFFu + MantissaOdd;
+				Result = Bits >> 13;
+			}
+
+			return static_cast<uint16>(Result | (Sign >> 16));
+		}
+
+		inline float HalfVector3D::HalfToFloat(uint16 h)
+		{
+			uint32 Bits = (static_cast<uint32>(h) & 0x7FFFu) << 13;
+			const uint32 Exponent = Bits & 0x0F800000u;
+			Bits += 0x38000000u;
+
+			float Result;
+			if (Exponent == 0x0F800000u)
+			{
+				/* Infinity / NaN */
+				Bits += 0x38000000u;
+				std::memcpy(&Result, &Bits, sizeof(Result));
+			}
+			else if (Exponent == 0)
+			{
+				/* Subnormal, renormalized by the FPU */
+				Bits += 0x00800000u;
+				std::memcpy(&Result, &Bits, sizeof(Result));
+				Result -= 6.103515625e-05f;
+			}
+			else
+			{
+				std::memcpy(&Result, &Bits, sizeof(Result));
+			}
+
+			return (h & 0x8000u) ? -Result : Result;
+		}
+
+		inline HalfVector3D HalfVector3D::Encode(const Vector3D& v)
+		{
+			HalfVector3D Result;
+			Result.X = FloatToHalf(v.X);
+			Result.Y = FloatToHalf(v.Y);
+			Result.Z = FloatToHalf(v.Z);
+			return Result;
+		}
+
+		inline Vector3D HalfVector3D::Decode() const
+		{
+			return Vector3D(HalfToFloat(X), HalfToFloat(Y), HalfToFloat(Z));
+		}
+
+		inline void HalfVector3D::EncodeBatch(const Vector3D* inVectors, HalfVector3D* outHalves, uint32 count)
+		{
+			/* Both sides are tightly packed, so this is a plain float to half array conversion */
+			const float* In = reinterpret_cast<const float*>(inVectors);
+			uint16* Out = reinterpret_cast<uint16*>(outHalves);
+			const uint32 ComponentCount = count * 3;
+			uint32 i = 0;
+
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				i = SIMDKernelsAVX2::FloatsToHalves(In, Out, ComponentCount);
+			}
+#endif
+			for (; i < ComponentCount; ++i)
+			{
+				Out[i] = FloatToHalf(In[i]);
+			}
+		}
+
+		inline void HalfVector3D::DecodeBatch(const HalfVector3D* inHalves, Vector3D* outVectors, uint32 count)
+		{
+			const uint16* In = reinterpret_cast<const uint16*>(inHalves);
+			float* Out = reinterpret_cast<float*>(outVectors);
+			const uint32 ComponentCount = count * 3;
+			uint32 i = 0;
+
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				i = SIMDKernelsAVX2::HalvesToFloats(In, Out, ComponentCount);
+			}
+#endif
+			for (; i < ComponentCount; ++i)
+			{
+				Out[i] = HalfToFloat(In[i]);
+			}
+		}
+
+		inline Vector3DQuantizer::Vector3DQuantizer(const Vector3D& min, const Vector3D& max)
+			: Min(min), Step((max - min) * (1.0f / 65535.0f))
+		{
+			/* A flat axis always decodes to its minimum */
+			InverseStep.X = Step.X > 0.0f ? 1.0f / Step.X : 0.0f;
+			InverseStep.Y = Step.Y > 0.0f ? 1.0f / Step.Y : 0.0f;
+			InverseStep.Z = Step.Z > 0.0f ? 1.0f / Step.Z : 0.0f;
+		}
+
+		inline QuantizedVector3D Vector3DQuantizer::Encode(const Vector3D& v) const
+		{
+			const float Values[3] =
+			{
+				std::nearbyint((v.X - Min.X) * InverseStep.X),
+				std::nearbyint((v.Y - Min.Y) * InverseStep.Y),
+				std::nearbyint((v.Z - Min.Z) * InverseStep.Z)
+			};
+
+			uint16 Quantized[3];
+			for (uint32 k = 0; k < 3; ++k)
+			{
+				Quantized[k] = static_cast<uint16>(Values[k] < 0.0f ? 0.0f : (Values[k] > 65535.0f ? 65535.0f : Values[k]));
+			}
+
+			QuantizedVector3D Result;
+			Result.X = Quantized[0];
+			Result.Y = Quantized[1];
+			Result.Z = Quantized[2];
+			return Result;
+		}
+
+		inline Vector3D Vector3DQuantizer::Decode(const QuantizedVector3D& q) const
+		{
+			return Vector3D(static_cast<float>(q.X) * Step.X + Min.X, static_cast<float>(q.Y) * Step.Y + Min.Y,
+				static_cast<float>(q.Z) * Step.Z + Min.Z);
+		}
+
+		inline void Vector3DQuantizer::EncodeBatch(const Vector3D* inVectors, QuantizedVector3D* outQuantized, uint32 count) const
+		{
+			const Vector3x8 Offset(Min);
+			const Vector3x8 Scale(InverseStep);
+			const VectorRegister8 Zero = VectorRegister8Zero();
+			const VectorRegister8 Max = VectorRegister8Replicate(65535.0f);
+
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				/* Clamped before rounding, VectorRegister8Round() is only valid within the int32 range on SSE2 */
+				const Vector3x8 Scaled = (Vector3x8::LoadAoS(inVectors + i) - Offset) * Scale;
+				const Vector3x8 Rounded
+				(
+					VectorRegister8Round(VectorRegister8Min(VectorRegister8Max(Scaled.X, Zero), Max)),
+					VectorRegister8Round(VectorRegister8Min(VectorRegister8Max(Scaled.Y, Zero), Max)),
+					VectorRegister8Round(VectorRegister8Min(VectorRegister8Max(Scaled.Z, Zero), Max))
+				);
+
+				/* Back to XYZ order as floats, then narrowed, the rounding and clamping above made them exact */
+				Vector3D Values[8];
+				Rounded.StoreAoS(Values);
+
+				const float* In = &Values[0].X;
+				uint16* Out = &outQuantized[i].X;
+				for (uint32 k = 0; k < 24; ++k)
+				{
+					Out[k] = static_cast<uint16>(In[k]);
+				}
+			}
+
+			for (; i < count; ++i)
+			{
+				outQuantized[i] = Encode(inVectors[i]);
+			}
+		}
+
+		inline void Vector3DQuantizer::DecodeBatch(const QuantizedVector3D* inQuantized, Vector3D* outVectors, uint32 count) const
+		{
+			const Vector3x8 Offset(Min);
+			const Vector3x8 Scale(Step);
+
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				Vector3D Values[8];
+				const uint16* In = &inQuantized[i].X;
+				float* Out = &Values[0].X;
+				for (uint32 k = 0; k < 24; ++k)
+				{
+					Out[k] = static_cast<float>(In[k]);
+				}
+
+				const Vector3x8 Quantized = Vector3x8::LoadAoS(Values);
+				Vector3x8
+				(
+					VectorRegister8MultiplyAdd(Quantized.X, Scale.X, Offset.X),
+					VectorRegister8MultiplyAdd(Quantized.Y, Scale.Y, Offset.Y),
+					VectorRegister8MultiplyAdd(Quantized.Z, Scale.Z, Offset.Z)
+				).StoreAoS(outVectors + i);
+			}
+
+			for (; i < count; ++i)
+			{
+				outVectors[i] = Decode(inQuantized[i]);
+			}
+		}
+
+		inline Vector3D Vector3DQuantizer::GetMaxError() const
+		{
+			return Step * 0.5f;
+		}
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include <type_traits>
 #include "Vector3D.h"
 
 /*
@@ -17,11 +18,11 @@ namespace Vrixic
 			float Z;
 			float Distance;
 
-			inline Plane();
+			inline constexpr Plane();
 
-			inline Plane(float x, float y, float z, float distance);
+			inline constexpr Plane(float x, float y, float z, float distance);
 
-			inline Plane(Vector3D& normal, float distance);
+			inline constexpr Plane(const Vector3D& normal, float distance);
 		public:
 
 			/*
@@ -48,12 +49,14 @@ namespace Vrixic
 
 		};
 
-		inline Plane::Plane() : X(0.0f), Y(0.0f), Z(0.0f), Distance(0.0f) { }
+		static_assert(std::is_trivially_copyable<Plane>::value, "Plane should stay trivially copyable");
 
-		inline Plane::Plane(float x, float y, float z, float distance)
+		inline constexpr Plane::Plane() : X(0.0f), Y(0.0f), Z(0.0f), Distance(0.0f) { }
+
+		inline constexpr Plane::Plane(float x, float y, float z, float distance)
 			: X(x), Y(y), Z(z), Distance(distance) { }
 
-		inline Plane::Plane(Vector3D& normal, float distance)
+		inline constexpr Plane::Plane(const Vector3D& normal, float distance)
 			: X(normal.X), Y(normal.Y), Z(normal.Z), Distance(distance) { }
 
 		inline float Plane::Dot(const Plane& p, const Vector3D& v)
@@ -9,7 +9,7 @@ namespace Vrixic
 		struct ProjectionMatrix4D : public Matrix4D
 		{
 		public:
-			inline ProjectionMatrix4D() : Matrix4D() { };
+			inline constexpr ProjectionMatrix4D() : Matrix4D() { };
 
 			/* By default its is a Left Handed Matrix, for DirectX */
 			inline ProjectionMatrix4D(float aspectRatio, float verticalFOVInDegs, float nearZ, float farZ);
@@ -27,7 +27,9 @@ namespace Vrixic
 		inline ProjectionMatrix4D::ProjectionMatrix4D(float aspectRatio, float verticalFOVInDegs, float nearZ, float farZ)
 		{
 			float Rads = MathUtils::DegreesToRadians(verticalFOVInDegs * 0.5f);
-			float Height = 1.0f / std::tanf(Rads);
+			float S, C;
+			MathUtils::SinCos(Rads, S, C);
+			float Height = C / S;
 			
 			float FarRange = farZ / (farZ - nearZ);
 			
@@ -61,7 +63,9 @@ namespace Vrixic
 		{
 			ProjectionMatrix4D Result = { };
 			float Rads = MathUtils::DegreesToRadians(verticalFOVInDegs * 0.5f);
-			float Height = 1.0f / std::tanf(Rads);
+			float S, C;
+			MathUtils::SinCos(Rads, S, C);
+			float Height = C / S;
 
 			float FarRange = farZ / (nearZ - farZ);
 
@@ -92,7 +96,9 @@ namespace Vrixic
 		{
 			ProjectionMatrix4D Result = { };
 			float Rads = MathUtils::DegreesToRadians(verticalFOVInDegs * 0.5f);
-			float Height = 1.0f / std::tanf(Rads);
+			float S, C;
+			MathUtils::SinCos(Rads, S, C);
+			float Height = C / S;
 
 			float FarRange = farZ / (farZ - nearZ);
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Matrix4D.h"
+#include "Vector3DStream.h"
 
 namespace Vrixic
 {
@@ -16,11 +17,11 @@ namespace Vrixic
 			float W;
 
 		public:
-			inline Quat();
+			inline constexpr Quat();
 
-			inline Quat(float x, float y, float z, float w);
+			inline constexpr Quat(float x, float y, float z, float w);
 
-			inline Quat(const Vector3D& v, float w);
+			inline constexpr Quat(const Vector3D& v, float w);
 
 		public:
 			/* Unary operator overloads */
@@ -42,9 +43,9 @@ namespace Vrixic
 			inline Quat operator*=(const Quat& q);
 
 		public:
-			inline static Quat Identity();
+			inline constexpr static Quat Identity();
 
-			inline static float DotProduct(const Quat& a, const Quat& b);
+			inline constexpr static float DotProduct(const Quat& a, const Quat& b);
 
 			/* Factory function for making a rotation quat with an axis and an angleInDegrees */
 			inline static Quat MakeRotationQuat(float axisX, float axisY, float axisZ, float angleInDegrees);
@@ -64,9 +65,14 @@ namespace Vrixic
 			/**
 			* Creates a quaternion from a rotational Matrix4D
 			* Algorithm from: "https://www.gamedeveloper.com/programming/rotating-objects-using-quaternions"
+			* 
+			* Branch free, the largest of 4w^2, 4x^2, 4y^2 and 4z^2 is selected with lane masks instead of testing the trace
 			*/
 			inline static Quat MakeFromMatrix4D(const Matrix4D& inMat);
 
+			/* MakeFromMatrix4D() for 'count' matrices, 8 at a time in SIMD registers */
+			inline static void MakeFromMatrix4DBatch(const Matrix4D* inMatrices, Quat* outQuats, uint32 count);
+
 			/**
 			* Spherical Interpolation
 			* Algorithm from: "https://www.gamedeveloper.com/programming/rotating-objects-using-quaternions"
@@ -108,32 +114,50 @@ namespace Vrixic
 			* 
 			* Passive Rotation -> Coordinate system is rotated with respect to the point
 			* Rotate a vector by this quaternion -> for a point q and quat q -> qpq^-1
+			* Evaluated as v + w * t + Cross(q, t) where t = 2 * Cross(q, v), two cross products instead of two quaternion products
 			*/
 			inline Vector3D RotateVector(const Vector3D& v) const;
 
 			/* 
-			* Slower as it calculates the Inverse() 
+			* Slower as it divides by LengthSquared(), works for quaternions that are not normalized
 			* 
 			* Passive Rotation -> Coordinate system is rotated with respect to the point
 			* Rotate a vector by this quaternion -> for a point q and quat q -> qpq^-1
 			*/
 			inline Vector3D RotateVectorSlow(const Vector3D& v) const;
 
+			/**
+			* Rotates an array of vectors by one quaternion, same as RotateVector() per element
+			* 'outVectors' may be the same array as 'inVectors' but the two must not partially overlap
+			*/
+			inline static void RotateVectors(const Quat& q, const Vector3D* inVectors, Vector3D* outVectors, uint32 count);
+
+			/**
+			* Rotates inVectors[i] by quats[i], same as RotateVector() per element
+			* 'outVectors' may be the same array as 'inVectors' but the two must not partially overlap
+			*/
+			inline static void RotateVectors(const Quat* quats, const Vector3D* inVectors, Vector3D* outVectors, uint32 count);
+
 			/**
 			* Creates a Matrix4D from quaternion
 			* 
 			* Algorithm from Algorithm from: "https://www.gamedeveloper.com/programming/rotating-objects-using-quaternions"
 			*/
 			inline Matrix4D ToMatrix4D() const;
+
+			/* ToMatrix4D() for 'count' quaternions, 8 at a time in SIMD registers */
+			inline static void ToMatrix4DBatch(const Quat* inQuats, Matrix4D* outMatrices, uint32 count);
 		};
 
-		inline Quat::Quat()
+		static_assert(std::is_trivially_copyable<Quat>::value, "Quat should stay trivially copyable");
+
+		inline constexpr Quat::Quat()
 			: X(0.0f), Y(0.0f), Z(0.0f), W(0.0f) { }
 
-		inline Quat::Quat(const Vector3D& v, float w)
+		inline constexpr Quat::Quat(const Vector3D& v, float w)
 			: X(v.X), Y(v.Y), Z(v.Z), W(w) { } 
 
-		inline Quat::Quat(float x, float y, float z, float w)
+		inline constexpr Quat::Quat(float x, float y, float z, float w)
 			: X(x), Y(y), Z(z), W(w) { }
 
 		inline Quat Quat::operator+(const Quat& q) const 
@@ -154,30 +178,9 @@ namespace Vrixic
 		inline Quat Quat::operator*(const Quat& q) const 
 		{
 			/* Q1 * Q2 = [w1 * w2 - Dot(v1, v2), w1*v2 + w2*v1 + Cross(v1, v2)] */
-
-			// InEfficient
-			//float ResultX = W * q.X + q.W * X + Y * q.Z - Z * q.Y;
-			//float ResultY = W * q.Y + q.W * Y + Z * q.X - X * q.Z;
-			//float ResultZ = W * q.Z + q.W * Z + X * q.Y - Y * q.X;
-			//float ResultW = W * q.W - (X * q.X + Y * q.Y + Z * q.Z);
-			
-			// Efficient 
-			float A, B, C, D, E, F, G, H;
-			A = (W + X) * (q.W + q.X);
-			B = (Z - Y) * (q.Y - q.Z);
-			C = (W - X) * (q.Y + q.Z);
-			D = (Y + Z) * (q.W - q.X);
-			E = (X + Z) * (q.X + q.Y);
-			F = (X - Z) * (q.X - q.Y);
-			G = (W + Y) * (q.W - q.Z);
-			H = (W - Y) * (q.W + q.Z);
-
-			float ResultX = A - (E + F + G + H)  * 0.5f;
-			float ResultY = C + (E - F + G - H)  * 0.5f;
-			float ResultZ = D + (E - F - G + H)  * 0.5f;
-			float ResultW = B + (-E - F + G + H) * 0.5f;
-
-			return Quat(ResultX, ResultY, ResultZ, ResultW);
+			Quat Result;
+			StoreVectorRegister(&Result.X, VectorRegisterQuatMultiply(MakeVectorRegister(&X), MakeVectorRegister(&q.X)));
+			return Result;
 		}
 
 		inline Quat Quat::operator+=(const Quat& q) 
@@ -202,25 +205,16 @@ namespace Vrixic
 
 		inline Quat Quat::operator*=(const Quat& q) 
 		{
-			float ResultX = W * q.X + q.W * X + Y * q.Z - Z * q.Y;
-			float ResultY = W * q.Y + q.W * Y + Z * q.X - X * q.Z;
-			float ResultZ = W * q.Z + q.W * Z + X * q.Y - Y * q.X;
-			float ResultW = W * q.W - (X * q.X + Y * q.Y + Z * q.Z);
-
-			X = ResultX;
-			Y = ResultY;
-			Z = ResultZ;
-			W = ResultW;
-
+			*this = *this * q;
 			return *this;
 		}
 
-		inline Quat Quat::Identity()
+		inline constexpr Quat Quat::Identity()
 		{
 			return Quat(0.0f, 0.0f, 0.0f, 1.0f);
 		}
 
-		inline float Quat::DotProduct(const Quat& a, const Quat& b)
+		inline constexpr float Quat::DotProduct(const Quat& a, const Quat& b)
 		{
 			return a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W;
 		}
@@ -229,8 +223,8 @@ namespace Vrixic
 		{
 			float HalfAngleInRads = MathUtils::DegreesToRadians(angleInDegrees * 0.5f);
 
-			float C = cosf(HalfAngleInRads);
-			float S = sinf(HalfAngleInRads);
+			float S, C;
+			MathUtils::SinCos(HalfAngleInRads, S, C);
 
 			return Quat(axisX * S, axisY * S, axisZ * S, C);
 		}
@@ -239,8 +233,8 @@ namespace Vrixic
 		{
 			float HalfAngleInRads = MathUtils::DegreesToRadians(angleInDegrees * 0.5f);
 
-			float C = cosf(HalfAngleInRads);
-			float S = sinf(HalfAngleInRads);
+			float S, C;
+			MathUtils::SinCos(HalfAngleInRads, S, C);
 
 			return Quat(axis.X * S, axis.Y * S, axis.Z * S, C);
 		}
@@ -251,14 +245,23 @@ namespace Vrixic
 			float YawRads = MathUtils::DegreesToRadians(inYaw * 0.5f);
 			float RollRads = MathUtils::DegreesToRadians(inRoll * 0.5f);
 
-			float SinPitch = sinf(PitchRads);
-			float CosPitch = cosf(PitchRads);
+			/* All three sine/cosine pairs come from one register */
+			VectorRegister Sines, Cosines;
+			VectorRegisterSinCos(MakeVectorRegister(PitchRads, YawRads, RollRads, 0.0f), Sines, Cosines);
 
-			float SinYaw = sinf(YawRads);
-			float CosYaw = cosf(YawRads);
+			alignas(16) float S[4];
+			alignas(16) float C[4];
+			StoreVectorRegisterAligned(S, Sines);
+			StoreVectorRegisterAligned(C, Cosines);
 
-			float SinRoll = sinf(RollRads);
-			float CosRoll = cosf(RollRads);
+			float SinPitch = S[0];
+			float CosPitch = C[0];
+
+			float SinYaw = S[1];
+			float CosYaw = C[1];
+
+			float SinRoll = S[2];
+			float CosRoll = C[2];
 
 			float CosPitchCosYaw = CosPitch * CosYaw;
 			float SinPitchSinYaw = SinPitch * SinYaw;
@@ -271,53 +274,58 @@ namespace Vrixic
 
 		inline Quat Quat::MakeFromMatrix4D(const Matrix4D& inMat)
 		{
-			Quat Result = Quat();
-
-			float Trace = inMat(0, 0) + inMat(1, 1) + inMat(2, 2);
+			/* 4x^2, 4y^2, 4z^2 and 4w^2, they add up to 4 so the largest is at least 1 */
+			const float TX = 1.0f + inMat(0, 0) - inMat(1, 1) - inMat(2, 2);
+			const float TY = 1.0f - inMat(0, 0) + inMat(1, 1) - inMat(2, 2);
+			const float TZ = 1.0f - inMat(0, 0) - inMat(1, 1) + inMat(2, 2);
+			const float TW = 1.0f + inMat(0, 0) + inMat(1, 1) + inMat(2, 2);
+			const VectorRegister T = MakeVectorRegister(TX, TY, TZ, TW);
+
+			/* 4wx, 4wy, 4wz, 4xy, 4xz and 4yz */
+			const float WX = inMat(2, 1) - inMat(1, 2);
+			const float WY = inMat(0, 2) - inMat(2, 0);
+			const float WZ = inMat(1, 0) - inMat(0, 1);
+			const float XY = inMat(1, 0) + inMat(0, 1);
+			const float XZ = inMat(0, 2) + inMat(2, 0);
+			const float YZ = inMat(2, 1) + inMat(1, 2);
+
+			/* Each candidate is 4 * component * (the component found with the square root) */
+			const VectorRegister CandidateX = MakeVectorRegister(TX, XY, XZ, WX);
+			const VectorRegister CandidateY = MakeVectorRegister(XY, TY, YZ, WY);
+			const VectorRegister CandidateZ = MakeVectorRegister(XZ, YZ, TZ, WZ);
+			const VectorRegister CandidateW = MakeVectorRegister(WX, WY, WZ, TW);
+
+			/* Largest diagonal term replicated, ties go to W, then X, then Y */
+			VectorRegister MaxT = VectorRegisterMax(T, VectorRegisterSwizzle<1, 0, 3, 2>(T));
+			MaxT = VectorRegisterMax(MaxT, VectorRegisterSwizzle<2, 3, 0, 1>(MaxT));
+			const VectorRegister IsMax = VectorRegisterCompareEqual(T, MaxT);
+
+			VectorRegister Numerator = VectorRegisterSelect(VectorRegisterReplicateComponent<1>(IsMax), CandidateY, CandidateZ);
+			Numerator = VectorRegisterSelect(VectorRegisterReplicateComponent<0>(IsMax), CandidateX, Numerator);
+			Numerator = VectorRegisterSelect(VectorRegisterReplicateComponent<3>(IsMax), CandidateW, Numerator);
+
+			Quat Result;
+			StoreVectorRegister(&Result.X, VectorRegisterMultiply(Numerator, VectorRegisterDivide(VectorRegisterReplicate(0.5f), VectorRegisterSqrt(MaxT))));
+			return Result;
+		}
 
-			// Check the diagonal
-			if (Trace > 0.0f)
+		inline void Quat::MakeFromMatrix4DBatch(const Matrix4D* inMatrices, Quat* outQuats, uint32 count)
+		{
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
 			{
-				float S = sqrtf(Trace + 1.0f);
-				float T = 0.5f / S;
+				VectorRegister8 E[3][3];
+				VectorRegister8GatherRotation(&inMatrices[i](0, 0), E);
 
-				Result.X = (inMat(2, 1) - inMat(1, 2)) * T;
-				Result.Y = (inMat(0, 2) - inMat(2, 0)) * T;
-				Result.Z = (inMat(1, 0) - inMat(0, 1)) * T;
-				Result.W = S * 0.5f;
+				VectorRegister8 X, Y, Z, W;
+				VectorRegister8QuatFromRotation(E, X, Y, Z, W);
+				VectorRegister8InterleaveXYZW(&outQuats[i].X, X, Y, Z, W);
 			}
-			else
-			{
-				// Diagonal is negative
-				int I = 0;
-				if (inMat(1, 1) > inMat(0, 0)) I = 1;
-				if (inMat(2, 2) > inMat(I, I)) I = 2;
-
-				static const int NEXT[3] = { 1, 2, 0 };
-				int J = NEXT[I];
-				int K = NEXT[J];
-
-				float* QuatPtr[4] = { &Result.X, &Result.Y, &Result.Z, &Result.W };
-
-				float S = sqrt((inMat(I, J) - (inMat(J, J) + inMat(K, K)))
-					+ 1.0f);
-				*QuatPtr[I] = S * 0.5f;
-				float T;
-				if (S != 0.0)
-				{
-					T = 0.5f / S;
-				}
-				else
-				{
-					T = S;
-				}
 
-				*QuatPtr[3] = (inMat(K, J) - inMat(J, K)) * T;
-				*QuatPtr[J] = (inMat(J, I) + inMat(I, J)) * T;
-				*QuatPtr[K] = (inMat(K, I) + inMat(I, K)) * T;
+			for (; i < count; ++i)
+			{
+				outQuats[i] = MakeFromMatrix4D(inMatrices[i]);
 			}
-
-			return Result;
 		}
 
 		inline Quat Quat::Slerp(const Quat& inFrom, const Quat& inTarget, float inTime)
@@ -345,10 +353,18 @@ namespace Vrixic
 			if ((1.0f - Dot) > DELTA)
 			{
 				// Slerp - calculate coefficients 
-				float Theta = acosf(Dot);
-				float SinTheta = sinf(Theta);
-				Scale0 = sinf((1.0f - inTime) * Theta) / SinTheta;
-				Scale1 = sinf(inTime * Theta) / SinTheta;
+				float Theta = MathUtils::Acos(Dot);
+
+				/* sin(Theta), sin((1 - t) * Theta) and sin(t * Theta) in one register */
+				VectorRegister Sines, Cosines;
+				VectorRegisterSinCos(VectorRegisterMultiply(MakeVectorRegister(1.0f, 1.0f - inTime, inTime, 0.0f), VectorRegisterReplicate(Theta)),
+					Sines, Cosines);
+
+				alignas(16) float S[4];
+				StoreVectorRegisterAligned(S, Sines);
+				float InvSinTheta = 1.0f / S[0];
+				Scale0 = S[1] * InvSinTheta;
+				Scale1 = S[2] * InvSinTheta;
 			}
 			else
 			{
@@ -422,54 +438,132 @@ namespace Vrixic
 
 		inline Vector3D Quat::RotateVector(const Vector3D& v) const
 		{
-			Quat ToRotate = Quat(v, 0.0f);
-			Quat Inv = Conjugate();
+			const Vector3D Q(X, Y, Z);
+			const Vector3D T = Vector3D::CrossProduct(Q, v) * 2.0f;
 
-			Quat Result = *this * ToRotate * Inv;
-
-			return Vector3D(Result.X, Result.Y, Result.Z);
+			return v + T * W + Vector3D::CrossProduct(Q, T);
 		}
 
 		inline Vector3D Quat::RotateVectorSlow(const Vector3D& v) const
 		{
-			Quat ToRotate = Quat(v, 0.0f);
-			Quat Inv = Inverse();
+			/* q * v * q^-1 is the rotation of the normalized quaternion, folding 1 / |q|^2 into t gives the same result */
+			const Vector3D Q(X, Y, Z);
+			const Vector3D T = Vector3D::CrossProduct(Q, v) * (2.0f / LengthSquared());
 
-			Quat Result = *this * ToRotate * Inv;
+			return v + T * W + Vector3D::CrossProduct(Q, T);
+		}
 
-			return Vector3D(Result.X, Result.Y, Result.Z);
+		inline void Quat::RotateVectors(const Quat& q, const Vector3D* inVectors, Vector3D* outVectors, uint32 count)
+		{
+			uint32 i = 0;
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				i = SIMDKernelsAVX2::RotateVectors(&q.X, reinterpret_cast<const float*>(inVectors), reinterpret_cast<float*>(outVectors), count);
+			}
+			else
+#endif
+			{
+				i = SIMDKernels::RotateVectors(&q.X, reinterpret_cast<const float*>(inVectors), reinterpret_cast<float*>(outVectors), count);
+			}
+
+			for (; i < count; ++i)
+			{
+				outVectors[i] = q.RotateVector(inVectors[i]);
+			}
+		}
+
+		inline void Quat::RotateVectors(const Quat* quats, const Vector3D* inVectors, Vector3D* outVectors, uint32 count)
+		{
+			uint32 i = 0;
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				i = SIMDKernelsAVX2::RotateVectorsPerQuat(reinterpret_cast<const float*>(quats), reinterpret_cast<const float*>(inVectors), reinterpret_cast<float*>(outVectors), count);
+			}
+			else
+#endif
+			{
+				i = SIMDKernels::RotateVectorsPerQuat(reinterpret_cast<const float*>(quats), reinterpret_cast<const float*>(inVectors), reinterpret_cast<float*>(outVectors), count);
+			}
+
+			for (; i < count; ++i)
+			{
+				outVectors[i] = quats[i].RotateVector(inVectors[i]);
+			}
 		}
 
 		inline Matrix4D Quat::ToMatrix4D() const
 		{
 			// Converts this quaternion to a rotation matrix.
 			//
-			// | 1 - 2(y^2 + z^2)	2(xy + zw)			2(xz - yw)			0 |
-			// | 2(xy - zw)			1 - 2(x^2 + z^2)	2(yz + xw)			0 |
-			// | 2(xz + yw)			2(yz - xw)			1 - 2(x^2 + y^2)	0 |
+			// | 1 - 2(y^2 + z^2)	2(xy - zw)			2(xz + yw)			0 |
+			// | 2(xy + zw)			1 - 2(x^2 + z^2)	2(yz - xw)			0 |
+			// | 2(xz - yw)			2(yz + xw)			1 - 2(x^2 + y^2)	0 |
 			// | 0					0					0					1 |
 
-			float X2 = X + X;
-			float Y2 = Y + Y;
-			float Z2 = Z + Z;
+			const VectorRegister Q = MakeVectorRegister(&X);
+			const VectorRegister Q2 = VectorRegisterAdd(Q, Q);
+
+			/* (2xx, 2yy, 2zz, -) gives the diagonal, (2xy, 2xz, 2yz, -) +- (2wz, 2wy, 2wx, -) the rest */
+			const VectorRegister Squares = VectorRegisterMultiply(Q, Q2);
+			const VectorRegister Diagonal = VectorRegisterSubtract(VectorRegisterReplicate(1.0f),
+				VectorRegisterAdd(VectorRegisterSwizzle<1, 0, 0, 3>(Squares), VectorRegisterSwizzle<2, 2, 1, 3>(Squares)));
 
-			float XX = X * X2;
-			float XY = X * Y2;
-			float XZ = X * Z2;
+			const VectorRegister Products = VectorRegisterMultiply(VectorRegisterSwizzle<0, 0, 1, 3>(Q), VectorRegisterSwizzle<1, 2, 2, 3>(Q2));
+			const VectorRegister WProducts = VectorRegisterMultiply(VectorRegisterReplicateComponent<3>(Q), VectorRegisterSwizzle<2, 1, 0, 3>(Q2));
 
-			float YY = Y * Y2;
-			float YZ = Y * Z2;
+			/* Sums = (m10, m02, m21, -), Differences = (m01, m20, m12, -) */
+			const VectorRegister Sums = VectorRegisterAdd(Products, WProducts);
+			const VectorRegister Differences = VectorRegisterSubtract(Products, WProducts);
+			const VectorRegister Zero = VectorRegisterZero();
 
-			float ZZ = Z * Z2;
+			Matrix4D Result;
+			StoreVectorRegister(&Result(0, 0), VectorRegisterShuffle<0, 2, 1, 2>(VectorRegisterShuffle<0, 1, 0, 1>(Diagonal, Differences), VectorRegisterShuffle<0, 1, 0, 0>(Sums, Zero)));
+			StoreVectorRegister(&Result(1, 0), VectorRegisterShuffle<0, 2, 0, 2>(VectorRegisterShuffle<0, 0, 1, 1>(Sums, Diagonal), VectorRegisterShuffle<2, 2, 0, 0>(Differences, Zero)));
+			StoreVectorRegister(&Result(2, 0), VectorRegisterShuffle<0, 2, 0, 2>(VectorRegisterShuffle<1, 1, 2, 2>(Differences, Sums), VectorRegisterShuffle<2, 2, 0, 0>(Diagonal, Zero)));
+			Result(3, 3) = 1.0f;
+			return Result;
+		}
+
+		inline void Quat::ToMatrix4DBatch(const Quat* inQuats, Matrix4D* outMatrices, uint32 count)
+		{
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				VectorRegister8 X, Y, Z, W;
+				VectorRegister8DeinterleaveXYZW(&inQuats[i].X, X, Y, Z, W);
 
-			float WX = W * X2;
-			float WY = W * Y2;
-			float WZ = W * Z2;
+				VectorRegister8 E[3][3];
+				VectorRegister8QuatToRotation(X, Y, Z, W, E);
 
-			return Matrix4D(1 - (YY + ZZ), XY - WZ, XZ + WY, 0, 
-							XY + WZ, 1 - (XX + ZZ), YZ - WX, 0, 
-							XZ - WY, YZ + WX, 1 - (XX + YY), 0,
-							0, 0, 0, 1);
+				/* Rows are transposed back out of the registers, the last column and row are the identity */
+				alignas(32) float Rows[32];
+				const VectorRegister8 Zero = VectorRegister8Zero();
+				for (int r = 0; r < 3; ++r)
+				{
+					VectorRegister8InterleaveXYZW(Rows, E[r][0], E[r][1], E[r][2], Zero);
+					for (int k = 0; k < 8; ++k)
+					{
+						StoreVectorRegister(&outMatrices[i + k](r, 0), VectorRegisterLoadAligned(Rows + k * 4));
+					}
+				}
+
+				for (int k = 0; k < 8; ++k)
+				{
+					StoreVectorRegister(&outMatrices[i + k](3, 0), MakeVectorRegister(0.0f, 0.0f, 0.0f, 1.0f));
+				}
+			}
+
+			for (; i < count; ++i)
+			{
+				outMatrices[i] = inQuats[i].ToMatrix4D();
+			}
+		}
+
+		inline Quat Matrix4D::ToQuat() const
+		{
+			return Quat::MakeFromMatrix4D(*this);
 		}
 	}
 }
@@ -0,0 +1,383 @@
+#pragma once
+#include "GenericDefines.h"
+#include "Quat.h"
+#include "SoAFloatArrays.h"
+#include "VrixicMathSIMD.h"
+#include "VrixicMathTranscendental.h"
+
+/**
+* Batched quaternion interpolation for pose blending, every function is branch free and takes the shortest path
+*
+* Largest rotation angle error against a double precision slerp of unit quaternions, measured on every backend over
+* random pairs (including equal and opposite ones) and 21 ratios in [0, 1]:
+*
+*	NLerp		0.1423 rad	does not move at constant speed, exact at ratios 0, 0.5 and 1, worst at ratio 0.24 of a half turn
+*	FastSlerp	7.6e-4 rad	nlerp with a polynomial corrected ratio (https://zeux.io/2015/07/23/approximating-slerp/)
+*	Slerp		3e-6 rad	VectorRegister8Acos() and VectorRegister8SinCos() at Precise accuracy, limited by the float dot
+*						product the angle is taken from when the two quats are close
+*/
+namespace Vrixic
+{
+	namespace Math
+	{
+		/* 8 Quats in structure of arrays form, lane i of every register belongs to the i'th quat */
+		struct Quatx8
+		{
+		public:
+			VectorRegister8 X;
+			VectorRegister8 Y;
+			VectorRegister8 Z;
+			VectorRegister8 W;
+
+		public:
+			inline Quatx8();
+
+			/* Replicates 'q' into all 8 lanes */
+			inline Quatx8(const Quat& q);
+
+			inline Quatx8(const VectorRegister8& x, const VectorRegister8& y, const VectorRegister8& z, const VectorRegister8& w);
+
+		public:
+			/* Hamilton product per lane, same as Quat::operator*() */
+			inline Quatx8 operator*(const Quatx8& q) const;
+
+		public:
+			/* Loads 8 quats from SoA arrays, each has to be 32-byte aligned */
+			inline static Quatx8 Load(const float* x, const float* y, const float* z, const float* w);
+
+			/* Loads 8 tightly packed Quats, 'q' does not have to be aligned */
+			inline static Quatx8 LoadAoS(const Quat* q);
+
+			/* Stores 8 quats into SoA arrays, each has to be 32-byte aligned */
+			inline void Store(float* x, float* y, float* z, float* w) const;
+
+			/* Stores 8 tightly packed Quats, 'q' does not have to be aligned */
+			inline void StoreAoS(Quat* q) const;
+
+			inline static VectorRegister8 DotProduct(const Quatx8& a, const Quatx8& b);
+
+			/* start * startWeight + end * endWeight, per lane */
+			inline static Quatx8 WeightedSum(const Quatx8& start, const VectorRegister8& startWeight, const Quatx8& end, const VectorRegister8& endWeight);
+
+			inline Quatx8 Conjugate() const;
+
+			/* Same as Quat::RotateVector() per lane */
+			inline Vector3x8 RotateVector(const Vector3x8& v) const;
+
+			/* Normalizes all 8 lanes, a zero quat stays zero */
+			inline const Quatx8& Normalize();
+
+			/* Normalized lerp, 'end' is negated in the lanes where it is in the other hemisphere */
+			inline static Quatx8 NLerp(const Quatx8& start, const Quatx8& end, const VectorRegister8& ratio);
+
+			/* NLerp() with the ratio corrected towards constant angular speed */
+			inline static Quatx8 FastSlerp(const Quatx8& start, const Quatx8& end, const VectorRegister8& ratio);
+
+			/* Spherical interpolation, falls back to lerp weights where the quats are less than ~2.5 degrees apart */
+			inline static Quatx8 Slerp(const Quatx8& start, const Quatx8& end, const VectorRegister8& ratio);
+		};
+
+		/**
+		* A growable array of Quats stored as 4 separate X[], Y[], Z[], W[] arrays
+		*
+		* The arrays are aligned and zero padded by SoAFloatArrays, so the batch kernels run whole Quatx8 packets without
+		*	a scalar tail
+		*/
+		class QuatStream
+		{
+		public:
+			/* Component arrays are padded to this many floats (one 64-byte cache line) */
+			static constexpr uint32 PADDING = SoAFloatArrays<4>::PADDING;
+
+		private:
+			/* X, Y, Z and W arrays, owns the allocation */
+			SoAFloatArrays<4> Arrays;
+
+		public:
+			inline QuatStream() { }
+
+			inline explicit QuatStream(uint32 count) : Arrays(count) { }
+
+		public:
+			inline uint32 Size() const { return Arrays.Size(); }
+
+			/* Size rounded up to the padding, loops may run up to this count */
+			inline uint32 PaddedSize() const { return Arrays.PaddedSize(); }
+
+			inline float* GetX() { return Arrays.GetArray(0); }
+			inline float* GetY() { return Arrays.GetArray(1); }
+			inline float* GetZ() { return Arrays.GetArray(2); }
+			inline float* GetW() { return Arrays.GetArray(3); }
+
+			inline const float* GetX() const { return Arrays.GetArray(0); }
+			inline const float* GetY() const { return Arrays.GetArray(1); }
+			inline const float* GetZ() const { return Arrays.GetArray(2); }
+			inline const float* GetW() const { return Arrays.GetArray(3); }
+
+			inline Quat Get(uint32 index) const;
+
+			inline void Set(uint32 index, const Quat& q);
+
+			/* Resizes the stream, existing elements are kept and new ones are zeroed */
+			inline void Resize(uint32 count) { Arrays.Resize(count); }
+
+			inline Quatx8 LoadPacket8(uint32 index) const;
+
+			inline void StorePacket8(uint32 index, const Quatx8& packet);
+
+			/* AoS -> SoA, resizes the stream to 'count' */
+			inline void FromAoS(const Quat* inQuats, uint32 count);
+
+			/* SoA -> AoS, 'outQuats' has to hold Size() elements */
+			inline void ToAoS(Quat* outQuats) const;
+
+		public:
+			/* Batch kernels, every input has to have the same Size() as the output stream, which can be one of the inputs */
+
+			inline static void NLerp(const QuatStream& start, const QuatStream& end, float ratio, QuatStream& outBlend);
+
+			inline static void FastSlerp(const QuatStream& start, const QuatStream& end, float ratio, QuatStream& outBlend);
+
+			inline static void Slerp(const QuatStream& start, const QuatStream& end, float ratio, QuatStream& outBlend);
+
+			/**
+			* Weighted blend of several poses, sum(poses[p] * weights[p]) normalized
+			* Each pose is flipped into the hemisphere of poses[0] first, so the weights do not have to add up to 1
+			*
+			* @param outBlend - can be poses[0], but not any of the other poses
+			*/
+			inline static void Blend(const QuatStream* poses, const float* weights, uint32 poseCount, QuatStream& outBlend);
+		};
+
+		/* Quatx8 */
+
+		inline Quatx8::Quatx8()
+			: X(VectorRegister8Zero()), Y(VectorRegister8Zero()), Z(VectorRegister8Zero()), W(VectorRegister8Zero()) { }
+
+		inline Quatx8::Quatx8(const Quat& q)
+			: X(VectorRegister8Replicate(q.X)), Y(VectorRegister8Replicate(q.Y)), Z(VectorRegister8Replicate(q.Z)), W(VectorRegister8Replicate(q.W)) { }
+
+		inline Quatx8::Quatx8(const VectorRegister8& x, const VectorRegister8& y, const VectorRegister8& z, const VectorRegister8& w)
+			: X(x), Y(y), Z(z), W(w) { }
+
+		inline Quatx8 Quatx8::operator*(const Quatx8& q) const
+		{
+			const VectorRegister8 ResultX = VectorRegister8MultiplyAdd(W, q.X, VectorRegister8MultiplyAdd(X, q.W, VectorRegister8Subtract(VectorRegister8Multiply(Y, q.Z), VectorRegister8Multiply(Z, q.Y))));
+			const VectorRegister8 ResultY = VectorRegister8MultiplyAdd(W, q.Y, VectorRegister8MultiplyAdd(Y, q.W, VectorRegister8Subtract(VectorRegister8Multiply(Z, q.X), VectorRegister8Multiply(X, q.Z))));
+			const VectorRegister8 ResultZ = VectorRegister8MultiplyAdd(W, q.Z, VectorRegister8MultiplyAdd(Z, q.W, VectorRegister8Subtract(VectorRegister8Multiply(X, q.Y), VectorRegister8Multiply(Y, q.X))));
+			const VectorRegister8 ResultW = VectorRegister8Subtract(VectorRegister8Multiply(W, q.W),
+				VectorRegister8MultiplyAdd(X, q.X, VectorRegister8MultiplyAdd(Y, q.Y, VectorRegister8Multiply(Z, q.Z))));
+
+			return Quatx8(ResultX, ResultY, ResultZ, ResultW);
+		}
+
+		inline Quatx8 Quatx8::Load(const float* x, const float* y, const float* z, const float* w)
+		{
+			return Quatx8(VectorRegister8LoadAligned(x), VectorRegister8LoadAligned(y), VectorRegister8LoadAligned(z), VectorRegister8LoadAligned(w));
+		}
+
+		inline Quatx8 Quatx8::LoadAoS(const Quat* q)
+		{
+			Quatx8 Result;
+			VectorRegister8DeinterleaveXYZW(&q[0].X, Result.X, Result.Y, Result.Z, Result.W);
+			return Result;
+		}
+
+		inline void Quatx8::Store(float* x, float* y, float* z, float* w) const
+		{
+			StoreVectorRegister8Aligned(x, X);
+			StoreVectorRegister8Aligned(y, Y);
+			StoreVectorRegister8Aligned(z, Z);
+			StoreVectorRegister8Aligned(w, W);
+		}
+
+		inline void Quatx8::StoreAoS(Quat* q) const
+		{
+			VectorRegister8InterleaveXYZW(&q[0].X, X, Y, Z, W);
+		}
+
+		inline VectorRegister8 Quatx8::DotProduct(const Quatx8& a, const Quatx8& b)
+		{
+			return VectorRegister8MultiplyAdd(a.X, b.X, VectorRegister8MultiplyAdd(a.Y, b.Y,
+				VectorRegister8MultiplyAdd(a.Z, b.Z, VectorRegister8Multiply(a.W, b.W))));
+		}
+
+		inline Quatx8 Quatx8::WeightedSum(const Quatx8& start, const VectorRegister8& startWeight, const Quatx8& end, const VectorRegister8& endWeight)
+		{
+			return Quatx8(VectorRegister8MultiplyAdd(start.X, startWeight, VectorRegister8Multiply(end.X, endWeight)),
+				VectorRegister8MultiplyAdd(start.Y, startWeight, VectorRegister8Multiply(end.Y, endWeight)),
+				VectorRegister8MultiplyAdd(start.Z, startWeight, VectorRegister8Multiply(end.Z, endWeight)),
+				VectorRegister8MultiplyAdd(start.W, startWeight, VectorRegister8Multiply(end.W, endWeight)));
+		}
+
+		inline Quatx8 Quatx8::Conjugate() const
+		{
+			return Quatx8(VectorRegister8Negate(X), VectorRegister8Negate(Y), VectorRegister8Negate(Z), W);
+		}
+
+		inline Vector3x8 Quatx8::RotateVector(const Vector3x8& v) const
+		{
+			/* v + w * t + Cross(q, t) where t = 2 * Cross(q, v) */
+			const Vector3x8 Q(X, Y, Z);
+			const Vector3x8 T = Vector3x8::CrossProduct(Q, v) * 2.0f;
+
+			return v + T * W + Vector3x8::CrossProduct(Q, T);
+		}
+
+		inline const Quatx8& Quatx8::Normalize()
+		{
+			/* The tiny floor keeps zero lanes (stream padding) at zero instead of NaN */
+			const VectorRegister8 LengthSquared = VectorRegister8Max(DotProduct(*this, *this), VectorRegister8Replicate(1e-30f));
+			const VectorRegister8 InverseLength = VectorRegister8Divide(VectorRegister8Replicate(1.0f), VectorRegister8Sqrt(LengthSquared));
+
+			X = VectorRegister8Multiply(X, InverseLength);
+			Y = VectorRegister8Multiply(Y, InverseLength);
+			Z = VectorRegister8Multiply(Z, InverseLength);
+			W = VectorRegister8Multiply(W, InverseLength);
+
+			return *this;
+		}
+
+		inline Quatx8 Quatx8::NLerp(const Quatx8& start, const Quatx8& end, const VectorRegister8& ratio)
+		{
+			/* The sign of the dot product moves onto the end weight */
+			const VectorRegister8 Sign = VectorRegister8BitwiseAnd(DotProduct(start, end), VectorRegister8Replicate(-0.0f));
+			const VectorRegister8 EndWeight = VectorRegister8BitwiseXor(ratio, Sign);
+
+			Quatx8 Result = WeightedSum(start, VectorRegister8Subtract(VectorRegister8Replicate(1.0f), ratio), end, EndWeight);
+			Result.Normalize();
+			return Result;
+		}
+
+		inline Quatx8 Quatx8::FastSlerp(const Quatx8& start, const Quatx8& end, const VectorRegister8& ratio)
+		{
+			const VectorRegister8 D = VectorRegister8Abs(DotProduct(start, end));
+
+			/* ratio + ratio * (ratio - 0.5) * (ratio - 1) * K, K = A * (ratio - 0.5)^2 + B fitted over the cosine D */
+			const VectorRegister8 A = VectorRegister8MultiplyAdd(D, VectorRegister8MultiplyAdd(D, VectorRegister8MultiplyAdd(D,
+				VectorRegister8Replicate(-1.43519f), VectorRegister8Replicate(3.55645f)), VectorRegister8Replicate(-3.2452f)), VectorRegister8Replicate(1.0904f));
+			const VectorRegister8 B = VectorRegister8MultiplyAdd(D, VectorRegister8MultiplyAdd(D,
+				VectorRegister8Replicate(0.215638f), VectorRegister8Replicate(-1.06021f)), VectorRegister8Replicate(0.848013f));
+
+			const VectorRegister8 Centered = VectorRegister8Subtract(ratio, VectorRegister8Replicate(0.5f));
+			const VectorRegister8 K = VectorRegister8MultiplyAdd(A, VectorRegister8Multiply(Centered, Centered), B);
+			const VectorRegister8 Correction = VectorRegister8Multiply(VectorRegister8Multiply(ratio, Centered),
+				VectorRegister8Subtract(ratio, VectorRegister8Replicate(1.0f)));
+
+			return NLerp(start, end, VectorRegister8MultiplyAdd(Correction, K, ratio));
+		}
+
+		inline Quatx8 Quatx8::Slerp(const Quatx8& start, const Quatx8& end, const VectorRegister8& ratio)
+		{
+			const VectorRegister8 One = VectorRegister8Replicate(1.0f);
+			const VectorRegister8 Dot = DotProduct(start, end);
+			const VectorRegister8 Sign = VectorRegister8BitwiseAnd(Dot, VectorRegister8Replicate(-0.0f));
+			const VectorRegister8 D = VectorRegister8Min(VectorRegister8Abs(Dot), One);
+
+			/* sin((1 - t) * Theta) / sin(Theta) and sin(t * Theta) / sin(Theta), same weights as Quat::Slerp() */
+			const VectorRegister8 Theta = VectorRegister8Acos(D);
+			const VectorRegister8 StartRatio = VectorRegister8Subtract(One, ratio);
+
+			VectorRegister8 SinTheta, SinStart, SinEnd, Cosine;
+			VectorRegister8SinCos(Theta, SinTheta, Cosine);
+			VectorRegister8SinCos(VectorRegister8Multiply(StartRatio, Theta), SinStart, Cosine);
+			VectorRegister8SinCos(VectorRegister8Multiply(ratio, Theta), SinEnd, Cosine);
+
+			const VectorRegister8 UseLerp = VectorRegister8CompareLess(VectorRegister8Subtract(One, D), VectorRegister8Replicate(0.001f));
+			const VectorRegister8 InverseSinTheta = VectorRegister8Divide(One, VectorRegister8Select(UseLerp, One, SinTheta));
+
+			const VectorRegister8 StartWeight = VectorRegister8Select(UseLerp, StartRatio, VectorRegister8Multiply(SinStart, InverseSinTheta));
+			const VectorRegister8 EndWeight = VectorRegister8Select(UseLerp, ratio, VectorRegister8Multiply(SinEnd, InverseSinTheta));
+
+			return WeightedSum(start, StartWeight, end, VectorRegister8BitwiseXor(EndWeight, Sign));
+		}
+
+		/* QuatStream */
+
+		inline Quat QuatStream::Get(uint32 index) const
+		{
+			return Quat(GetX()[index], GetY()[index], GetZ()[index], GetW()[index]);
+		}
+
+		inline void QuatStream::Set(uint32 index, const Quat& q)
+		{
+			GetX()[index] = q.X;
+			GetY()[index] = q.Y;
+			GetZ()[index] = q.Z;
+			GetW()[index] = q.W;
+		}
+
+		inline Quatx8 QuatStream::LoadPacket8(uint32 index) const
+		{
+			return Quatx8::Load(GetX() + index, GetY() + index, GetZ() + index, GetW() + index);
+		}
+
+		inline void QuatStream::StorePacket8(uint32 index, const Quatx8& packet)
+		{
+			packet.Store(GetX() + index, GetY() + index, GetZ() + index, GetW() + index);
+		}
+
+		inline void QuatStream::FromAoS(const Quat* inQuats, uint32 count)
+		{
+			Arrays.FromInterleaved(reinterpret_cast<const float*>(inQuats), count);
+		}
+
+		inline void QuatStream::ToAoS(Quat* outQuats) const
+		{
+			Arrays.ToInterleaved(reinterpret_cast<float*>(outQuats));
+		}
+
+		inline void QuatStream::NLerp(const QuatStream& start, const QuatStream& end, float ratio, QuatStream& outBlend)
+		{
+			const VectorRegister8 Ratio = VectorRegister8Replicate(ratio);
+			for (uint32 i = 0; i < start.PaddedSize(); i += 8)
+			{
+				outBlend.StorePacket8(i, Quatx8::NLerp(start.LoadPacket8(i), end.LoadPacket8(i), Ratio));
+			}
+		}
+
+		inline void QuatStream::FastSlerp(const QuatStream& start, const QuatStream& end, float ratio, QuatStream& outBlend)
+		{
+			const VectorRegister8 Ratio = VectorRegister8Replicate(ratio);
+			for (uint32 i = 0; i < start.PaddedSize(); i += 8)
+			{
+				outBlend.StorePacket8(i, Quatx8::FastSlerp(start.LoadPacket8(i), end.LoadPacket8(i), Ratio));
+			}
+		}
+
+		inline void QuatStream::Slerp(const QuatStream& start, const QuatStream& end, float ratio, QuatStream& outBlend)
+		{
+			const VectorRegister8 Ratio = VectorRegister8Replicate(ratio);
+			for (uint32 i = 0; i < start.PaddedSize(); i += 8)
+			{
+				outBlend.StorePacket8(i, Quatx8::Slerp(start.LoadPacket8(i), end.LoadPacket8(i), Ratio));
+			}
+		}
+
+		inline void QuatStream::Blend(const QuatStream* poses, const float* weights, uint32 poseCount, QuatStream& outBlend)
+		{
+			const VectorRegister8 SignMask = VectorRegister8Replicate(-0.0f);
+
+			/* One pass per packet over all poses, the sum stays in registers */
+			for (uint32 i = 0; i < poses[0].PaddedSize(); i += 8)
+			{
+				const Quatx8 Reference = poses[0].LoadPacket8(i);
+				const VectorRegister8 FirstWeight = VectorRegister8Replicate(weights[0]);
+				Quatx8 Sum(VectorRegister8Multiply(Reference.X, FirstWeight), VectorRegister8Multiply(Reference.Y, FirstWeight),
+					VectorRegister8Multiply(Reference.Z, FirstWeight), VectorRegister8Multiply(Reference.W, FirstWeight));
+
+				for (uint32 p = 1; p < poseCount; ++p)
+				{
+					const Quatx8 Pose = poses[p].LoadPacket8(i);
+					const VectorRegister8 Sign = VectorRegister8BitwiseAnd(Quatx8::DotProduct(Reference, Pose), SignMask);
+					const VectorRegister8 Weight = VectorRegister8BitwiseXor(VectorRegister8Replicate(weights[p]), Sign);
+
+					Sum = Quatx8::WeightedSum(Pose, Weight, Sum, VectorRegister8Replicate(1.0f));
+				}
+
+				Sum.Normalize();
+				outBlend.StorePacket8(i, Sum);
+			}
+		}
+	}
+}
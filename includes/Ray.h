@@ -1,10 +1,21 @@
 #pragma once
+#include "GenericDefines.h"
+#include "VrixicMathHelper.h"
+#include "Plane.h"
 #include "Vector3D.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Vrixic
 {
 	namespace Math
 	{
+		/**
+		* Every intersection test returns true when the ray hits within [0, maxDistance] and writes the distance along the
+		* ray to 'outDistance', which is only written on a hit. Distances are in units of Direction, so they are world
+		* units unless the ray was created with an unnormalized direction and inIsNormalized set
+		*/
 		class Ray
 		{
 			/** Origin point of the Ray*/
@@ -13,6 +24,12 @@ namespace Vrixic
 			/** Direction vector of the Ray */
 			Vector3D Direction;
 
+			/** 1 / Direction per component, a zero component gets +-1e30 so the slab test never multiplies 0 by infinity */
+			Vector3D InverseDirection;
+
+			/** Bit i is set when component i of Direction is negative, selects the near side of each slab */
+			uint32 SignBits;
+
 		public:
 			/**
 			* Creates a defaut ray with 0 as origin, and forward as direction
@@ -31,20 +48,51 @@ namespace Vrixic
 		public:
 			/**
 			* Calculates a point on ray at position specified by paramater
-			* 
+			*
 			* @param inScalar - Distance from origin along the Ray
 			* @return Vector3D a point on Ray
 			*/
-			Vector3D PointAtPosition(float inScalar) const;
+			inline Vector3D PointAtPosition(float inScalar) const;
+
+			inline const Vector3D& GetOrigin() const;
+
+			inline const Vector3D& GetDirection() const;
+
+			inline const Vector3D& GetInverseDirection() const;
+
+			inline uint32 GetSignBits() const;
+
+			/* Slab test, the distance is where the ray enters the box or 0 when the origin is inside */
+			inline bool IntersectAABB(const Vector3D& aabbMin, const Vector3D& aabbMax, float maxDistance, float& outDistance) const;
+
+			/* Needs a unit length direction, the distance is where the ray enters the sphere or where it leaves it when the origin is inside */
+			inline bool IntersectSphere(const Vector3D& center, float radius, float maxDistance, float& outDistance) const;
+
+			/* Both sides of the plane, a ray parallel to the plane never hits */
+			inline bool IntersectPlane(const Plane& plane, float maxDistance, float& outDistance) const;
+
+			/**
+			* Moller-Trumbore, both sides of the triangle
+			*
+			* @param outU - barycentric weight of 'v1' at the hit point, only written on a hit
+			* @param outV - barycentric weight of 'v2' at the hit point, 'v0' has 1 - outU - outV
+			*/
+			inline bool IntersectTriangle(const Vector3D& v0, const Vector3D& v1, const Vector3D& v2, float maxDistance,
+				float& outDistance, float& outU, float& outV) const;
+
+		private:
+			inline void UpdateInverseDirection();
 		};
 
-		Ray::Ray()
+		inline Ray::Ray()
 		{
 			Origin = Vector3D::ZeroVector();
-			Direction = Vector3D(0, 0, 1); 
+			Direction = Vector3D(0, 0, 1);
+
+			UpdateInverseDirection();
 		}
 
-		Ray::Ray(const Vector3D& inOrigin, const Vector3D& inDirection, bool inIsNormalized)
+		inline Ray::Ray(const Vector3D& inOrigin, const Vector3D& inDirection, bool inIsNormalized)
 		{
 			Origin = inOrigin;
 			Direction = inDirection;
@@ -53,11 +101,155 @@ namespace Vrixic
 			{
 				Direction.Normalize();
 			}
+
+			UpdateInverseDirection();
 		}
 
-		Vector3D Ray::PointAtPosition(float inScalar) const
+		inline Vector3D Ray::PointAtPosition(float inScalar) const
 		{
 			return Origin + (Direction * inScalar);
 		}
+
+		inline const Vector3D& Ray::GetOrigin() const
+		{
+			return Origin;
+		}
+
+		inline const Vector3D& Ray::GetDirection() const
+		{
+			return Direction;
+		}
+
+		inline const Vector3D& Ray::GetInverseDirection() const
+		{
+			return InverseDirection;
+		}
+
+		inline uint32 Ray::GetSignBits() const
+		{
+			return SignBits;
+		}
+
+		inline bool Ray::IntersectAABB(const Vector3D& aabbMin, const Vector3D& aabbMax, float maxDistance, float& outDistance) const
+		{
+			/* The sign bits pick the near and far plane of each slab, no min/max per axis */
+			const bool NegativeX = (SignBits & 1) != 0;
+			const bool NegativeY = (SignBits & 2) != 0;
+			const bool NegativeZ = (SignBits & 4) != 0;
+
+			float Entry = ((NegativeX ? aabbMax.X : aabbMin.X) - Origin.X) * InverseDirection.X;
+			float Exit = ((NegativeX ? aabbMin.X : aabbMax.X) - Origin.X) * InverseDirection.X;
+
+			Entry = std::max(Entry, ((NegativeY ? aabbMax.Y : aabbMin.Y) - Origin.Y) * InverseDirection.Y);
+			Exit = std::min(Exit, ((NegativeY ? aabbMin.Y : aabbMax.Y) - Origin.Y) * InverseDirection.Y);
+
+			Entry = std::max(Entry, ((NegativeZ ? aabbMax.Z : aabbMin.Z) - Origin.Z) * InverseDirection.Z);
+			Exit = std::min(Exit, ((NegativeZ ? aabbMin.Z : aabbMax.Z) - Origin.Z) * InverseDirection.Z);
+
+			Entry = std::max(Entry, 0.0f);
+			Exit = std::min(Exit, maxDistance);
+
+			if (Entry > Exit)
+			{
+				return false;
+			}
+
+			outDistance = Entry;
+			return true;
+		}
+
+		inline bool Ray::IntersectSphere(const Vector3D& center, float radius, float maxDistance, float& outDistance) const
+		{
+			/* t^2 + 2bt + c = 0 with b = dot(o - center, d) and c = |o - center|^2 - radius^2 */
+			const Vector3D ToOrigin = Origin - center;
+			const float B = Vector3D::DotProduct(ToOrigin, Direction);
+			const float C = Vector3D::DotProduct(ToOrigin, ToOrigin) - radius * radius;
+			const float Discriminant = B * B - C;
+
+			if (Discriminant < 0.0f)
+			{
+				return false;
+			}
+
+			const float Root = std::sqrt(Discriminant);
+			const float Distance = (-B - Root) >= 0.0f ? -B - Root : -B + Root;
+
+			if (Distance < 0.0f || Distance > maxDistance)
+			{
+				return false;
+			}
+
+			outDistance = Distance;
+			return true;
+		}
+
+		inline bool Ray::IntersectPlane(const Plane& plane, float maxDistance, float& outDistance) const
+		{
+			const float Denominator = Plane::Dot(plane, Direction);
+			if (Denominator == 0.0f)
+			{
+				return false;
+			}
+
+			const float Distance = (plane.Distance - Plane::Dot(plane, Origin)) / Denominator;
+			if (Distance < 0.0f || Distance > maxDistance)
+			{
+				return false;
+			}
+
+			outDistance = Distance;
+			return true;
+		}
+
+		inline bool Ray::IntersectTriangle(const Vector3D& v0, const Vector3D& v1, const Vector3D& v2, float maxDistance,
+			float& outDistance, float& outU, float& outV) const
+		{
+			const Vector3D Edge1 = v1 - v0;
+			const Vector3D Edge2 = v2 - v0;
+
+			const Vector3D P = Vector3D::CrossProduct(Direction, Edge2);
+			const float Determinant = Vector3D::DotProduct(Edge1, P);
+
+			/* Parallel to the triangle, or a degenerate triangle */
+			if (std::abs(Determinant) < 1e-12f)
+			{
+				return false;
+			}
+
+			const float InverseDeterminant = 1.0f / Determinant;
+			const Vector3D ToOrigin = Origin - v0;
+
+			const float U = Vector3D::DotProduct(ToOrigin, P) * InverseDeterminant;
+			if (U < 0.0f || U > 1.0f)
+			{
+				return false;
+			}
+
+			const Vector3D Q = Vector3D::CrossProduct(ToOrigin, Edge1);
+			const float V = Vector3D::DotProduct(Direction, Q) * InverseDeterminant;
+			if (V < 0.0f || U + V > 1.0f)
+			{
+				return false;
+			}
+
+			const float Distance = Vector3D::DotProduct(Edge2, Q) * InverseDeterminant;
+			if (Distance < 0.0f || Distance > maxDistance)
+			{
+				return false;
+			}
+
+			outDistance = Distance;
+			outU = U;
+			outV = V;
+			return true;
+		}
+
+		inline void Ray::UpdateInverseDirection()
+		{
+			const auto Inverse = [](float d) { return std::abs(d) < 1e-30f ? std::copysign(1e30f, d) : 1.0f / d; };
+
+			InverseDirection = Vector3D(Inverse(Direction.X), Inverse(Direction.Y), Inverse(Direction.Z));
+			SignBits = (std::signbit(Direction.X) ? 1u : 0u) | (std::signbit(Direction.Y) ? 2u : 0u) | (std::signbit(Direction.Z) ? 4u : 0u);
+		}
 	}
 }
@@ -0,0 +1,316 @@
+#pragma once
+#include "GenericDefines.h"
+#include "Plane.h"
+#include "Ray.h"
+#include "Vector3D.h"
+#include "Vector3DStream.h"
+#include "VrixicMathSIMD.h"
+
+/**
+* 4 and 8 wide ray packets, every test runs all rays of the packet against one primitive
+*
+* Each test returns a lane mask (all bits set for a hit) and follows the same rules as the matching Ray test. Lanes of
+* the out registers are only written where the ray hits, so passing the closest distance found so far as both
+* 'maxDistance' and 'outDistance' keeps the closest hit per ray:
+*
+*	VectorRegister Closest = VectorRegisterReplicate(FarDistance);
+*	for (...) Packet.IntersectTriangle(V0, V1, V2, Closest, Closest, U, V);
+*
+* Packets are meant to be built once and tested against many primitives, gathering the rays costs about as much as one
+* test. With AVX2 a RayPacket8 needs 32-byte alignment, which std::vector does not give before C++17
+*/
+namespace Vrixic
+{
+	namespace Math
+	{
+		struct RayPacket4
+		{
+		public:
+			Vector3x4 Origin;
+			Vector3x4 Direction;
+			Vector3x4 InverseDirection;
+
+		public:
+			inline RayPacket4();
+
+			/* Gathers rays[0] to rays[3] */
+			inline explicit RayPacket4(const Ray* rays);
+
+		public:
+			inline VectorRegister IntersectAABB(const Vector3D& aabbMin, const Vector3D& aabbMax, const VectorRegister& maxDistance,
+				VectorRegister& outDistance) const;
+
+			/* Needs unit length directions */
+			inline VectorRegister IntersectSphere(const Vector3D& center, float radius, const VectorRegister& maxDistance,
+				VectorRegister& outDistance) const;
+
+			inline VectorRegister IntersectPlane(const Plane& plane, const VectorRegister& maxDistance, VectorRegister& outDistance) const;
+
+			inline VectorRegister IntersectTriangle(const Vector3D& v0, const Vector3D& v1, const Vector3D& v2, const VectorRegister& maxDistance,
+				VectorRegister& outDistance, VectorRegister& outU, VectorRegister& outV) const;
+
+		private:
+			inline static VectorRegister CompareLessEqual(const VectorRegister& a, const VectorRegister& b);
+
+			/* a <= b <= c per lane */
+			inline static VectorRegister CompareInRange(const VectorRegister& a, const VectorRegister& b, const VectorRegister& c);
+		};
+
+		struct RayPacket8
+		{
+		public:
+			Vector3x8 Origin;
+			Vector3x8 Direction;
+			Vector3x8 InverseDirection;
+
+		public:
+			inline RayPacket8();
+
+			/* Gathers rays[0] to rays[7] */
+			inline explicit RayPacket8(const Ray* rays);
+
+		public:
+			inline VectorRegister8 IntersectAABB(const Vector3D& aabbMin, const Vector3D& aabbMax, const VectorRegister8& maxDistance,
+				VectorRegister8& outDistance) const;
+
+			/* Needs unit length directions */
+			inline VectorRegister8 IntersectSphere(const Vector3D& center, float radius, const VectorRegister8& maxDistance,
+				VectorRegister8& outDistance) const;
+
+			inline VectorRegister8 IntersectPlane(const Plane& plane, const VectorRegister8& maxDistance, VectorRegister8& outDistance) const;
+
+			inline VectorRegister8 IntersectTriangle(const Vector3D& v0, const Vector3D& v1, const Vector3D& v2, const VectorRegister8& maxDistance,
+				VectorRegister8& outDistance, VectorRegister8& outU, VectorRegister8& outV) const;
+
+		private:
+			inline static VectorRegister8 CompareLessEqual(const VectorRegister8& a, const VectorRegister8& b);
+
+			/* a <= b <= c per lane */
+			inline static VectorRegister8 CompareInRange(const VectorRegister8& a, const VectorRegister8& b, const VectorRegister8& c);
+		};
+
+		/* RayPacket4 */
+
+		inline RayPacket4::RayPacket4() { }
+
+		inline RayPacket4::RayPacket4(const Ray* rays)
+		{
+			Vector3D Origins[4], Directions[4], InverseDirections[4];
+			for (uint32 i = 0; i < 4; ++i)
+			{
+				Origins[i] = rays[i].GetOrigin();
+				Directions[i] = rays[i].GetDirection();
+				InverseDirections[i] = rays[i].GetInverseDirection();
+			}
+
+			Origin = Vector3x4::LoadAoS(Origins);
+			Direction = Vector3x4::LoadAoS(Directions);
+			InverseDirection = Vector3x4::LoadAoS(InverseDirections);
+		}
+
+		inline VectorRegister RayPacket4::IntersectAABB(const Vector3D& aabbMin, const Vector3D& aabbMax, const VectorRegister& maxDistance,
+			VectorRegister& outDistance) const
+		{
+			/* The lanes can point different ways, so the near and far plane of each slab come from min/max */
+			const Vector3x4 ToMin = (Vector3x4(aabbMin) - Origin) * InverseDirection;
+			const Vector3x4 ToMax = (Vector3x4(aabbMax) - Origin) * InverseDirection;
+
+			VectorRegister Entry = VectorRegisterMax(VectorRegisterMin(ToMin.X, ToMax.X), VectorRegisterZero());
+			VectorRegister Exit = VectorRegisterMin(VectorRegisterMax(ToMin.X, ToMax.X), maxDistance);
+			Entry = VectorRegisterMax(Entry, VectorRegisterMax(VectorRegisterMin(ToMin.Y, ToMax.Y), VectorRegisterMin(ToMin.Z, ToMax.Z)));
+			Exit = VectorRegisterMin(Exit, VectorRegisterMin(VectorRegisterMax(ToMin.Y, ToMax.Y), VectorRegisterMax(ToMin.Z, ToMax.Z)));
+
+			const VectorRegister Hit = CompareLessEqual(Entry, Exit);
+			outDistance = VectorRegisterSelect(Hit, Entry, outDistance);
+			return Hit;
+		}
+
+		inline VectorRegister RayPacket4::IntersectSphere(const Vector3D& center, float radius, const VectorRegister& maxDistance,
+			VectorRegister& outDistance) const
+		{
+			const Vector3x4 ToOrigin = Origin - Vector3x4(center);
+			const VectorRegister B = Vector3x4::DotProduct(ToOrigin, Direction);
+			const VectorRegister C = VectorRegisterSubtract(ToOrigin.LengthSquared(), VectorRegisterReplicate(radius * radius));
+			const VectorRegister Discriminant = VectorRegisterSubtract(VectorRegisterMultiply(B, B), C);
+
+			/* Lanes that miss take the root of 0 and are masked out below */
+			const VectorRegister Root = VectorRegisterSqrt(VectorRegisterMax(Discriminant, VectorRegisterZero()));
+			const VectorRegister Near = VectorRegisterSubtract(VectorRegisterNegate(B), Root);
+			const VectorRegister Far = VectorRegisterAdd(VectorRegisterNegate(B), Root);
+			const VectorRegister Distance = VectorRegisterSelect(CompareLessEqual(VectorRegisterZero(), Near), Near, Far);
+
+			const VectorRegister Hit = VectorRegisterBitwiseAnd(CompareLessEqual(VectorRegisterZero(), Discriminant),
+				CompareInRange(VectorRegisterZero(), Distance, maxDistance));
+			outDistance = VectorRegisterSelect(Hit, Distance, outDistance);
+			return Hit;
+		}
+
+		inline VectorRegister RayPacket4::IntersectPlane(const Plane& plane, const VectorRegister& maxDistance, VectorRegister& outDistance) const
+		{
+			const Vector3x4 Normal(plane.GetNormal());
+			const VectorRegister Denominator = Vector3x4::DotProduct(Normal, Direction);
+			const VectorRegister Distance = VectorRegisterDivide(
+				VectorRegisterSubtract(VectorRegisterReplicate(plane.Distance), Vector3x4::DotProduct(Normal, Origin)), Denominator);
+
+			/* Parallel lanes divide by zero, their infinity or NaN is masked out by the first compare */
+			const VectorRegister Hit = VectorRegisterBitwiseAnd(VectorRegisterCompareGreater(VectorRegisterAbs(Denominator), VectorRegisterZero()),
+				CompareInRange(VectorRegisterZero(), Distance, maxDistance));
+			outDistance = VectorRegisterSelect(Hit, Distance, outDistance);
+			return Hit;
+		}
+
+		inline VectorRegister RayPacket4::IntersectTriangle(const Vector3D& v0, const Vector3D& v1, const Vector3D& v2, const VectorRegister& maxDistance,
+			VectorRegister& outDistance, VectorRegister& outU, VectorRegister& outV) const
+		{
+			const Vector3x4 Edge1(v1 - v0);
+			const Vector3x4 Edge2(v2 - v0);
+
+			const Vector3x4 P = Vector3x4::CrossProduct(Direction, Edge2);
+			const VectorRegister Determinant = Vector3x4::DotProduct(Edge1, P);
+			const VectorRegister InverseDeterminant = VectorRegisterDivide(VectorRegisterReplicate(1.0f), Determinant);
+
+			const Vector3x4 ToOrigin = Origin - Vector3x4(v0);
+			const VectorRegister U = VectorRegisterMultiply(Vector3x4::DotProduct(ToOrigin, P), InverseDeterminant);
+
+			const Vector3x4 Q = Vector3x4::CrossProduct(ToOrigin, Edge1);
+			const VectorRegister V = VectorRegisterMultiply(Vector3x4::DotProduct(Direction, Q), InverseDeterminant);
+			const VectorRegister Distance = VectorRegisterMultiply(Vector3x4::DotProduct(Edge2, Q), InverseDeterminant);
+
+			const VectorRegister Zero = VectorRegisterZero();
+			const VectorRegister One = VectorRegisterReplicate(1.0f);
+
+			VectorRegister Hit = VectorRegisterCompareGreater(VectorRegisterAbs(Determinant), VectorRegisterReplicate(1e-12f));
+			Hit = VectorRegisterBitwiseAnd(Hit, CompareInRange(Zero, U, One));
+			Hit = VectorRegisterBitwiseAnd(Hit, CompareLessEqual(Zero, V));
+			Hit = VectorRegisterBitwiseAnd(Hit, CompareLessEqual(VectorRegisterAdd(U, V), One));
+			Hit = VectorRegisterBitwiseAnd(Hit, CompareInRange(Zero, Distance, maxDistance));
+
+			outDistance = VectorRegisterSelect(Hit, Distance, outDistance);
+			outU = VectorRegisterSelect(Hit, U, outU);
+			outV = VectorRegisterSelect(Hit, V, outV);
+			return Hit;
+		}
+
+		inline VectorRegister RayPacket4::CompareLessEqual(const VectorRegister& a, const VectorRegister& b)
+		{
+			return VectorRegisterBitwiseOr(VectorRegisterCompareLess(a, b), VectorRegisterCompareEqual(a, b));
+		}
+
+		inline VectorRegister RayPacket4::CompareInRange(const VectorRegister& a, const VectorRegister& b, const VectorRegister& c)
+		{
+			return VectorRegisterBitwiseAnd(CompareLessEqual(a, b), CompareLessEqual(b, c));
+		}
+
+		/* RayPacket8 */
+
+		inline RayPacket8::RayPacket8() { }
+
+		inline RayPacket8::RayPacket8(const Ray* rays)
+		{
+			Vector3D Origins[8], Directions[8], InverseDirections[8];
+			for (uint32 i = 0; i < 8; ++i)
+			{
+				Origins[i] = rays[i].GetOrigin();
+				Directions[i] = rays[i].GetDirection();
+				InverseDirections[i] = rays[i].GetInverseDirection();
+			}
+
+			Origin = Vector3x8::LoadAoS(Origins);
+			Direction = Vector3x8::LoadAoS(Directions);
+			InverseDirection = Vector3x8::LoadAoS(InverseDirections);
+		}
+
+		inline VectorRegister8 RayPacket8::IntersectAABB(const Vector3D& aabbMin, const Vector3D& aabbMax, const VectorRegister8& maxDistance,
+			VectorRegister8& outDistance) const
+		{
+			/* The lanes can point different ways, so the near and far plane of each slab come from min/max */
+			const Vector3x8 ToMin = (Vector3x8(aabbMin) - Origin) * InverseDirection;
+			const Vector3x8 ToMax = (Vector3x8(aabbMax) - Origin) * InverseDirection;
+
+			VectorRegister8 Entry = VectorRegister8Max(VectorRegister8Min(ToMin.X, ToMax.X), VectorRegister8Zero());
+			VectorRegister8 Exit = VectorRegister8Min(VectorRegister8Max(ToMin.X, ToMax.X), maxDistance);
+			Entry = VectorRegister8Max(Entry, VectorRegister8Max(VectorRegister8Min(ToMin.Y, ToMax.Y), VectorRegister8Min(ToMin.Z, ToMax.Z)));
+			Exit = VectorRegister8Min(Exit, VectorRegister8Min(VectorRegister8Max(ToMin.Y, ToMax.Y), VectorRegister8Max(ToMin.Z, ToMax.Z)));
+
+			const VectorRegister8 Hit = CompareLessEqual(Entry, Exit);
+			outDistance = VectorRegister8Select(Hit, Entry, outDistance);
+			return Hit;
+		}
+
+		inline VectorRegister8 RayPacket8::IntersectSphere(const Vector3D& center, float radius, const VectorRegister8& maxDistance,
+			VectorRegister8& outDistance) const
+		{
+			const Vector3x8 ToOrigin = Origin - Vector3x8(center);
+			const VectorRegister8 B = Vector3x8::DotProduct(ToOrigin, Direction);
+			const VectorRegister8 C = VectorRegister8Subtract(ToOrigin.LengthSquared(), VectorRegister8Replicate(radius * radius));
+			const VectorRegister8 Discriminant = VectorRegister8Subtract(VectorRegister8Multiply(B, B), C);
+
+			/* Lanes that miss take the root of 0 and are masked out below */
+			const VectorRegister8 Root = VectorRegister8Sqrt(VectorRegister8Max(Discriminant, VectorRegister8Zero()));
+			const VectorRegister8 Near = VectorRegister8Subtract(VectorRegister8Negate(B), Root);
+			const VectorRegister8 Far = VectorRegister8Add(VectorRegister8Negate(B), Root);
+			const VectorRegister8 Distance = VectorRegister8Select(CompareLessEqual(VectorRegister8Zero(), Near), Near, Far);
+
+			const VectorRegister8 Hit = VectorRegister8BitwiseAnd(CompareLessEqual(VectorRegister8Zero(), Discriminant),
+				CompareInRange(VectorRegister8Zero(), Distance, maxDistance));
+			outDistance = VectorRegister8Select(Hit, Distance, outDistance);
+			return Hit;
+		}
+
+		inline VectorRegister8 RayPacket8::IntersectPlane(const Plane& plane, const VectorRegister8& maxDistance, VectorRegister8& outDistance) const
+		{
+			const Vector3x8 Normal(plane.GetNormal());
+			const VectorRegister8 Denominator = Vector3x8::DotProduct(Normal, Direction);
+			const VectorRegister8 Distance = VectorRegister8Divide(
+				VectorRegister8Subtract(VectorRegister8Replicate(plane.Distance), Vector3x8::DotProduct(Normal, Origin)), Denominator);
+
+			/* Parallel lanes divide by zero, their infinity or NaN is masked out by the first compare */
+			const VectorRegister8 Hit = VectorRegister8BitwiseAnd(VectorRegister8CompareGreater(VectorRegister8Abs(Denominator), VectorRegister8Zero()),
+				CompareInRange(VectorRegister8Zero(), Distance, maxDistance));
+			outDistance = VectorRegister8Select(Hit, Distance, outDistance);
+			return Hit;
+		}
+
+		inline VectorRegister8 RayPacket8::IntersectTriangle(const Vector3D& v0, const Vector3D& v1, const Vector3D& v2, const VectorRegister8& maxDistance,
+			VectorRegister8& outDistance, VectorRegister8& outU, VectorRegister8& outV) const
+		{
+			const Vector3x8 Edge1(v1 - v0);
+			const Vector3x8 Edge2(v2 - v0);
+
+			const Vector3x8 P = Vector3x8::CrossProduct(Direction, Edge2);
+			const VectorRegister8 Determinant = Vector3x8::DotProduct(Edge1, P);
+			const VectorRegister8 InverseDeterminant = VectorRegister8Divide(VectorRegister8Replicate(1.0f), Determinant);
+
+			const Vector3x8 ToOrigin = Origin - Vector3x8(v0);
+			const VectorRegister8 U = VectorRegister8Multiply(Vector3x8::DotProduct(ToOrigin, P), InverseDeterminant);
+
+			const Vector3x8 Q = Vector3x8::CrossProduct(ToOrigin, Edge1);
+			const VectorRegister8 V = VectorRegister8Multiply(Vector3x8::DotProduct(Direction, Q), InverseDeterminant);
+			const VectorRegister8 Distance = VectorRegister8Multiply(Vector3x8::DotProduct(Edge2, Q), InverseDeterminant);
+
+			const VectorRegister8 Zero = VectorRegister8Zero();
+			const VectorRegister8 One = VectorRegister8Replicate(1.0f);
+
+			VectorRegister8 Hit = VectorRegister8CompareGreater(VectorRegister8Abs(Determinant), VectorRegister8Replicate(1e-12f));
+			Hit = VectorRegister8BitwiseAnd(Hit, CompareInRange(Zero, U, One));
+			Hit = VectorRegister8BitwiseAnd(Hit, CompareLessEqual(Zero, V));
+			Hit = VectorRegister8BitwiseAnd(Hit, CompareLessEqual(VectorRegister8Add(U, V), One));
+			Hit = VectorRegister8BitwiseAnd(Hit, CompareInRange(Zero, Distance, maxDistance));
+
+			outDistance = VectorRegister8Select(Hit, Distance, outDistance);
+			outU = VectorRegister8Select(Hit, U, outU);
+			outV = VectorRegister8Select(Hit, V, outV);
+			return Hit;
+		}
+
+		inline VectorRegister8 RayPacket8::CompareLessEqual(const VectorRegister8& a, const VectorRegister8& b)
+		{
+			return VectorRegister8BitwiseOr(VectorRegister8CompareLess(a, b), VectorRegister8CompareEqual(a, b));
+		}
+
+		inline VectorRegister8 RayPacket8::CompareInRange(const VectorRegister8& a, const VectorRegister8& b, const VectorRegister8& c)
+		{
+			return VectorRegister8BitwiseAnd(CompareLessEqual(a, b), CompareLessEqual(b, c));
+		}
+	}
+}
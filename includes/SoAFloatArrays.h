@@ -0,0 +1,272 @@
+#pragma once
+#include "GenericDefines.h"
+#include "VrixicMathSIMD.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace Vrixic
+{
+	namespace Math
+	{
+		/**
+		* The storage behind Vector3DStream and QuatStream, 'ComponentCount' (3 or 4) float arrays of the same length in one
+		* allocation
+		*
+		* Every array starts on a 64-byte boundary and is padded with zeros up to a multiple of 16 floats,
+		*	so the batch kernels run whole 8 lane packets without a scalar tail
+		*/
+		template<uint32 ComponentCount>
+		class SoAFloatArrays
+		{
+		public:
+			/* Arrays are padded to this many floats (one 64-byte cache line) */
+			static constexpr uint32 PADDING = 16;
+
+		private:
+			/* Unaligned allocation that owns every array */
+			float* Buffer;
+
+			float* Arrays[ComponentCount];
+
+			uint32 Count;
+			uint32 Capacity;
+
+		public:
+			inline SoAFloatArrays();
+
+			inline explicit SoAFloatArrays(uint32 count);
+
+			inline SoAFloatArrays(const SoAFloatArrays& other);
+
+			inline SoAFloatArrays(SoAFloatArrays&& other) noexcept;
+
+			inline ~SoAFloatArrays();
+
+			inline SoAFloatArrays& operator=(const SoAFloatArrays& other);
+
+			inline SoAFloatArrays& operator=(SoAFloatArrays&& other) noexcept;
+
+		public:
+			inline uint32 Size() const { return Count; }
+
+			/* Size rounded up to the padding, loops may run up to this count */
+			inline uint32 PaddedSize() const { return (Count + PADDING - 1) & ~(PADDING - 1); }
+
+			inline float* GetArray(uint32 component) { return Arrays[component]; }
+
+			inline const float* GetArray(uint32 component) const { return Arrays[component]; }
+
+			/* Resizes every array, existing elements are kept and new ones are zeroed */
+			inline void Resize(uint32 count);
+
+			/* 'inElements' holds 'count' elements of ComponentCount tightly packed floats, resizes the arrays to 'count' */
+			inline void FromInterleaved(const float* inElements, uint32 count);
+
+			/* 'outElements' has to hold Size() elements of ComponentCount floats */
+			inline void ToInterleaved(float* outElements) const;
+
+		private:
+			inline void Allocate(uint32 capacity);
+
+			/* 8 interleaved elements <-> 8 floats of every array at 'index', overloaded on the component count */
+			inline static void DeinterleavePacket8(const float* in, float* const (&arrays)[3], uint32 index);
+
+			inline static void DeinterleavePacket8(const float* in, float* const (&arrays)[4], uint32 index);
+
+			inline static void InterleavePacket8(float* out, float* const (&arrays)[3], uint32 index);
+
+			inline static void InterleavePacket8(float* out, float* const (&arrays)[4], uint32 index);
+		};
+
+		template<uint32 ComponentCount>
+		inline SoAFloatArrays<ComponentCount>::SoAFloatArrays()
+			: Buffer(nullptr), Arrays(), Count(0), Capacity(0) { }
+
+		template<uint32 ComponentCount>
+		inline SoAFloatArrays<ComponentCount>::SoAFloatArrays(uint32 count)
+			: SoAFloatArrays()
+		{
+			Resize(count);
+		}
+
+		template<uint32 ComponentCount>
+		inline SoAFloatArrays<ComponentCount>::SoAFloatArrays(const SoAFloatArrays& other)
+			: SoAFloatArrays()
+		{
+			*this = other;
+		}
+
+		template<uint32 ComponentCount>
+		inline SoAFloatArrays<ComponentCount>::SoAFloatArrays(SoAFloatArrays&& other) noexcept
+			: SoAFloatArrays()
+		{
+			*this = std::move(other);
+		}
+
+		template<uint32 ComponentCount>
+		inline SoAFloatArrays<ComponentCount>::~SoAFloatArrays()
+		{
+			delete[] Buffer;
+		}
+
+		template<uint32 ComponentCount>
+		inline SoAFloatArrays<ComponentCount>& SoAFloatArrays<ComponentCount>::operator=(const SoAFloatArrays& other)
+		{
+			if (this != &other)
+			{
+				Count = 0;
+				Resize(other.Count);
+
+				const size_t Bytes = other.PaddedSize() * sizeof(float);
+				if (Bytes > 0)
+				{
+					for (uint32 c = 0; c < ComponentCount; ++c)
+					{
+						std::memcpy(Arrays[c], other.Arrays[c], Bytes);
+					}
+				}
+			}
+
+			return *this;
+		}
+
+		template<uint32 ComponentCount>
+		inline SoAFloatArrays<ComponentCount>& SoAFloatArrays<ComponentCount>::operator=(SoAFloatArrays&& other) noexcept
+		{
+			std::swap(Buffer, other.Buffer);
+			std::swap(Arrays, other.Arrays);
+			std::swap(Count, other.Count);
+			std::swap(Capacity, other.Capacity);
+
+			return *this;
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::Resize(uint32 count)
+		{
+			const uint32 OldCount = Count;
+			const uint32 OldPaddedSize = PaddedSize();
+			const uint32 NewPaddedSize = (count + PADDING - 1) & ~(PADDING - 1);
+
+			if (NewPaddedSize > Capacity)
+			{
+				SoAFloatArrays Old(std::move(*this));
+				Allocate(NewPaddedSize);
+
+				if (OldPaddedSize > 0)
+				{
+					for (uint32 c = 0; c < ComponentCount; ++c)
+					{
+						std::memcpy(Arrays[c], Old.Arrays[c], OldPaddedSize * sizeof(float));
+					}
+				}
+			}
+
+			/* Keep the padding and any newly exposed elements zeroed */
+			const uint32 ClearStart = count < OldCount ? count : OldCount;
+			const uint32 ClearEnd = NewPaddedSize > OldPaddedSize ? NewPaddedSize : OldPaddedSize;
+			if (ClearEnd > ClearStart)
+			{
+				for (uint32 c = 0; c < ComponentCount; ++c)
+				{
+					std::memset(Arrays[c] + ClearStart, 0, (ClearEnd - ClearStart) * sizeof(float));
+				}
+			}
+
+			Count = count;
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::FromInterleaved(const float* inElements, uint32 count)
+		{
+			Resize(count);
+
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				DeinterleavePacket8(inElements + i * ComponentCount, Arrays, i);
+			}
+
+			for (; i < count; ++i)
+			{
+				for (uint32 c = 0; c < ComponentCount; ++c)
+				{
+					Arrays[c][i] = inElements[i * ComponentCount + c];
+				}
+			}
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::ToInterleaved(float* outElements) const
+		{
+			uint32 i = 0;
+			for (; i + 8 <= Count; i += 8)
+			{
+				InterleavePacket8(outElements + i * ComponentCount, Arrays, i);
+			}
+
+			for (; i < Count; ++i)
+			{
+				for (uint32 c = 0; c < ComponentCount; ++c)
+				{
+					outElements[i * ComponentCount + c] = Arrays[c][i];
+				}
+			}
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::Allocate(uint32 capacity)
+		{
+			/* One block for every array, over allocated so the first array can start on a 64-byte boundary */
+			const uint32 Alignment = PADDING;
+			Buffer = new float[capacity * ComponentCount + Alignment];
+
+			const std::uintptr_t Address = reinterpret_cast<std::uintptr_t>(Buffer);
+			const std::uintptr_t AlignedAddress = (Address + (Alignment * sizeof(float) - 1)) & ~static_cast<std::uintptr_t>(Alignment * sizeof(float) - 1);
+
+			Arrays[0] = reinterpret_cast<float*>(AlignedAddress);
+			for (uint32 c = 1; c < ComponentCount; ++c)
+			{
+				Arrays[c] = Arrays[c - 1] + capacity;
+			}
+			Capacity = capacity;
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::DeinterleavePacket8(const float* in, float* const (&arrays)[3], uint32 index)
+		{
+			VectorRegister8 X, Y, Z;
+			VectorRegister8DeinterleaveXYZ(in, X, Y, Z);
+			StoreVectorRegister8Aligned(arrays[0] + index, X);
+			StoreVectorRegister8Aligned(arrays[1] + index, Y);
+			StoreVectorRegister8Aligned(arrays[2] + index, Z);
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::DeinterleavePacket8(const float* in, float* const (&arrays)[4], uint32 index)
+		{
+			VectorRegister8 X, Y, Z, W;
+			VectorRegister8DeinterleaveXYZW(in, X, Y, Z, W);
+			StoreVectorRegister8Aligned(arrays[0] + index, X);
+			StoreVectorRegister8Aligned(arrays[1] + index, Y);
+			StoreVectorRegister8Aligned(arrays[2] + index, Z);
+			StoreVectorRegister8Aligned(arrays[3] + index, W);
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::InterleavePacket8(float* out, float* const (&arrays)[3], uint32 index)
+		{
+			VectorRegister8InterleaveXYZ(out, VectorRegister8LoadAligned(arrays[0] + index), VectorRegister8LoadAligned(arrays[1] + index),
+				VectorRegister8LoadAligned(arrays[2] + index));
+		}
+
+		template<uint32 ComponentCount>
+		inline void SoAFloatArrays<ComponentCount>::InterleavePacket8(float* out, float* const (&arrays)[4], uint32 index)
+		{
+			VectorRegister8InterleaveXYZW(out, VectorRegister8LoadAligned(arrays[0] + index), VectorRegister8LoadAligned(arrays[1] + index),
+				VectorRegister8LoadAligned(arrays[2] + index), VectorRegister8LoadAligned(arrays[3] + index));
+		}
+	}
+}
@@ -0,0 +1,294 @@
+#pragma once
+#include "GenericDefines.h"
+#include "Matrix4D.h"
+#include "Quat.h"
+#include "Vector3D.h"
+#include "VrixicMathSIMD.h"
+
+#include <cmath>
+
+namespace Vrixic
+{
+	namespace Math
+	{
+		/**
+		* Translation, rotation and scale of a Matrix4D, the matrix is Scale * Rotation.ToMatrix4D() * Translation
+		* (row vectors, so the scale is applied first)
+		*/
+		struct Transform
+		{
+		public:
+			Vector3D Translation;
+			Quat Rotation;
+			Vector3D Scale;
+
+		public:
+			/* Identity transform */
+			inline constexpr Transform();
+
+			inline constexpr Transform(const Vector3D& translation, const Quat& rotation, const Vector3D& scale);
+
+		public:
+			/**
+			* Splits a matrix into translation, rotation and scale in one pass, the scale is the length of each basis
+			* row and the rotation is built from the rows divided by it
+			*
+			* A mirrored matrix (negative determinant) gets a negative X scale. Shear is not representable, a sheared
+			* matrix gives the rotation closest to its normalized rows
+			*/
+			inline static Transform Decompose(const Matrix4D& matrix);
+
+			/* Decompose() for 'count' matrices, 8 at a time in SIMD registers */
+			inline static void DecomposeBatch(const Matrix4D* inMatrices, Transform* outTransforms, uint32 count);
+
+			/* Inverse of Decompose() */
+			inline Matrix4D ToMatrix4D() const;
+
+		public:
+			/**
+			* Same order as Matrix4D, (a * b) applies 'a' first, computed in SIMD registers
+			* Exact when the scale of 'b' is uniform, otherwise the shear the matrix product would have is dropped
+			*/
+			inline Transform operator*(const Transform& t) const;
+
+			/* Exact for a uniform scale, a zero scale component inverts to zero */
+			inline Transform Inverse() const;
+
+			/* Same as Matrix4D::TransformPoints() of ToMatrix4D() */
+			inline Vector3D TransformPoint(const Vector3D& point) const;
+
+			/* TransformPoint() without the translation */
+			inline Vector3D TransformVector(const Vector3D& vector) const;
+
+			/* Undoes TransformPoint() for any scale without a zero component */
+			inline Vector3D InverseTransformPoint(const Vector3D& point) const;
+
+			/* TransformPoint() for 'count' points, runs ToMatrix4D() once and then Matrix4D::TransformPoints() */
+			inline void TransformPoints(const Vector3D* inPoints, Vector3D* outPoints, uint32 count) const;
+
+			/**
+			* outTransforms[i] = left[i] * right[i] for 'count' pairs
+			*
+			* @param outTransforms - can be the same array as either input
+			*/
+			inline static void MultiplyBatch(const Transform* left, const Transform* right, Transform* outTransforms, uint32 count);
+
+		private:
+			/**
+			* Quaternion of a pure rotation matrix, the same convention as Quat::MakeFromMatrix4D()
+			* The largest of 4w^2, 4x^2, 4y^2 and 4z^2 picks which component is found with a square root, the others come
+			* from the off diagonal sums and differences, so no component loses precision to cancellation
+			*/
+			inline static Quat RotationFromRows(const Vector3D& row0, const Vector3D& row1, const Vector3D& row2);
+		};
+
+		static_assert(sizeof(Transform) == 10 * sizeof(float), "operator*() stores Transform as 10 tightly packed floats");
+
+		inline constexpr Transform::Transform()
+			: Translation(0.0f, 0.0f, 0.0f), Rotation(0.0f, 0.0f, 0.0f, 1.0f), Scale(1.0f, 1.0f, 1.0f) { }
+
+		inline constexpr Transform::Transform(const Vector3D& translation, const Quat& rotation, const Vector3D& scale)
+			: Translation(translation), Rotation(rotation), Scale(scale) { }
+
+		inline Transform Transform::Decompose(const Matrix4D& matrix)
+		{
+			const Vector3D Row0(matrix(0, 0), matrix(0, 1), matrix(0, 2));
+			const Vector3D Row1(matrix(1, 0), matrix(1, 1), matrix(1, 2));
+			const Vector3D Row2(matrix(2, 0), matrix(2, 1), matrix(2, 2));
+
+			Vector3D Scale(Row0.Length(), Row1.Length(), Row2.Length());
+			if (Vector3D::DotProduct(Row0, Vector3D::CrossProduct(Row1, Row2)) < 0.0f)
+			{
+				Scale.X = -Scale.X;
+			}
+
+			/* A row with zero scale stays zero, the rotation of such a matrix is undefined and comes out unnormalized */
+			const float InverseX = Scale.X != 0.0f ? 1.0f / Scale.X : 0.0f;
+			const float InverseY = Scale.Y != 0.0f ? 1.0f / Scale.Y : 0.0f;
+			const float InverseZ = Scale.Z != 0.0f ? 1.0f / Scale.Z : 0.0f;
+
+			return Transform(Vector3D(matrix(3, 0), matrix(3, 1), matrix(3, 2)),
+				RotationFromRows(Row0 * InverseX, Row1 * InverseY, Row2 * InverseZ), Scale);
+		}
+
+		inline Quat Transform::RotationFromRows(const Vector3D& row0, const Vector3D& row1, const Vector3D& row2)
+		{
+			/* 4w^2, 4x^2, 4y^2 and 4z^2, they add up to 4 so the largest is at least 1 */
+			const float TW = 1.0f + row0.X + row1.Y + row2.Z;
+			const float TX = 1.0f + row0.X - row1.Y - row2.Z;
+			const float TY = 1.0f - row0.X + row1.Y - row2.Z;
+			const float TZ = 1.0f - row0.X - row1.Y + row2.Z;
+
+			/* 4wx, 4wy, 4wz, 4xy, 4xz and 4yz */
+			const float WX = row2.Y - row1.Z;
+			const float WY = row0.Z - row2.X;
+			const float WZ = row1.X - row0.Y;
+			const float XY = row1.X + row0.Y;
+			const float XZ = row0.Z + row2.X;
+			const float YZ = row2.Y + row1.Z;
+
+			/* Every component is (4 * largest * component) / (4 * largest) */
+			Quat Numerator;
+			float T;
+			if (TW >= TX && TW >= TY && TW >= TZ)
+			{
+				Numerator = Quat(WX, WY, WZ, TW);
+				T = TW;
+			}
+			else if (TX >= TY && TX >= TZ)
+			{
+				Numerator = Quat(TX, XY, XZ, WX);
+				T = TX;
+			}
+			else if (TY >= TZ)
+			{
+				Numerator = Quat(XY, TY, YZ, WY);
+				T = TY;
+			}
+			else
+			{
+				Numerator = Quat(XZ, YZ, TZ, WZ);
+				T = TZ;
+			}
+
+			const float Factor = 0.5f / sqrtf(T);
+			return Quat(Numerator.X * Factor, Numerator.Y * Factor, Numerator.Z * Factor, Numerator.W * Factor);
+		}
+
+		inline void Transform::DecomposeBatch(const Matrix4D* inMatrices, Transform* outTransforms, uint32 count)
+		{
+			const VectorRegister8 Zero = VectorRegister8Zero();
+			const VectorRegister8 One = VectorRegister8Replicate(1.0f);
+
+			uint32 i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				VectorRegister8 E[3][3];
+				VectorRegister8GatherRotation(&inMatrices[i](0, 0), E);
+
+				auto Length = [](const VectorRegister8& x, const VectorRegister8& y, const VectorRegister8& z)
+				{
+					return VectorRegister8Sqrt(VectorRegister8MultiplyAdd(x, x, VectorRegister8MultiplyAdd(y, y, VectorRegister8Multiply(z, z))));
+				};
+
+				VectorRegister8 ScaleX = Length(E[0][0], E[0][1], E[0][2]);
+				const VectorRegister8 ScaleY = Length(E[1][0], E[1][1], E[1][2]);
+				const VectorRegister8 ScaleZ = Length(E[2][0], E[2][1], E[2][2]);
+
+				/* Row0 . (Row1 x Row2), its sign bit moves onto the X scale */
+				const VectorRegister8 Determinant = VectorRegister8MultiplyAdd(E[0][0], VectorRegister8Subtract(VectorRegister8Multiply(E[1][1], E[2][2]), VectorRegister8Multiply(E[1][2], E[2][1])),
+					VectorRegister8MultiplyAdd(E[0][1], VectorRegister8Subtract(VectorRegister8Multiply(E[1][2], E[2][0]), VectorRegister8Multiply(E[1][0], E[2][2])),
+					VectorRegister8Multiply(E[0][2], VectorRegister8Subtract(VectorRegister8Multiply(E[1][0], E[2][1]), VectorRegister8Multiply(E[1][1], E[2][0])))));
+				ScaleX = VectorRegister8Select(VectorRegister8CompareLess(Determinant, Zero), VectorRegister8Negate(ScaleX), ScaleX);
+
+				auto SafeInverse = [&](const VectorRegister8& s)
+				{
+					return VectorRegister8Select(VectorRegister8CompareEqual(s, Zero), Zero, VectorRegister8Divide(One, s));
+				};
+
+				const VectorRegister8 InverseScale[3] = { SafeInverse(ScaleX), SafeInverse(ScaleY), SafeInverse(ScaleZ) };
+				for (int r = 0; r < 3; ++r)
+				{
+					for (int c = 0; c < 3; ++c)
+					{
+						E[r][c] = VectorRegister8Multiply(E[r][c], InverseScale[r]);
+					}
+				}
+
+				/* Same selection as RotationFromRows() */
+				VectorRegister8 X, Y, Z, W;
+				VectorRegister8QuatFromRotation(E, X, Y, Z, W);
+
+				alignas(32) float Rotations[32];
+				VectorRegister8InterleaveXYZW(Rotations, X, Y, Z, W);
+
+				alignas(32) float Scales[3][8];
+				StoreVectorRegister8Aligned(Scales[0], ScaleX);
+				StoreVectorRegister8Aligned(Scales[1], ScaleY);
+				StoreVectorRegister8Aligned(Scales[2], ScaleZ);
+
+				for (uint32 k = 0; k < 8; ++k)
+				{
+					const Matrix4D& Matrix = inMatrices[i + k];
+					outTransforms[i + k] = Transform(Vector3D(Matrix(3, 0), Matrix(3, 1), Matrix(3, 2)),
+						Quat(Rotations[k * 4], Rotations[k * 4 + 1], Rotations[k * 4 + 2], Rotations[k * 4 + 3]),
+						Vector3D(Scales[0][k], Scales[1][k], Scales[2][k]));
+				}
+			}
+
+			for (; i < count; ++i)
+			{
+				outTransforms[i] = Decompose(inMatrices[i]);
+			}
+		}
+
+		inline Matrix4D Transform::ToMatrix4D() const
+		{
+			Matrix4D Result = Rotation.ToMatrix4D();
+			VectorRegisterMatrixScaleRows(&Result(0, 0), Scale.X, Scale.Y, Scale.Z);
+			Result.SetTranslation(Translation);
+			return Result;
+		}
+
+		inline Transform Transform::operator*(const Transform& t) const
+		{
+			const VectorRegister RightRotation = MakeVectorRegister(&t.Rotation.X);
+			const VectorRegister ResultRotation = VectorRegisterQuatMultiply(MakeVectorRegister(&Rotation.X), RightRotation);
+
+			/* (Scale.X, Scale.Y, Scale.Z, Rotation.W), loaded from Rotation.W so the load stays inside the struct */
+			const VectorRegister RightScale = VectorRegisterSwizzle<1, 2, 3, 0>(MakeVectorRegister(&t.Rotation.W));
+			const VectorRegister ResultScale = VectorRegisterMultiply(VectorRegisterSwizzle<1, 2, 3, 0>(MakeVectorRegister(&Rotation.W)), RightScale);
+
+			/* t.TransformPoint(Translation), the W lanes carry unused values */
+			const VectorRegister Point = VectorRegisterMultiply(MakeVectorRegister(&Translation.X), RightScale);
+			const VectorRegister Conjugate = VectorRegisterBitwiseXor(RightRotation, MakeVectorRegister(-0.0f, -0.0f, -0.0f, 0.0f));
+			const VectorRegister T = VectorRegisterCross3(Conjugate, VectorRegisterAdd(Point, Point));
+			const VectorRegister Rotated = VectorRegisterAdd(VectorRegisterMultiplyAdd(T, VectorRegisterReplicateComponent<3>(Conjugate), Point), VectorRegisterCross3(Conjugate, T));
+
+			/* Overlapping stores, each one fixes the float the previous one spilled into */
+			Transform Result;
+			float* Floats = reinterpret_cast<float*>(&Result);
+			StoreVectorRegister(Floats, VectorRegisterAdd(Rotated, MakeVectorRegister(&t.Translation.X)));
+			StoreVectorRegister(Floats + 6, VectorRegisterSwizzle<3, 0, 1, 2>(ResultScale));
+			StoreVectorRegister(Floats + 3, ResultRotation);
+			return Result;
+		}
+
+		inline Transform Transform::Inverse() const
+		{
+			const Vector3D InverseScale(Scale.X != 0.0f ? 1.0f / Scale.X : 0.0f, Scale.Y != 0.0f ? 1.0f / Scale.Y : 0.0f,
+				Scale.Z != 0.0f ? 1.0f / Scale.Z : 0.0f);
+
+			return Transform(-(Rotation.RotateVector(Translation) * InverseScale), Rotation.Conjugate(), InverseScale);
+		}
+
+		inline Vector3D Transform::TransformPoint(const Vector3D& point) const
+		{
+			return TransformVector(point) + Translation;
+		}
+
+		inline Vector3D Transform::TransformVector(const Vector3D& vector) const
+		{
+			/* Matrices built by Quat::ToMatrix4D() rotate row vectors by the conjugate */
+			return Rotation.Conjugate().RotateVector(vector * Scale);
+		}
+
+		inline Vector3D Transform::InverseTransformPoint(const Vector3D& point) const
+		{
+			return Rotation.RotateVector(point - Translation) / Scale;
+		}
+
+		inline void Transform::TransformPoints(const Vector3D* inPoints, Vector3D* outPoints, uint32 count) const
+		{
+			ToMatrix4D().TransformPoints(inPoints, outPoints, count);
+		}
+
+		inline void Transform::MultiplyBatch(const Transform* left, const Transform* right, Transform* outTransforms, uint32 count)
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				outTransforms[i] = left[i] * right[i];
+			}
+		}
+	}
+}
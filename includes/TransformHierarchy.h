@@ -0,0 +1,363 @@
+#pragma once
+
+#include "GenericDefines.h"
+#include "Matrix4D.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+/**
+* Parent/child transform propagation, World = Local * ParentWorld (row vectors, so the local transform is applied first)
+*
+* Nodes are kept sorted by depth in flat arrays, every parent comes before its children and each depth is one contiguous
+* range. Update() walks the depths in order and only recomputes nodes whose local matrix changed or whose parent was
+* recomputed, runs of such nodes are gathered and multiplied with Matrix4D::MultiplyBatch()
+*
+*	TransformHierarchy Hierarchy;
+*	uint32 Root = Hierarchy.AddNode(RootLocal);
+*	uint32 Child = Hierarchy.AddNode(ChildLocal, Root);
+*	Hierarchy.Update();
+*	const Matrix4D& World = Hierarchy.GetWorldMatrix(Child);
+*
+* Handles returned by AddNode() stay valid until Clear(), they are not indices into the sorted arrays
+*/
+namespace Vrixic
+{
+	namespace Math
+	{
+		struct TransformHierarchy
+		{
+		public:
+			static constexpr uint32 InvalidNode = 0xFFFFFFFFu;
+
+		private:
+			/* Indexed by handle */
+			std::vector<uint32> NodeParents;
+			std::vector<uint32> NodeDepths;
+			std::vector<uint32> NodeToIndex;
+
+			/* Indexed by sorted position */
+			std::vector<Matrix4D> LocalMatrices;
+			std::vector<Matrix4D> WorldMatrices;
+			std::vector<uint32> ParentIndices;
+			std::vector<uint8> DirtyFlags;
+
+			/* Depth d occupies [LevelOffsets[d], LevelOffsets[d + 1]) of the sorted arrays */
+			std::vector<uint32> LevelOffsets;
+
+			/* Shallowest depth holding a dirty node, equal to the level count when nothing is dirty */
+			uint32 MinDirtyDepth;
+
+			/* Set when nodes were added since the last sort */
+			bool LayoutDirty;
+
+		public:
+			inline TransformHierarchy();
+
+		public:
+			/**
+			* Adds a node and returns its handle
+			*
+			* @param parent - handle of an existing node, or InvalidNode for a root
+			*/
+			inline uint32 AddNode(const Matrix4D& local, uint32 parent = InvalidNode);
+
+			/* Marks the node, and so everything under it, for the next Update() */
+			inline void SetLocalMatrix(uint32 node, const Matrix4D& local);
+
+			inline const Matrix4D& GetLocalMatrix(uint32 node) const;
+
+			/* Only up to date after Update() */
+			inline const Matrix4D& GetWorldMatrix(uint32 node) const;
+
+			inline uint32 GetParent(uint32 node) const;
+
+			inline uint32 GetNodeCount() const;
+
+			/* Number of distinct depths, only up to date after Update() */
+			inline uint32 GetLevelCount() const;
+
+			inline void Reserve(uint32 capacity);
+
+			inline void Clear();
+
+			/* Recomputes the world matrix of every dirty node and its descendants */
+			inline void Update();
+
+			/**
+			* Same as Update() but hands each depth to 'parallelFor' so the nodes of one depth can be spread over threads
+			*
+			* @param parallelFor - called as parallelFor(count, job) and must call job(begin, end) over disjoint ranges
+			*	covering [0, count) before returning, 'job' is safe to run concurrently on different ranges
+			*/
+			template<typename ParallelFor>
+			inline void Update(ParallelFor&& parallelFor);
+
+		private:
+			/* Re-sorts the nodes by depth, children of the same parent end up next to each other */
+			inline void SortByDepth();
+
+			/* Propagates dirty flags from the parents of [begin, end) and recomputes the dirty nodes */
+			inline void UpdateRange(uint32 begin, uint32 end);
+
+			/* Clears the flags that were consumed by an update */
+			inline void FinishUpdate();
+		};
+
+		inline TransformHierarchy::TransformHierarchy()
+			: MinDirtyDepth(0), LayoutDirty(false) { }
+
+		inline uint32 TransformHierarchy::AddNode(const Matrix4D& local, uint32 parent)
+		{
+			const uint32 Handle = static_cast<uint32>(NodeParents.size());
+			const uint32 Depth = parent == InvalidNode ? 0 : NodeDepths[parent] + 1;
+
+			NodeParents.push_back(parent);
+			NodeDepths.push_back(Depth);
+			NodeToIndex.push_back(Handle);
+
+			/* Stored unsorted until the next Update() */
+			LocalMatrices.push_back(local);
+			WorldMatrices.push_back(local);
+			ParentIndices.push_back(parent == InvalidNode ? parent : NodeToIndex[parent]);
+			DirtyFlags.push_back(1);
+
+			LayoutDirty = true;
+			return Handle;
+		}
+
+		inline void TransformHierarchy::SetLocalMatrix(uint32 node, const Matrix4D& local)
+		{
+			const uint32 Index = NodeToIndex[node];
+			LocalMatrices[Index] = local;
+			DirtyFlags[Index] = 1;
+
+			if (NodeDepths[node] < MinDirtyDepth)
+			{
+				MinDirtyDepth = NodeDepths[node];
+			}
+		}
+
+		inline const Matrix4D& TransformHierarchy::GetLocalMatrix(uint32 node) const
+		{
+			return LocalMatrices[NodeToIndex[node]];
+		}
+
+		inline const Matrix4D& TransformHierarchy::GetWorldMatrix(uint32 node) const
+		{
+			return WorldMatrices[NodeToIndex[node]];
+		}
+
+		inline uint32 TransformHierarchy::GetParent(uint32 node) const
+		{
+			return NodeParents[node];
+		}
+
+		inline uint32 TransformHierarchy::GetNodeCount() const
+		{
+			return static_cast<uint32>(NodeParents.size());
+		}
+
+		inline uint32 TransformHierarchy::GetLevelCount() const
+		{
+			return LevelOffsets.empty() ? 0 : static_cast<uint32>(LevelOffsets.size() - 1);
+		}
+
+		inline void TransformHierarchy::Reserve(uint32 capacity)
+		{
+			NodeParents.reserve(capacity);
+			NodeDepths.reserve(capacity);
+			NodeToIndex.reserve(capacity);
+			LocalMatrices.reserve(capacity);
+			WorldMatrices.reserve(capacity);
+			ParentIndices.reserve(capacity);
+			DirtyFlags.reserve(capacity);
+		}
+
+		inline void TransformHierarchy::Clear()
+		{
+			NodeParents.clear();
+			NodeDepths.clear();
+			NodeToIndex.clear();
+			LocalMatrices.clear();
+			WorldMatrices.clear();
+			ParentIndices.clear();
+			DirtyFlags.clear();
+			LevelOffsets.clear();
+			MinDirtyDepth = 0;
+			LayoutDirty = false;
+		}
+
+		inline void TransformHierarchy::Update()
+		{
+			Update([](uint32 count, auto&& job) { job(0u, count); });
+		}
+
+		template<typename ParallelFor>
+		inline void TransformHierarchy::Update(ParallelFor&& parallelFor)
+		{
+			if (LayoutDirty)
+			{
+				SortByDepth();
+			}
+
+			const uint32 LevelCount = GetLevelCount();
+			for (uint32 Depth = MinDirtyDepth; Depth < LevelCount; ++Depth)
+			{
+				const uint32 LevelBegin = LevelOffsets[Depth];
+				const uint32 NodeCount = LevelOffsets[Depth + 1] - LevelBegin;
+
+				parallelFor(NodeCount, [this, LevelBegin](uint32 begin, uint32 end)
+				{
+					UpdateRange(LevelBegin + begin, LevelBegin + end);
+				});
+			}
+
+			FinishUpdate();
+		}
+
+		inline void TransformHierarchy::SortByDepth()
+		{
+			const uint32 Count = GetNodeCount();
+
+			/* Children of every node as one flat list, node n's children are in [ChildOffsets[n], ChildOffsets[n + 1]) */
+			std::vector<uint32> ChildOffsets(Count + 1, 0);
+			for (uint32 Node = 0; Node < Count; ++Node)
+			{
+				if (NodeParents[Node] != InvalidNode)
+				{
+					ChildOffsets[NodeParents[Node] + 1]++;
+				}
+			}
+			for (uint32 Node = 0; Node < Count; ++Node)
+			{
+				ChildOffsets[Node + 1] += ChildOffsets[Node];
+			}
+
+			std::vector<uint32> Children(ChildOffsets[Count]);
+			std::vector<uint32> Cursor(ChildOffsets.begin(), ChildOffsets.end() - 1);
+			for (uint32 Node = 0; Node < Count; ++Node)
+			{
+				if (NodeParents[Node] != InvalidNode)
+				{
+					Children[Cursor[NodeParents[Node]]++] = Node;
+				}
+			}
+
+			/* Breadth first from the roots, which yields depth order with siblings grouped */
+			std::vector<uint32> Order;
+			Order.reserve(Count);
+			for (uint32 Node = 0; Node < Count; ++Node)
+			{
+				if (NodeParents[Node] == InvalidNode)
+				{
+					Order.push_back(Node);
+				}
+			}
+			for (uint32 i = 0; i < Order.size(); ++i)
+			{
+				const uint32 Node = Order[i];
+				Order.insert(Order.end(), Children.begin() + ChildOffsets[Node], Children.begin() + ChildOffsets[Node + 1]);
+			}
+
+			/* Permute the sorted arrays, 'Order' holds handles and NodeToIndex still maps them to the old positions */
+			std::vector<Matrix4D> SortedLocals(Count);
+			std::vector<Matrix4D> SortedWorlds(Count);
+			std::vector<uint8> SortedFlags(Count);
+			for (uint32 i = 0; i < Count; ++i)
+			{
+				const uint32 OldIndex = NodeToIndex[Order[i]];
+				SortedLocals[i] = LocalMatrices[OldIndex];
+				SortedWorlds[i] = WorldMatrices[OldIndex];
+				SortedFlags[i] = DirtyFlags[OldIndex];
+			}
+
+			LevelOffsets.clear();
+			for (uint32 i = 0; i < Count; ++i)
+			{
+				const uint32 Node = Order[i];
+				NodeToIndex[Node] = i;
+
+				const uint32 Depth = NodeDepths[Node];
+				while (LevelOffsets.size() <= Depth)
+				{
+					LevelOffsets.push_back(i);
+				}
+			}
+			LevelOffsets.push_back(Count);
+
+			for (uint32 i = 0; i < Count; ++i)
+			{
+				const uint32 Parent = NodeParents[Order[i]];
+				ParentIndices[i] = Parent == InvalidNode ? Parent : NodeToIndex[Parent];
+			}
+
+			LocalMatrices.swap(SortedLocals);
+			WorldMatrices.swap(SortedWorlds);
+			DirtyFlags.swap(SortedFlags);
+
+			/* New nodes can sit at any depth, recheck them all once */
+			MinDirtyDepth = 0;
+			LayoutDirty = false;
+		}
+
+		inline void TransformHierarchy::UpdateRange(uint32 begin, uint32 end)
+		{
+			/* Parents are gathered next to each other so a run of dirty nodes is one batched multiply */
+			const uint32 BatchSize = 32;
+			Matrix4D ParentWorlds[BatchSize];
+
+			uint32 i = begin;
+			while (i < end)
+			{
+				const uint32 Parent = ParentIndices[i];
+				if (Parent == InvalidNode)
+				{
+					if (DirtyFlags[i])
+					{
+						WorldMatrices[i] = LocalMatrices[i];
+					}
+					++i;
+					continue;
+				}
+
+				DirtyFlags[i] |= DirtyFlags[Parent];
+				if (!DirtyFlags[i])
+				{
+					++i;
+					continue;
+				}
+
+				const uint32 RunBegin = i;
+				uint32 RunCount = 0;
+				while (i < end && RunCount < BatchSize && ParentIndices[i] != InvalidNode)
+				{
+					DirtyFlags[i] |= DirtyFlags[ParentIndices[i]];
+					if (!DirtyFlags[i])
+					{
+						break;
+					}
+
+					ParentWorlds[RunCount++] = WorldMatrices[ParentIndices[i]];
+					++i;
+				}
+
+				Matrix4D::MultiplyBatch(&LocalMatrices[RunBegin], ParentWorlds, &WorldMatrices[RunBegin], RunCount);
+			}
+		}
+
+		inline void TransformHierarchy::FinishUpdate()
+		{
+			/* Every flag before the first dirty depth was already clear */
+			const uint32 LevelCount = GetLevelCount();
+			if (MinDirtyDepth < LevelCount)
+			{
+				const uint32 First = LevelOffsets[MinDirtyDepth];
+				std::memset(DirtyFlags.data() + First, 0, DirtyFlags.size() - First);
+			}
+
+			MinDirtyDepth = LevelCount;
+		}
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
-#include <corecrt_math.h>
+#include <cmath>
+#include <type_traits>
 #include "VrixicMathHelper.h"
 
 namespace Vrixic
@@ -15,17 +16,15 @@ namespace Vrixic
 			float Z;
 
 		public:
-			inline Vector3D();
+			inline constexpr Vector3D();
 
-			inline Vector3D(float val);
+			inline constexpr Vector3D(float val);
 
-			inline Vector3D(float x, float y, float z);
+			inline constexpr Vector3D(float x, float y, float z);
 
 		public:
 			/* Unary operator overloads */
 
-			inline Vector3D operator=(const Vector3D& other);
-
 			inline Vector3D operator+(const Vector3D& v) const;
 
 			inline Vector3D operator-(const Vector3D& v) const;
@@ -54,11 +53,11 @@ namespace Vrixic
 			inline Vector3D operator/=(const Vector3D& v);
 
 		public:
-			inline static Vector3D ZeroVector();
+			inline constexpr static Vector3D ZeroVector();
 
-			inline static float DotProduct(const Vector3D& a, const Vector3D& b);
+			inline constexpr static float DotProduct(const Vector3D& a, const Vector3D& b);
 
-			inline static Vector3D CrossProduct(const Vector3D& a, const Vector3D& b);
+			inline constexpr static Vector3D CrossProduct(const Vector3D& a, const Vector3D& b);
 
 			inline static Vector3D Lerp(const Vector3D& start, const Vector3D& end, float ratio);
 
@@ -74,24 +73,18 @@ namespace Vrixic
 			inline const Vector3D& Normalize();
 		};
 
-		inline Vector3D::Vector3D()
+		/* No user defined copy/assignment so arrays of vectors can be memcpy'd and constant tables built at compile time */
+		static_assert(std::is_trivially_copyable<Vector3D>::value, "Vector3D should stay trivially copyable");
+
+		inline constexpr Vector3D::Vector3D()
 			: X(0.0f), Y(0.0f), Z(0.0f) {}
 
-		inline Vector3D::Vector3D(float val)
+		inline constexpr Vector3D::Vector3D(float val)
 			: X(val), Y(val), Z(val) {}
 
-		inline Vector3D::Vector3D(float x, float y, float z)
+		inline constexpr Vector3D::Vector3D(float x, float y, float z)
 			: X(x), Y(y), Z(z) {}
 
-		inline Vector3D Vector3D::operator=(const Vector3D& other)
-		{
-			X = other.X;
-			Y = other.Y;
-			Z = other.Z;
-
-			return *this;
-		}
-
 		inline Vector3D Vector3D::operator+(const Vector3D& v) const
 		{
 			return Vector3D(X + v.X, Y + v.Y, Z + v.Z);
@@ -183,17 +176,17 @@ namespace Vrixic
 			return *this;
 		}
 
-		inline Vector3D Vector3D::ZeroVector()
+		inline constexpr Vector3D Vector3D::ZeroVector()
 		{
 			return Vector3D(0.0f, 0.0f, 0.0f);
 		}
 
-		inline float Vector3D::DotProduct(const Vector3D& a, const Vector3D& b)
+		inline constexpr float Vector3D::DotProduct(const Vector3D& a, const Vector3D& b)
 		{
 			return (a.X * b.X + a.Y * b.Y + a.Z * b.Z);
 		}
 
-		inline Vector3D Vector3D::CrossProduct(const Vector3D& a, const Vector3D& b)
+		inline constexpr Vector3D Vector3D::CrossProduct(const Vector3D& a, const Vector3D& b)
 		{
 			return Vector3D(
 				a.Y * b.Z - a.Z * b.Y,
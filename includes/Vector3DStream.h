@@ -0,0 +1,550 @@
+#pragma once
+#include "GenericDefines.h"
+#include "SoAFloatArrays.h"
+#include "Vector3D.h"
+#include "VrixicMathSIMD.h"
+#include "VrixicMathKernels.h"
+
+#include <cstring>
+
+namespace Vrixic
+{
+	namespace Math
+	{
+		/* 4 Vector3Ds in structure of arrays form, lane i of every register belongs to the i'th vector */
+		struct Vector3x4
+		{
+		public:
+			VectorRegister X;
+			VectorRegister Y;
+			VectorRegister Z;
+
+		public:
+			inline Vector3x4();
+
+			/* Replicates 'v' into all 4 lanes */
+			inline Vector3x4(const Vector3D& v);
+
+			inline Vector3x4(const VectorRegister& x, const VectorRegister& y, const VectorRegister& z);
+
+		public:
+			inline Vector3x4 operator+(const Vector3x4& v) const;
+
+			inline Vector3x4 operator-(const Vector3x4& v) const;
+
+			inline Vector3x4 operator*(const Vector3x4& v) const;
+
+			/* Scales every lane by the matching lane of 'scalar' */
+			inline Vector3x4 operator*(const VectorRegister& scalar) const;
+
+			inline Vector3x4 operator*(float scalar) const;
+
+		public:
+			/* Loads 4 vectors from SoA arrays, each has to be 16-byte aligned */
+			inline static Vector3x4 Load(const float* x, const float* y, const float* z);
+
+			/* Loads 4 tightly packed Vector3Ds, 'v' does not have to be aligned */
+			inline static Vector3x4 LoadAoS(const Vector3D* v);
+
+			/* Stores 4 vectors into SoA arrays, each has to be 16-byte aligned */
+			inline void Store(float* x, float* y, float* z) const;
+
+			/* Stores 4 tightly packed Vector3Ds, 'v' does not have to be aligned */
+			inline void StoreAoS(Vector3D* v) const;
+
+			inline static VectorRegister DotProduct(const Vector3x4& a, const Vector3x4& b);
+
+			inline static Vector3x4 CrossProduct(const Vector3x4& a, const Vector3x4& b);
+
+			inline static Vector3x4 Lerp(const Vector3x4& start, const Vector3x4& end, const VectorRegister& ratio);
+
+			/* Manhattan distance -> non-accurate, but fast distance calculation*/
+			inline static VectorRegister ManhattanDistance(const Vector3x4& a, const Vector3x4& b);
+
+			inline VectorRegister Length() const;
+
+			inline VectorRegister LengthSquared() const;
+
+			/* Normalizes all 4 lanes, same as Vector3D::Normalize() */
+			inline const Vector3x4& Normalize();
+		};
+
+		/* 8 Vector3Ds in structure of arrays form, lane i of every register belongs to the i'th vector */
+		struct Vector3x8
+		{
+		public:
+			VectorRegister8 X;
+			VectorRegister8 Y;
+			VectorRegister8 Z;
+
+		public:
+			inline Vector3x8();
+
+			/* Replicates 'v' into all 8 lanes */
+			inline Vector3x8(const Vector3D& v);
+
+			inline Vector3x8(const VectorRegister8& x, const VectorRegister8& y, const VectorRegister8& z);
+
+		public:
+			inline Vector3x8 operator+(const Vector3x8& v) const;
+
+			inline Vector3x8 operator-(const Vector3x8& v) const;
+
+			inline Vector3x8 operator*(const Vector3x8& v) const;
+
+			/* Scales every lane by the matching lane of 'scalar' */
+			inline Vector3x8 operator*(const VectorRegister8& scalar) const;
+
+			inline Vector3x8 operator*(float scalar) const;
+
+		public:
+			/* Loads 8 vectors from SoA arrays, each has to be 32-byte aligned */
+			inline static Vector3x8 Load(const float* x, const float* y, const float* z);
+
+			/* Loads 8 tightly packed Vector3Ds, 'v' does not have to be aligned */
+			inline static Vector3x8 LoadAoS(const Vector3D* v);
+
+			/* Stores 8 vectors into SoA arrays, each has to be 32-byte aligned */
+			inline void Store(float* x, float* y, float* z) const;
+
+			/* Stores 8 tightly packed Vector3Ds, 'v' does not have to be aligned */
+			inline void StoreAoS(Vector3D* v) const;
+
+			inline static VectorRegister8 DotProduct(const Vector3x8& a, const Vector3x8& b);
+
+			inline static Vector3x8 CrossProduct(const Vector3x8& a, const Vector3x8& b);
+
+			inline static Vector3x8 Lerp(const Vector3x8& start, const Vector3x8& end, const VectorRegister8& ratio);
+
+			/* Manhattan distance -> non-accurate, but fast distance calculation*/
+			inline static VectorRegister8 ManhattanDistance(const Vector3x8& a, const Vector3x8& b);
+
+			inline VectorRegister8 Length() const;
+
+			inline VectorRegister8 LengthSquared() const;
+
+			/* Normalizes all 8 lanes, same as Vector3D::Normalize() */
+			inline const Vector3x8& Normalize();
+		};
+
+		/**
+		* A growable array of Vector3Ds stored as 3 separate X[], Y[], Z[] arrays
+		*
+		* The arrays are aligned and zero padded by SoAFloatArrays, so the batch kernels run whole Vector3x8 packets without
+		*	a scalar tail
+		*/
+		class Vector3DStream
+		{
+		public:
+			/* Component arrays are padded to this many floats (one 64-byte cache line) */
+			static constexpr uint32 PADDING = SoAFloatArrays<3>::PADDING;
+
+		private:
+			/* X, Y and Z arrays, owns the allocation */
+			SoAFloatArrays<3> Arrays;
+
+		public:
+			inline Vector3DStream() { }
+
+			inline explicit Vector3DStream(uint32 count) : Arrays(count) { }
+
+		public:
+			inline uint32 Size() const { return Arrays.Size(); }
+
+			/* Size rounded up to the padding, loops may run up to this count */
+			inline uint32 PaddedSize() const { return Arrays.PaddedSize(); }
+
+			inline float* GetX() { return Arrays.GetArray(0); }
+			inline float* GetY() { return Arrays.GetArray(1); }
+			inline float* GetZ() { return Arrays.GetArray(2); }
+
+			inline const float* GetX() const { return Arrays.GetArray(0); }
+			inline const float* GetY() const { return Arrays.GetArray(1); }
+			inline const float* GetZ() const { return Arrays.GetArray(2); }
+
+			inline Vector3D Get(uint32 index) const;
+
+			inline void Set(uint32 index, const Vector3D& v);
+
+			/* Resizes the stream, existing elements are kept and new ones are zeroed */
+			inline void Resize(uint32 count) { Arrays.Resize(count); }
+
+			inline Vector3x4 LoadPacket4(uint32 index) const;
+
+			inline Vector3x8 LoadPacket8(uint32 index) const;
+
+			inline void StorePacket4(uint32 index, const Vector3x4& packet);
+
+			inline void StorePacket8(uint32 index, const Vector3x8& packet);
+
+			/* AoS -> SoA, resizes the stream to 'count' */
+			inline void FromAoS(const Vector3D* inVectors, uint32 count);
+
+			/* SoA -> AoS, 'outVectors' has to hold Size() elements */
+			inline void ToAoS(Vector3D* outVectors) const;
+
+		public:
+			/* Batch kernels, every input has to have the same Size() as the output array */
+
+			inline static void DotProduct(const Vector3DStream& a, const Vector3DStream& b, float* outDots);
+
+			inline static void CrossProduct(const Vector3DStream& a, const Vector3DStream& b, Vector3DStream& outCross);
+
+			inline static void Lerp(const Vector3DStream& start, const Vector3DStream& end, float ratio, Vector3DStream& outLerp);
+
+			inline static void ManhattanDistance(const Vector3DStream& a, const Vector3DStream& b, float* outDistances);
+
+			inline void Length(float* outLengths) const;
+
+			/* Normalizes every vector in place */
+			inline void Normalize();
+		};
+
+		/* Vector3x4 */
+
+		inline Vector3x4::Vector3x4()
+			: X(VectorRegisterZero()), Y(VectorRegisterZero()), Z(VectorRegisterZero()) { }
+
+		inline Vector3x4::Vector3x4(const Vector3D& v)
+			: X(VectorRegisterReplicate(v.X)), Y(VectorRegisterReplicate(v.Y)), Z(VectorRegisterReplicate(v.Z)) { }
+
+		inline Vector3x4::Vector3x4(const VectorRegister& x, const VectorRegister& y, const VectorRegister& z)
+			: X(x), Y(y), Z(z) { }
+
+		inline Vector3x4 Vector3x4::operator+(const Vector3x4& v) const
+		{
+			return Vector3x4(VectorRegisterAdd(X, v.X), VectorRegisterAdd(Y, v.Y), VectorRegisterAdd(Z, v.Z));
+		}
+
+		inline Vector3x4 Vector3x4::operator-(const Vector3x4& v) const
+		{
+			return Vector3x4(VectorRegisterSubtract(X, v.X), VectorRegisterSubtract(Y, v.Y), VectorRegisterSubtract(Z, v.Z));
+		}
+
+		inline Vector3x4 Vector3x4::operator*(const Vector3x4& v) const
+		{
+			return Vector3x4(VectorRegisterMultiply(X, v.X), VectorRegisterMultiply(Y, v.Y), VectorRegisterMultiply(Z, v.Z));
+		}
+
+		inline Vector3x4 Vector3x4::operator*(const VectorRegister& scalar) const
+		{
+			return Vector3x4(VectorRegisterMultiply(X, scalar), VectorRegisterMultiply(Y, scalar), VectorRegisterMultiply(Z, scalar));
+		}
+
+		inline Vector3x4 Vector3x4::operator*(float scalar) const
+		{
+			return *this * VectorRegisterReplicate(scalar);
+		}
+
+		inline Vector3x4 Vector3x4::Load(const float* x, const float* y, const float* z)
+		{
+			return Vector3x4(VectorRegisterLoadAligned(x), VectorRegisterLoadAligned(y), VectorRegisterLoadAligned(z));
+		}
+
+		inline Vector3x4 Vector3x4::LoadAoS(const Vector3D* v)
+		{
+			Vector3x4 Result;
+			VectorRegisterDeinterleaveXYZ(reinterpret_cast<const float*>(v), Result.X, Result.Y, Result.Z);
+			return Result;
+		}
+
+		inline void Vector3x4::Store(float* x, float* y, float* z) const
+		{
+			StoreVectorRegisterAligned(x, X);
+			StoreVectorRegisterAligned(y, Y);
+			StoreVectorRegisterAligned(z, Z);
+		}
+
+		inline void Vector3x4::StoreAoS(Vector3D* v) const
+		{
+			VectorRegisterInterleaveXYZ(reinterpret_cast<float*>(v), X, Y, Z);
+		}
+
+		inline VectorRegister Vector3x4::DotProduct(const Vector3x4& a, const Vector3x4& b)
+		{
+			return VectorRegisterMultiplyAdd(a.Z, b.Z, VectorRegisterMultiplyAdd(a.Y, b.Y, VectorRegisterMultiply(a.X, b.X)));
+		}
+
+		inline Vector3x4 Vector3x4::CrossProduct(const Vector3x4& a, const Vector3x4& b)
+		{
+			return Vector3x4(
+				VectorRegisterSubtract(VectorRegisterMultiply(a.Y, b.Z), VectorRegisterMultiply(a.Z, b.Y)),
+				VectorRegisterSubtract(VectorRegisterMultiply(a.Z, b.X), VectorRegisterMultiply(a.X, b.Z)),
+				VectorRegisterSubtract(VectorRegisterMultiply(a.X, b.Y), VectorRegisterMultiply(a.Y, b.X))
+			);
+		}
+
+		inline Vector3x4 Vector3x4::Lerp(const Vector3x4& start, const Vector3x4& end, const VectorRegister& ratio)
+		{
+			return Vector3x4(
+				VectorRegisterMultiplyAdd(VectorRegisterSubtract(end.X, start.X), ratio, start.X),
+				VectorRegisterMultiplyAdd(VectorRegisterSubtract(end.Y, start.Y), ratio, start.Y),
+				VectorRegisterMultiplyAdd(VectorRegisterSubtract(end.Z, start.Z), ratio, start.Z)
+			);
+		}
+
+		inline VectorRegister Vector3x4::ManhattanDistance(const Vector3x4& a, const Vector3x4& b)
+		{
+			VectorRegister DeltaX = VectorRegisterAbs(VectorRegisterSubtract(b.X, a.X));
+			VectorRegister DeltaY = VectorRegisterAbs(VectorRegisterSubtract(b.Y, a.Y));
+			VectorRegister DeltaZ = VectorRegisterAbs(VectorRegisterSubtract(b.Z, a.Z));
+
+			return VectorRegisterAdd(VectorRegisterAdd(DeltaX, DeltaY), DeltaZ);
+		}
+
+		inline VectorRegister Vector3x4::Length() const
+		{
+			return VectorRegisterSqrt(LengthSquared());
+		}
+
+		inline VectorRegister Vector3x4::LengthSquared() const
+		{
+			return DotProduct(*this, *this);
+		}
+
+		inline const Vector3x4& Vector3x4::Normalize()
+		{
+			const VectorRegister Magnitude = VectorRegisterDivide(VectorRegisterReplicate(1.0f), VectorRegisterAdd(Length(), VectorRegisterReplicate(EPSILON)));
+			X = VectorRegisterMultiply(X, Magnitude);
+			Y = VectorRegisterMultiply(Y, Magnitude);
+			Z = VectorRegisterMultiply(Z, Magnitude);
+
+			return *this;
+		}
+
+		/* Vector3x8 */
+
+		inline Vector3x8::Vector3x8()
+			: X(VectorRegister8Zero()), Y(VectorRegister8Zero()), Z(VectorRegister8Zero()) { }
+
+		inline Vector3x8::Vector3x8(const Vector3D& v)
+			: X(VectorRegister8Replicate(v.X)), Y(VectorRegister8Replicate(v.Y)), Z(VectorRegister8Replicate(v.Z)) { }
+
+		inline Vector3x8::Vector3x8(const VectorRegister8& x, const VectorRegister8& y, const VectorRegister8& z)
+			: X(x), Y(y), Z(z) { }
+
+		inline Vector3x8 Vector3x8::operator+(const Vector3x8& v) const
+		{
+			return Vector3x8(VectorRegister8Add(X, v.X), VectorRegister8Add(Y, v.Y), VectorRegister8Add(Z, v.Z));
+		}
+
+		inline Vector3x8 Vector3x8::operator-(const Vector3x8& v) const
+		{
+			return Vector3x8(VectorRegister8Subtract(X, v.X), VectorRegister8Subtract(Y, v.Y), VectorRegister8Subtract(Z, v.Z));
+		}
+
+		inline Vector3x8 Vector3x8::operator*(const Vector3x8& v) const
+		{
+			return Vector3x8(VectorRegister8Multiply(X, v.X), VectorRegister8Multiply(Y, v.Y), VectorRegister8Multiply(Z, v.Z));
+		}
+
+		inline Vector3x8 Vector3x8::operator*(const VectorRegister8& scalar) const
+		{
+			return Vector3x8(VectorRegister8Multiply(X, scalar), VectorRegister8Multiply(Y, scalar), VectorRegister8Multiply(Z, scalar));
+		}
+
+		inline Vector3x8 Vector3x8::operator*(float scalar) const
+		{
+			return *this * VectorRegister8Replicate(scalar);
+		}
+
+		inline Vector3x8 Vector3x8::Load(const float* x, const float* y, const float* z)
+		{
+			return Vector3x8(VectorRegister8LoadAligned(x), VectorRegister8LoadAligned(y), VectorRegister8LoadAligned(z));
+		}
+
+		inline Vector3x8 Vector3x8::LoadAoS(const Vector3D* v)
+		{
+			Vector3x8 Result;
+			VectorRegister8DeinterleaveXYZ(reinterpret_cast<const float*>(v), Result.X, Result.Y, Result.Z);
+			return Result;
+		}
+
+		inline void Vector3x8::Store(float* x, float* y, float* z) const
+		{
+			StoreVectorRegister8Aligned(x, X);
+			StoreVectorRegister8Aligned(y, Y);
+			StoreVectorRegister8Aligned(z, Z);
+		}
+
+		inline void Vector3x8::StoreAoS(Vector3D* v) const
+		{
+			VectorRegister8InterleaveXYZ(reinterpret_cast<float*>(v), X, Y, Z);
+		}
+
+		inline VectorRegister8 Vector3x8::DotProduct(const Vector3x8& a, const Vector3x8& b)
+		{
+			return VectorRegister8MultiplyAdd(a.Z, b.Z, VectorRegister8MultiplyAdd(a.Y, b.Y, VectorRegister8Multiply(a.X, b.X)));
+		}
+
+		inline Vector3x8 Vector3x8::CrossProduct(const Vector3x8& a, const Vector3x8& b)
+		{
+			return Vector3x8(
+				VectorRegister8Subtract(VectorRegister8Multiply(a.Y, b.Z), VectorRegister8Multiply(a.Z, b.Y)),
+				VectorRegister8Subtract(VectorRegister8Multiply(a.Z, b.X), VectorRegister8Multiply(a.X, b.Z)),
+				VectorRegister8Subtract(VectorRegister8Multiply(a.X, b.Y), VectorRegister8Multiply(a.Y, b.X))
+			);
+		}
+
+		inline Vector3x8 Vector3x8::Lerp(const Vector3x8& start, const Vector3x8& end, const VectorRegister8& ratio)
+		{
+			return Vector3x8(
+				VectorRegister8MultiplyAdd(VectorRegister8Subtract(end.X, start.X), ratio, start.X),
+				VectorRegister8MultiplyAdd(VectorRegister8Subtract(end.Y, start.Y), ratio, start.Y),
+				VectorRegister8MultiplyAdd(VectorRegister8Subtract(end.Z, start.Z), ratio, start.Z)
+			);
+		}
+
+		inline VectorRegister8 Vector3x8::ManhattanDistance(const Vector3x8& a, const Vector3x8& b)
+		{
+			VectorRegister8 DeltaX = VectorRegister8Abs(VectorRegister8Subtract(b.X, a.X));
+			VectorRegister8 DeltaY = VectorRegister8Abs(VectorRegister8Subtract(b.Y, a.Y));
+			VectorRegister8 DeltaZ = VectorRegister8Abs(VectorRegister8Subtract(b.Z, a.Z));
+
+			return VectorRegister8Add(VectorRegister8Add(DeltaX, DeltaY), DeltaZ);
+		}
+
+		inline VectorRegister8 Vector3x8::Length() const
+		{
+			return VectorRegister8Sqrt(LengthSquared());
+		}
+
+		inline VectorRegister8 Vector3x8::LengthSquared() const
+		{
+			return DotProduct(*this, *this);
+		}
+
+		inline const Vector3x8& Vector3x8::Normalize()
+		{
+			const VectorRegister8 Magnitude = VectorRegister8Divide(VectorRegister8Replicate(1.0f), VectorRegister8Add(Length(), VectorRegister8Replicate(EPSILON)));
+			X = VectorRegister8Multiply(X, Magnitude);
+			Y = VectorRegister8Multiply(Y, Magnitude);
+			Z = VectorRegister8Multiply(Z, Magnitude);
+
+			return *this;
+		}
+
+		/* Vector3DStream */
+
+		inline Vector3D Vector3DStream::Get(uint32 index) const
+		{
+			return Vector3D(GetX()[index], GetY()[index], GetZ()[index]);
+		}
+
+		inline void Vector3DStream::Set(uint32 index, const Vector3D& v)
+		{
+			GetX()[index] = v.X;
+			GetY()[index] = v.Y;
+			GetZ()[index] = v.Z;
+		}
+
+		inline Vector3x4 Vector3DStream::LoadPacket4(uint32 index) const
+		{
+			return Vector3x4::Load(GetX() + index, GetY() + index, GetZ() + index);
+		}
+
+		inline Vector3x8 Vector3DStream::LoadPacket8(uint32 index) const
+		{
+			return Vector3x8::Load(GetX() + index, GetY() + index, GetZ() + index);
+		}
+
+		inline void Vector3DStream::StorePacket4(uint32 index, const Vector3x4& packet)
+		{
+			packet.Store(GetX() + index, GetY() + index, GetZ() + index);
+		}
+
+		inline void Vector3DStream::StorePacket8(uint32 index, const Vector3x8& packet)
+		{
+			packet.Store(GetX() + index, GetY() + index, GetZ() + index);
+		}
+
+		inline void Vector3DStream::FromAoS(const Vector3D* inVectors, uint32 count)
+		{
+			Arrays.FromInterleaved(reinterpret_cast<const float*>(inVectors), count);
+		}
+
+		inline void Vector3DStream::ToAoS(Vector3D* outVectors) const
+		{
+			Arrays.ToInterleaved(reinterpret_cast<float*>(outVectors));
+		}
+
+		inline void Vector3DStream::DotProduct(const Vector3DStream& a, const Vector3DStream& b, float* outDots)
+		{
+			/* 'outDots' is not padded, so the last partial packet goes through a temporary */
+			uint32 i = 0;
+			for (; i + 8 <= a.Size(); i += 8)
+			{
+				StoreVectorRegister8(outDots + i, Vector3x8::DotProduct(a.LoadPacket8(i), b.LoadPacket8(i)));
+			}
+
+			if (i < a.Size())
+			{
+				alignas(32) float Tail[8];
+				StoreVectorRegister8Aligned(Tail, Vector3x8::DotProduct(a.LoadPacket8(i), b.LoadPacket8(i)));
+				std::memcpy(outDots + i, Tail, (a.Size() - i) * sizeof(float));
+			}
+		}
+
+		inline void Vector3DStream::CrossProduct(const Vector3DStream& a, const Vector3DStream& b, Vector3DStream& outCross)
+		{
+			for (uint32 i = 0; i < a.PaddedSize(); i += 8)
+			{
+				outCross.StorePacket8(i, Vector3x8::CrossProduct(a.LoadPacket8(i), b.LoadPacket8(i)));
+			}
+		}
+
+		inline void Vector3DStream::Lerp(const Vector3DStream& start, const Vector3DStream& end, float ratio, Vector3DStream& outLerp)
+		{
+			const VectorRegister8 Ratio = VectorRegister8Replicate(ratio);
+			for (uint32 i = 0; i < start.PaddedSize(); i += 8)
+			{
+				outLerp.StorePacket8(i, Vector3x8::Lerp(start.LoadPacket8(i), end.LoadPacket8(i), Ratio));
+			}
+		}
+
+		inline void Vector3DStream::ManhattanDistance(const Vector3DStream& a, const Vector3DStream& b, float* outDistances)
+		{
+			uint32 i = 0;
+			for (; i + 8 <= a.Size(); i += 8)
+			{
+				StoreVectorRegister8(outDistances + i, Vector3x8::ManhattanDistance(a.LoadPacket8(i), b.LoadPacket8(i)));
+			}
+
+			if (i < a.Size())
+			{
+				alignas(32) float Tail[8];
+				StoreVectorRegister8Aligned(Tail, Vector3x8::ManhattanDistance(a.LoadPacket8(i), b.LoadPacket8(i)));
+				std::memcpy(outDistances + i, Tail, (a.Size() - i) * sizeof(float));
+			}
+		}
+
+		inline void Vector3DStream::Length(float* outLengths) const
+		{
+			uint32 i = 0;
+			for (; i + 8 <= Size(); i += 8)
+			{
+				StoreVectorRegister8(outLengths + i, LoadPacket8(i).Length());
+			}
+
+			if (i < Size())
+			{
+				alignas(32) float Tail[8];
+				StoreVectorRegister8Aligned(Tail, LoadPacket8(i).Length());
+				std::memcpy(outLengths + i, Tail, (Size() - i) * sizeof(float));
+			}
+		}
+
+		inline void Vector3DStream::Normalize()
+		{
+			/* Padding is zero, which normalizes to zero, so whole packets are safe */
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+			if (GetActiveSIMDLevel() >= SIMDLevel::AVX2)
+			{
+				SIMDKernelsAVX2::NormalizeSoA(GetX(), GetY(), GetZ(), PaddedSize());
+				return;
+			}
+#endif
+			SIMDKernels::NormalizeSoA(GetX(), GetY(), GetZ(), PaddedSize());
+		}
+	}
+}
@@ -1,11 +1,15 @@
 #pragma once
 #include "Vector3D.h"
+#include "VrixicMathSIMD.h"
+
+#include <type_traits>
 
 namespace Vrixic
 {
 	namespace Math
 	{
-		struct Vector4D
+		/* 16-byte aligned so the components can be loaded straight into a VectorRegister */
+		struct alignas(16) Vector4D
 		{
 		public:
 			float X;
@@ -14,13 +18,15 @@ namespace Vrixic
 			float W;
 
 		public:
-			inline Vector4D();
+			inline constexpr Vector4D();
+
+			inline constexpr Vector4D(float val);
 
-			inline Vector4D(float val);
+			inline constexpr Vector4D(float x, float y, float z, float w = 1);
 
-			inline Vector4D(float x, float y, float z, float w = 1);
+			inline constexpr Vector4D(const Vector3D& v, float w = 1);
 
-			inline Vector4D(const Vector3D& v, float w = 1);
+			inline explicit Vector4D(const VectorRegister& v);
 
 		public:
 			/* Unary operator overloads */
@@ -53,7 +59,7 @@ namespace Vrixic
 			inline Vector4D operator/=(const Vector4D& v);
 
 		public:
-			inline static Vector4D ZeroVector();
+			inline constexpr static Vector4D ZeroVector();
 
 			inline static float DotProduct(const Vector4D& a, const Vector4D& b);
 
@@ -66,82 +72,83 @@ namespace Vrixic
 			inline const Vector4D& Normalize();
 
 			inline Vector3D ToVector3D() const;
+
+			/* Loads all 4 components into a vector register */
+			inline VectorRegister ToVectorRegister() const;
 		};
 
-		inline Vector4D::Vector4D()
+		static_assert(std::is_trivially_copyable<Vector4D>::value, "Vector4D should stay trivially copyable");
+
+		inline constexpr Vector4D::Vector4D()
 			: X(0.0f), Y(0.0f), Z(0.0f), W(0.0f) {}
 
-		inline Vector4D::Vector4D(float val)
+		inline constexpr Vector4D::Vector4D(float val)
 			: X(val), Y(val), Z(val), W(val) {}
 
-		inline Vector4D::Vector4D(float x, float y, float z, float w)
+		inline constexpr Vector4D::Vector4D(float x, float y, float z, float w)
 			: X(x), Y(y), Z(z), W(w) {}
 
-		inline Vector4D::Vector4D(const Vector3D& v, float w)
+		inline constexpr Vector4D::Vector4D(const Vector3D& v, float w)
 			: X(v.X), Y(v.Y), Z(v.Z), W(w) {}
 
+		inline Vector4D::Vector4D(const VectorRegister& v)
+		{
+			StoreVectorRegisterAligned(&X, v);
+		}
+
 		inline Vector4D Vector4D::operator+(const Vector4D& v) const
 		{
-			return Vector4D(X + v.X, Y + v.Y, Z + v.Z, W + v.W);
+			return Vector4D(VectorRegisterAdd(ToVectorRegister(), v.ToVectorRegister()));
 		}
 
 		inline Vector4D Vector4D::operator-(const Vector4D& v) const
 		{
-			return Vector4D(X - v.X, Y - v.Y, Z - v.Z, W - v.W);
+			return Vector4D(VectorRegisterSubtract(ToVectorRegister(), v.ToVectorRegister()));
 		}
 
 		inline Vector4D Vector4D::operator-() const
 		{
-			return Vector4D(-X, -Y, -Z, -W);
+			return Vector4D(VectorRegisterNegate(ToVectorRegister()));
 		}
 
 		inline Vector4D Vector4D::operator*(float scalar) const
 		{
-			return Vector4D(X * scalar, Y * scalar, Z * scalar, W * scalar);
+			return Vector4D(VectorRegisterMultiply(ToVectorRegister(), VectorRegisterReplicate(scalar)));
 		}
 
 		inline Vector4D Vector4D::operator/(float scalar) const
 		{
 			float r = 1.0f / scalar;
-			return Vector4D(X * r, Y * r, Z * r, W * r);
+			return Vector4D(VectorRegisterMultiply(ToVectorRegister(), VectorRegisterReplicate(r)));
 		}
 
 		inline Vector4D Vector4D::operator*(const Vector4D& v) const
 		{
-			return Vector4D(X * v.X, Y * v.Y, Z * v.Z, W * v.W);
+			return Vector4D(VectorRegisterMultiply(ToVectorRegister(), v.ToVectorRegister()));
 		}
 
 		inline Vector4D Vector4D::operator/(const Vector4D& v) const
 		{
-			return Vector4D(X / v.X, Y / v.Y, Z / v.Z, W / v.W);
+			return Vector4D(VectorRegisterDivide(ToVectorRegister(), v.ToVectorRegister()));
 		}
 
 		inline Vector4D Vector4D::operator+=(const Vector4D& v)
 		{
-			X += v.X;
-			Y += v.Y;
-			Z += v.Z;
-			W += v.W;
+			StoreVectorRegisterAligned(&X, VectorRegisterAdd(ToVectorRegister(), v.ToVectorRegister()));
 
 			return *this;
 		}
 
 		inline Vector4D Vector4D::operator-=(const Vector4D& v)
 		{
-			X -= v.X;
-			Y -= v.Y;
-			Z -= v.Z;
-			W -= v.W;
+			StoreVectorRegisterAligned(&X, VectorRegisterSubtract(ToVectorRegister(), v.ToVectorRegister()));
 
 			return *this;
 		}
 
 		inline Vector4D Vector4D::operator*=(float scalar)
 		{
-			X *= scalar;
-			Y *= scalar;
-			Z *= scalar;
-			W *= scalar;
+			StoreVectorRegisterAligned(&X, VectorRegisterMultiply(ToVectorRegister(), VectorRegisterReplicate(scalar)));
 
 			return *this;
 		}
@@ -149,48 +156,41 @@ namespace Vrixic
 		inline Vector4D Vector4D::operator/=(float scalar)
 		{
 			float r = 1.0f / scalar;
-			X *= r;
-			Y *= r;
-			Z *= r;
-			W *= r;
+			StoreVectorRegisterAligned(&X, VectorRegisterMultiply(ToVectorRegister(), VectorRegisterReplicate(r)));
 
 			return *this;
 		}
 
 		inline Vector4D Vector4D::operator*=(const Vector4D& v)
 		{
-			X *= v.X;
-			Y *= v.Y;
-			Z *= v.Z;
-			W *= v.W;
+			StoreVectorRegisterAligned(&X, VectorRegisterMultiply(ToVectorRegister(), v.ToVectorRegister()));
 
 			return *this;
 		}
 
 		inline Vector4D Vector4D::operator/=(const Vector4D& v)
 		{
-			X /= v.X;
-			Y /= v.Y;
-			Z /= v.Z;
-			W /= v.W;
+			StoreVectorRegisterAligned(&X, VectorRegisterDivide(ToVectorRegister(), v.ToVectorRegister()));
 
 			return *this;
 		}
 
-		inline Vector4D Vector4D::ZeroVector()
+		inline constexpr Vector4D Vector4D::ZeroVector()
 		{
 			return Vector4D(0, 0, 0, 0);
 		}
 
 		inline float Vector4D::DotProduct(const Vector4D& a, const Vector4D& b)
 		{
-			return (a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W);
+			return VectorRegisterGetX(VectorRegisterDot4(a.ToVectorRegister(), b.ToVectorRegister()));
 		}
 
 		inline Vector4D Vector4D::Lerp(const Vector4D& start, const Vector4D& end, float ratio)
 		{
 			//return Vector4D(MathUtils::Lerp(start.X, end.X, ratio), MathUtils::Lerp(start.Y, end.Y, ratio), MathUtils::Lerp(start.Z, end.Z, ratio), MathUtils::Lerp(start.W, end.W, ratio));
-			return start + (end - start) * ratio;
+			VectorRegister Start = start.ToVectorRegister();
+			VectorRegister Delta = VectorRegisterSubtract(end.ToVectorRegister(), Start);
+			return Vector4D(VectorRegisterMultiplyAdd(Delta, VectorRegisterReplicate(ratio), Start));
 		}
 
 		inline float Vector4D::Length() const
@@ -205,11 +205,9 @@ namespace Vrixic
 
 		inline const Vector4D& Vector4D::Normalize()
 		{
-			const float Magnitude = (1.0f / (Length() + EPSILON));
-			X *= Magnitude;
-			Y *= Magnitude;
-			Z *= Magnitude;
-			W *= Magnitude;
+			VectorRegister V = ToVectorRegister();
+			VectorRegister Magnitude = VectorRegisterAdd(VectorRegisterSqrt(VectorRegisterDot4(V, V)), VectorRegisterReplicate(EPSILON));
+			StoreVectorRegisterAligned(&X, VectorRegisterDivide(V, Magnitude));
 
 			return *this;
 		}
@@ -218,5 +216,10 @@ namespace Vrixic
 		{
 			return Vector3D(X, Y, Z);
 		}
+
+		inline VectorRegister Vector4D::ToVectorRegister() const
+		{
+			return VectorRegisterLoadAligned(&X);
+		}
 	}
 }
@@ -0,0 +1,262 @@
+#pragma once
+#include "GenericDefines.h"
+#include "VrixicMathSIMD.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+/*
+* Runtime CPU feature detection for the batch kernels
+*
+* The inline math always uses the instruction set the compiler is targeting (see VrixicMathSIMD.h)
+* The batch kernels (Matrix4D::TransformPoints, Frustum::CullAABBs, ...) can also use a wider instruction set than the
+* binary was compiled for, picked at startup with CPUID. This way one SSE2 build runs the AVX2 kernels where it can and
+* still runs on older CPUs
+*
+* The level can be forced for testing with SetSIMDLevel() or the VRIXIC_MATH_SIMD_LEVEL environment variable
+* (scalar, sse2, sse4, avx2, avx512). The active level, forced or detected, is always one this build has kernels for:
+* the compiled level, or AVX2 when dispatching. A level between the two (sse4 in an SSE2 build) runs and reports the
+* compiled level, and nothing goes above what the CPU supports
+*
+* Define VRIXIC_MATH_NO_DISPATCH before including to only use the compile time instruction set
+*/
+#if defined(_M_X64) || defined(_M_AMD64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define VRIXIC_MATH_X86 1
+#endif
+
+#if defined(VRIXIC_MATH_X86) && defined(VRIXIC_SIMD_SSE2) && !defined(VRIXIC_SIMD_AVX2) && !defined(VRIXIC_MATH_NO_DISPATCH) \
+	&& (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+	#define VRIXIC_MATH_DISPATCH_AVX2 1
+#endif
+
+#if defined(VRIXIC_MATH_X86)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+enum class SIMDLevel : uint32
+{
+	Scalar = 0,
+	SSE2,
+	SSE4,
+	AVX2,
+	AVX512
+};
+
+/* returns the name of the level, the same names are accepted by VRIXIC_MATH_SIMD_LEVEL */
+inline const char* GetSIMDLevelName(SIMDLevel level)
+{
+	switch (level)
+	{
+	case SIMDLevel::SSE2:
+		return "sse2";
+	case SIMDLevel::SSE4:
+		return "sse4";
+	case SIMDLevel::AVX2:
+		return "avx2";
+	case SIMDLevel::AVX512:
+		return "avx512";
+	default:
+		return "scalar";
+	}
+}
+
+/* returns the level the inline math was compiled for, nothing runs below this level */
+inline SIMDLevel GetCompiledSIMDLevel()
+{
+#if defined(VRIXIC_SIMD_AVX2)
+	return SIMDLevel::AVX2;
+#elif defined(VRIXIC_SIMD_SSE4)
+	return SIMDLevel::SSE4;
+#elif defined(VRIXIC_SIMD_SSE2)
+	return SIMDLevel::SSE2;
+#else
+	return SIMDLevel::Scalar;
+#endif
+}
+
+namespace VrixicCPU
+{
+#if defined(VRIXIC_MATH_X86)
+	/* Registers returned by CPUID: EAX, EBX, ECX, EDX */
+	inline void CPUID(uint32 leaf, uint32 subLeaf, uint32 outRegisters[4])
+	{
+#if defined(_MSC_VER)
+		int Registers[4];
+		__cpuidex(Registers, static_cast<int>(leaf), static_cast<int>(subLeaf));
+		std::memcpy(outRegisters, Registers, sizeof(Registers));
+#else
+		__cpuid_count(leaf, subLeaf, outRegisters[0], outRegisters[1], outRegisters[2], outRegisters[3]);
+#endif
+	}
+
+	/* Which register states the OS saves on a context switch, only valid when CPUID reports OSXSAVE */
+	inline uint64 ReadXCR0()
+	{
+#if defined(_MSC_VER)
+		return static_cast<uint64>(_xgetbv(0));
+#else
+		uint32 Low, High;
+		__asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+		return (static_cast<uint64>(High) << 32) | Low;
+#endif
+	}
+#endif
+
+	inline SIMDLevel DetectSIMDLevel()
+	{
+#if defined(VRIXIC_MATH_X86)
+		uint32 Registers[4];
+		CPUID(0, 0, Registers);
+		const uint32 MaxLeaf = Registers[0];
+
+		CPUID(1, 0, Registers);
+		const uint32 Leaf1ECX = Registers[2];
+		const uint32 Leaf1EDX = Registers[3];
+
+		if (!(Leaf1EDX & (1u << 26)))
+		{
+			return SIMDLevel::Scalar;
+		}
+
+		if (!(Leaf1ECX & (1u << 19)))
+		{
+			return SIMDLevel::SSE2;
+		}
+
+		/* AVX needs the CPU support and the OS saving the YMM registers */
+		const bool HasOSXSave = (Leaf1ECX & (1u << 27)) != 0;
+		const bool HasAVX = (Leaf1ECX & (1u << 28)) != 0;
+		const bool HasFMA = (Leaf1ECX & (1u << 12)) != 0;
+		if (MaxLeaf < 7 || !HasOSXSave || !HasAVX || !HasFMA)
+		{
+			return SIMDLevel::SSE4;
+		}
+
+		const uint64 XCR0 = ReadXCR0();
+		if ((XCR0 & 0x6) != 0x6)
+		{
+			return SIMDLevel::SSE4;
+		}
+
+		CPUID(7, 0, Registers);
+		const uint32 Leaf7EBX = Registers[1];
+		if (!(Leaf7EBX & (1u << 5)))
+		{
+			return SIMDLevel::SSE4;
+		}
+
+		/* AVX-512F, also needs the opmask and ZMM registers saved */
+		if ((Leaf7EBX & (1u << 16)) && (XCR0 & 0xE6) == 0xE6)
+		{
+			return SIMDLevel::AVX512;
+		}
+
+		return SIMDLevel::AVX2;
+#else
+		return GetCompiledSIMDLevel();
+#endif
+	}
+
+	/* Parses VRIXIC_MATH_SIMD_LEVEL, returns false when it is not set or not a known level */
+	inline bool ReadSIMDLevelOverride(SIMDLevel& outLevel)
+	{
+		char Value[16] = { };
+#if defined(_MSC_VER)
+		size_t Length = 0;
+		if (getenv_s(&Length, Value, sizeof(Value), "VRIXIC_MATH_SIMD_LEVEL") != 0 || Length == 0)
+		{
+			return false;
+		}
+#else
+		const char* Env = std::getenv("VRIXIC_MATH_SIMD_LEVEL");
+		if (Env == nullptr)
+		{
+			return false;
+		}
+		std::strncpy(Value, Env, sizeof(Value) - 1);
+#endif
+
+		for (uint32 i = 0; i <= static_cast<uint32>(SIMDLevel::AVX512); ++i)
+		{
+			if (std::strcmp(Value, GetSIMDLevelName(static_cast<SIMDLevel>(i))) == 0)
+			{
+				outLevel = static_cast<SIMDLevel>(i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/* Widest level this build has kernels for, anything above it runs the same code */
+	inline SIMDLevel GetHighestKernelSIMDLevel()
+	{
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+		return SIMDLevel::AVX2;
+#else
+		return GetCompiledSIMDLevel();
+#endif
+	}
+
+	/* The compiled level and GetHighestKernelSIMDLevel() are the only ones with their own kernels, others map down to one of them */
+	inline SIMDLevel ClampSIMDLevel(SIMDLevel level, SIMDLevel supported)
+	{
+		if (level > supported)
+		{
+			level = supported;
+		}
+
+		return level >= GetHighestKernelSIMDLevel() ? GetHighestKernelSIMDLevel() : GetCompiledSIMDLevel();
+	}
+
+	/* Shared by every translation unit, the function local static makes sure there is only one */
+	inline std::atomic<uint32>& ActiveSIMDLevelStorage()
+	{
+		static std::atomic<uint32> ActiveLevel(static_cast<uint32>(-1));
+		return ActiveLevel;
+	}
+}
+
+/* returns the widest level this CPU and OS support, detected once */
+inline SIMDLevel GetSupportedSIMDLevel()
+{
+	static const SIMDLevel Supported = VrixicCPU::DetectSIMDLevel();
+	return Supported;
+}
+
+/**
+* Forces the level the batch kernels use
+*
+* @param level - lowered to what the CPU supports, then to the compiled level unless it reaches the widest kernels in this build
+*/
+inline void SetSIMDLevel(SIMDLevel level)
+{
+	const SIMDLevel Level = VrixicCPU::ClampSIMDLevel(level, GetSupportedSIMDLevel());
+	VrixicCPU::ActiveSIMDLevelStorage().store(static_cast<uint32>(Level), std::memory_order_relaxed);
+}
+
+/* Goes back to the VRIXIC_MATH_SIMD_LEVEL override if there is one, the supported level otherwise */
+inline void ResetSIMDLevel()
+{
+	SIMDLevel Level = GetSupportedSIMDLevel();
+	VrixicCPU::ReadSIMDLevelOverride(Level);
+	SetSIMDLevel(Level);
+}
+
+/* returns the level the batch kernels currently use */
+inline SIMDLevel GetActiveSIMDLevel()
+{
+	uint32 Level = VrixicCPU::ActiveSIMDLevelStorage().load(std::memory_order_relaxed);
+	if (Level == static_cast<uint32>(-1))
+	{
+		ResetSIMDLevel();
+		Level = VrixicCPU::ActiveSIMDLevelStorage().load(std::memory_order_relaxed);
+	}
+
+	return static_cast<SIMDLevel>(Level);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "VrixicMathTranscendental.h"
+
 #include <cstdlib>
 
 #define PI (3.1415926535897932f)
@@ -73,4 +75,66 @@ public:
 	{
 		return (RADSTODEG * radians);
 	}
+
+	/* Scalar versions of the VrixicMathTranscendental.h functions, the error of every accuracy tier is listed there */
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static void SinCos(float radians, float& outSin, float& outCos)
+	{
+		using namespace TranscendentalKernels;
+		ScalarOps::Register S, C;
+		TranscendentalKernels::SinCos<Accuracy, ScalarWidth>(ScalarOps::Replicate(radians), S, C);
+		outSin = ScalarOps::GetX(S);
+		outCos = ScalarOps::GetX(C);
+	}
+
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static float Sin(float radians)
+	{
+		float S, C;
+		SinCos<Accuracy>(radians, S, C);
+		return S;
+	}
+
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static float Cos(float radians)
+	{
+		float S, C;
+		SinCos<Accuracy>(radians, S, C);
+		return C;
+	}
+
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static float Atan2(float y, float x)
+	{
+		using namespace TranscendentalKernels;
+		return ScalarOps::GetX(TranscendentalKernels::Atan2<Accuracy, ScalarWidth>(ScalarOps::Replicate(y), ScalarOps::Replicate(x)));
+	}
+
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static float Acos(float x)
+	{
+		using namespace TranscendentalKernels;
+		return ScalarOps::GetX(TranscendentalKernels::Acos<Accuracy, ScalarWidth>(ScalarOps::Replicate(x)));
+	}
+
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static float Exp(float x)
+	{
+		using namespace TranscendentalKernels;
+		return ScalarOps::GetX(TranscendentalKernels::Exp<Accuracy, ScalarWidth>(ScalarOps::Replicate(x)));
+	}
+
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static float Log(float x)
+	{
+		using namespace TranscendentalKernels;
+		return ScalarOps::GetX(TranscendentalKernels::Log<Accuracy, ScalarWidth>(ScalarOps::Replicate(x)));
+	}
+
+	template<MathAccuracy Accuracy = MathAccuracy::Precise>
+	inline static float ReciprocalSqrt(float x)
+	{
+		using namespace TranscendentalKernels;
+		return ScalarOps::GetX(TranscendentalKernels::ReciprocalSqrt<Accuracy, ScalarWidth>(ScalarOps::Replicate(x)));
+	}
 };
@@ -0,0 +1,125 @@
+#pragma once
+#include "VrixicMathCPU.h"
+#include "VrixicMathHelper.h"
+
+/*
+* Batch kernels shared by Matrix4D, Frustum, Quat and Vector3DStream
+*
+* The 8 wide kernels are written once in VrixicMathKernels8.h on top of VectorRegister8 and built twice:
+*	SIMDKernels     - with the instruction set the binary is compiled for, what the types call by default
+*	SIMDKernelsAVX2 - under an avx2,fma target, used when the binary is compiled for less than AVX2 but the CPU has it
+*		(see VrixicMathCPU.h). Only called after GetActiveSIMDLevel() reported AVX2 or higher
+*/
+namespace SIMDKernels
+{
+#include "VrixicMathKernels8.h"
+}
+
+#if defined(VRIXIC_MATH_DISPATCH_AVX2)
+
+#include <immintrin.h>
+
+/* MSVC allows AVX intrinsics in any function, GCC and Clang need the instruction set enabled for every function in here */
+#if defined(__clang__)
+	#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target("avx2,fma")
+#endif
+
+namespace SIMDKernelsAVX2
+{
+	/* Same VectorRegister8 functions as the inline math, only as native __m256 with FMA */
+	#define VRIXIC_SIMD8_AVX2 1
+	#define VRIXIC_SIMD8_FMA 1
+
+	#include "VrixicMathSIMD8.h"
+	#include "VrixicMathKernels8.h"
+
+	#undef VRIXIC_SIMD8_AVX2
+	#undef VRIXIC_SIMD8_FMA
+
+	/* Integer kernels without a VectorRegister8 equivalent */
+
+	/* HalfVector3D::EncodeBatch, same integer rounding as HalfVector3D::FloatToHalf() without needing F16C */
+	inline uint32 FloatsToHalves(const float* values, uint16* results, uint32 count)
+	{
+		const __m256i SignMask = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+		const __m256i Overflow = _mm256_set1_epi32(0x477FFFFF);
+		const __m256i Infinity = _mm256_set1_epi32(0x7F800000);
+		const __m256i SubnormalLimit = _mm256_set1_epi32(0x38800000);
+		const __m256i Rebias = _mm256_set1_epi32(static_cast<int>(0xC8000FFFu));
+		const __m256i One = _mm256_set1_epi32(1);
+		const __m256 SubnormalMagic = _mm256_set1_ps(0.5f);
+
+		uint32 i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i Bits = _mm256_castps_si256(_mm256_loadu_ps(values + i));
+			const __m256i Sign = _mm256_and_si256(Bits, SignMask);
+			Bits = _mm256_xor_si256(Bits, Sign);
+
+			/* NaN stays a quiet NaN, everything else too large becomes infinity */
+			const __m256i IsNaN = _mm256_cmpgt_epi32(Bits, Infinity);
+			const __m256i Special = _mm256_blendv_epi8(_mm256_set1_epi32(0x7C00), _mm256_set1_epi32(0x7E00), IsNaN);
+
+			const __m256 Shifted = _mm256_add_ps(_mm256_castsi256_ps(Bits), SubnormalMagic);
+			const __m256i Subnormal = _mm256_sub_epi32(_mm256_castps_si256(Shifted), _mm256_castps_si256(SubnormalMagic));
+
+			const __m256i MantissaOdd = _mm256_and_si256(_mm256_srli_epi32(Bits, 13), One);
+			const __m256i Normal = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(Bits, Rebias), MantissaOdd), 13);
+
+			__m256i Result = _mm256_blendv_epi8(Normal, Subnormal, _mm256_cmpgt_epi32(SubnormalLimit, Bits));
+			Result = _mm256_blendv_epi8(Result, Special, _mm256_cmpgt_epi32(Bits, Overflow));
+			Result = _mm256_or_si256(Result, _mm256_srli_epi32(Sign, 16));
+
+			/* Narrow to 16 bits, packus works per 128-bit half so the two halves are joined afterwards */
+			const __m256i Packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(Result, Result), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), _mm256_castsi256_si128(Packed));
+		}
+
+		_mm256_zeroupper();
+		return i;
+	}
+
+	/* HalfVector3D::DecodeBatch, same as HalfVector3D::HalfToFloat() */
+	inline uint32 HalvesToFloats(const uint16* values, float* results, uint32 count)
+	{
+		const __m256i MagnitudeMask = _mm256_set1_epi32(0x7FFF);
+		const __m256i ExponentMask = _mm256_set1_epi32(0x0F800000);
+		const __m256i Rebias = _mm256_set1_epi32(0x38000000);
+		const __m256i SubnormalBias = _mm256_set1_epi32(0x00800000);
+		const __m256 SubnormalMagic = _mm256_set1_ps(6.103515625e-05f);
+
+		uint32 i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i Halves = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+
+			__m256i Bits = _mm256_slli_epi32(_mm256_and_si256(Halves, MagnitudeMask), 13);
+			const __m256i Exponent = _mm256_and_si256(Bits, ExponentMask);
+			Bits = _mm256_add_epi32(Bits, Rebias);
+
+			/* Infinity / NaN get the rest of the exponent range, subnormals are renormalized by a subtraction */
+			const __m256i Special = _mm256_add_epi32(Bits, Rebias);
+			const __m256 Subnormal = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_add_epi32(Bits, SubnormalBias)), SubnormalMagic);
+
+			__m256 Result = _mm256_castsi256_ps(_mm256_blendv_epi8(Bits, Special, _mm256_cmpeq_epi32(Exponent, ExponentMask)));
+			Result = _mm256_blendv_ps(Result, Subnormal, _mm256_castsi256_ps(_mm256_cmpeq_epi32(Exponent, _mm256_setzero_si256())));
+
+			const __m256i Sign = _mm256_slli_epi32(_mm256_srli_epi32(Halves, 15), 31);
+			_mm256_storeu_ps(results + i, _mm256_or_ps(Result, _mm256_castsi256_ps(Sign)));
+		}
+
+		_mm256_zeroupper();
+		return i;
+	}
+}
+
+#if defined(__clang__)
+	#pragma clang attribute pop
+#elif defined(__GNUC__)
+	#pragma GCC pop_options
+#endif
+
+#endif
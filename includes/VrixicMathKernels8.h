@@ -0,0 +1,272 @@
+/*
+* Bodies of the 8 wide batch kernels, included by VrixicMathKernels.h and nothing else
+*
+* Has no include guard on purpose: it is included once into SIMDKernels, built with the VectorRegister8 of the
+* compiled instruction set, and once more into SIMDKernelsAVX2 under an avx2,fma target for runtime dispatch
+*
+* Every kernel works on raw float arrays, handles whole packets of 8 only and returns how many elements it did,
+* the caller finishes the rest with its own code
+*/
+
+/* Matrix4D::TransformPoints/TransformVectors, 'matrix' is the row major 4x4 */
+inline uint32 TransformVector3DArray(const float* matrix, const float* in, float* out, uint32 count, bool hasTranslation)
+{
+	/* Vectors are split into X/Y/Z registers so every lane is one vector, matrix entries are broadcast once */
+	const VectorRegister8 M00 = VectorRegister8Replicate(matrix[0]), M01 = VectorRegister8Replicate(matrix[1]), M02 = VectorRegister8Replicate(matrix[2]);
+	const VectorRegister8 M10 = VectorRegister8Replicate(matrix[4]), M11 = VectorRegister8Replicate(matrix[5]), M12 = VectorRegister8Replicate(matrix[6]);
+	const VectorRegister8 M20 = VectorRegister8Replicate(matrix[8]), M21 = VectorRegister8Replicate(matrix[9]), M22 = VectorRegister8Replicate(matrix[10]);
+	const VectorRegister8 T0 = VectorRegister8Replicate(hasTranslation ? matrix[12] : 0.0f);
+	const VectorRegister8 T1 = VectorRegister8Replicate(hasTranslation ? matrix[13] : 0.0f);
+	const VectorRegister8 T2 = VectorRegister8Replicate(hasTranslation ? matrix[14] : 0.0f);
+
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		/* Prefetch only inside the array */
+		if (i + 32 < count)
+		{
+			VectorRegisterPrefetch(in + (i + 32) * 3);
+		}
+
+		VectorRegister8 X, Y, Z;
+		VectorRegister8DeinterleaveXYZ(in + i * 3, X, Y, Z);
+
+		VectorRegister8 RX = VectorRegister8MultiplyAdd(Z, M20, VectorRegister8MultiplyAdd(Y, M10, VectorRegister8MultiplyAdd(X, M00, T0)));
+		VectorRegister8 RY = VectorRegister8MultiplyAdd(Z, M21, VectorRegister8MultiplyAdd(Y, M11, VectorRegister8MultiplyAdd(X, M01, T1)));
+		VectorRegister8 RZ = VectorRegister8MultiplyAdd(Z, M22, VectorRegister8MultiplyAdd(Y, M12, VectorRegister8MultiplyAdd(X, M02, T2)));
+
+		VectorRegister8InterleaveXYZ(out + i * 3, RX, RY, RZ);
+	}
+
+	VectorRegister8ZeroUpper();
+	return i;
+}
+
+/* Matrix4D::TransformHomogeneous, 'matrix' has to be 16-byte aligned, the caller fences after streaming */
+inline uint32 TransformVector4DArray(const float* matrix, const float* in, float* out, uint32 count, bool stream)
+{
+	/* Two vectors per register, every row is broadcast into both halves */
+	const VectorRegister8 Row0 = VectorRegister8ReplicateVector(VectorRegisterLoadAligned(matrix));
+	const VectorRegister8 Row1 = VectorRegister8ReplicateVector(VectorRegisterLoadAligned(matrix + 4));
+	const VectorRegister8 Row2 = VectorRegister8ReplicateVector(VectorRegisterLoadAligned(matrix + 8));
+	const VectorRegister8 Row3 = VectorRegister8ReplicateVector(VectorRegisterLoadAligned(matrix + 12));
+
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		if (i + 16 < count)
+		{
+			VectorRegisterPrefetch(in + (i + 16) * 4);
+		}
+
+		for (uint32 j = 0; j < 8; j += 2)
+		{
+			const VectorRegister8 V = MakeVectorRegister8(in + (i + j) * 4);
+			VectorRegister8 R = VectorRegister8Multiply(VectorRegister8ReplicateComponent<0>(V), Row0);
+			R = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<1>(V), Row1, R);
+			R = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<2>(V), Row2, R);
+			R = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<3>(V), Row3, R);
+
+			/* Vector4D is only 16-byte aligned, so streaming is done per half */
+			if (stream)
+			{
+				StreamVectorRegister8(out + (i + j) * 4, R);
+			}
+			else
+			{
+				StoreVectorRegister8(out + (i + j) * 4, R);
+			}
+		}
+	}
+
+	VectorRegister8ZeroUpper();
+	return i;
+}
+
+/*
+* Frustum culling, 'planes' is Frustum::CullingPlaneData: NormalX/Y/Z, AbsNormalX/Y/Z, Distance, 6 floats each
+* Uses plain multiply/add instead of FMA so the result is the same as Frustum::IsAABBVisible()
+* returns the visibility of box i in bit i
+*/
+inline uint32 TestAABBPacket(const float* planes, const VectorRegister8& cx, const VectorRegister8& cy, const VectorRegister8& cz,
+	const VectorRegister8& ex, const VectorRegister8& ey, const VectorRegister8& ez)
+{
+	VectorRegister8 Outside = VectorRegister8Zero();
+	for (uint32 i = 0; i < 6; ++i)
+	{
+		/* Signed distance of the center plus the extents projected onto the normal, negative means fully behind */
+		VectorRegister8 Distance = VectorRegister8Add(VectorRegister8Add(VectorRegister8Multiply(cx, VectorRegister8Replicate(planes[i])),
+			VectorRegister8Multiply(cy, VectorRegister8Replicate(planes[6 + i]))), VectorRegister8Multiply(cz, VectorRegister8Replicate(planes[12 + i])));
+		Distance = VectorRegister8Subtract(Distance, VectorRegister8Replicate(planes[36 + i]));
+
+		VectorRegister8 Radius = VectorRegister8Add(VectorRegister8Add(VectorRegister8Multiply(ex, VectorRegister8Replicate(planes[18 + i])),
+			VectorRegister8Multiply(ey, VectorRegister8Replicate(planes[24 + i]))), VectorRegister8Multiply(ez, VectorRegister8Replicate(planes[30 + i])));
+
+		Outside = VectorRegister8BitwiseOr(Outside, VectorRegister8CompareLess(VectorRegister8Add(Distance, Radius), VectorRegister8Zero()));
+	}
+
+	return ~static_cast<uint32>(VectorRegister8MoveMask(Outside)) & 0xFFu;
+}
+
+/* Frustum::CullAABBs, ORs the bits into 'outVisibilityMask' which the caller cleared */
+inline uint32 CullAABBs(const float* planes, const float* centers, const float* extents, uint32 count, uint32* outVisibilityMask)
+{
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		VectorRegister8 CX, CY, CZ, EX, EY, EZ;
+		VectorRegister8DeinterleaveXYZ(centers + i * 3, CX, CY, CZ);
+		VectorRegister8DeinterleaveXYZ(extents + i * 3, EX, EY, EZ);
+
+		/* i is a multiple of 8, so the 8 bits never straddle two words */
+		outVisibilityMask[i >> 5] |= TestAABBPacket(planes, CX, CY, CZ, EX, EY, EZ) << (i & 31);
+	}
+
+	VectorRegister8ZeroUpper();
+	return i;
+}
+
+/* Frustum::CullAABBsToIndices, 'inOutVisibleCount' is the number of indices already written */
+inline uint32 CullAABBsToIndices(const float* planes, const float* centers, const float* extents, uint32 count, uint32* outVisibleIndices, uint32& inOutVisibleCount)
+{
+	uint32 VisibleCount = inOutVisibleCount;
+
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		VectorRegister8 CX, CY, CZ, EX, EY, EZ;
+		VectorRegister8DeinterleaveXYZ(centers + i * 3, CX, CY, CZ);
+		VectorRegister8DeinterleaveXYZ(extents + i * 3, EX, EY, EZ);
+
+		/* Always write, only advance when visible, so there is no branch per box */
+		const uint32 Visible = TestAABBPacket(planes, CX, CY, CZ, EX, EY, EZ);
+		for (uint32 j = 0; j < 8; ++j)
+		{
+			outVisibleIndices[VisibleCount] = i + j;
+			VisibleCount += (Visible >> j) & 1u;
+		}
+	}
+
+	inOutVisibleCount = VisibleCount;
+	VectorRegister8ZeroUpper();
+	return i;
+}
+
+/* Frustum::CullAABBs for Vector3DStream, the arrays are 32-byte aligned and padded to a multiple of 8, padding lanes never show up in the mask */
+inline void CullAABBsSoA(const float* planes, const float* cx, const float* cy, const float* cz,
+	const float* ex, const float* ey, const float* ez, uint32 count, uint32* outVisibilityMask)
+{
+	for (uint32 i = 0; i < count; i += 8)
+	{
+		uint32 Visible = TestAABBPacket(planes, VectorRegister8LoadAligned(cx + i), VectorRegister8LoadAligned(cy + i), VectorRegister8LoadAligned(cz + i),
+			VectorRegister8LoadAligned(ex + i), VectorRegister8LoadAligned(ey + i), VectorRegister8LoadAligned(ez + i));
+		if (count - i < 8)
+		{
+			Visible &= (1u << (count - i)) - 1u;
+		}
+
+		outVisibilityMask[i >> 5] |= Visible << (i & 31);
+	}
+
+	VectorRegister8ZeroUpper();
+}
+
+/* Vector3DStream::Normalize, same math as Vector3x8::Normalize(), 'paddedCount' is a multiple of 8 and the arrays are 32-byte aligned */
+inline void NormalizeSoA(float* x, float* y, float* z, uint32 paddedCount)
+{
+	const VectorRegister8 One = VectorRegister8Replicate(1.0f);
+	const VectorRegister8 Epsilon = VectorRegister8Replicate(EPSILON);
+
+	for (uint32 i = 0; i < paddedCount; i += 8)
+	{
+		const VectorRegister8 X = VectorRegister8LoadAligned(x + i), Y = VectorRegister8LoadAligned(y + i), Z = VectorRegister8LoadAligned(z + i);
+
+		const VectorRegister8 Length = VectorRegister8Sqrt(VectorRegister8MultiplyAdd(Z, Z, VectorRegister8MultiplyAdd(Y, Y, VectorRegister8Multiply(X, X))));
+		const VectorRegister8 Magnitude = VectorRegister8Divide(One, VectorRegister8Add(Length, Epsilon));
+
+		StoreVectorRegister8Aligned(x + i, VectorRegister8Multiply(X, Magnitude));
+		StoreVectorRegister8Aligned(y + i, VectorRegister8Multiply(Y, Magnitude));
+		StoreVectorRegister8Aligned(z + i, VectorRegister8Multiply(Z, Magnitude));
+	}
+
+	VectorRegister8ZeroUpper();
+}
+
+/* Matrix4D::InverseBatch, 8 matrices per VectorRegister8MatrixInverse(), 'outDeterminants' can be null */
+inline uint32 InverseMatrices(const float* matrices, float* results, float* outDeterminants, uint32 count)
+{
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		VectorRegister8MatrixInverse(results + i * 16, matrices + i * 16, outDeterminants != nullptr ? outDeterminants + i : nullptr);
+	}
+
+	VectorRegister8ZeroUpper();
+	return i;
+}
+
+/* Matrix4D::MultiplyBatch, does every matrix since VectorRegister8MatrixMultiply() works on one pair, 'results' can alias either input */
+inline uint32 MultiplyMatrices(const float* left, const float* right, float* results, uint32 count)
+{
+	uint32 i = 0;
+	for (; i < count; ++i)
+	{
+		VectorRegister8MatrixMultiply(results + i * 16, left + i * 16, right + i * 16);
+	}
+
+	VectorRegister8ZeroUpper();
+	return i;
+}
+
+/* v' = v + w * t + cross(q, t) with t = 2 * cross(q, v) for 8 vectors, same order of operations as Quat::RotateVector() */
+inline void RotatePacket(const VectorRegister8& qx, const VectorRegister8& qy, const VectorRegister8& qz, const VectorRegister8& qw,
+	VectorRegister8& inOutX, VectorRegister8& inOutY, VectorRegister8& inOutZ)
+{
+	const VectorRegister8 Two = VectorRegister8Replicate(2.0f);
+
+	const VectorRegister8 TX = VectorRegister8Multiply(VectorRegister8Subtract(VectorRegister8Multiply(qy, inOutZ), VectorRegister8Multiply(qz, inOutY)), Two);
+	const VectorRegister8 TY = VectorRegister8Multiply(VectorRegister8Subtract(VectorRegister8Multiply(qz, inOutX), VectorRegister8Multiply(qx, inOutZ)), Two);
+	const VectorRegister8 TZ = VectorRegister8Multiply(VectorRegister8Subtract(VectorRegister8Multiply(qx, inOutY), VectorRegister8Multiply(qy, inOutX)), Two);
+
+	inOutX = VectorRegister8Add(VectorRegister8Add(inOutX, VectorRegister8Multiply(TX, qw)), VectorRegister8Subtract(VectorRegister8Multiply(qy, TZ), VectorRegister8Multiply(qz, TY)));
+	inOutY = VectorRegister8Add(VectorRegister8Add(inOutY, VectorRegister8Multiply(TY, qw)), VectorRegister8Subtract(VectorRegister8Multiply(qz, TX), VectorRegister8Multiply(qx, TZ)));
+	inOutZ = VectorRegister8Add(VectorRegister8Add(inOutZ, VectorRegister8Multiply(TZ, qw)), VectorRegister8Subtract(VectorRegister8Multiply(qx, TY), VectorRegister8Multiply(qy, TX)));
+}
+
+/* Quat::RotateVectors with one quaternion, 'quat' is X, Y, Z, W */
+inline uint32 RotateVectors(const float* quat, const float* in, float* out, uint32 count)
+{
+	const VectorRegister8 QX = VectorRegister8Replicate(quat[0]), QY = VectorRegister8Replicate(quat[1]);
+	const VectorRegister8 QZ = VectorRegister8Replicate(quat[2]), QW = VectorRegister8Replicate(quat[3]);
+
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		VectorRegister8 X, Y, Z;
+		VectorRegister8DeinterleaveXYZ(in + i * 3, X, Y, Z);
+		RotatePacket(QX, QY, QZ, QW, X, Y, Z);
+		VectorRegister8InterleaveXYZ(out + i * 3, X, Y, Z);
+	}
+
+	VectorRegister8ZeroUpper();
+	return i;
+}
+
+/* Quat::RotateVectors with one quaternion per vector */
+inline uint32 RotateVectorsPerQuat(const float* quats, const float* in, float* out, uint32 count)
+{
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		VectorRegister8 QX, QY, QZ, QW;
+		VectorRegister8DeinterleaveXYZW(quats + i * 4, QX, QY, QZ, QW);
+
+		VectorRegister8 X, Y, Z;
+		VectorRegister8DeinterleaveXYZ(in + i * 3, X, Y, Z);
+		RotatePacket(QX, QY, QZ, QW, X, Y, Z);
+		VectorRegister8InterleaveXYZ(out + i * 3, X, Y, Z);
+	}
+
+	VectorRegister8ZeroUpper();
+	return i;
+}
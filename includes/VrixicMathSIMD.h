@@ -0,0 +1,856 @@
+#pragma once
+
+/*
+* Portable SIMD layer used by the math types
+*
+* The widest instruction set the compiler is targeting gets picked: AVX2 -> SSE4.1 -> SSE2 -> scalar
+* Define VRIXIC_MATH_NO_SIMD before including to force the scalar fallback
+*/
+#if !defined(VRIXIC_MATH_NO_SIMD)
+	#if defined(__AVX2__)
+		#define VRIXIC_SIMD_AVX2 1
+	#endif
+
+	#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+		#define VRIXIC_SIMD_FMA 1
+	#endif
+
+	#if defined(__SSE4_1__) || defined(__AVX__)
+		#define VRIXIC_SIMD_SSE4 1
+	#endif
+
+	#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define VRIXIC_SIMD_SSE2 1
+	#endif
+#endif
+
+#if defined(VRIXIC_SIMD_AVX2) || defined(VRIXIC_SIMD_FMA)
+#include <immintrin.h>
+#elif defined(VRIXIC_SIMD_SSE4)
+#include <smmintrin.h>
+#elif defined(VRIXIC_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#include <cmath>
+#include <cstring>
+
+#if defined(VRIXIC_SIMD_SSE2)
+
+/* A float4 vector where the X component of the vector is stored in the lowest 32 bits */
+typedef __m128 VectorRegister;
+
+#else
+
+/* A float4 vector where the X component of the vector is stored in the lowest 32 bits */
+struct alignas(16) VectorRegister
+{
+	float V[4];
+};
+
+#endif
+
+/* returns and makes a vector with 4 floats */
+inline VectorRegister MakeVectorRegister(float x, float y, float z, float w)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_setr_ps(x, y, z, w);
+#else
+	return VectorRegister{ { x, y, z, w } };
+#endif
+}
+
+/* returns and makes a vector with 4 floats, 'v' does not have to be aligned */
+inline VectorRegister MakeVectorRegister(const float* v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_loadu_ps(v);
+#else
+	return VectorRegister{ { v[0], v[1], v[2], v[3] } };
+#endif
+}
+
+/* returns and makes a vector with 4 floats, 'v' has to be 16-byte aligned */
+inline VectorRegister VectorRegisterLoadAligned(const float* v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_load_ps(v);
+#else
+	return VectorRegister{ { v[0], v[1], v[2], v[3] } };
+#endif
+}
+
+/* returns a vector with all 4 components set to 'f' */
+inline VectorRegister VectorRegisterReplicate(float f)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_set1_ps(f);
+#else
+	return VectorRegister{ { f, f, f, f } };
+#endif
+}
+
+inline VectorRegister VectorRegisterZero()
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_setzero_ps();
+#else
+	return VectorRegister{ { 0.0f, 0.0f, 0.0f, 0.0f } };
+#endif
+}
+
+/* stores a vector register into 4 floats, 'v' does not have to be aligned */
+inline void StoreVectorRegister(float* v, const VectorRegister& vectorRegister)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	_mm_storeu_ps(v, vectorRegister);
+#else
+	v[0] = vectorRegister.V[0];
+	v[1] = vectorRegister.V[1];
+	v[2] = vectorRegister.V[2];
+	v[3] = vectorRegister.V[3];
+#endif
+}
+
+/* stores a vector register into 4 floats, 'v' has to be 16-byte aligned */
+inline void StoreVectorRegisterAligned(float* v, const VectorRegister& vectorRegister)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	_mm_store_ps(v, vectorRegister);
+#else
+	StoreVectorRegister(v, vectorRegister);
+#endif
+}
+
+/* returns the X component (lowest 32 bits) of the vector register */
+inline float VectorRegisterGetX(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_cvtss_f32(v);
+#else
+	return v.V[0];
+#endif
+}
+
+/* stores a vector register into 4 floats bypassing the cache, 'v' has to be 16-byte aligned, finish with VectorRegisterStreamFence() */
+inline void StreamVectorRegister(float* v, const VectorRegister& vectorRegister)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	_mm_stream_ps(v, vectorRegister);
+#else
+	StoreVectorRegister(v, vectorRegister);
+#endif
+}
+
+/* Orders all previous StreamVectorRegister() stores before any store that follows */
+inline void VectorRegisterStreamFence()
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	_mm_sfence();
+#endif
+}
+
+/* Hints the cache line holding 'address' into the cache, never faults */
+inline void VectorRegisterPrefetch(const void* address)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+	(void)address;
+#endif
+}
+
+/**
+* Splits 4 packed XYZ triples (12 floats) into one register per component
+* 
+* @param in - x0 y0 z0 x1 y1 z1 x2 y2 z2 x3 y3 z3, does not have to be aligned
+*/
+inline void VectorRegisterDeinterleaveXYZ(const float* in, VectorRegister& outX, VectorRegister& outY, VectorRegister& outZ)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	VectorRegister A = _mm_loadu_ps(in);		// x0 y0 z0 x1
+	VectorRegister B = _mm_loadu_ps(in + 4);	// y1 z1 x2 y2
+	VectorRegister C = _mm_loadu_ps(in + 8);	// z2 x3 y3 z3
+
+	outX = _mm_shuffle_ps(A, _mm_shuffle_ps(B, C, _MM_SHUFFLE(1, 0, 3, 2)), _MM_SHUFFLE(3, 0, 3, 0));
+	outY = _mm_shuffle_ps(_mm_shuffle_ps(A, B, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(B, C, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	outZ = _mm_shuffle_ps(_mm_shuffle_ps(A, B, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(C, C, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+#else
+	outX = VectorRegister{ { in[0], in[3], in[6], in[9] } };
+	outY = VectorRegister{ { in[1], in[4], in[7], in[10] } };
+	outZ = VectorRegister{ { in[2], in[5], in[8], in[11] } };
+#endif
+}
+
+/* Packs 3 component registers back into 4 XYZ triples (12 floats), 'out' does not have to be aligned */
+inline void VectorRegisterInterleaveXYZ(float* out, const VectorRegister& inX, const VectorRegister& inY, const VectorRegister& inZ)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	VectorRegister A = _mm_shuffle_ps(_mm_shuffle_ps(inX, inY, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(inZ, inX, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	VectorRegister B = _mm_shuffle_ps(_mm_shuffle_ps(inY, inZ, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(inX, inY, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+	VectorRegister C = _mm_shuffle_ps(_mm_shuffle_ps(inZ, inX, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(inY, inZ, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+	_mm_storeu_ps(out, A);
+	_mm_storeu_ps(out + 4, B);
+	_mm_storeu_ps(out + 8, C);
+#else
+	for (int i = 0; i < 4; ++i)
+	{
+		out[i * 3 + 0] = inX.V[i];
+		out[i * 3 + 1] = inY.V[i];
+		out[i * 3 + 2] = inZ.V[i];
+	}
+#endif
+}
+
+/**
+* Splits 4 XYZW records spaced 'stride' floats apart into one register per component, a 4x4 transpose
+* 
+* @param in - x0 y0 z0 w0, then x1 y1 z1 w1 at in + stride ..., does not have to be aligned
+*/
+inline void VectorRegisterGatherXYZW(const float* in, int stride, VectorRegister& outX, VectorRegister& outY, VectorRegister& outZ, VectorRegister& outW)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	VectorRegister R0 = _mm_loadu_ps(in);
+	VectorRegister R1 = _mm_loadu_ps(in + stride);
+	VectorRegister R2 = _mm_loadu_ps(in + stride * 2);
+	VectorRegister R3 = _mm_loadu_ps(in + stride * 3);
+
+	VectorRegister T0 = _mm_unpacklo_ps(R0, R1);	// x0 x1 y0 y1
+	VectorRegister T1 = _mm_unpackhi_ps(R0, R1);	// z0 z1 w0 w1
+	VectorRegister T2 = _mm_unpacklo_ps(R2, R3);	// x2 x3 y2 y3
+	VectorRegister T3 = _mm_unpackhi_ps(R2, R3);	// z2 z3 w2 w3
+
+	outX = _mm_movelh_ps(T0, T2);
+	outY = _mm_movehl_ps(T2, T0);
+	outZ = _mm_movelh_ps(T1, T3);
+	outW = _mm_movehl_ps(T3, T1);
+#else
+	const float* R1 = in + stride;
+	const float* R2 = in + stride * 2;
+	const float* R3 = in + stride * 3;
+
+	outX = VectorRegister{ { in[0], R1[0], R2[0], R3[0] } };
+	outY = VectorRegister{ { in[1], R1[1], R2[1], R3[1] } };
+	outZ = VectorRegister{ { in[2], R1[2], R2[2], R3[2] } };
+	outW = VectorRegister{ { in[3], R1[3], R2[3], R3[3] } };
+#endif
+}
+
+/* Packs 4 component registers back into 4 XYZW records spaced 'stride' floats apart, 'out' does not have to be aligned */
+inline void VectorRegisterScatterXYZW(float* out, int stride, const VectorRegister& inX, const VectorRegister& inY, const VectorRegister& inZ, const VectorRegister& inW)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	VectorRegister T0 = _mm_unpacklo_ps(inX, inY);	// x0 y0 x1 y1
+	VectorRegister T1 = _mm_unpackhi_ps(inX, inY);	// x2 y2 x3 y3
+	VectorRegister T2 = _mm_unpacklo_ps(inZ, inW);	// z0 w0 z1 w1
+	VectorRegister T3 = _mm_unpackhi_ps(inZ, inW);	// z2 w2 z3 w3
+
+	_mm_storeu_ps(out, _mm_movelh_ps(T0, T2));
+	_mm_storeu_ps(out + stride, _mm_movehl_ps(T2, T0));
+	_mm_storeu_ps(out + stride * 2, _mm_movelh_ps(T1, T3));
+	_mm_storeu_ps(out + stride * 3, _mm_movehl_ps(T3, T1));
+#else
+	for (int i = 0; i < 4; ++i)
+	{
+		out[i * stride + 0] = inX.V[i];
+		out[i * stride + 1] = inY.V[i];
+		out[i * stride + 2] = inZ.V[i];
+		out[i * stride + 3] = inW.V[i];
+	}
+#endif
+}
+
+/* Splits 4 packed XYZW records (16 floats) into one register per component, 'in' does not have to be aligned */
+inline void VectorRegisterDeinterleaveXYZW(const float* in, VectorRegister& outX, VectorRegister& outY, VectorRegister& outZ, VectorRegister& outW)
+{
+	VectorRegisterGatherXYZW(in, 4, outX, outY, outZ, outW);
+}
+
+/* Packs 4 component registers back into 4 XYZW records (16 floats), 'out' does not have to be aligned */
+inline void VectorRegisterInterleaveXYZW(float* out, const VectorRegister& inX, const VectorRegister& inY, const VectorRegister& inZ, const VectorRegister& inW)
+{
+	VectorRegisterScatterXYZW(out, 4, inX, inY, inZ, inW);
+}
+
+/* Component wise operations */
+
+inline VectorRegister VectorRegisterAdd(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_add_ps(a, b);
+#else
+	return VectorRegister{ { a.V[0] + b.V[0], a.V[1] + b.V[1], a.V[2] + b.V[2], a.V[3] + b.V[3] } };
+#endif
+}
+
+inline VectorRegister VectorRegisterSubtract(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_sub_ps(a, b);
+#else
+	return VectorRegister{ { a.V[0] - b.V[0], a.V[1] - b.V[1], a.V[2] - b.V[2], a.V[3] - b.V[3] } };
+#endif
+}
+
+inline VectorRegister VectorRegisterMultiply(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_mul_ps(a, b);
+#else
+	return VectorRegister{ { a.V[0] * b.V[0], a.V[1] * b.V[1], a.V[2] * b.V[2], a.V[3] * b.V[3] } };
+#endif
+}
+
+inline VectorRegister VectorRegisterDivide(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_div_ps(a, b);
+#else
+	return VectorRegister{ { a.V[0] / b.V[0], a.V[1] / b.V[1], a.V[2] / b.V[2], a.V[3] / b.V[3] } };
+#endif
+}
+
+/* returns (a * b) + c */
+inline VectorRegister VectorRegisterMultiplyAdd(const VectorRegister& a, const VectorRegister& b, const VectorRegister& c)
+{
+#if defined(VRIXIC_SIMD_FMA)
+	return _mm_fmadd_ps(a, b, c);
+#elif defined(VRIXIC_SIMD_SSE2)
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#else
+	return VectorRegisterAdd(VectorRegisterMultiply(a, b), c);
+#endif
+}
+
+inline VectorRegister VectorRegisterNegate(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_sub_ps(_mm_setzero_ps(), v);
+#else
+	return VectorRegister{ { -v.V[0], -v.V[1], -v.V[2], -v.V[3] } };
+#endif
+}
+
+inline VectorRegister VectorRegisterAbs(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+#else
+	return VectorRegister{ { std::fabs(v.V[0]), std::fabs(v.V[1]), std::fabs(v.V[2]), std::fabs(v.V[3]) } };
+#endif
+}
+
+inline VectorRegister VectorRegisterMin(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_min_ps(a, b);
+#else
+	return VectorRegister{ { a.V[0] < b.V[0] ? a.V[0] : b.V[0], a.V[1] < b.V[1] ? a.V[1] : b.V[1],
+		a.V[2] < b.V[2] ? a.V[2] : b.V[2], a.V[3] < b.V[3] ? a.V[3] : b.V[3] } };
+#endif
+}
+
+inline VectorRegister VectorRegisterMax(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_max_ps(a, b);
+#else
+	return VectorRegister{ { a.V[0] > b.V[0] ? a.V[0] : b.V[0], a.V[1] > b.V[1] ? a.V[1] : b.V[1],
+		a.V[2] > b.V[2] ? a.V[2] : b.V[2], a.V[3] > b.V[3] ? a.V[3] : b.V[3] } };
+#endif
+}
+
+inline VectorRegister VectorRegisterSqrt(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_sqrt_ps(v);
+#else
+	return VectorRegister{ { std::sqrt(v.V[0]), std::sqrt(v.V[1]), std::sqrt(v.V[2]), std::sqrt(v.V[3]) } };
+#endif
+}
+
+/* Rounds every component to the nearest integer, ties go to even. On SSE2 only valid while |v| < 2^31 */
+inline VectorRegister VectorRegisterRound(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE4)
+	return _mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#elif defined(VRIXIC_SIMD_SSE2)
+	return _mm_cvtepi32_ps(_mm_cvtps_epi32(v));
+#else
+	return VectorRegister{ { std::nearbyint(v.V[0]), std::nearbyint(v.V[1]), std::nearbyint(v.V[2]), std::nearbyint(v.V[3]) } };
+#endif
+}
+
+/**
+* Comparisons return a mask register, a lane is all 1 bits when the comparison is true and 0 otherwise
+* Masks are combined with the Bitwise functions and read back with VectorRegisterMoveMask()
+*/
+
+#if !defined(VRIXIC_SIMD_SSE2)
+/* Scalar fallback helpers, reinterpret a lane as its bits and back */
+inline unsigned int VectorRegisterLaneBits(float f)
+{
+	unsigned int Bits;
+	std::memcpy(&Bits, &f, sizeof(Bits));
+	return Bits;
+}
+
+inline float VectorRegisterLaneFromBits(unsigned int bits)
+{
+	float F;
+	std::memcpy(&F, &bits, sizeof(F));
+	return F;
+}
+
+inline float VectorRegisterLaneMask(bool b)
+{
+	return VectorRegisterLaneFromBits(b ? 0xFFFFFFFFu : 0u);
+}
+#endif
+
+inline VectorRegister VectorRegisterCompareLess(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_cmplt_ps(a, b);
+#else
+	return VectorRegister{ { VectorRegisterLaneMask(a.V[0] < b.V[0]), VectorRegisterLaneMask(a.V[1] < b.V[1]),
+		VectorRegisterLaneMask(a.V[2] < b.V[2]), VectorRegisterLaneMask(a.V[3] < b.V[3]) } };
+#endif
+}
+
+inline VectorRegister VectorRegisterCompareGreater(const VectorRegister& a, const VectorRegister& b)
+{
+	return VectorRegisterCompareLess(b, a);
+}
+
+inline VectorRegister VectorRegisterCompareEqual(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_cmpeq_ps(a, b);
+#else
+	return VectorRegister{ { VectorRegisterLaneMask(a.V[0] == b.V[0]), VectorRegisterLaneMask(a.V[1] == b.V[1]),
+		VectorRegisterLaneMask(a.V[2] == b.V[2]), VectorRegisterLaneMask(a.V[3] == b.V[3]) } };
+#endif
+}
+
+inline VectorRegister VectorRegisterBitwiseAnd(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_and_ps(a, b);
+#else
+	VectorRegister Result;
+	for (int i = 0; i < 4; ++i)
+	{
+		Result.V[i] = VectorRegisterLaneFromBits(VectorRegisterLaneBits(a.V[i]) & VectorRegisterLaneBits(b.V[i]));
+	}
+	return Result;
+#endif
+}
+
+inline VectorRegister VectorRegisterBitwiseOr(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_or_ps(a, b);
+#else
+	VectorRegister Result;
+	for (int i = 0; i < 4; ++i)
+	{
+		Result.V[i] = VectorRegisterLaneFromBits(VectorRegisterLaneBits(a.V[i]) | VectorRegisterLaneBits(b.V[i]));
+	}
+	return Result;
+#endif
+}
+
+inline VectorRegister VectorRegisterBitwiseXor(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_xor_ps(a, b);
+#else
+	VectorRegister Result;
+	for (int i = 0; i < 4; ++i)
+	{
+		Result.V[i] = VectorRegisterLaneFromBits(VectorRegisterLaneBits(a.V[i]) ^ VectorRegisterLaneBits(b.V[i]));
+	}
+	return Result;
+#endif
+}
+
+/* returns 'a' in lanes where 'mask' is set and 'b' everywhere else */
+inline VectorRegister VectorRegisterSelect(const VectorRegister& mask, const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE4)
+	return _mm_blendv_ps(b, a, mask);
+#elif defined(VRIXIC_SIMD_SSE2)
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#else
+	VectorRegister Result;
+	for (int i = 0; i < 4; ++i)
+	{
+		Result.V[i] = (VectorRegisterLaneBits(mask.V[i]) >> 31) ? a.V[i] : b.V[i];
+	}
+	return Result;
+#endif
+}
+
+/* returns the sign bit of every lane packed into the low 4 bits, lane 0 -> bit 0 */
+inline int VectorRegisterMoveMask(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_movemask_ps(v);
+#else
+	return static_cast<int>((VectorRegisterLaneBits(v.V[0]) >> 31) | ((VectorRegisterLaneBits(v.V[1]) >> 31) << 1) |
+		((VectorRegisterLaneBits(v.V[2]) >> 31) << 2) | ((VectorRegisterLaneBits(v.V[3]) >> 31) << 3));
+#endif
+}
+
+/* returns about 12 bits of 1 / sqrt(v) per lane, the scalar fallback computes 1 / sqrt() */
+inline VectorRegister VectorRegisterReciprocalSqrtEstimate(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_rsqrt_ps(v);
+#else
+	return VectorRegister{ { 1.0f / std::sqrt(v.V[0]), 1.0f / std::sqrt(v.V[1]), 1.0f / std::sqrt(v.V[2]), 1.0f / std::sqrt(v.V[3]) } };
+#endif
+}
+
+/**
+* Exponent and mantissa of positive normal floats, v = VectorRegisterMantissa(v) * 2^VectorRegisterExponent(v)
+* Zero, denormals, negative numbers, infinity and NaN have to be handled by the caller
+*/
+
+/* returns the unbiased exponent of every lane as a float */
+inline VectorRegister VectorRegisterExponent(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(v), 23), _mm_set1_epi32(127)));
+#else
+	VectorRegister Result;
+	for (int i = 0; i < 4; ++i)
+	{
+		Result.V[i] = static_cast<float>(static_cast<int>(VectorRegisterLaneBits(v.V[i]) >> 23) - 127);
+	}
+	return Result;
+#endif
+}
+
+/* returns every lane scaled by a power of two into [1, 2) */
+inline VectorRegister VectorRegisterMantissa(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_or_ps(_mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(1.0f));
+#else
+	VectorRegister Result;
+	for (int i = 0; i < 4; ++i)
+	{
+		Result.V[i] = VectorRegisterLaneFromBits((VectorRegisterLaneBits(v.V[i]) & 0x007FFFFFu) | 0x3F800000u);
+	}
+	return Result;
+#endif
+}
+
+/* returns 2^n for integer valued lanes in [-126, 127], built directly in the exponent bits */
+inline VectorRegister VectorRegisterExp2Integer(const VectorRegister& n)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23));
+#else
+	VectorRegister Result;
+	for (int i = 0; i < 4; ++i)
+	{
+		Result.V[i] = VectorRegisterLaneFromBits(static_cast<unsigned int>(static_cast<int>(n.V[i]) + 127) << 23);
+	}
+	return Result;
+#endif
+}
+
+/* Shuffles the components of 'v', each index selects the source component (0 = X ... 3 = W) */
+template<int X, int Y, int Z, int W>
+inline VectorRegister VectorRegisterSwizzle(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+#else
+	return VectorRegister{ { v.V[X], v.V[Y], v.V[Z], v.V[W] } };
+#endif
+}
+
+/* returns (a[X], a[Y], b[Z], b[W]), the first two components come from 'a' and the last two from 'b' */
+template<int X, int Y, int Z, int W>
+inline VectorRegister VectorRegisterShuffle(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE2)
+	return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+#else
+	return VectorRegister{ { a.V[X], a.V[Y], b.V[Z], b.V[W] } };
+#endif
+}
+
+/* returns a vector with all 4 components set to component 'I' of 'v' */
+template<int I>
+inline VectorRegister VectorRegisterReplicateComponent(const VectorRegister& v)
+{
+	return VectorRegisterSwizzle<I, I, I, I>(v);
+}
+
+/* returns the 4 component dot product replicated into all components */
+inline VectorRegister VectorRegisterDot4(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE4)
+	return _mm_dp_ps(a, b, 0xFF);
+#elif defined(VRIXIC_SIMD_SSE2)
+	VectorRegister Mul = _mm_mul_ps(a, b);
+	VectorRegister Sum = _mm_add_ps(Mul, _mm_shuffle_ps(Mul, Mul, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_add_ps(Sum, _mm_shuffle_ps(Sum, Sum, _MM_SHUFFLE(1, 0, 3, 2)));
+#else
+	return VectorRegisterReplicate(a.V[0] * b.V[0] + a.V[1] * b.V[1] + a.V[2] * b.V[2] + a.V[3] * b.V[3]);
+#endif
+}
+
+/* returns the 3 component dot product replicated into all components, W is ignored */
+inline VectorRegister VectorRegisterDot3(const VectorRegister& a, const VectorRegister& b)
+{
+#if defined(VRIXIC_SIMD_SSE4)
+	return _mm_dp_ps(a, b, 0x7F);
+#elif defined(VRIXIC_SIMD_SSE2)
+	VectorRegister Mul = _mm_mul_ps(a, b);
+	VectorRegister Sum = _mm_add_ss(Mul, _mm_shuffle_ps(Mul, Mul, _MM_SHUFFLE(1, 1, 1, 1)));
+	Sum = _mm_add_ss(Sum, _mm_shuffle_ps(Mul, Mul, _MM_SHUFFLE(2, 2, 2, 2)));
+	return _mm_shuffle_ps(Sum, Sum, _MM_SHUFFLE(0, 0, 0, 0));
+#else
+	return VectorRegisterReplicate(a.V[0] * b.V[0] + a.V[1] * b.V[1] + a.V[2] * b.V[2]);
+#endif
+}
+
+/* returns the cross product of the XYZ components, W of the result is 0 */
+inline VectorRegister VectorRegisterCross3(const VectorRegister& a, const VectorRegister& b)
+{
+	VectorRegister Result = VectorRegisterMultiply(VectorRegisterSwizzle<1, 2, 0, 3>(a), VectorRegisterSwizzle<2, 0, 1, 3>(b));
+	return VectorRegisterSubtract(Result, VectorRegisterMultiply(VectorRegisterSwizzle<2, 0, 1, 3>(a), VectorRegisterSwizzle<1, 2, 0, 3>(b)));
+}
+
+/* Hamilton product of two (x, y, z, w) quaternions, each row of the product is a swizzle of 'b' with its signs flipped */
+inline VectorRegister VectorRegisterQuatMultiply(const VectorRegister& a, const VectorRegister& b)
+{
+	VectorRegister Result = VectorRegisterMultiply(VectorRegisterReplicateComponent<3>(a), b);
+	Result = VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<0>(a),
+		VectorRegisterBitwiseXor(VectorRegisterSwizzle<3, 2, 1, 0>(b), MakeVectorRegister(0.0f, -0.0f, 0.0f, -0.0f)), Result);
+	Result = VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<1>(a),
+		VectorRegisterBitwiseXor(VectorRegisterSwizzle<2, 3, 0, 1>(b), MakeVectorRegister(0.0f, 0.0f, -0.0f, -0.0f)), Result);
+	return VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<2>(a),
+		VectorRegisterBitwiseXor(VectorRegisterSwizzle<1, 0, 3, 2>(b), MakeVectorRegister(-0.0f, 0.0f, 0.0f, -0.0f)), Result);
+}
+
+/*
+* 8 float vector, a native 256-bit register when compiling for AVX2, otherwise a pair of VectorRegisters
+* Lane i of every 8 wide function matches element i in memory, see VrixicMathSIMD8.h
+*/
+#if defined(VRIXIC_SIMD_AVX2)
+	#define VRIXIC_SIMD8_AVX2 1
+#endif
+
+#if defined(VRIXIC_SIMD_FMA)
+	#define VRIXIC_SIMD8_FMA 1
+#endif
+
+#include "VrixicMathSIMD8.h"
+
+#undef VRIXIC_SIMD8_AVX2
+#undef VRIXIC_SIMD8_FMA
+
+/* Row vector 'V1' multiplied by a 4x4 whose rows are already loaded into registers */
+inline VectorRegister VectorRegisterTransformByRows(const VectorRegister& V1, const VectorRegister& Row0, const VectorRegister& Row1,
+	const VectorRegister& Row2, const VectorRegister& Row3)
+{
+	VectorRegister Result = VectorRegisterMultiply(VectorRegisterReplicateComponent<0>(V1), Row0);
+	Result = VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<1>(V1), Row1, Result);
+	Result = VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<2>(V1), Row2, Result);
+	return VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<3>(V1), Row3, Result);
+}
+
+/* A Homogenous transform, row vector 'V1' multiplied by a row major 4x4 'Transform' which has to be 16-byte aligned */
+inline VectorRegister TransformVectorByMatrix(const VectorRegister& V1, const float* Transform)
+{
+	return VectorRegisterTransformByRows(V1, VectorRegisterLoadAligned(Transform), VectorRegisterLoadAligned(Transform + 4),
+		VectorRegisterLoadAligned(Transform + 8), VectorRegisterLoadAligned(Transform + 12));
+}
+
+/* Multiplies two matrices and result is returned via Param1, 'result' may alias either input */
+inline void VectorRegisterMatrixMultiply(float* result, const float* matrix1, const float* matrix2)
+{
+	VectorRegister8MatrixMultiply(result, matrix1, matrix2);
+}
+
+/**
+* Structured in place products for matrix chains, each one is a full 4x4 product where the other matrix is a single
+* axis rotation, translation or scale, so only the few entries that matrix changes are computed
+*
+* A rotation in the (I, J) plane is the identity with [I][I] = [J][J] = cos, [I][J] = sin and [J][I] = -sin, which is
+* how Matrix4D::MakeRotX (1, 2), MakeRotY (2, 0) and MakeRotZ (0, 1) are laid out
+*/
+
+/* returns 'j' when 'k' is 'i', 'i' when 'k' is 'j' and 'k' otherwise */
+constexpr int VectorRegisterSwapLaneIndex(int k, int i, int j)
+{
+	return k == i ? j : (k == j ? i : k);
+}
+
+/* matrix = rotation * matrix, only rows I and J change */
+template<int I, int J>
+inline void VectorRegisterMatrixRotateRows(float* matrix, float sine, float cosine)
+{
+	const VectorRegister RowI = MakeVectorRegister(matrix + I * 4);
+	const VectorRegister RowJ = MakeVectorRegister(matrix + J * 4);
+	const VectorRegister Sin = VectorRegisterReplicate(sine);
+	const VectorRegister Cos = VectorRegisterReplicate(cosine);
+
+	StoreVectorRegister(matrix + I * 4, VectorRegisterMultiplyAdd(RowJ, Sin, VectorRegisterMultiply(RowI, Cos)));
+	StoreVectorRegister(matrix + J * 4, VectorRegisterSubtract(VectorRegisterMultiply(RowJ, Cos), VectorRegisterMultiply(RowI, Sin)));
+}
+
+/* matrix = matrix * rotation, only columns I and J change so every row is mixed with its I/J swapped copy */
+template<int I, int J>
+inline void VectorRegisterMatrixRotateColumns(float* matrix, float sine, float cosine)
+{
+	const VectorRegister Scale = MakeVectorRegister(
+		(I == 0 || J == 0) ? cosine : 1.0f, (I == 1 || J == 1) ? cosine : 1.0f,
+		(I == 2 || J == 2) ? cosine : 1.0f, 1.0f);
+	const VectorRegister Mix = MakeVectorRegister(
+		I == 0 ? -sine : (J == 0 ? sine : 0.0f), I == 1 ? -sine : (J == 1 ? sine : 0.0f),
+		I == 2 ? -sine : (J == 2 ? sine : 0.0f), 0.0f);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		const VectorRegister Row = MakeVectorRegister(matrix + i * 4);
+		const VectorRegister Swapped = VectorRegisterSwizzle<VectorRegisterSwapLaneIndex(0, I, J), VectorRegisterSwapLaneIndex(1, I, J),
+			VectorRegisterSwapLaneIndex(2, I, J), 3>(Row);
+
+		StoreVectorRegister(matrix + i * 4, VectorRegisterMultiplyAdd(Swapped, Mix, VectorRegisterMultiply(Row, Scale)));
+	}
+}
+
+/* matrix = translation * matrix, only row 3 changes */
+inline void VectorRegisterMatrixTranslateRows(float* matrix, float x, float y, float z)
+{
+	VectorRegister Row3 = MakeVectorRegister(matrix + 12);
+	Row3 = VectorRegisterMultiplyAdd(VectorRegisterReplicate(x), MakeVectorRegister(matrix), Row3);
+	Row3 = VectorRegisterMultiplyAdd(VectorRegisterReplicate(y), MakeVectorRegister(matrix + 4), Row3);
+	Row3 = VectorRegisterMultiplyAdd(VectorRegisterReplicate(z), MakeVectorRegister(matrix + 8), Row3);
+	StoreVectorRegister(matrix + 12, Row3);
+}
+
+/* matrix = matrix * translation, every row gets its W times the translation added */
+inline void VectorRegisterMatrixTranslateColumns(float* matrix, float x, float y, float z)
+{
+	const VectorRegister Translation = MakeVectorRegister(x, y, z, 0.0f);
+	for (int i = 0; i < 4; ++i)
+	{
+		const VectorRegister Row = MakeVectorRegister(matrix + i * 4);
+		StoreVectorRegister(matrix + i * 4, VectorRegisterMultiplyAdd(VectorRegisterReplicateComponent<3>(Row), Translation, Row));
+	}
+}
+
+/* matrix = scale * matrix, rows 0 - 2 are scaled */
+inline void VectorRegisterMatrixScaleRows(float* matrix, float x, float y, float z)
+{
+	StoreVectorRegister(matrix, VectorRegisterMultiply(MakeVectorRegister(matrix), VectorRegisterReplicate(x)));
+	StoreVectorRegister(matrix + 4, VectorRegisterMultiply(MakeVectorRegister(matrix + 4), VectorRegisterReplicate(y)));
+	StoreVectorRegister(matrix + 8, VectorRegisterMultiply(MakeVectorRegister(matrix + 8), VectorRegisterReplicate(z)));
+}
+
+/* matrix = matrix * scale, columns 0 - 2 are scaled */
+inline void VectorRegisterMatrixScaleColumns(float* matrix, float x, float y, float z)
+{
+	const VectorRegister Scale = MakeVectorRegister(x, y, z, 1.0f);
+	for (int i = 0; i < 4; ++i)
+	{
+		StoreVectorRegister(matrix + i * 4, VectorRegisterMultiply(MakeVectorRegister(matrix + i * 4), Scale));
+	}
+}
+
+/* 2x2 matrix helpers for the block inverse, a register holds a row major 2x2 matrix as (m00, m01, m10, m11) */
+
+/* returns a * b */
+inline VectorRegister VectorRegisterMatrix2Multiply(const VectorRegister& a, const VectorRegister& b)
+{
+	return VectorRegisterAdd(VectorRegisterMultiply(a, VectorRegisterSwizzle<0, 3, 0, 3>(b)),
+		VectorRegisterMultiply(VectorRegisterSwizzle<1, 0, 3, 2>(a), VectorRegisterSwizzle<2, 1, 2, 1>(b)));
+}
+
+/* returns adjugate(a) * b */
+inline VectorRegister VectorRegisterMatrix2AdjugateMultiply(const VectorRegister& a, const VectorRegister& b)
+{
+	return VectorRegisterSubtract(VectorRegisterMultiply(VectorRegisterSwizzle<3, 3, 0, 0>(a), b),
+		VectorRegisterMultiply(VectorRegisterSwizzle<1, 1, 2, 2>(a), VectorRegisterSwizzle<2, 3, 0, 1>(b)));
+}
+
+/* returns a * adjugate(b) */
+inline VectorRegister VectorRegisterMatrix2MultiplyAdjugate(const VectorRegister& a, const VectorRegister& b)
+{
+	return VectorRegisterSubtract(VectorRegisterMultiply(a, VectorRegisterSwizzle<3, 0, 3, 0>(b)),
+		VectorRegisterMultiply(VectorRegisterSwizzle<1, 0, 3, 2>(a), VectorRegisterSwizzle<2, 1, 2, 1>(b)));
+}
+
+/**
+* Inverts a row major 4x4 matrix by splitting it into 2x2 blocks | A B |
+*                                                                 | C D |
+* The determinant falls out of the same block products, so it is returned instead of computed separately
+*
+* @param result - only written when the determinant is not zero, can alias 'matrix'
+* @return float the determinant of 'matrix'
+*/
+inline float VectorRegisterMatrixInverse(float* result, const float* matrix)
+{
+	VectorRegister R0 = MakeVectorRegister(matrix);
+	VectorRegister R1 = MakeVectorRegister(matrix + 4);
+	VectorRegister R2 = MakeVectorRegister(matrix + 8);
+	VectorRegister R3 = MakeVectorRegister(matrix + 12);
+
+	VectorRegister A = VectorRegisterShuffle<0, 1, 0, 1>(R0, R1);
+	VectorRegister B = VectorRegisterShuffle<2, 3, 2, 3>(R0, R1);
+	VectorRegister C = VectorRegisterShuffle<0, 1, 0, 1>(R2, R3);
+	VectorRegister D = VectorRegisterShuffle<2, 3, 2, 3>(R2, R3);
+
+	/* (|A|, |B|, |C|, |D|) */
+	VectorRegister DetSub = VectorRegisterSubtract(
+		VectorRegisterMultiply(VectorRegisterShuffle<0, 2, 0, 2>(R0, R2), VectorRegisterShuffle<1, 3, 1, 3>(R1, R3)),
+		VectorRegisterMultiply(VectorRegisterShuffle<1, 3, 1, 3>(R0, R2), VectorRegisterShuffle<0, 2, 0, 2>(R1, R3)));
+	VectorRegister DetA = VectorRegisterReplicateComponent<0>(DetSub);
+	VectorRegister DetB = VectorRegisterReplicateComponent<1>(DetSub);
+	VectorRegister DetC = VectorRegisterReplicateComponent<2>(DetSub);
+	VectorRegister DetD = VectorRegisterReplicateComponent<3>(DetSub);
+
+	/* inverse = 1 / |M| * | X Y |, the blocks are computed as their adjugates first */
+	/*                     | Z W |                                                   */
+	VectorRegister DC = VectorRegisterMatrix2AdjugateMultiply(D, C);
+	VectorRegister AB = VectorRegisterMatrix2AdjugateMultiply(A, B);
+
+	VectorRegister X = VectorRegisterSubtract(VectorRegisterMultiply(DetD, A), VectorRegisterMatrix2Multiply(B, DC));
+	VectorRegister W = VectorRegisterSubtract(VectorRegisterMultiply(DetA, D), VectorRegisterMatrix2Multiply(C, AB));
+	VectorRegister Y = VectorRegisterSubtract(VectorRegisterMultiply(DetB, C), VectorRegisterMatrix2MultiplyAdjugate(D, AB));
+	VectorRegister Z = VectorRegisterSubtract(VectorRegisterMultiply(DetC, B), VectorRegisterMatrix2MultiplyAdjugate(A, DC));
+
+	/* |M| = |A||D| + |B||C| - trace((A#B)(D#C)) */
+	VectorRegister Det = VectorRegisterSubtract(VectorRegisterAdd(VectorRegisterMultiply(DetA, DetD), VectorRegisterMultiply(DetB, DetC)),
+		VectorRegisterDot4(AB, VectorRegisterSwizzle<0, 2, 1, 3>(DC)));
+
+	const float Determinant = VectorRegisterGetX(Det);
+	if (Determinant == 0.0f)
+	{
+		return Determinant;
+	}
+
+	/* The sign pattern turns each block into its adjugate */
+	VectorRegister RDet = VectorRegisterDivide(MakeVectorRegister(1.0f, -1.0f, -1.0f, 1.0f), Det);
+	X = VectorRegisterMultiply(X, RDet);
+	Y = VectorRegisterMultiply(Y, RDet);
+	Z = VectorRegisterMultiply(Z, RDet);
+	W = VectorRegisterMultiply(W, RDet);
+
+	StoreVectorRegister(result, VectorRegisterShuffle<3, 1, 3, 1>(X, Y));
+	StoreVectorRegister(result + 4, VectorRegisterShuffle<2, 0, 2, 0>(X, Y));
+	StoreVectorRegister(result + 8, VectorRegisterShuffle<3, 1, 3, 1>(Z, W));
+	StoreVectorRegister(result + 12, VectorRegisterShuffle<2, 0, 2, 0>(Z, W));
+
+	return Determinant;
+}
@@ -0,0 +1,652 @@
+/*
+* The 8 wide half of the SIMD layer, included by VrixicMathSIMD.h and nothing else
+*
+* Has no include guard on purpose: VrixicMathKernels.h includes it a second time inside its own namespace with
+* VRIXIC_SIMD8_AVX2 / VRIXIC_SIMD8_FMA defined and an avx2,fma target, so the dispatched batch kernels are built from
+* these same functions instead of a hand written copy
+*
+* VRIXIC_SIMD8_AVX2 - VectorRegister8 is a native __m256, otherwise a pair of VectorRegisters
+* VRIXIC_SIMD8_FMA  - VectorRegister8MultiplyAdd() is fused, only used together with VRIXIC_SIMD8_AVX2
+*/
+
+/*
+* 8 float vector, a native 256-bit register when compiling for AVX2, otherwise a pair of VectorRegisters
+* Lane i of every 8 wide function matches element i in memory
+*/
+#if defined(VRIXIC_SIMD8_AVX2)
+
+typedef __m256 VectorRegister8;
+
+#else
+
+struct VectorRegister8
+{
+	VectorRegister Low;
+	VectorRegister High;
+};
+
+#endif
+
+/* returns and makes a vector with 8 floats, 'v' does not have to be aligned */
+inline VectorRegister8 MakeVectorRegister8(const float* v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_loadu_ps(v);
+#else
+	return VectorRegister8{ MakeVectorRegister(v), MakeVectorRegister(v + 4) };
+#endif
+}
+
+/* returns and makes a vector with 8 floats, 'v' has to be 32-byte aligned */
+inline VectorRegister8 VectorRegister8LoadAligned(const float* v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_load_ps(v);
+#else
+	return VectorRegister8{ VectorRegisterLoadAligned(v), VectorRegisterLoadAligned(v + 4) };
+#endif
+}
+
+/* returns a vector with all 8 components set to 'f' */
+inline VectorRegister8 VectorRegister8Replicate(float f)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_set1_ps(f);
+#else
+	return VectorRegister8{ VectorRegisterReplicate(f), VectorRegisterReplicate(f) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Zero()
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_setzero_ps();
+#else
+	return VectorRegister8{ VectorRegisterZero(), VectorRegisterZero() };
+#endif
+}
+
+/* stores a vector register into 8 floats, 'v' does not have to be aligned */
+inline void StoreVectorRegister8(float* v, const VectorRegister8& vectorRegister)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	_mm256_storeu_ps(v, vectorRegister);
+#else
+	StoreVectorRegister(v, vectorRegister.Low);
+	StoreVectorRegister(v + 4, vectorRegister.High);
+#endif
+}
+
+/* stores a vector register into 8 floats, 'v' has to be 32-byte aligned */
+inline void StoreVectorRegister8Aligned(float* v, const VectorRegister8& vectorRegister)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	_mm256_store_ps(v, vectorRegister);
+#else
+	StoreVectorRegisterAligned(v, vectorRegister.Low);
+	StoreVectorRegisterAligned(v + 4, vectorRegister.High);
+#endif
+}
+
+/* stores a vector register into 8 floats bypassing the cache, each half is streamed on its own so 'v' only has to be 16-byte aligned */
+inline void StreamVectorRegister8(float* v, const VectorRegister8& vectorRegister)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	_mm_stream_ps(v, _mm256_castps256_ps128(vectorRegister));
+	_mm_stream_ps(v + 4, _mm256_extractf128_ps(vectorRegister, 1));
+#else
+	StreamVectorRegister(v, vectorRegister.Low);
+	StreamVectorRegister(v + 4, vectorRegister.High);
+#endif
+}
+
+/* returns 'v' in both 4 lane halves */
+inline VectorRegister8 VectorRegister8ReplicateVector(const VectorRegister& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+#else
+	return VectorRegister8{ v, v };
+#endif
+}
+
+/* Clears the upper halves before returning to SSE code, only does something in the dispatched AVX2 kernels */
+inline void VectorRegister8ZeroUpper()
+{
+#if defined(VRIXIC_SIMD8_AVX2) && !defined(VRIXIC_SIMD_AVX2)
+	_mm256_zeroupper();
+#endif
+}
+
+/* Component wise operations */
+
+inline VectorRegister8 VectorRegister8Add(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_add_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterAdd(a.Low, b.Low), VectorRegisterAdd(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Subtract(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_sub_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterSubtract(a.Low, b.Low), VectorRegisterSubtract(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Multiply(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_mul_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterMultiply(a.Low, b.Low), VectorRegisterMultiply(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Divide(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_div_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterDivide(a.Low, b.Low), VectorRegisterDivide(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Min(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_min_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterMin(a.Low, b.Low), VectorRegisterMin(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Max(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_max_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterMax(a.Low, b.Low), VectorRegisterMax(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Sqrt(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_sqrt_ps(v);
+#else
+	return VectorRegister8{ VectorRegisterSqrt(v.Low), VectorRegisterSqrt(v.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Round(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+	return VectorRegister8{ VectorRegisterRound(v.Low), VectorRegisterRound(v.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Negate(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_sub_ps(_mm256_setzero_ps(), v);
+#else
+	return VectorRegister8{ VectorRegisterNegate(v.Low), VectorRegisterNegate(v.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Abs(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+#else
+	return VectorRegister8{ VectorRegisterAbs(v.Low), VectorRegisterAbs(v.High) };
+#endif
+}
+
+/* returns (a * b) + c */
+inline VectorRegister8 VectorRegister8MultiplyAdd(const VectorRegister8& a, const VectorRegister8& b, const VectorRegister8& c)
+{
+#if defined(VRIXIC_SIMD8_AVX2) && defined(VRIXIC_SIMD8_FMA)
+	return _mm256_fmadd_ps(a, b, c);
+#elif defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#else
+	return VectorRegister8{ VectorRegisterMultiplyAdd(a.Low, b.Low, c.Low), VectorRegisterMultiplyAdd(a.High, b.High, c.High) };
+#endif
+}
+
+/* Comparisons and masks, same rules as the 4 wide versions */
+
+inline VectorRegister8 VectorRegister8CompareLess(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+#else
+	return VectorRegister8{ VectorRegisterCompareLess(a.Low, b.Low), VectorRegisterCompareLess(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8CompareGreater(const VectorRegister8& a, const VectorRegister8& b)
+{
+	return VectorRegister8CompareLess(b, a);
+}
+
+inline VectorRegister8 VectorRegister8CompareEqual(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+#else
+	return VectorRegister8{ VectorRegisterCompareEqual(a.Low, b.Low), VectorRegisterCompareEqual(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8BitwiseAnd(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_and_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterBitwiseAnd(a.Low, b.Low), VectorRegisterBitwiseAnd(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8BitwiseOr(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_or_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterBitwiseOr(a.Low, b.Low), VectorRegisterBitwiseOr(a.High, b.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8BitwiseXor(const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_xor_ps(a, b);
+#else
+	return VectorRegister8{ VectorRegisterBitwiseXor(a.Low, b.Low), VectorRegisterBitwiseXor(a.High, b.High) };
+#endif
+}
+
+/* returns 'a' in lanes where 'mask' is set and 'b' everywhere else */
+inline VectorRegister8 VectorRegister8Select(const VectorRegister8& mask, const VectorRegister8& a, const VectorRegister8& b)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_blendv_ps(b, a, mask);
+#else
+	return VectorRegister8{ VectorRegisterSelect(mask.Low, a.Low, b.Low), VectorRegisterSelect(mask.High, a.High, b.High) };
+#endif
+}
+
+/* returns the sign bit of every lane packed into the low 8 bits, lane 0 -> bit 0 */
+inline int VectorRegister8MoveMask(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_movemask_ps(v);
+#else
+	return VectorRegisterMoveMask(v.Low) | (VectorRegisterMoveMask(v.High) << 4);
+#endif
+}
+
+/* 8 wide versions of VectorRegisterReciprocalSqrtEstimate(), VectorRegisterExponent(), VectorRegisterMantissa() and VectorRegisterExp2Integer() */
+inline VectorRegister8 VectorRegister8ReciprocalSqrtEstimate(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_rsqrt_ps(v);
+#else
+	return VectorRegister8{ VectorRegisterReciprocalSqrtEstimate(v.Low), VectorRegisterReciprocalSqrtEstimate(v.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Exponent(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(v), 23), _mm256_set1_epi32(127)));
+#else
+	return VectorRegister8{ VectorRegisterExponent(v.Low), VectorRegisterExponent(v.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Mantissa(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_or_ps(_mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x007FFFFF))), _mm256_set1_ps(1.0f));
+#else
+	return VectorRegister8{ VectorRegisterMantissa(v.Low), VectorRegisterMantissa(v.High) };
+#endif
+}
+
+inline VectorRegister8 VectorRegister8Exp2Integer(const VectorRegister8& n)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+#else
+	return VectorRegister8{ VectorRegisterExp2Integer(n.Low), VectorRegisterExp2Integer(n.High) };
+#endif
+}
+
+/* returns component 'I' of each 4 lane half replicated across that half, used when a register holds two 4 vectors */
+template<int I>
+inline VectorRegister8 VectorRegister8ReplicateComponent(const VectorRegister8& v)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	return _mm256_shuffle_ps(v, v, _MM_SHUFFLE(I, I, I, I));
+#else
+	return VectorRegister8{ VectorRegisterReplicateComponent<I>(v.Low), VectorRegisterReplicateComponent<I>(v.High) };
+#endif
+}
+
+/* Splits 8 packed XYZ triples (24 floats) into one register per component, 'in' does not have to be aligned */
+inline void VectorRegister8DeinterleaveXYZ(const float* in, VectorRegister8& outX, VectorRegister8& outY, VectorRegister8& outZ)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	__m256 M03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in)), _mm_loadu_ps(in + 12), 1);
+	__m256 M14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 4)), _mm_loadu_ps(in + 16), 1);
+	__m256 M25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 8)), _mm_loadu_ps(in + 20), 1);
+
+	__m256 XY = _mm256_shuffle_ps(M14, M25, _MM_SHUFFLE(2, 1, 3, 2));
+	__m256 YZ = _mm256_shuffle_ps(M03, M14, _MM_SHUFFLE(1, 0, 2, 1));
+	outX = _mm256_shuffle_ps(M03, XY, _MM_SHUFFLE(2, 0, 3, 0));
+	outY = _mm256_shuffle_ps(YZ, XY, _MM_SHUFFLE(3, 1, 2, 0));
+	outZ = _mm256_shuffle_ps(YZ, M25, _MM_SHUFFLE(3, 0, 3, 1));
+#else
+	VectorRegisterDeinterleaveXYZ(in, outX.Low, outY.Low, outZ.Low);
+	VectorRegisterDeinterleaveXYZ(in + 12, outX.High, outY.High, outZ.High);
+#endif
+}
+
+/* Packs 3 component registers back into 8 XYZ triples (24 floats), 'out' does not have to be aligned */
+inline void VectorRegister8InterleaveXYZ(float* out, const VectorRegister8& inX, const VectorRegister8& inY, const VectorRegister8& inZ)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	__m256 RXY = _mm256_shuffle_ps(inX, inY, _MM_SHUFFLE(2, 0, 2, 0));
+	__m256 RYZ = _mm256_shuffle_ps(inY, inZ, _MM_SHUFFLE(3, 1, 3, 1));
+	__m256 RZX = _mm256_shuffle_ps(inZ, inX, _MM_SHUFFLE(3, 1, 2, 0));
+
+	__m256 R03 = _mm256_shuffle_ps(RXY, RZX, _MM_SHUFFLE(2, 0, 2, 0));
+	__m256 R14 = _mm256_shuffle_ps(RYZ, RXY, _MM_SHUFFLE(3, 1, 2, 0));
+	__m256 R25 = _mm256_shuffle_ps(RZX, RYZ, _MM_SHUFFLE(3, 1, 3, 1));
+
+	_mm_storeu_ps(out, _mm256_castps256_ps128(R03));
+	_mm_storeu_ps(out + 4, _mm256_castps256_ps128(R14));
+	_mm_storeu_ps(out + 8, _mm256_castps256_ps128(R25));
+	_mm_storeu_ps(out + 12, _mm256_extractf128_ps(R03, 1));
+	_mm_storeu_ps(out + 16, _mm256_extractf128_ps(R14, 1));
+	_mm_storeu_ps(out + 20, _mm256_extractf128_ps(R25, 1));
+#else
+	VectorRegisterInterleaveXYZ(out, inX.Low, inY.Low, inZ.Low);
+	VectorRegisterInterleaveXYZ(out + 12, inX.High, inY.High, inZ.High);
+#endif
+}
+
+/**
+* Splits 8 XYZW records spaced 'stride' floats apart into one register per component
+*
+* @param in - x0 y0 z0 w0, then x1 y1 z1 w1 at in + stride ..., does not have to be aligned
+*/
+inline void VectorRegister8GatherXYZW(const float* in, int stride, VectorRegister8& outX, VectorRegister8& outY, VectorRegister8& outZ, VectorRegister8& outW)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	/* Record i goes in the low half and record i + 4 in the high half, then both halves are transposed at once */
+	const float* High = in + stride * 4;
+	__m256 R0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in)), _mm_loadu_ps(High), 1);
+	__m256 R1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + stride)), _mm_loadu_ps(High + stride), 1);
+	__m256 R2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + stride * 2)), _mm_loadu_ps(High + stride * 2), 1);
+	__m256 R3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + stride * 3)), _mm_loadu_ps(High + stride * 3), 1);
+
+	__m256 T0 = _mm256_unpacklo_ps(R0, R1);
+	__m256 T1 = _mm256_unpackhi_ps(R0, R1);
+	__m256 T2 = _mm256_unpacklo_ps(R2, R3);
+	__m256 T3 = _mm256_unpackhi_ps(R2, R3);
+
+	outX = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(1, 0, 1, 0));
+	outY = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(3, 2, 3, 2));
+	outZ = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(1, 0, 1, 0));
+	outW = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(3, 2, 3, 2));
+#else
+	VectorRegisterGatherXYZW(in, stride, outX.Low, outY.Low, outZ.Low, outW.Low);
+	VectorRegisterGatherXYZW(in + stride * 4, stride, outX.High, outY.High, outZ.High, outW.High);
+#endif
+}
+
+/* Packs 4 component registers back into 8 XYZW records spaced 'stride' floats apart, 'out' does not have to be aligned */
+inline void VectorRegister8ScatterXYZW(float* out, int stride, const VectorRegister8& inX, const VectorRegister8& inY, const VectorRegister8& inZ, const VectorRegister8& inW)
+{
+#if defined(VRIXIC_SIMD8_AVX2)
+	__m256 T0 = _mm256_unpacklo_ps(inX, inY);
+	__m256 T1 = _mm256_unpackhi_ps(inX, inY);
+	__m256 T2 = _mm256_unpacklo_ps(inZ, inW);
+	__m256 T3 = _mm256_unpackhi_ps(inZ, inW);
+
+	__m256 R0 = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 R1 = _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 R2 = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 R3 = _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(3, 2, 3, 2));
+
+	float* High = out + stride * 4;
+	_mm_storeu_ps(out, _mm256_castps256_ps128(R0));
+	_mm_storeu_ps(out + stride, _mm256_castps256_ps128(R1));
+	_mm_storeu_ps(out + stride * 2, _mm256_castps256_ps128(R2));
+	_mm_storeu_ps(out + stride * 3, _mm256_castps256_ps128(R3));
+	_mm_storeu_ps(High, _mm256_extractf128_ps(R0, 1));
+	_mm_storeu_ps(High + stride, _mm256_extractf128_ps(R1, 1));
+	_mm_storeu_ps(High + stride * 2, _mm256_extractf128_ps(R2, 1));
+	_mm_storeu_ps(High + stride * 3, _mm256_extractf128_ps(R3, 1));
+#else
+	VectorRegisterScatterXYZW(out, stride, inX.Low, inY.Low, inZ.Low, inW.Low);
+	VectorRegisterScatterXYZW(out + stride * 4, stride, inX.High, inY.High, inZ.High, inW.High);
+#endif
+}
+
+/* Splits 8 packed XYZW records (32 floats) into one register per component, 'in' does not have to be aligned */
+inline void VectorRegister8DeinterleaveXYZW(const float* in, VectorRegister8& outX, VectorRegister8& outY, VectorRegister8& outZ, VectorRegister8& outW)
+{
+	VectorRegister8GatherXYZW(in, 4, outX, outY, outZ, outW);
+}
+
+/* Packs 4 component registers back into 8 XYZW records (32 floats), 'out' does not have to be aligned */
+inline void VectorRegister8InterleaveXYZW(float* out, const VectorRegister8& inX, const VectorRegister8& inY, const VectorRegister8& inZ, const VectorRegister8& inW)
+{
+	VectorRegister8ScatterXYZW(out, 4, inX, inY, inZ, inW);
+}
+
+/* Multiplies two row major 4x4 matrices, two rows of 'matrix1' per register and each row of 'matrix2' in both halves, 'result' may alias either input */
+inline void VectorRegister8MatrixMultiply(float* result, const float* matrix1, const float* matrix2)
+{
+	const VectorRegister8 B0 = VectorRegister8ReplicateVector(MakeVectorRegister(matrix2));
+	const VectorRegister8 B1 = VectorRegister8ReplicateVector(MakeVectorRegister(matrix2 + 4));
+	const VectorRegister8 B2 = VectorRegister8ReplicateVector(MakeVectorRegister(matrix2 + 8));
+	const VectorRegister8 B3 = VectorRegister8ReplicateVector(MakeVectorRegister(matrix2 + 12));
+
+	const VectorRegister8 A01 = MakeVectorRegister8(matrix1);
+	const VectorRegister8 A23 = MakeVectorRegister8(matrix1 + 8);
+
+	VectorRegister8 R01 = VectorRegister8Multiply(VectorRegister8ReplicateComponent<0>(A01), B0);
+	VectorRegister8 R23 = VectorRegister8Multiply(VectorRegister8ReplicateComponent<0>(A23), B0);
+	R01 = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<1>(A01), B1, R01);
+	R23 = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<1>(A23), B1, R23);
+	R01 = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<2>(A01), B2, R01);
+	R23 = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<2>(A23), B2, R23);
+	R01 = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<3>(A01), B3, R01);
+	R23 = VectorRegister8MultiplyAdd(VectorRegister8ReplicateComponent<3>(A23), B3, R23);
+
+	StoreVectorRegister8(result, R01);
+	StoreVectorRegister8(result + 8, R23);
+}
+
+/* a * b - c * d + e * f, the same cofactor terms as Matrix4D::Inverse() */
+inline VectorRegister8 VectorRegister8Cofactor(const VectorRegister8& a, const VectorRegister8& b, const VectorRegister8& c, const VectorRegister8& d,
+	const VectorRegister8& e, const VectorRegister8& f)
+{
+	return VectorRegister8MultiplyAdd(e, f, VectorRegister8Subtract(VectorRegister8Multiply(a, b), VectorRegister8Multiply(c, d)));
+}
+
+/**
+* Inverts 8 contiguous row major 4x4 matrices at once, every register holds one element of all 8 matrices
+* Matrices with a zero determinant are copied unchanged, same as Matrix4D::Inverse()
+*
+* @param results - 8 matrices, can alias 'matrices'
+* @param outDeterminants - 8 floats, can be null
+*/
+inline void VectorRegister8MatrixInverse(float* results, const float* matrices, float* outDeterminants)
+{
+	VectorRegister8 E[4][4];
+
+	/* Row r of all 8 matrices is gathered and transposed, so E[r][c] holds element (r, c) of every matrix */
+	for (int r = 0; r < 4; ++r)
+	{
+		VectorRegister8GatherXYZW(matrices + r * 4, 16, E[r][0], E[r][1], E[r][2], E[r][3]);
+	}
+
+	/* 2x2 determinants of the top two rows */
+	VectorRegister8 X0 = VectorRegister8Subtract(VectorRegister8Multiply(E[0][0], E[1][1]), VectorRegister8Multiply(E[0][1], E[1][0]));
+	VectorRegister8 X1 = VectorRegister8Subtract(VectorRegister8Multiply(E[0][0], E[1][2]), VectorRegister8Multiply(E[0][2], E[1][0]));
+	VectorRegister8 X2 = VectorRegister8Subtract(VectorRegister8Multiply(E[0][0], E[1][3]), VectorRegister8Multiply(E[0][3], E[1][0]));
+	VectorRegister8 X3 = VectorRegister8Subtract(VectorRegister8Multiply(E[0][1], E[1][2]), VectorRegister8Multiply(E[0][2], E[1][1]));
+	VectorRegister8 X4 = VectorRegister8Subtract(VectorRegister8Multiply(E[0][1], E[1][3]), VectorRegister8Multiply(E[0][3], E[1][1]));
+	VectorRegister8 X5 = VectorRegister8Subtract(VectorRegister8Multiply(E[0][2], E[1][3]), VectorRegister8Multiply(E[0][3], E[1][2]));
+
+	/* 2x2 determinants of the bottom two rows */
+	VectorRegister8 M0 = VectorRegister8Subtract(VectorRegister8Multiply(E[2][2], E[3][3]), VectorRegister8Multiply(E[2][3], E[3][2]));
+	VectorRegister8 M1 = VectorRegister8Subtract(VectorRegister8Multiply(E[2][1], E[3][3]), VectorRegister8Multiply(E[2][3], E[3][1]));
+	VectorRegister8 M2 = VectorRegister8Subtract(VectorRegister8Multiply(E[2][1], E[3][2]), VectorRegister8Multiply(E[2][2], E[3][1]));
+	VectorRegister8 M3 = VectorRegister8Subtract(VectorRegister8Multiply(E[2][0], E[3][3]), VectorRegister8Multiply(E[2][3], E[3][0]));
+	VectorRegister8 M4 = VectorRegister8Subtract(VectorRegister8Multiply(E[2][0], E[3][2]), VectorRegister8Multiply(E[2][2], E[3][0]));
+	VectorRegister8 M5 = VectorRegister8Subtract(VectorRegister8Multiply(E[2][0], E[3][1]), VectorRegister8Multiply(E[2][1], E[3][0]));
+
+	VectorRegister8 Det = VectorRegister8Multiply(X0, M0);
+	Det = VectorRegister8Subtract(Det, VectorRegister8Multiply(X1, M1));
+	Det = VectorRegister8MultiplyAdd(X2, M2, Det);
+	Det = VectorRegister8MultiplyAdd(X3, M3, Det);
+	Det = VectorRegister8Subtract(Det, VectorRegister8Multiply(X4, M4));
+	Det = VectorRegister8MultiplyAdd(X5, M5, Det);
+
+	const VectorRegister8 Zero = VectorRegister8Zero();
+	const VectorRegister8 NonZero = VectorRegister8BitwiseOr(VectorRegister8CompareLess(Det, Zero), VectorRegister8CompareGreater(Det, Zero));
+	const VectorRegister8 RDet = VectorRegister8Divide(VectorRegister8Replicate(1.0f), Det);
+
+	VectorRegister8 R[4][4];
+	R[0][0] = VectorRegister8Cofactor(E[1][1], M0, E[1][2], M1, E[1][3], M2);
+	R[0][1] = VectorRegister8Negate(VectorRegister8Cofactor(E[0][1], M0, E[0][2], M1, E[0][3], M2));
+	R[0][2] = VectorRegister8Cofactor(E[3][1], X5, E[3][2], X4, E[3][3], X3);
+	R[0][3] = VectorRegister8Negate(VectorRegister8Cofactor(E[2][1], X5, E[2][2], X4, E[2][3], X3));
+
+	R[1][0] = VectorRegister8Negate(VectorRegister8Cofactor(E[1][0], M0, E[1][2], M3, E[1][3], M4));
+	R[1][1] = VectorRegister8Cofactor(E[0][0], M0, E[0][2], M3, E[0][3], M4);
+	R[1][2] = VectorRegister8Negate(VectorRegister8Cofactor(E[3][0], X5, E[3][2], X2, E[3][3], X1));
+	R[1][3] = VectorRegister8Cofactor(E[2][0], X5, E[2][2], X2, E[2][3], X1);
+
+	R[2][0] = VectorRegister8Cofactor(E[1][0], M1, E[1][1], M3, E[1][3], M5);
+	R[2][1] = VectorRegister8Negate(VectorRegister8Cofactor(E[0][0], M1, E[0][1], M3, E[0][3], M5));
+	R[2][2] = VectorRegister8Cofactor(E[3][0], X4, E[3][1], X2, E[3][3], X0);
+	R[2][3] = VectorRegister8Negate(VectorRegister8Cofactor(E[2][0], X4, E[2][1], X2, E[2][3], X0));
+
+	R[3][0] = VectorRegister8Negate(VectorRegister8Cofactor(E[1][0], M2, E[1][1], M4, E[1][2], M5));
+	R[3][1] = VectorRegister8Cofactor(E[0][0], M2, E[0][1], M4, E[0][2], M5);
+	R[3][2] = VectorRegister8Negate(VectorRegister8Cofactor(E[3][0], X3, E[3][1], X1, E[3][2], X0));
+	R[3][3] = VectorRegister8Cofactor(E[2][0], X3, E[2][1], X1, E[2][2], X0);
+
+	for (int r = 0; r < 4; ++r)
+	{
+		for (int c = 0; c < 4; ++c)
+		{
+			R[r][c] = VectorRegister8Select(NonZero, VectorRegister8Multiply(R[r][c], RDet), E[r][c]);
+		}
+
+		VectorRegister8ScatterXYZW(results + r * 4, 16, R[r][0], R[r][1], R[r][2], R[r][3]);
+	}
+
+	if (outDeterminants != nullptr)
+	{
+		StoreVectorRegister8(outDeterminants, Det);
+	}
+}
+
+/* returns 'w' where 'notW' is clear, else 'x' where 'notX' is clear, else 'y' where 'notY' is clear, else 'z' */
+inline VectorRegister8 VectorRegister8SelectOf4(const VectorRegister8& notW, const VectorRegister8& notX, const VectorRegister8& notY,
+	const VectorRegister8& w, const VectorRegister8& x, const VectorRegister8& y, const VectorRegister8& z)
+{
+	return VectorRegister8Select(notW, VectorRegister8Select(notX, VectorRegister8Select(notY, z, y), x), w);
+}
+
+/* outE[r][c] receives element (r, c) of 8 consecutive row major 4x4 matrices, the 3x3 rotation part only */
+inline void VectorRegister8GatherRotation(const float* matrices, VectorRegister8 outE[3][3])
+{
+	for (int r = 0; r < 3; ++r)
+	{
+		VectorRegister8 W;
+		VectorRegister8GatherXYZW(matrices + r * 4, 16, outE[r][0], outE[r][1], outE[r][2], W);
+	}
+}
+
+/**
+* Quaternions of 8 pure rotation matrices at once, e[r][c] holds element (r, c) of every matrix
+* Same convention as Quat::MakeFromMatrix4D(), the largest of 4w^2, 4x^2, 4y^2 and 4z^2 picks which component comes
+* from a square root, the others come from the off diagonal sums and differences so none of them loses precision
+*/
+inline void VectorRegister8QuatFromRotation(const VectorRegister8 e[3][3], VectorRegister8& outX, VectorRegister8& outY, VectorRegister8& outZ, VectorRegister8& outW)
+{
+	const VectorRegister8 One = VectorRegister8Replicate(1.0f);
+
+	const VectorRegister8 TW = VectorRegister8Add(One, VectorRegister8Add(e[0][0], VectorRegister8Add(e[1][1], e[2][2])));
+	const VectorRegister8 TX = VectorRegister8Add(One, VectorRegister8Subtract(e[0][0], VectorRegister8Add(e[1][1], e[2][2])));
+	const VectorRegister8 TY = VectorRegister8Subtract(VectorRegister8Add(One, e[1][1]), VectorRegister8Add(e[0][0], e[2][2]));
+	const VectorRegister8 TZ = VectorRegister8Subtract(VectorRegister8Add(One, e[2][2]), VectorRegister8Add(e[0][0], e[1][1]));
+
+	const VectorRegister8 WX = VectorRegister8Subtract(e[2][1], e[1][2]);
+	const VectorRegister8 WY = VectorRegister8Subtract(e[0][2], e[2][0]);
+	const VectorRegister8 WZ = VectorRegister8Subtract(e[1][0], e[0][1]);
+	const VectorRegister8 XY = VectorRegister8Add(e[1][0], e[0][1]);
+	const VectorRegister8 XZ = VectorRegister8Add(e[0][2], e[2][0]);
+	const VectorRegister8 YZ = VectorRegister8Add(e[2][1], e[1][2]);
+
+	/* A lane mask is set where that candidate loses to a later one, ties go to W, then X, then Y */
+	const VectorRegister8 NotW = VectorRegister8BitwiseOr(VectorRegister8CompareLess(TW, TX),
+		VectorRegister8BitwiseOr(VectorRegister8CompareLess(TW, TY), VectorRegister8CompareLess(TW, TZ)));
+	const VectorRegister8 NotX = VectorRegister8BitwiseOr(VectorRegister8CompareLess(TX, TY), VectorRegister8CompareLess(TX, TZ));
+	const VectorRegister8 NotY = VectorRegister8CompareLess(TY, TZ);
+
+	const VectorRegister8 Factor = VectorRegister8Divide(VectorRegister8Replicate(0.5f), VectorRegister8Sqrt(VectorRegister8SelectOf4(NotW, NotX, NotY, TW, TX, TY, TZ)));
+
+	outX = VectorRegister8Multiply(VectorRegister8SelectOf4(NotW, NotX, NotY, WX, TX, XY, XZ), Factor);
+	outY = VectorRegister8Multiply(VectorRegister8SelectOf4(NotW, NotX, NotY, WY, XY, TY, YZ), Factor);
+	outZ = VectorRegister8Multiply(VectorRegister8SelectOf4(NotW, NotX, NotY, WZ, XZ, YZ, TZ), Factor);
+	outW = VectorRegister8Multiply(VectorRegister8SelectOf4(NotW, NotX, NotY, TW, WX, WY, WZ), Factor);
+}
+
+/* Rotation part of Quat::ToMatrix4D() for 8 quaternions at once, outE[r][c] receives element (r, c) of every matrix */
+inline void VectorRegister8QuatToRotation(const VectorRegister8& x, const VectorRegister8& y, const VectorRegister8& z, const VectorRegister8& w, VectorRegister8 outE[3][3])
+{
+	const VectorRegister8 One = VectorRegister8Replicate(1.0f);
+	const VectorRegister8 X2 = VectorRegister8Add(x, x);
+	const VectorRegister8 Y2 = VectorRegister8Add(y, y);
+	const VectorRegister8 Z2 = VectorRegister8Add(z, z);
+
+	const VectorRegister8 XX = VectorRegister8Multiply(x, X2);
+	const VectorRegister8 YY = VectorRegister8Multiply(y, Y2);
+	const VectorRegister8 ZZ = VectorRegister8Multiply(z, Z2);
+	const VectorRegister8 XY = VectorRegister8Multiply(x, Y2);
+	const VectorRegister8 XZ = VectorRegister8Multiply(x, Z2);
+	const VectorRegister8 YZ = VectorRegister8Multiply(y, Z2);
+	const VectorRegister8 WX = VectorRegister8Multiply(w, X2);
+	const VectorRegister8 WY = VectorRegister8Multiply(w, Y2);
+	const VectorRegister8 WZ = VectorRegister8Multiply(w, Z2);
+
+	outE[0][0] = VectorRegister8Subtract(One, VectorRegister8Add(YY, ZZ));
+	outE[0][1] = VectorRegister8Subtract(XY, WZ);
+	outE[0][2] = VectorRegister8Add(XZ, WY);
+
+	outE[1][0] = VectorRegister8Add(XY, WZ);
+	outE[1][1] = VectorRegister8Subtract(One, VectorRegister8Add(XX, ZZ));
+	outE[1][2] = VectorRegister8Subtract(YZ, WX);
+
+	outE[2][0] = VectorRegister8Subtract(XZ, WY);
+	outE[2][1] = VectorRegister8Add(YZ, WX);
+	outE[2][2] = VectorRegister8Subtract(One, VectorRegister8Add(XX, YY));
+}
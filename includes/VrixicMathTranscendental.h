@@ -0,0 +1,630 @@
+#pragma once
+
+#include "GenericDefines.h"
+#include "VrixicMathSIMD.h"
+
+#include <cmath>
+#include <cstring>
+
+/**
+* Vectorized transcendental functions, polynomial approximations that make no libm calls
+*
+* Every function has a 4 lane (VectorRegister...) and an 8 lane (VectorRegister8...) version, the scalar versions are
+* in MathUtils. The accuracy is a template argument so every call site picks what it needs, Precise is the default
+*
+*	VectorRegister8SinCos<MathAccuracy::Fast>(Angles, Sines, Cosines);
+*	float Angle = MathUtils::Atan2<MathAccuracy::Medium>(y, x);
+*
+* Max error in ulp against the double precision result, measured on every backend over every float in the range given
+* (Atan2 over 16M random pairs, SinCos past |x| = 8192 over 256K random floats). Below 8192 SinCos reduces the angle with
+* exact products, the lanes past it take a slower exact reduction (ReduceLargeAngle) and stay within the same bounds.
+* Infinity and NaN give NaN. build/VrixicMathLibraryTest holds every tier to this table
+*
+*	Function			Range				Fast		Medium		Precise
+*	SinCos				finite				9500		27			3
+*	Atan2				finite				26400		502			4
+*	Acos				[-1, 1]				65500		757			2
+*	Exp					[-87.3, 88.7]		1650		71			2
+*	Log					(0, +inf)			11500		26			1
+*	ReciprocalSqrt		(0, +inf)			5000		5			2
+*
+* Fast is about 3 to 4 correct digits, Medium about 5 to 6. Fast and Medium use shorter minimax polynomials fitted for
+* these tiers, Precise uses the Cephes single precision ones. The scalar fallback of ReciprocalSqrt is 1 / sqrt() in every tier
+*/
+enum class MathAccuracy : uint32
+{
+	Fast = 0,
+	Medium,
+	Precise
+};
+
+namespace TranscendentalKernels
+{
+	/**
+	* Gives VectorRegister (Width 4), VectorRegister8 (Width 8) and float (Width 1) one set of names so every function
+	* below is written once. Keyed on the width because GCC drops the attributes of __m128 used as a template argument
+	*/
+	template<int Width>
+	struct RegisterOps;
+
+	template<>
+	struct RegisterOps<4>
+	{
+		typedef VectorRegister Register;
+
+		static inline VectorRegister Replicate(float f) { return VectorRegisterReplicate(f); }
+		static inline float GetX(const VectorRegister& v) { return VectorRegisterGetX(v); }
+		static inline VectorRegister Load(const float* v) { return MakeVectorRegister(v); }
+		static inline void Store(float* v, const VectorRegister& r) { StoreVectorRegister(v, r); }
+		static inline int MoveMask(const VectorRegister& v) { return VectorRegisterMoveMask(v); }
+		static inline VectorRegister Add(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterAdd(a, b); }
+		static inline VectorRegister Subtract(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterSubtract(a, b); }
+		static inline VectorRegister Multiply(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterMultiply(a, b); }
+		static inline VectorRegister Divide(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterDivide(a, b); }
+		static inline VectorRegister MultiplyAdd(const VectorRegister& a, const VectorRegister& b, const VectorRegister& c) { return VectorRegisterMultiplyAdd(a, b, c); }
+		static inline VectorRegister Abs(const VectorRegister& v) { return VectorRegisterAbs(v); }
+		static inline VectorRegister Min(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterMin(a, b); }
+		static inline VectorRegister Max(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterMax(a, b); }
+		static inline VectorRegister Sqrt(const VectorRegister& v) { return VectorRegisterSqrt(v); }
+		static inline VectorRegister Round(const VectorRegister& v) { return VectorRegisterRound(v); }
+		static inline VectorRegister CompareLess(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterCompareLess(a, b); }
+		static inline VectorRegister CompareGreater(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterCompareGreater(a, b); }
+		static inline VectorRegister CompareEqual(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterCompareEqual(a, b); }
+		static inline VectorRegister BitwiseAnd(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterBitwiseAnd(a, b); }
+		static inline VectorRegister BitwiseXor(const VectorRegister& a, const VectorRegister& b) { return VectorRegisterBitwiseXor(a, b); }
+		static inline VectorRegister Select(const VectorRegister& mask, const VectorRegister& a, const VectorRegister& b) { return VectorRegisterSelect(mask, a, b); }
+		static inline VectorRegister ReciprocalSqrtEstimate(const VectorRegister& v) { return VectorRegisterReciprocalSqrtEstimate(v); }
+		static inline VectorRegister Exponent(const VectorRegister& v) { return VectorRegisterExponent(v); }
+		static inline VectorRegister Mantissa(const VectorRegister& v) { return VectorRegisterMantissa(v); }
+		static inline VectorRegister Exp2Integer(const VectorRegister& n) { return VectorRegisterExp2Integer(n); }
+	};
+
+	template<>
+	struct RegisterOps<8>
+	{
+		typedef VectorRegister8 Register;
+
+		static inline VectorRegister8 Replicate(float f) { return VectorRegister8Replicate(f); }
+		static inline VectorRegister8 Load(const float* v) { return MakeVectorRegister8(v); }
+		static inline void Store(float* v, const VectorRegister8& r) { StoreVectorRegister8(v, r); }
+		static inline int MoveMask(const VectorRegister8& v) { return VectorRegister8MoveMask(v); }
+		static inline VectorRegister8 Add(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8Add(a, b); }
+		static inline VectorRegister8 Subtract(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8Subtract(a, b); }
+		static inline VectorRegister8 Multiply(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8Multiply(a, b); }
+		static inline VectorRegister8 Divide(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8Divide(a, b); }
+		static inline VectorRegister8 MultiplyAdd(const VectorRegister8& a, const VectorRegister8& b, const VectorRegister8& c) { return VectorRegister8MultiplyAdd(a, b, c); }
+		static inline VectorRegister8 Abs(const VectorRegister8& v) { return VectorRegister8Abs(v); }
+		static inline VectorRegister8 Min(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8Min(a, b); }
+		static inline VectorRegister8 Max(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8Max(a, b); }
+		static inline VectorRegister8 Sqrt(const VectorRegister8& v) { return VectorRegister8Sqrt(v); }
+		static inline VectorRegister8 Round(const VectorRegister8& v) { return VectorRegister8Round(v); }
+		static inline VectorRegister8 CompareLess(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8CompareLess(a, b); }
+		static inline VectorRegister8 CompareGreater(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8CompareGreater(a, b); }
+		static inline VectorRegister8 CompareEqual(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8CompareEqual(a, b); }
+		static inline VectorRegister8 BitwiseAnd(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8BitwiseAnd(a, b); }
+		static inline VectorRegister8 BitwiseXor(const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8BitwiseXor(a, b); }
+		static inline VectorRegister8 Select(const VectorRegister8& mask, const VectorRegister8& a, const VectorRegister8& b) { return VectorRegister8Select(mask, a, b); }
+		static inline VectorRegister8 ReciprocalSqrtEstimate(const VectorRegister8& v) { return VectorRegister8ReciprocalSqrtEstimate(v); }
+		static inline VectorRegister8 Exponent(const VectorRegister8& v) { return VectorRegister8Exponent(v); }
+		static inline VectorRegister8 Mantissa(const VectorRegister8& v) { return VectorRegister8Mantissa(v); }
+		static inline VectorRegister8 Exp2Integer(const VectorRegister8& n) { return VectorRegister8Exp2Integer(n); }
+	};
+
+	/* Plain floats for MathUtils in the scalar fallback, masks are floats with all bits set the same way as in a register */
+	template<>
+	struct RegisterOps<1>
+	{
+		typedef float Register;
+
+		static inline uint32 Bits(float f) { uint32 B; std::memcpy(&B, &f, sizeof(B)); return B; }
+		static inline float FromBits(uint32 b) { float F; std::memcpy(&F, &b, sizeof(F)); return F; }
+		static inline float Mask(bool b) { return FromBits(b ? 0xFFFFFFFFu : 0u); }
+
+		static inline float Replicate(float f) { return f; }
+		static inline float GetX(float v) { return v; }
+		static inline float Load(const float* v) { return *v; }
+		static inline void Store(float* v, float r) { *v = r; }
+		static inline int MoveMask(float v) { return static_cast<int>(Bits(v) >> 31); }
+		static inline float Add(float a, float b) { return a + b; }
+		static inline float Subtract(float a, float b) { return a - b; }
+		static inline float Multiply(float a, float b) { return a * b; }
+		static inline float Divide(float a, float b) { return a / b; }
+		static inline float MultiplyAdd(float a, float b, float c) { return a * b + c; }
+		static inline float Abs(float v) { return std::fabs(v); }
+		static inline float Min(float a, float b) { return a < b ? a : b; }
+		static inline float Max(float a, float b) { return a > b ? a : b; }
+		static inline float Sqrt(float v) { return std::sqrt(v); }
+		static inline float Round(float v) { return std::nearbyint(v); }
+		static inline float CompareLess(float a, float b) { return Mask(a < b); }
+		static inline float CompareGreater(float a, float b) { return Mask(a > b); }
+		static inline float CompareEqual(float a, float b) { return Mask(a == b); }
+		static inline float BitwiseAnd(float a, float b) { return FromBits(Bits(a) & Bits(b)); }
+		static inline float BitwiseXor(float a, float b) { return FromBits(Bits(a) ^ Bits(b)); }
+		static inline float Select(float mask, float a, float b) { return (Bits(mask) >> 31) ? a : b; }
+		static inline float ReciprocalSqrtEstimate(float v) { return 1.0f / std::sqrt(v); }
+		static inline float Exponent(float v) { return static_cast<float>(static_cast<int32>(Bits(v) >> 23) - 127); }
+		static inline float Mantissa(float v) { return FromBits((Bits(v) & 0x007FFFFFu) | 0x3F800000u); }
+		static inline float Exp2Integer(float n) { return FromBits(static_cast<uint32>(static_cast<int32>(n) + 127) << 23); }
+	};
+
+	/* MathUtils runs on lane 0 of a VectorRegister when SSE is there, one SSE lane is cheaper than the bit tricks on floats */
+#if defined(VRIXIC_SIMD_SSE2)
+	static constexpr int ScalarWidth = 4;
+#else
+	static constexpr int ScalarWidth = 1;
+#endif
+
+	typedef RegisterOps<ScalarWidth> ScalarOps;
+
+	/**
+	* Payne-Hanek reduction for the angles SinCos cannot reduce exactly (|x| >= 8192), returns x - n * pi/2 with n mod 4 in
+	* 'outQuadrant'. The 24 bit mantissa is multiplied by the 96 bits of 2/pi that line up with its exponent, which gives
+	* x * 2/pi mod 4 as a 2.62 fixed point number. Infinity and NaN give NaN
+	*/
+	inline float ReduceLargeAngle(float x, float& outQuadrant)
+	{
+		/* 2/pi from the first bit on, each entry starts 8 bits after the previous one */
+		static const uint32 TwoOverPiBits[24] =
+		{
+			0x000000a2u, 0x0000a2f9u, 0x00a2f983u, 0xa2f9836eu, 0xf9836e4eu, 0x836e4e44u, 0x6e4e4415u, 0x4e441529u,
+			0x441529fcu, 0x1529fc27u, 0x29fc2757u, 0xfc2757d1u, 0x2757d1f5u, 0x57d1f534u, 0xd1f534ddu, 0xf534ddc0u,
+			0x34ddc0dbu, 0xddc0db62u, 0xc0db6295u, 0xdb629599u, 0x6295993cu, 0x95993c43u, 0x993c4390u, 0x3c439041u
+		};
+
+		uint32 Bits;
+		std::memcpy(&Bits, &x, sizeof(Bits));
+		if ((Bits & 0x7F800000u) == 0x7F800000u)
+		{
+			outQuadrant = 0.0f;
+			return x - x;
+		}
+
+		const uint32* PiBits = &TwoOverPiBits[(Bits >> 26) & 15];
+		const uint32 Mantissa = ((Bits & 0x007FFFFFu) | 0x00800000u) << ((Bits >> 23) & 7);
+
+		/* Only the low 32 bits of the first product and the high 32 bits of the last one land in the 64 bit window */
+		uint64 Fraction = (static_cast<uint64>(Mantissa * PiBits[0]) << 32) | ((static_cast<uint64>(Mantissa) * PiBits[8]) >> 32);
+		Fraction += static_cast<uint64>(Mantissa) * PiBits[4];
+
+		const uint64 Quadrant = (Fraction + (1ull << 61)) >> 62;
+		Fraction -= Quadrant << 62;
+
+		/* pi/2 * 2^-62 */
+		const double Reduced = static_cast<double>(static_cast<int64>(Fraction)) * 3.4061215800865545e-19;
+		const bool Negative = (Bits >> 31) != 0;
+		outQuadrant = static_cast<float>(Negative ? (4 - Quadrant) & 3 : Quadrant);
+		return static_cast<float>(Negative ? -Reduced : Reduced);
+	}
+
+	/* The quadrant of every angle and what is left of it after subtracting quadrant * pi/2, exact for |x| < 8192 */
+	template<int Width>
+	inline void ReduceAngles(const typename RegisterOps<Width>::Register& angles, typename RegisterOps<Width>::Register& outQuadrant, typename RegisterOps<Width>::Register& outReduced)
+	{
+		typedef RegisterOps<Width> Op;
+
+		/**
+		* pi/2 is subtracted in six parts (Cody-Waite). The first five have at most 11 significant bits, so for |x| < 8192
+		* (quadrants below 2^13) every product is exact with or without FMA and the reduced angle stays accurate even
+		* next to a multiple of pi/2, where sin or cos is tiny
+		*/
+		outQuadrant = Op::Round(Op::Multiply(angles, Op::Replicate(0.636619772367581343f)));
+
+		outReduced = Op::MultiplyAdd(outQuadrant, Op::Replicate(-1.5703125f), angles);
+		outReduced = Op::MultiplyAdd(outQuadrant, Op::Replicate(-4.8351287841796875e-4f), outReduced);
+		outReduced = Op::MultiplyAdd(outQuadrant, Op::Replicate(-3.1385570764541626e-7f), outReduced);
+		outReduced = Op::MultiplyAdd(outQuadrant, Op::Replicate(-6.070877134334296e-11f), outReduced);
+		outReduced = Op::MultiplyAdd(outQuadrant, Op::Replicate(-6.222800053024002e-14f), outReduced);
+		outReduced = Op::MultiplyAdd(outQuadrant, Op::Replicate(-5.721188916458728e-18f), outReduced);
+	}
+
+	/* sin and cos from the quadrant and the reduced angle in [-pi/4, pi/4] */
+	template<MathAccuracy Accuracy, int Width>
+	inline void SinCosReduced(const typename RegisterOps<Width>::Register& quadrant, const typename RegisterOps<Width>::Register& reduced, typename RegisterOps<Width>::Register& outSin, typename RegisterOps<Width>::Register& outCos)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		const Register R2 = Op::Multiply(reduced, reduced);
+		const Register R3 = Op::Multiply(R2, reduced);
+
+		/* sin(r) = r + r^3 * P(r^2) and cos(r) = 1 + r^2 * Q(r^2) on [-pi/4, pi/4] */
+		Register SinR;
+		Register CosR;
+		if (Accuracy == MathAccuracy::Fast)
+		{
+			SinR = Op::MultiplyAdd(R3, Op::Replicate(-1.6242791e-1f), reduced);
+			CosR = Op::MultiplyAdd(R2, Op::Replicate(4.0458458e-2f), Op::Replicate(-4.9976056e-1f));
+			CosR = Op::MultiplyAdd(R2, CosR, Op::Replicate(1.0f));
+		}
+		else if (Accuracy == MathAccuracy::Medium)
+		{
+			SinR = Op::MultiplyAdd(R2, Op::Replicate(8.1632827e-3f), Op::Replicate(-1.6663390e-1f));
+			SinR = Op::MultiplyAdd(R3, SinR, reduced);
+			CosR = Op::MultiplyAdd(R2, Op::Replicate(-1.3591854e-3f), Op::Replicate(4.1655777e-2f));
+			CosR = Op::MultiplyAdd(R2, CosR, Op::Replicate(-4.9999885e-1f));
+			CosR = Op::MultiplyAdd(R2, CosR, Op::Replicate(1.0f));
+		}
+		else
+		{
+			SinR = Op::MultiplyAdd(R2, Op::Replicate(-1.9515295891e-4f), Op::Replicate(8.3321608736e-3f));
+			SinR = Op::MultiplyAdd(R2, SinR, Op::Replicate(-1.6666654611e-1f));
+			SinR = Op::MultiplyAdd(R3, SinR, reduced);
+			CosR = Op::MultiplyAdd(R2, Op::Replicate(2.443315711809948e-5f), Op::Replicate(-1.388731625493765e-3f));
+			CosR = Op::MultiplyAdd(R2, CosR, Op::Replicate(4.166664568298827e-2f));
+			CosR = Op::MultiplyAdd(Op::Multiply(R2, R2), CosR, Op::MultiplyAdd(R2, Op::Replicate(-0.5f), Op::Replicate(1.0f)));
+		}
+
+		/* Quadrant mod 4 and mod 2, the offsets keep the rounding away from ties so the rounding mode does not matter */
+		const Register Q = Op::MultiplyAdd(Op::Round(Op::Multiply(Op::Subtract(quadrant, Op::Replicate(1.5f)), Op::Replicate(0.25f))),
+			Op::Replicate(-4.0f), quadrant);
+		const Register Odd = Op::MultiplyAdd(Op::Round(Op::Multiply(Op::Subtract(Q, Op::Replicate(0.5f)), Op::Replicate(0.5f))),
+			Op::Replicate(-2.0f), Q);
+
+		/* Q = 0: (s, c), 1: (c, -s), 2: (-s, -c), 3: (-c, s) */
+		const Register SwapMask = Op::CompareGreater(Odd, Op::Replicate(0.5f));
+		const Register SignBit = Op::Replicate(-0.0f);
+		const Register SinSign = Op::BitwiseAnd(Op::CompareGreater(Q, Op::Replicate(1.5f)), SignBit);
+		const Register CosSign = Op::BitwiseAnd(Op::CompareLess(Op::Abs(Op::Subtract(Q, Op::Replicate(1.5f))), Op::Replicate(1.0f)), SignBit);
+
+		outSin = Op::BitwiseXor(Op::Select(SwapMask, CosR, SinR), SinSign);
+		outCos = Op::BitwiseXor(Op::Select(SwapMask, SinR, CosR), CosSign);
+	}
+
+	/**
+	* SinCos of a register with a lane past 8192, infinity or NaN, those lanes take ReduceLargeAngle one at a time. Out of
+	* line so the registers of the common path are not spilled around the call
+	*/
+	template<MathAccuracy Accuracy, int Width>
+	VRIXIC_NOINLINE inline void SinCosLargeAngles(const typename RegisterOps<Width>::Register& angles, int exactMask, typename RegisterOps<Width>::Register& outSin, typename RegisterOps<Width>::Register& outCos)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		Register Quadrant;
+		Register Reduced;
+		ReduceAngles<Width>(angles, Quadrant, Reduced);
+
+		float Angles[Width];
+		float ReducedAngles[Width];
+		float Quadrants[Width];
+		Op::Store(Angles, angles);
+		Op::Store(ReducedAngles, Reduced);
+		Op::Store(Quadrants, Quadrant);
+		for (int i = 0; i < Width; ++i)
+		{
+			if ((exactMask & (1 << i)) == 0)
+			{
+				ReducedAngles[i] = ReduceLargeAngle(Angles[i], Quadrants[i]);
+			}
+		}
+
+		SinCosReduced<Accuracy, Width>(Op::Load(Quadrants), Op::Load(ReducedAngles), outSin, outCos);
+	}
+
+	template<MathAccuracy Accuracy, int Width>
+	inline void SinCos(const typename RegisterOps<Width>::Register& angles, typename RegisterOps<Width>::Register& outSin, typename RegisterOps<Width>::Register& outCos)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		/* The branch is not taken for ordinary angles */
+		const int ExactMask = Op::MoveMask(Op::CompareLess(Op::Abs(angles), Op::Replicate(8192.0f)));
+		if (ExactMask != (1 << Width) - 1)
+		{
+			SinCosLargeAngles<Accuracy, Width>(angles, ExactMask, outSin, outCos);
+			return;
+		}
+
+		Register Quadrant;
+		Register Reduced;
+		ReduceAngles<Width>(angles, Quadrant, Reduced);
+		SinCosReduced<Accuracy, Width>(Quadrant, Reduced, outSin, outCos);
+	}
+
+	template<MathAccuracy Accuracy, int Width>
+	inline typename RegisterOps<Width>::Register Atan2(const typename RegisterOps<Width>::Register& y, const typename RegisterOps<Width>::Register& x)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		/* atan of min / max is in [0, pi/4], the octant is restored after */
+		const Register AbsY = Op::Abs(y);
+		const Register AbsX = Op::Abs(x);
+		const Register Min = Op::Min(AbsY, AbsX);
+		const Register Max = Op::Max(AbsY, AbsX);
+
+		/* atan2(0, 0) is 0 instead of NaN */
+		Register T = Op::Select(Op::CompareEqual(Max, Op::Replicate(0.0f)), Op::Replicate(0.0f), Op::Divide(Min, Max));
+		Register Offset = Op::Replicate(0.0f);
+		if (Accuracy == MathAccuracy::Precise)
+		{
+			/* Past tan(pi/8), atan(t) = pi/4 + atan((t - 1) / (t + 1)) keeps the Cephes polynomial in its range */
+			const Register Big = Op::CompareGreater(T, Op::Replicate(0.414213562f));
+			const Register One = Op::Replicate(1.0f);
+			T = Op::Select(Big, Op::Divide(Op::Subtract(T, One), Op::Add(T, One)), T);
+			Offset = Op::BitwiseAnd(Big, Op::Replicate(0.785398163f));
+		}
+		const Register T2 = Op::Multiply(T, T);
+
+		Register Angle;
+		if (Accuracy == MathAccuracy::Fast)
+		{
+			Angle = Op::MultiplyAdd(T2, Op::Replicate(8.9267515e-2f), Op::Replicate(-3.0105999e-1f));
+			Angle = Op::MultiplyAdd(T2, Angle, Op::Replicate(9.9842941e-1f));
+			Angle = Op::Multiply(T, Angle);
+		}
+		else if (Accuracy == MathAccuracy::Medium)
+		{
+			Angle = Op::MultiplyAdd(T2, Op::Replicate(2.3866605e-2f), Op::Replicate(-9.1933782e-2f));
+			Angle = Op::MultiplyAdd(T2, Angle, Op::Replicate(1.8522108e-1f));
+			Angle = Op::MultiplyAdd(T2, Angle, Op::Replicate(-3.3170234e-1f));
+			Angle = Op::MultiplyAdd(T2, Angle, Op::Replicate(9.9997015e-1f));
+			Angle = Op::Multiply(T, Angle);
+		}
+		else
+		{
+			Angle = Op::MultiplyAdd(T2, Op::Replicate(8.05374449538e-2f), Op::Replicate(-1.38776856032e-1f));
+			Angle = Op::MultiplyAdd(T2, Angle, Op::Replicate(1.99777106478e-1f));
+			Angle = Op::MultiplyAdd(T2, Angle, Op::Replicate(-3.33329491539e-1f));
+			Angle = Op::Add(Op::MultiplyAdd(Op::Multiply(T2, T), Angle, T), Offset);
+		}
+
+		Angle = Op::Select(Op::CompareGreater(AbsY, AbsX), Op::Subtract(Op::Replicate(1.57079632679f), Angle), Angle);
+		Angle = Op::Select(Op::CompareLess(x, Op::Replicate(0.0f)), Op::Subtract(Op::Replicate(3.14159265359f), Angle), Angle);
+		return Op::BitwiseXor(Angle, Op::BitwiseAnd(y, Op::Replicate(-0.0f)));
+	}
+
+	template<MathAccuracy Accuracy, int Width>
+	inline typename RegisterOps<Width>::Register Acos(const typename RegisterOps<Width>::Register& x)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		const Register AbsX = Op::Abs(x);
+		const Register Negative = Op::CompareLess(x, Op::Replicate(0.0f));
+		const Register Pi = Op::Replicate(3.14159265359f);
+
+		if (Accuracy != MathAccuracy::Precise)
+		{
+			/* acos(|x|) = sqrt(1 - |x|) * P(|x|) and acos(-x) = pi - acos(x) */
+			Register P;
+			if (Accuracy == MathAccuracy::Fast)
+			{
+				P = Op::MultiplyAdd(AbsX, Op::Replicate(-1.5597098e-1f), Op::Replicate(1.5646648f));
+			}
+			else
+			{
+				P = Op::MultiplyAdd(AbsX, Op::Replicate(-1.8616362e-2f), Op::Replicate(7.4093153e-2f));
+				P = Op::MultiplyAdd(AbsX, P, Op::Replicate(-2.1205248e-1f));
+				P = Op::MultiplyAdd(AbsX, P, Op::Replicate(1.5707254f));
+			}
+
+			const Register Angle = Op::Multiply(Op::Sqrt(Op::Subtract(Op::Replicate(1.0f), AbsX)), P);
+			return Op::Select(Negative, Op::Subtract(Pi, Angle), Angle);
+		}
+
+		/**
+		* Cephes asinf: asin(s) = s + s * z * P(z), past 0.5 the argument becomes s = sqrt((1 - |x|) / 2) which gives
+		* acos(|x|) = 2 * asin(s), below it acos(x) = pi/2 - asin(x)
+		*/
+		const Register Big = Op::CompareGreater(AbsX, Op::Replicate(0.5f));
+		const Register Z = Op::Select(Big, Op::Multiply(Op::Replicate(0.5f), Op::Subtract(Op::Replicate(1.0f), AbsX)), Op::Multiply(AbsX, AbsX));
+		const Register S = Op::Select(Big, Op::Sqrt(Z), AbsX);
+
+		Register P = Op::MultiplyAdd(Z, Op::Replicate(4.2163199048e-2f), Op::Replicate(2.4181311049e-2f));
+		P = Op::MultiplyAdd(Z, P, Op::Replicate(4.5470025998e-2f));
+		P = Op::MultiplyAdd(Z, P, Op::Replicate(7.4953002686e-2f));
+		P = Op::MultiplyAdd(Z, P, Op::Replicate(1.6666752422e-1f));
+		const Register Asin = Op::MultiplyAdd(Op::Multiply(S, Z), P, S);
+
+		Register BigAngle = Op::Add(Asin, Asin);
+		BigAngle = Op::Select(Negative, Op::Subtract(Pi, BigAngle), BigAngle);
+		const Register SmallAngle = Op::Subtract(Op::Replicate(1.57079632679f), Op::BitwiseXor(Asin, Op::BitwiseAnd(x, Op::Replicate(-0.0f))));
+		return Op::Select(Big, BigAngle, SmallAngle);
+	}
+
+	template<MathAccuracy Accuracy, int Width>
+	inline typename RegisterOps<Width>::Register Exp(const typename RegisterOps<Width>::Register& x)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		/* exp(x) = 2^n * exp(r), r = x - n * ln(2) in [-ln(2)/2, ln(2)/2] with ln(2) split in two parts */
+		const Register N = Op::Min(Op::Max(Op::Round(Op::Multiply(x, Op::Replicate(1.44269504089f))), Op::Replicate(-126.0f)), Op::Replicate(128.0f));
+		Register R = Op::MultiplyAdd(N, Op::Replicate(-0.693359375f), x);
+		R = Op::MultiplyAdd(N, Op::Replicate(2.12194440e-4f), R);
+		const Register R2 = Op::Multiply(R, R);
+
+		/* exp(r) = 1 + r + r^2 * P(r) */
+		Register P;
+		if (Accuracy == MathAccuracy::Fast)
+		{
+			P = Op::MultiplyAdd(R, Op::Replicate(1.6662817e-1f), Op::Replicate(5.0394109e-1f));
+		}
+		else if (Accuracy == MathAccuracy::Medium)
+		{
+			P = Op::MultiplyAdd(R, Op::Replicate(4.1277735e-2f), Op::Replicate(1.6753514e-1f));
+			P = Op::MultiplyAdd(R, P, Op::Replicate(5.0005116e-1f));
+		}
+		else
+		{
+			P = Op::MultiplyAdd(R, Op::Replicate(1.9875691500e-4f), Op::Replicate(1.3981999507e-3f));
+			P = Op::MultiplyAdd(R, P, Op::Replicate(8.3334519073e-3f));
+			P = Op::MultiplyAdd(R, P, Op::Replicate(4.1665795894e-2f));
+			P = Op::MultiplyAdd(R, P, Op::Replicate(1.6666665459e-1f));
+			P = Op::MultiplyAdd(R, P, Op::Replicate(5.0000001201e-1f));
+		}
+		const Register ExpR = Op::MultiplyAdd(R2, P, Op::Add(R, Op::Replicate(1.0f)));
+
+		/* 2^128 is not a float, the last step up to FLT_MAX is a separate multiply by 2 */
+		Register Result = Op::Multiply(ExpR, Op::Exp2Integer(Op::Min(N, Op::Replicate(127.0f))));
+		Result = Op::Multiply(Result, Op::Select(Op::CompareGreater(N, Op::Replicate(127.5f)), Op::Replicate(2.0f), Op::Replicate(1.0f)));
+
+		/* Overflow gives +inf, results below FLT_MIN are flushed to 0 */
+		Result = Op::Select(Op::CompareGreater(x, Op::Replicate(88.7228394f)), Op::Replicate(INFINITY), Result);
+		return Op::Select(Op::CompareLess(x, Op::Replicate(-87.3365448f)), Op::Replicate(0.0f), Result);
+	}
+
+	template<MathAccuracy Accuracy, int Width>
+	inline typename RegisterOps<Width>::Register Log(const typename RegisterOps<Width>::Register& x)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		/* Denormals are scaled up by 2^23 first so their exponent can be read from the bits */
+		const Register Denormal = Op::CompareLess(x, Op::Replicate(1.17549435e-38f));
+		const Register X = Op::Select(Denormal, Op::Multiply(x, Op::Replicate(8388608.0f)), x);
+
+		/* log(x) = e * ln(2) + log(1 + f) with 1 + f in [sqrt(0.5), sqrt(2)) */
+		Register Mantissa = Op::Mantissa(X);
+		Register E = Op::Subtract(Op::Exponent(X), Op::BitwiseAnd(Denormal, Op::Replicate(23.0f)));
+		const Register Halve = Op::CompareGreater(Mantissa, Op::Replicate(1.41421356f));
+		Mantissa = Op::Select(Halve, Op::Multiply(Mantissa, Op::Replicate(0.5f)), Mantissa);
+		E = Op::Add(E, Op::BitwiseAnd(Halve, Op::Replicate(1.0f)));
+
+		const Register F = Op::Subtract(Mantissa, Op::Replicate(1.0f));
+		const Register F2 = Op::Multiply(F, F);
+
+		/* log(1 + f) = f - f^2 / 2 + f^3 * P(f) */
+		Register P;
+		if (Accuracy == MathAccuracy::Fast)
+		{
+			P = Op::MultiplyAdd(F, Op::Replicate(-2.3728770e-1f), Op::Replicate(3.5024308e-1f));
+		}
+		else if (Accuracy == MathAccuracy::Medium)
+		{
+			P = Op::MultiplyAdd(F, Op::Replicate(1.1781789e-1f), Op::Replicate(-1.8407181e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(2.0442207e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(-2.4943833e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(3.3320860e-1f));
+		}
+		else
+		{
+			P = Op::MultiplyAdd(F, Op::Replicate(7.0376836292e-2f), Op::Replicate(-1.1514610310e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(1.1676998740e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(-1.2420140846e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(1.4249322787e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(-1.6668057665e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(2.0000714765e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(-2.4999993993e-1f));
+			P = Op::MultiplyAdd(F, P, Op::Replicate(3.3333331174e-1f));
+		}
+
+		/* ln(2) is split in two parts, the small one is added with the polynomial */
+		Register Y = Op::Multiply(Op::Multiply(F2, F), P);
+		Y = Op::MultiplyAdd(E, Op::Replicate(-2.12194440e-4f), Y);
+		Y = Op::MultiplyAdd(F2, Op::Replicate(-0.5f), Y);
+		Register Result = Op::MultiplyAdd(E, Op::Replicate(0.693359375f), Op::Add(F, Y));
+
+		/* log(0) = -inf, negative numbers give NaN, +inf and NaN are returned as they are */
+		Result = Op::Select(Op::CompareGreater(x, Op::Replicate(0.0f)), Result,
+			Op::Select(Op::CompareEqual(x, Op::Replicate(0.0f)), Op::Replicate(-INFINITY), Op::Replicate(NAN)));
+		return Op::Select(Op::CompareLess(x, Op::Replicate(INFINITY)), Result, x);
+	}
+
+	template<MathAccuracy Accuracy, int Width>
+	inline typename RegisterOps<Width>::Register ReciprocalSqrt(const typename RegisterOps<Width>::Register& x)
+	{
+		typedef RegisterOps<Width> Op;
+		typedef typename Op::Register Register;
+
+		if (Accuracy == MathAccuracy::Precise)
+		{
+			return Op::Divide(Op::Replicate(1.0f), Op::Sqrt(x));
+		}
+
+		const Register Estimate = Op::ReciprocalSqrtEstimate(x);
+		if (Accuracy == MathAccuracy::Fast)
+		{
+			return Estimate;
+		}
+
+		/* One Newton-Raphson step, e * (1.5 - 0.5 * x * e^2) */
+		const Register HalfX = Op::Multiply(x, Op::Replicate(0.5f));
+		return Op::Multiply(Estimate, Op::MultiplyAdd(Op::Multiply(HalfX, Estimate), Op::Subtract(Op::Replicate(0.0f), Estimate), Op::Replicate(1.5f)));
+	}
+}
+
+/**
+* Sine and cosine of every lane (radians) in one pass. For every finite angle the error stays within 3 ulp (Precise),
+* 27 ulp (Medium) and 9500 ulp (Fast) in every SIMD mode, see the table above
+*/
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline void VectorRegisterSinCos(const VectorRegister& angles, VectorRegister& outSin, VectorRegister& outCos)
+{
+	TranscendentalKernels::SinCos<Accuracy, 4>(angles, outSin, outCos);
+}
+
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline void VectorRegister8SinCos(const VectorRegister8& angles, VectorRegister8& outSin, VectorRegister8& outCos)
+{
+	TranscendentalKernels::SinCos<Accuracy, 8>(angles, outSin, outCos);
+}
+
+/* Angle of (x, y) in [-pi, pi] like atan2(), atan2(0, 0) is 0 */
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister VectorRegisterAtan2(const VectorRegister& y, const VectorRegister& x)
+{
+	return TranscendentalKernels::Atan2<Accuracy, 4>(y, x);
+}
+
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister8 VectorRegister8Atan2(const VectorRegister8& y, const VectorRegister8& x)
+{
+	return TranscendentalKernels::Atan2<Accuracy, 8>(y, x);
+}
+
+/* Arc cosine in [0, pi], NaN outside [-1, 1] */
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister VectorRegisterAcos(const VectorRegister& x)
+{
+	return TranscendentalKernels::Acos<Accuracy, 4>(x);
+}
+
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister8 VectorRegister8Acos(const VectorRegister8& x)
+{
+	return TranscendentalKernels::Acos<Accuracy, 8>(x);
+}
+
+/* e^x, +inf past 88.72 and 0 below -87.33 */
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister VectorRegisterExp(const VectorRegister& x)
+{
+	return TranscendentalKernels::Exp<Accuracy, 4>(x);
+}
+
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister8 VectorRegister8Exp(const VectorRegister8& x)
+{
+	return TranscendentalKernels::Exp<Accuracy, 8>(x);
+}
+
+/* Natural logarithm, -inf for 0 and NaN for negative numbers */
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister VectorRegisterLog(const VectorRegister& x)
+{
+	return TranscendentalKernels::Log<Accuracy, 4>(x);
+}
+
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister8 VectorRegister8Log(const VectorRegister8& x)
+{
+	return TranscendentalKernels::Log<Accuracy, 8>(x);
+}
+
+/**
+* 1 / sqrt(x), Fast is the hardware estimate and Medium adds one Newton-Raphson step to it
+* Fast and Medium expect positive finite input, Precise also handles 0 and +inf
+*/
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister VectorRegisterReciprocalSqrt(const VectorRegister& x)
+{
+	return TranscendentalKernels::ReciprocalSqrt<Accuracy, 4>(x);
+}
+
+template<MathAccuracy Accuracy = MathAccuracy::Precise>
+inline VectorRegister8 VectorRegister8ReciprocalSqrt(const VectorRegister8& x)
+{
+	return TranscendentalKernels::ReciprocalSqrt<Accuracy, 8>(x);
+}